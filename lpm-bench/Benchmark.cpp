@@ -0,0 +1,130 @@
+#include "Benchmark.h"
+
+#include <sys/time.h>
+#include <iomanip>
+
+
+BenchmarkCase::BenchmarkCase(string kernel, string unit, const BenchmarkSize& size)
+{
+	this->kernel = kernel;
+	this->unit = unit;
+	this->size = size;
+}
+
+BenchmarkCase::~BenchmarkCase()
+{
+}
+
+string BenchmarkCase::GetKernel() const
+{
+	return kernel;
+}
+
+string BenchmarkCase::GetUnit() const
+{
+	return unit;
+}
+
+const BenchmarkSize& BenchmarkCase::GetSize() const
+{
+	return size;
+}
+
+string BenchmarkCase::GetSizeString() const
+{
+	stringstream ss("");
+	ss << "L=" << size.numLoc << " T=" << size.numPeriods << " N=" << size.numUsers;
+	return ss.str();
+}
+
+string BenchmarkCase::GetReport() const
+{
+	return "";
+}
+
+BenchmarkRunner::BenchmarkRunner(double minSeconds, ostream& output) : output(output)
+{
+	this->minSeconds = minSeconds;
+}
+
+double BenchmarkRunner::GetTimeInSeconds()
+{
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+
+	return tv.tv_sec + tv.tv_usec * 1e-6;
+}
+
+void BenchmarkRunner::PrintHeader()
+{
+	output << left << setw(28) << "kernel" << setw(22) << "size" << right << setw(10) << "runs" << setw(14) << "us/run"
+			<< setw(22) << "throughput" << setw(14) << "allocs/run" << setw(14) << "KB/run" << "  report" << endl;
+}
+
+bool BenchmarkRunner::Run(BenchmarkCase* benchmark, BenchmarkResult* result)
+{
+	if(benchmark == NULL) { return false; }
+
+	if(benchmark->SetUp() == false)
+	{
+		output << left << setw(28) << benchmark->GetKernel() << setw(22) << benchmark->GetSizeString() << "set up failed!" << endl;
+		benchmark->TearDown();
+		return false;
+	}
+
+	Memory* memory = Memory::GetInstance();
+
+	bool success = benchmark->Run(); // warm-up
+
+	ull runs = 1; double elapsed = 0.0;
+	ull allocations = 0; ull bytes = 0;
+	while(success == true)
+	{
+		ull allocationsBefore = 0; ull bytesBefore = 0;
+		memory->GetAllocationStatistics(&allocationsBefore, &bytesBefore);
+
+		double start = GetTimeInSeconds();
+		for(ull i = 0; i < runs && success == true; i++) { success = benchmark->Run(); }
+		elapsed = GetTimeInSeconds() - start;
+
+		memory->GetAllocationStatistics(&allocations, &bytes);
+		allocations -= allocationsBefore; bytes -= bytesBefore;
+
+		if(elapsed >= minSeconds) { break; }
+
+		// aim at the minimum duration (at most 10 times more runs at once)
+		ull estimate = elapsed > 0.0 ? (ull)(runs * 1.2 * minSeconds / elapsed) + 1 : runs * 10;
+		runs = MAX(runs * 2, MIN(estimate, runs * 10));
+	}
+
+	benchmark->TearDown();
+
+	if(success == false)
+	{
+		output << left << setw(28) << benchmark->GetKernel() << setw(22) << benchmark->GetSizeString() << "run failed!" << endl;
+		return false;
+	}
+
+	BenchmarkResult res;
+	res.runs = runs;
+	res.secondsPerRun = elapsed / runs;
+	res.workPerSecond = res.secondsPerRun > 0.0 ? benchmark->GetWorkPerRun() / res.secondsPerRun : 0.0;
+	res.allocationsPerRun = (double)allocations / runs;
+	res.bytesPerRun = (double)bytes / runs;
+
+	stringstream throughput("");
+	throughput << setprecision(4) << res.workPerSecond << " " << benchmark->GetUnit() << "/s";
+
+	output << left << setw(28) << benchmark->GetKernel() << setw(22) << benchmark->GetSizeString() << right << setw(10) << res.runs
+			<< fixed << setprecision(2) << setw(14) << res.secondsPerRun * 1e6 << setw(22) << throughput.str()
+			<< setprecision(1) << setw(14) << res.allocationsPerRun << setw(14) << res.bytesPerRun / 1024.0;
+	output.unsetf(ios_base::floatfield);
+
+	string report = benchmark->GetReport();
+	if(report.empty() == false) { output << "  " << report; }
+	output << endl;
+
+	if(result != NULL) { *result = res; }
+
+	return true;
+}
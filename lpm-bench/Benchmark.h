@@ -0,0 +1,89 @@
+#ifndef BENCHMARK_H_
+#define BENCHMARK_H_
+
+#include "include/Public.h"
+#include "include/Private.h"
+
+using namespace lpm;
+using namespace std;
+
+
+// problem size of a benchmark case (not every kernel uses every dimension)
+struct BenchmarkSize
+{
+	ull numLoc; // L: number of locations
+	ull numPeriods; // T: number of time periods
+	ull numUsers; // N: number of users (or of items, e.g. assignment size, parsed fields)
+};
+
+/*
+ * A benchmark case: one kernel at one problem size.
+ * SetUp() and TearDown() are not timed; Run() is the timed operation and is called repeatedly (each call does GetWorkPerRun() units of work).
+ */
+class BenchmarkCase
+{
+  public:
+	BenchmarkCase(string kernel, string unit, const BenchmarkSize& size);
+
+	virtual ~BenchmarkCase();
+
+	string GetKernel() const;
+
+	string GetUnit() const;
+
+	const BenchmarkSize& GetSize() const;
+
+	virtual string GetSizeString() const;
+
+	virtual bool SetUp() = 0;
+
+	virtual bool Run() = 0;
+
+	virtual void TearDown() = 0;
+
+	virtual double GetWorkPerRun() const = 0;
+
+	// additional result of the case (e.g. the accuracy of an approximation), reported after the statistics
+	virtual string GetReport() const;
+
+  protected:
+	string kernel;
+
+	string unit;
+
+	BenchmarkSize size;
+};
+
+// measured statistics of a benchmark case
+struct BenchmarkResult
+{
+	ull runs;
+	double secondsPerRun;
+	double workPerSecond;
+	double allocationsPerRun; // chunks allocated through Allocate (see Memory::GetAllocationStatistics())
+	double bytesPerRun;
+};
+
+/*
+ * Runs the benchmark cases and reports their throughput and allocations (one line per case).
+ * Each case is run once to warm up, then repeatedly (doubling the number of runs) until the timed loop lasts at least the minimum duration.
+ */
+class BenchmarkRunner
+{
+  public:
+	BenchmarkRunner(double minSeconds = 0.5, ostream& output = cout);
+
+	void PrintHeader();
+
+	bool Run(BenchmarkCase* benchmark, BenchmarkResult* result = NULL);
+
+  private:
+	static double GetTimeInSeconds();
+
+	double minSeconds;
+
+	ostream& output;
+};
+
+
+#endif
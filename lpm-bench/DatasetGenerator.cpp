@@ -0,0 +1,154 @@
+#include "DatasetGenerator.h"
+
+#include <iomanip>
+
+
+DatasetGenerator::DatasetGenerator(ull numUsers, ull numTimes, ull numLoc, uint64 seed) : stream(seed)
+{
+	this->numUsers = numUsers;
+	this->numTimes = numTimes;
+	this->numLoc = numLoc;
+
+	gridWidth = 1;
+	while(gridWidth * gridWidth < numLoc) { gridWidth++; }
+}
+
+bool DatasetGenerator::Generate(const string& prefix)
+{
+	if(numUsers == 0 || numTimes < 2 || numLoc < 2) { return false; }
+
+	size_t pos = prefix.rfind('/');
+	string directory = (pos == string::npos) ? "." : prefix.substr(0, pos);
+
+	return WriteLocations(directory + "/" "locations") == true && WriteMobility(prefix + ".mobility") == true && WriteTraces(prefix + ".trace") == true;
+}
+
+bool DatasetGenerator::WriteLocations(const string& filePath) const
+{
+	File file(filePath, false);
+	if(file.IsGood() == false) { return false; }
+
+	for(ull loc = 1; loc <= numLoc; loc++)
+	{
+		stringstream ss(""); ss << fixed << setprecision(1);
+		ss << (double)GetGridX(loc) << DEFAULT_FIELDS_DELIMITER << " " << (double)GetGridY(loc);
+
+		if(file.WriteLine(ss.str()) == false) { return false; }
+	}
+
+	return true;
+}
+
+bool DatasetGenerator::WriteMobility(const string& filePath) const
+{
+	File file(filePath, false);
+	if(file.IsGood() == false) { return false; }
+
+	for(ull loc1 = 1; loc1 <= numLoc; loc1++)
+	{
+		stringstream ss("");
+		for(ull loc2 = 1; loc2 <= numLoc; loc2++)
+		{
+			if(loc2 != 1) { ss << DEFAULT_FIELDS_DELIMITER << " "; }
+			ss << (IsFeasible(loc1, loc2) == true ? 1 : 0);
+		}
+
+		if(file.WriteLine(ss.str()) == false) { return false; }
+	}
+
+	return true;
+}
+
+bool DatasetGenerator::WriteTraces(const string& filePath)
+{
+	File file(filePath, false);
+	if(file.IsGood() == false) { return false; }
+
+	const double wanderProb = 0.1;
+
+	for(ull user = 1; user <= numUsers; user++)
+	{
+		ull home = stream.GetUniformRandomULLBetween(1, numLoc);
+		ull work = stream.GetUniformRandomULLBetween(1, numLoc);
+
+		ull loc = home;
+		for(ull tm = 1; tm <= numTimes; tm++)
+		{
+			if(tm > 1)
+			{
+				// at work from 8am to 5pm, at home otherwise
+				ull hour = (tm - 1) % DATASET_DAY_LENGTH;
+				ull target = (hour >= 8 && hour < 17) ? work : home;
+
+				if(stream.GetUniformRandomDouble() < wanderProb) { loc = RandomNeighbour(loc); }
+				else { loc = StepTowards(loc, target); }
+			}
+
+			stringstream ss("");
+			ss << user << DEFAULT_FIELDS_DELIMITER << tm << DEFAULT_FIELDS_DELIMITER << loc;
+
+			if(file.WriteLine(ss.str()) == false) { return false; }
+		}
+	}
+
+	return true;
+}
+
+ull DatasetGenerator::GetGridX(ull loc) const
+{
+	return (loc - 1) % gridWidth;
+}
+
+ull DatasetGenerator::GetGridY(ull loc) const
+{
+	return (loc - 1) / gridWidth;
+}
+
+// returns the location at the given cell of the grid (0 if the cell is outside of the grid)
+ull DatasetGenerator::GetLocation(ull x, ull y) const
+{
+	if(x >= gridWidth) { return 0; }
+
+	ull loc = y * gridWidth + x + 1;
+
+	return loc <= numLoc ? loc : 0;
+}
+
+bool DatasetGenerator::IsFeasible(ull loc1, ull loc2) const
+{
+	ll dx = (ll)GetGridX(loc1) - (ll)GetGridX(loc2);
+	ll dy = (ll)GetGridY(loc1) - (ll)GetGridY(loc2);
+
+	return ABS(dx) <= DATASET_MOBILITY_RADIUS && ABS(dy) <= DATASET_MOBILITY_RADIUS;
+}
+
+// moves (at most) one cell towards the target (diagonally if need be)
+ull DatasetGenerator::StepTowards(ull loc, ull target) const
+{
+	ull x = GetGridX(loc); ull y = GetGridY(loc);
+	ull tx = GetGridX(target); ull ty = GetGridY(target);
+
+	ull nx = x < tx ? x + 1 : (x > tx ? x - 1 : x);
+	ull ny = y < ty ? y + 1 : (y > ty ? y - 1 : y);
+
+	ull next = GetLocation(nx, ny);
+	if(next == 0) { next = GetLocation(nx, y); } // the last row of the grid may be incomplete (the current row is complete)
+
+	return next;
+}
+
+ull DatasetGenerator::RandomNeighbour(ull loc)
+{
+	ull x = GetGridX(loc); ull y = GetGridY(loc);
+
+	while(true)
+	{
+		ll nx = (ll)x + (ll)stream.GetUniformRandomULLBetween(0, 2) - 1;
+		ll ny = (ll)y + (ll)stream.GetUniformRandomULLBetween(0, 2) - 1;
+
+		if(nx < 0 || ny < 0) { continue; }
+
+		ull next = GetLocation((ull)nx, (ull)ny);
+		if(next != 0) { return next; }
+	}
+}
@@ -0,0 +1,63 @@
+#ifndef DATASETGENERATOR_H_
+#define DATASETGENERATOR_H_
+
+#include "include/Public.h"
+#include "include/Private.h"
+#include "include/RNG.h"
+
+using namespace lpm;
+using namespace std;
+
+
+// transitions are feasible between locations at most this many grid cells apart (in each direction)
+#define DATASET_MOBILITY_RADIUS 2
+
+// number of timestamps in a day of the generated traces
+#define DATASET_DAY_LENGTH 24
+
+/*
+ * Generates a synthetic sg-LPM input dataset: <prefix>.trace, <prefix>.mobility and <directory of prefix>/locations.
+ *
+ * The L locations are laid out on a grid (one unit apart), and a transition is feasible between locations at most DATASET_MOBILITY_RADIUS
+ * cells apart. Each of the N users has a home and a work location: the user is at home at night, commutes (one cell per timestamp) to
+ * work in the day, and sometimes wanders to a neighbouring location. Every trace is complete (T timestamps) and only uses feasible transitions.
+ */
+class DatasetGenerator
+{
+  public:
+	DatasetGenerator(ull numUsers, ull numTimes, ull numLoc, uint64 seed = 1);
+
+	bool Generate(const string& prefix);
+
+  private:
+	bool WriteLocations(const string& filePath) const;
+
+	bool WriteMobility(const string& filePath) const;
+
+	bool WriteTraces(const string& filePath);
+
+	ull GetGridX(ull loc) const;
+
+	ull GetGridY(ull loc) const;
+
+	ull GetLocation(ull x, ull y) const;
+
+	bool IsFeasible(ull loc1, ull loc2) const;
+
+	ull StepTowards(ull loc, ull target) const;
+
+	ull RandomNeighbour(ull loc);
+
+	ull numUsers;
+
+	ull numTimes;
+
+	ull numLoc;
+
+	ull gridWidth;
+
+	RNGStream stream;
+};
+
+
+#endif
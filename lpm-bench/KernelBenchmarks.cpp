@@ -0,0 +1,627 @@
+#include "KernelBenchmarks.h"
+
+#include <unistd.h>
+#include <iomanip>
+
+
+// seed of the random inputs (the inputs of a case only depend on its size)
+const uint64 BENCH_INPUT_SEED = 0x5EED;
+
+// number of samples drawn by each run of the RNG sampling cases
+const ull BENCH_SAMPLES_PER_RUN = 1000;
+
+bool SetUpBenchmarkParameters(const BenchmarkSize& size)
+{
+	Parameters* params = Parameters::GetInstance();
+
+	if(size.numLoc < 2 || size.numPeriods == 0 || (BENCH_NUM_TIMESTAMPS % size.numPeriods) != 0) { return false; }
+
+	params->ClearUsersSet();
+	if(params->AddUsersRange(1, MAX(size.numUsers, 1)) == false) { return false; }
+	if(params->SetTimestampsRange(1, BENCH_NUM_TIMESTAMPS) == false) { return false; }
+	if(params->SetLocationstampsRange(1, size.numLoc) == false) { return false; }
+
+	TPNode* partitioning = params->CreateTimePartitioning(1, BENCH_NUM_TIMESTAMPS);
+	if(partitioning == NULL) { return false; }
+
+	ull periodLength = BENCH_NUM_TIMESTAMPS / size.numPeriods;
+
+	vector<TimePeriod> periods = vector<TimePeriod>();
+	for(ull tp = 0; tp < size.numPeriods; tp++)
+	{
+		TimePeriod period;
+		period.start = tp * periodLength;
+		period.length = periodLength;
+		period.id = tp + 1;
+		period.dummy = false;
+
+		periods.push_back(period);
+	}
+
+	return partitioning->Partition(periods) == true && params->SetTimePartitioning(partitioning) == true;
+}
+
+// fills the given (dimension x dimension) matrix with a random transition matrix (each row sums up to 1)
+static void FillRandomTransitionMatrix(double* matrix, ull dimension, RNGStream* stream)
+{
+	stream->FillUniform(matrix, dimension * dimension);
+	for(ull row = 0; row < dimension; row++) { NORMALIZE_VECTOR(&matrix[GET_INDEX(row, 0, dimension)], dimension); }
+}
+
+static string GetItemsSizeString(const char* name, ull count)
+{
+	stringstream ss("");
+	ss << name << "=" << count;
+	return ss.str();
+}
+
+
+MinimumCostAssignmentCase::MinimumCostAssignmentCase(const BenchmarkSize& size)
+ : BenchmarkCase("MinimumCostAssignment(ll)", "row", size)
+{
+}
+
+string MinimumCostAssignmentCase::GetSizeString() const
+{
+	return GetItemsSizeString("N", size.numUsers);
+}
+
+bool MinimumCostAssignmentCase::SetUp()
+{
+	ull n = size.numUsers;
+	if(n == 0) { return false; }
+
+	RNGStream stream(BENCH_INPUT_SEED);
+
+	costs = vector<ll>(n * n);
+	for(ull i = 0; i < n * n; i++) { costs[i] = (ll)stream.GetUniformRandomULLBetween(0, 1000000); }
+
+	work = vector<ll>(n * n);
+	assignment = vector<ll>(n);
+
+	return true;
+}
+
+bool MinimumCostAssignmentCase::Run()
+{
+	// the cost matrix is modified by the algorithm
+	memcpy(&work[0], &costs[0], costs.size() * sizeof(ll));
+	Algorithms::MinimumCostAssignment(&work[0], (ll)size.numUsers, &assignment[0]);
+
+	return true;
+}
+
+void MinimumCostAssignmentCase::TearDown()
+{
+	costs.clear(); work.clear(); assignment.clear();
+}
+
+double MinimumCostAssignmentCase::GetWorkPerRun() const
+{
+	return size.numUsers;
+}
+
+
+RealMinimumCostAssignmentCase::RealMinimumCostAssignmentCase(const BenchmarkSize& size)
+ : BenchmarkCase("MinimumCostAssignment(dbl)", "row", size)
+{
+}
+
+string RealMinimumCostAssignmentCase::GetSizeString() const
+{
+	return GetItemsSizeString("N", size.numUsers);
+}
+
+bool RealMinimumCostAssignmentCase::SetUp()
+{
+	ull n = size.numUsers;
+	if(n == 0) { return false; }
+
+	RNGStream stream(BENCH_INPUT_SEED);
+
+	costs = vector<double>(n * n);
+	for(ull i = 0; i < n * n; i++) { costs[i] = -log(stream.GetUniformRandomDouble()); } // negative log-likelihoods
+
+	assignment = vector<ll>(n);
+
+	return true;
+}
+
+bool RealMinimumCostAssignmentCase::Run()
+{
+	Algorithms::MinimumCostAssignment(&costs[0], size.numUsers, &assignment[0]);
+
+	return true;
+}
+
+void RealMinimumCostAssignmentCase::TearDown()
+{
+	costs.clear(); assignment.clear();
+}
+
+double RealMinimumCostAssignmentCase::GetWorkPerRun() const
+{
+	return size.numUsers;
+}
+
+
+MaximumWeightAssignmentCase::MaximumWeightAssignmentCase(const BenchmarkSize& size)
+ : BenchmarkCase("MaximumWeightAssignment", "row", size)
+{
+}
+
+string MaximumWeightAssignmentCase::GetSizeString() const
+{
+	return GetItemsSizeString("N", size.numUsers);
+}
+
+bool MaximumWeightAssignmentCase::SetUp()
+{
+	ull n = size.numUsers;
+	if(n == 0) { return false; }
+
+	RNGStream stream(BENCH_INPUT_SEED);
+
+	weights = vector<ll>(n * n);
+	for(ull i = 0; i < n * n; i++) { weights[i] = (ll)stream.GetUniformRandomULLBetween(0, 1000000); }
+
+	work = vector<ll>(n * n);
+	mapping = vector<ll>(n);
+
+	return true;
+}
+
+bool MaximumWeightAssignmentCase::Run()
+{
+	// the weight matrix is modified by the algorithm
+	memcpy(&work[0], &weights[0], weights.size() * sizeof(ll));
+	Algorithms::MaximumWeightAssignment((ll)size.numUsers, &work[0], &mapping[0]);
+
+	return true;
+}
+
+void MaximumWeightAssignmentCase::TearDown()
+{
+	weights.clear(); work.clear(); mapping.clear();
+}
+
+double MaximumWeightAssignmentCase::GetWorkPerRun() const
+{
+	return size.numUsers;
+}
+
+
+ApproximateAssignmentCase::ApproximateAssignmentCase(const BenchmarkSize& size, double regularization, ull iterations)
+ : BenchmarkCase("ApproximateAssignment", "row", size)
+{
+	this->regularization = regularization;
+	this->iterations = iterations;
+}
+
+string ApproximateAssignmentCase::GetSizeString() const
+{
+	stringstream ss("");
+	ss << "N=" << size.numUsers << " eps=" << regularization << " it=" << iterations;
+	return ss.str();
+}
+
+bool ApproximateAssignmentCase::SetUp()
+{
+	ull n = size.numUsers;
+	if(n == 0) { return false; }
+
+	RNGStream stream(BENCH_INPUT_SEED);
+
+	// skewed distributions (normalized exponential variates, i.e. uniform Dirichlet samples)
+	first = vector<double>(n); second = vector<double>(n);
+	for(ull i = 0; i < n; i++) { first[i] = -log(stream.GetUniformRandomDouble()); second[i] = -log(stream.GetUniformRandomDouble()); }
+	NORMALIZE_VECTOR(&first[0], n); NORMALIZE_VECTOR(&second[0], n);
+
+	weights = vector<double>(n * n);
+	vector<double> costs = vector<double>(n * n);
+	for(ull i = 0; i < n; i++)
+	{
+		for(ull j = 0; j < n; j++)
+		{
+			weights[GET_INDEX(i, j, n)] = log2(MIN(first[i], second[j]));
+			costs[GET_INDEX(i, j, n)] = -weights[GET_INDEX(i, j, n)];
+		}
+	}
+
+	// accuracy against the exact assignment
+	vector<ll> exact = vector<ll>(n);
+	Algorithms::MinimumCostAssignment(&costs[0], n, &exact[0]);
+
+	assignment = vector<ll>(n);
+	Algorithms::ApproximateMaximumWeightAssignment(&weights[0], n, &assignment[0], regularization, iterations);
+
+	ull sameRows = 0;
+	for(ull i = 0; i < n; i++) { if(assignment[i] == exact[i]) { sameRows++; } }
+
+	stringstream ss("");
+	ss << fixed << setprecision(4) << "similarity ratio=" << ComputeSimilarity(assignment) / ComputeSimilarity(exact);
+	ss << setprecision(1) << " same rows=" << 100.0 * sameRows / n << "%";
+	report = ss.str();
+
+	return true;
+}
+
+bool ApproximateAssignmentCase::Run()
+{
+	Algorithms::ApproximateMaximumWeightAssignment(&weights[0], size.numUsers, &assignment[0], regularization, iterations);
+
+	return true;
+}
+
+void ApproximateAssignmentCase::TearDown()
+{
+	first.clear(); second.clear(); weights.clear(); assignment.clear();
+}
+
+double ApproximateAssignmentCase::GetWorkPerRun() const
+{
+	return size.numUsers;
+}
+
+string ApproximateAssignmentCase::GetReport() const
+{
+	return report;
+}
+
+double ApproximateAssignmentCase::ComputeSimilarity(const vector<ll>& sigma) const
+{
+	double similarity = 0.0;
+	for(ull i = 0; i < sigma.size(); i++) { similarity += MIN(first[i], second[sigma[i]]); }
+
+	return similarity;
+}
+
+
+MultiplySquareMatricesCase::MultiplySquareMatricesCase(const BenchmarkSize& size)
+ : BenchmarkCase("MultiplySquareMatrices", "flop", size)
+{
+	dimension = size.numLoc * size.numPeriods;
+}
+
+bool MultiplySquareMatricesCase::SetUp()
+{
+	if(dimension == 0) { return false; }
+
+	RNGStream stream(BENCH_INPUT_SEED);
+
+	left = vector<double>(dimension * dimension);
+	right = vector<double>(dimension * dimension);
+	result = vector<double>(dimension * dimension);
+
+	FillRandomTransitionMatrix(&left[0], dimension, &stream);
+	FillRandomTransitionMatrix(&right[0], dimension, &stream);
+
+	return true;
+}
+
+bool MultiplySquareMatricesCase::Run()
+{
+	Algorithms::MultiplySquareMatrices(&left[0], &right[0], dimension, &result[0]);
+
+	return true;
+}
+
+void MultiplySquareMatricesCase::TearDown()
+{
+	left.clear(); right.clear(); result.clear();
+}
+
+double MultiplySquareMatricesCase::GetWorkPerRun() const
+{
+	return 2.0 * dimension * dimension * dimension;
+}
+
+
+SteadyStateVectorCase::SteadyStateVectorCase(const BenchmarkSize& size)
+ : BenchmarkCase("ComputeSteadyStateVector", "state", size)
+{
+	kernels = NULL;
+}
+
+bool SteadyStateVectorCase::SetUp()
+{
+	if(SetUpBenchmarkParameters(size) == false) { return false; }
+
+	ull numStates = size.numLoc * size.numPeriods;
+
+	RNGStream stream(BENCH_INPUT_SEED);
+
+	transitionMatrix = vector<double>(numStates * numStates);
+	FillRandomTransitionMatrix(&transitionMatrix[0], numStates, &stream);
+
+	steadyStateVector = vector<double>(numStates);
+
+	kernels = new KnowledgeConstructionKernels();
+
+	return true;
+}
+
+bool SteadyStateVectorCase::Run()
+{
+	kernels->ComputeSteadyStateVector(&transitionMatrix[0], &steadyStateVector[0]);
+
+	return true;
+}
+
+void SteadyStateVectorCase::TearDown()
+{
+	if(kernels != NULL) { kernels->Release(); kernels = NULL; }
+
+	transitionMatrix.clear(); steadyStateVector.clear();
+}
+
+double SteadyStateVectorCase::GetWorkPerRun() const
+{
+	return size.numLoc * size.numPeriods;
+}
+
+
+GibbsSamplingCase::GibbsSamplingCase(const BenchmarkSize& size)
+ : BenchmarkCase("DoGibbsSampling", "user", size)
+{
+	kernels = NULL;
+	priorTransitionsCount = NULL;
+}
+
+bool GibbsSamplingCase::SetUp()
+{
+	if(size.numUsers == 0 || SetUpBenchmarkParameters(size) == false) { return false; }
+
+	ull numStates = size.numLoc * size.numPeriods;
+
+	stream = RNGStream(BENCH_INPUT_SEED);
+
+	// a uniform prior (every transition is feasible)
+	ull countByteSize = numStates * numStates * sizeof(double);
+	priorTransitionsCount = (double*)Allocate(countByteSize);
+	VERIFY(priorTransitionsCount != NULL);
+	for(ull i = 0; i < numStates * numStates; i++) { priorTransitionsCount[i] = 1.0; }
+
+	// one full learning trace (over all the timestamps) per user
+	traces = vector<vector<TraceVector> >(size.numUsers);
+	for(ull u = 0; u < size.numUsers; u++)
+	{
+		TraceVector tvec;
+		tvec.offset = 1;
+		tvec.length = BENCH_NUM_TIMESTAMPS;
+		tvec.trace = (ull*)Allocate(tvec.length * sizeof(ull));
+		VERIFY(tvec.trace != NULL);
+
+		for(ull tm = 0; tm < tvec.length; tm++) { tvec.trace[tm] = stream.GetUniformRandomULLBetween(1, size.numLoc); }
+
+		traces[u].push_back(tvec);
+	}
+
+	kernels = new KnowledgeConstructionKernels();
+
+	return true;
+}
+
+bool GibbsSamplingCase::Run()
+{
+	bool success = true;
+	for(ull u = 0; u < size.numUsers && success == true; u++)
+	{
+		UserProfile* profile = new UserProfile(u + 1);
+		success = kernels->DoGibbsSampling(traces[u], priorTransitionsCount, profile, &stream);
+		profile->Release();
+	}
+
+	return success;
+}
+
+void GibbsSamplingCase::TearDown()
+{
+	if(kernels != NULL) { kernels->Release(); kernels = NULL; }
+
+	if(priorTransitionsCount != NULL) { Free(priorTransitionsCount); priorTransitionsCount = NULL; }
+
+	foreach_const(vector<vector<TraceVector> >, traces, iter) { foreach_const(vector<TraceVector>, *iter, iterTV) { Free(iterTV->trace); } }
+	traces.clear();
+}
+
+double GibbsSamplingCase::GetWorkPerRun() const
+{
+	return size.numUsers;
+}
+
+
+RNGSamplingCase::RNGSamplingCase(const BenchmarkSize& size, Method method)
+ : BenchmarkCase(method == LinearScan ? "RNG::SampleIndexFromVector" : (method == AliasMethod ? "AliasTable::Sample" : "GetDirichletRandomSample"),
+		 method == Dirichlet ? "variate" : "sample", size)
+{
+	this->method = method;
+	checksum = 0;
+}
+
+string RNGSamplingCase::GetSizeString() const
+{
+	return GetItemsSizeString("L", size.numLoc);
+}
+
+bool RNGSamplingCase::SetUp()
+{
+	if(size.numLoc == 0) { return false; }
+
+	stream = RNGStream(BENCH_INPUT_SEED);
+
+	probVector = vector<double>(size.numLoc);
+	stream.FillUniform(&probVector[0], size.numLoc);
+	NORMALIZE_VECTOR(&probVector[0], size.numLoc);
+
+	theta = vector<double>(size.numLoc);
+
+	return method != AliasMethod || table.Build(&probVector[0], size.numLoc) == true;
+}
+
+bool RNGSamplingCase::Run()
+{
+	switch(method)
+	{
+		case LinearScan:
+			for(ull i = 0; i < BENCH_SAMPLES_PER_RUN; i++) { checksum += stream.SampleIndexFromVector(&probVector[0], size.numLoc); }
+			break;
+
+		case AliasMethod:
+			for(ull i = 0; i < BENCH_SAMPLES_PER_RUN; i++) { checksum += table.Sample(&stream); }
+			break;
+
+		case Dirichlet: // the alpha of a posterior (counts + 1)
+			stream.GetDirichletRandomSample(&probVector[0], size.numLoc, &theta[0]);
+			break;
+	}
+
+	return true;
+}
+
+void RNGSamplingCase::TearDown()
+{
+	probVector.clear(); theta.clear();
+}
+
+double RNGSamplingCase::GetWorkPerRun() const
+{
+	return method == Dirichlet ? size.numLoc : BENCH_SAMPLES_PER_RUN;
+}
+
+
+ParseFieldsCase::ParseFieldsCase(const BenchmarkSize& size)
+ : BenchmarkCase("LineParser::ParseFields", "field", size)
+{
+}
+
+string ParseFieldsCase::GetSizeString() const
+{
+	return GetItemsSizeString("N", size.numUsers);
+}
+
+bool ParseFieldsCase::SetUp()
+{
+	if(size.numUsers == 0) { return false; }
+
+	RNGStream stream(BENCH_INPUT_SEED);
+
+	// a line as written by LineFormatter (e.g. a row of a transition matrix)
+	vector<double> row = vector<double>(size.numUsers);
+	stream.FillUniform(&row[0], size.numUsers);
+
+	VERIFY(LineFormatter<double>::GetInstance()->FormatVector(&row[0], size.numUsers, line) == true);
+
+	values.reserve(size.numUsers);
+
+	return true;
+}
+
+bool ParseFieldsCase::Run()
+{
+	values.clear();
+
+	return LineParser<double>::GetInstance()->ParseFields(line, values, size.numUsers) == true;
+}
+
+void ParseFieldsCase::TearDown()
+{
+	line = ""; values.clear();
+}
+
+double ParseFieldsCase::GetWorkPerRun() const
+{
+	return size.numUsers;
+}
+
+
+ContextFileCase::ContextFileCase(const BenchmarkSize& size, bool store, string directory)
+ : BenchmarkCase(store == true ? "StoreContextOperation" : "LoadContextOperation", "profile", size)
+{
+	this->store = store;
+	context = NULL;
+
+	stringstream ss("");
+	ss << directory << "/lpm-bench-context-" << getpid() << ".tmp";
+	filePath = ss.str();
+}
+
+bool ContextFileCase::SetUp()
+{
+	if(size.numUsers == 0 || SetUpBenchmarkParameters(size) == false) { return false; }
+
+	ull numStates = size.numLoc * size.numPeriods;
+
+	RNGStream stream(BENCH_INPUT_SEED);
+
+	// a context of random profiles (which the load case reads from the stored file)
+	context = new Context();
+	for(ull u = 1; u <= size.numUsers; u++)
+	{
+		double* transitionMatrix = (double*)Allocate(numStates * numStates * sizeof(double));
+		double* steadyStateVector = (double*)Allocate(numStates * sizeof(double));
+		VERIFY(transitionMatrix != NULL && steadyStateVector != NULL);
+
+		FillRandomTransitionMatrix(transitionMatrix, numStates, &stream);
+		for(ull i = 0; i < numStates; i++) { steadyStateVector[i] = 1.0 / numStates; }
+
+		UserProfile* profile = new UserProfile(u);
+		VERIFY(profile->SetTransitionMatrix(transitionMatrix) == true && profile->SetSteadyStateVector(steadyStateVector) == true);
+
+		VERIFY(context->AddProfile(profile) == true);
+		profile->Release();
+	}
+
+	if(store == false) // write the file read by the runs
+	{
+		StoreContextOperation* operation = new StoreContextOperation();
+		File file(filePath, false);
+
+		bool success = operation->Execute(context, &file);
+		operation->Release();
+
+		if(success == false) { return false; }
+	}
+
+	return true;
+}
+
+bool ContextFileCase::Run()
+{
+	bool success = false;
+
+	if(store == true)
+	{
+		StoreContextOperation* operation = new StoreContextOperation();
+		File file(filePath, false);
+
+		success = operation->Execute(context, &file);
+		operation->Release();
+	}
+	else
+	{
+		LoadContextOperation* operation = new LoadContextOperation();
+		File file(filePath, true);
+		Context* loaded = new Context();
+
+		map<ull, UserProfile*> profiles = map<ull, UserProfile*>();
+		success = operation->Execute(&file, loaded) == true && loaded->GetProfiles(profiles) == true && profiles.size() == size.numUsers;
+
+		loaded->Release(); operation->Release();
+	}
+
+	return success;
+}
+
+void ContextFileCase::TearDown()
+{
+	if(context != NULL) { context->Release(); context = NULL; }
+
+	remove(filePath.c_str());
+	remove((filePath + ".accuracy").c_str());
+}
+
+double ContextFileCase::GetWorkPerRun() const
+{
+	return size.numUsers;
+}
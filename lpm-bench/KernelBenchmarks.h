@@ -0,0 +1,220 @@
+#ifndef KERNELBENCHMARKS_H_
+#define KERNELBENCHMARKS_H_
+
+#include "Benchmark.h"
+
+#include "include/Algorithms.h"
+#include "include/RNG.h"
+
+
+// number of timestamps of the benchmark parameters (split into T time periods of equal length)
+#define BENCH_NUM_TIMESTAMPS 24
+
+// sets the parameters (users 1..N, locations 1..L, T time periods over BENCH_NUM_TIMESTAMPS timestamps) used by the knowledge kernels
+bool SetUpBenchmarkParameters(const BenchmarkSize& size);
+
+// exposes the knowledge construction kernels of CreateContextOperation
+class KnowledgeConstructionKernels : public CreateContextOperation
+{
+  public:
+	using CreateContextOperation::ComputeSteadyStateVector;
+
+	using CreateContextOperation::DoGibbsSampling;
+};
+
+
+// Algorithms::MinimumCostAssignment() on an N x N integer cost matrix
+class MinimumCostAssignmentCase : public BenchmarkCase
+{
+  public:
+	MinimumCostAssignmentCase(const BenchmarkSize& size);
+
+	virtual string GetSizeString() const;
+	virtual bool SetUp();
+	virtual bool Run();
+	virtual void TearDown();
+	virtual double GetWorkPerRun() const;
+
+  private:
+	vector<ll> costs;
+	vector<ll> work;
+	vector<ll> assignment;
+};
+
+// Algorithms::MinimumCostAssignment() on an N x N floating-point cost matrix
+class RealMinimumCostAssignmentCase : public BenchmarkCase
+{
+  public:
+	RealMinimumCostAssignmentCase(const BenchmarkSize& size);
+
+	virtual string GetSizeString() const;
+	virtual bool SetUp();
+	virtual bool Run();
+	virtual void TearDown();
+	virtual double GetWorkPerRun() const;
+
+  private:
+	vector<double> costs;
+	vector<ll> assignment;
+};
+
+// Algorithms::MaximumWeightAssignment() on an N x N weight matrix
+class MaximumWeightAssignmentCase : public BenchmarkCase
+{
+  public:
+	MaximumWeightAssignmentCase(const BenchmarkSize& size);
+
+	virtual string GetSizeString() const;
+	virtual bool SetUp();
+	virtual bool Run();
+	virtual void TearDown();
+	virtual double GetWorkPerRun() const;
+
+  private:
+	vector<ll> weights;
+	vector<ll> work;
+	vector<ll> mapping;
+};
+
+// Algorithms::ApproximateMaximumWeightAssignment() on the N x N weight matrix of the zeroth-order hidden semantics similarity of two random
+// stationary distributions p, q (w[i][j] = log2(min(p[i], q[j])), see HiddenSemanticsSimilarityAnalysisOperation)
+// its accuracy against the exact assignment (Algorithms::MinimumCostAssignment()) is reported: ratio of the similarities sum_i min(p[i], q[sigma[i]])
+// and proportion of the rows assigned as in the exact assignment
+class ApproximateAssignmentCase : public BenchmarkCase
+{
+  public:
+	ApproximateAssignmentCase(const BenchmarkSize& size, double regularization, ull iterations);
+
+	virtual string GetSizeString() const;
+	virtual bool SetUp();
+	virtual bool Run();
+	virtual void TearDown();
+	virtual double GetWorkPerRun() const;
+	virtual string GetReport() const;
+
+  private:
+	double ComputeSimilarity(const vector<ll>& sigma) const;
+
+	double regularization;
+	ull iterations;
+
+	vector<double> first;
+	vector<double> second;
+	vector<double> weights;
+	vector<ll> assignment;
+
+	string report;
+};
+
+// Algorithms::MultiplySquareMatrices() on (L*T) x (L*T) matrices
+class MultiplySquareMatricesCase : public BenchmarkCase
+{
+  public:
+	MultiplySquareMatricesCase(const BenchmarkSize& size);
+
+	virtual bool SetUp();
+	virtual bool Run();
+	virtual void TearDown();
+	virtual double GetWorkPerRun() const;
+
+  private:
+	ull dimension;
+	vector<double> left;
+	vector<double> right;
+	vector<double> result;
+};
+
+// CreateContextOperation::ComputeSteadyStateVector() of a random (L*T) x (L*T) transition matrix
+class SteadyStateVectorCase : public BenchmarkCase
+{
+  public:
+	SteadyStateVectorCase(const BenchmarkSize& size);
+
+	virtual bool SetUp();
+	virtual bool Run();
+	virtual void TearDown();
+	virtual double GetWorkPerRun() const;
+
+  private:
+	KnowledgeConstructionKernels* kernels;
+	vector<double> transitionMatrix;
+	vector<double> steadyStateVector;
+};
+
+// CreateContextOperation::DoGibbsSampling() of N users (one learning trace each)
+class GibbsSamplingCase : public BenchmarkCase
+{
+  public:
+	GibbsSamplingCase(const BenchmarkSize& size);
+
+	virtual bool SetUp();
+	virtual bool Run();
+	virtual void TearDown();
+	virtual double GetWorkPerRun() const;
+
+  private:
+	KnowledgeConstructionKernels* kernels;
+	vector<vector<TraceVector> > traces;
+	double* priorTransitionsCount;
+	RNGStream stream;
+};
+
+// sampling with the RNG: SampleIndexFromVector(), AliasTable::Sample() and GetDirichletRandomSample() over L outcomes
+class RNGSamplingCase : public BenchmarkCase
+{
+  public:
+	enum Method { LinearScan, AliasMethod, Dirichlet };
+
+	RNGSamplingCase(const BenchmarkSize& size, Method method);
+
+	virtual string GetSizeString() const;
+	virtual bool SetUp();
+	virtual bool Run();
+	virtual void TearDown();
+	virtual double GetWorkPerRun() const;
+
+  private:
+	Method method;
+	vector<double> probVector;
+	vector<double> theta;
+	AliasTable table;
+	RNGStream stream;
+	ull checksum;
+};
+
+// LineParser::ParseFields() of a line of N comma-separated real numbers
+class ParseFieldsCase : public BenchmarkCase
+{
+  public:
+	ParseFieldsCase(const BenchmarkSize& size);
+
+	virtual string GetSizeString() const;
+	virtual bool SetUp();
+	virtual bool Run();
+	virtual void TearDown();
+	virtual double GetWorkPerRun() const;
+
+  private:
+	string line;
+	vector<double> values;
+};
+
+// StoreContextOperation (store == true) or LoadContextOperation of a context of N random profiles over L*T states
+class ContextFileCase : public BenchmarkCase
+{
+  public:
+	ContextFileCase(const BenchmarkSize& size, bool store, string directory);
+
+	virtual bool SetUp();
+	virtual bool Run();
+	virtual void TearDown();
+	virtual double GetWorkPerRun() const;
+
+  private:
+	bool store;
+	string filePath;
+	Context* context;
+};
+
+
+#endif
@@ -0,0 +1,33 @@
+################################################################################
+# Automatically-generated file. Do not edit!
+################################################################################
+
+# Add inputs and outputs from these tool invocations to the build variables 
+CPP_SRCS += \
+../Benchmark.cpp \
+../DatasetGenerator.cpp \
+../KernelBenchmarks.cpp \
+../main.cpp 
+
+OBJS += \
+./Benchmark.o \
+./DatasetGenerator.o \
+./KernelBenchmarks.o \
+./main.o 
+
+CPP_DEPS += \
+./Benchmark.d \
+./DatasetGenerator.d \
+./KernelBenchmarks.d \
+./main.d 
+
+
+# Each subdirectory must supply rules for building sources it contributes
+%.o: ../%.cpp
+	@echo 'Building file: $<'
+	@echo 'Invoking: GCC C++ Compiler'
+	g++ -I"%LPM_ROOTPATH%" -m64 -pthread -O3 -Wall -c -fmessage-length=0 -MMD -MP -MF"$(@:%.o=%.d)" -MT"$(@:%.o=%.d)" -o "$@" "$<"
+	@echo 'Finished building: $<'
+	@echo ' '
+
+
@@ -0,0 +1,161 @@
+#include "Benchmark.h"
+#include "KernelBenchmarks.h"
+#include "DatasetGenerator.h"
+
+/*
+ * Micro-benchmarks of the lpm kernels.
+ *
+ * Usage: lpm-bench [kernel filter] [min seconds per case] [quick]
+ *        lpm-bench generate <output prefix> <N> <T> <L> [seed]
+ *
+ * Each kernel is run over a sweep of problem sizes: L (number of locations), T (number of time periods) and N (number of users,
+ * or of items for the kernels which do not depend on the locations, e.g. the size of an assignment problem).
+ * Only the kernels whose name contains the filter are run (all of them if the filter is "all").
+ * For each case, the time per run, the throughput and the allocations per run (done through Allocate, see Memory) are reported,
+ * along with the accuracy of the approximations (e.g. of the approximate assignment against the exact one).
+ * The store/load context cases write a temporary file to the current directory.
+ *
+ * The "generate" mode writes a synthetic sg-LPM dataset of N users, T timestamps and L locations instead (see DatasetGenerator),
+ * it is used by the end-to-end benchmark script 'sg-bench.sh'.
+ */
+
+static bool KernelSelected(const string& kernel, const string& filter)
+{
+	return filter == "all" || kernel.find(filter) != string::npos;
+}
+
+static BenchmarkSize MakeSize(ull numLoc, ull numPeriods, ull numUsers)
+{
+	BenchmarkSize size;
+	size.numLoc = numLoc; size.numPeriods = numPeriods; size.numUsers = numUsers;
+	return size;
+}
+
+static int GenerateDataset(int argc, char **argv)
+{
+	if(argc < 6)
+	{
+		cout << "Usage: lpm-bench generate <output prefix> <N> <T> <L> [seed]" << endl;
+		return -1;
+	}
+
+	string prefix = string(argv[2]);
+
+	ull numUsers = 0; ull numTimes = 0; ull numLoc = 0; uint64 seed = 1;
+	{ stringstream ss(""); ss << argv[3]; ss >> numUsers; }
+	{ stringstream ss(""); ss << argv[4]; ss >> numTimes; }
+	{ stringstream ss(""); ss << argv[5]; ss >> numLoc; }
+	if(argc >= 7) { stringstream ss(""); ss << argv[6]; ss >> seed; }
+
+	DatasetGenerator generator(numUsers, numTimes, numLoc, seed);
+	if(generator.Generate(prefix) == false)
+	{
+		cout << "Unable to generate the dataset " << prefix << " (N = " << numUsers << ", T = " << numTimes << ", L = " << numLoc << ")" << endl;
+		return -1;
+	}
+
+	return 0;
+}
+
+int main(int argc, char **argv)
+{
+	if(argc >= 2 && string(argv[1]) == "generate") { return GenerateDataset(argc, argv); }
+
+	string filter = "all";
+	if(argc >= 2) { filter = string(argv[1]); }
+
+	double minSeconds = 0.5;
+	if(argc >= 3) { stringstream ss(""); ss << argv[2]; ss >> minSeconds; }
+
+	bool quick = false;
+	if(argc >= 4) { string q = string(argv[3]); if(q == "quick") { quick = true; } }
+
+	Log::GetInstance()->SetEnabled(false);
+	RNG::GetInstance()->SetSeed(1);
+
+	// sizes swept
+	vector<ull> assignmentSizes = vector<ull>();
+	assignmentSizes.push_back(16); assignmentSizes.push_back(64); assignmentSizes.push_back(256);
+	if(quick == false) { assignmentSizes.push_back(512); }
+
+	vector<ull> locSizes = vector<ull>();
+	locSizes.push_back(10); locSizes.push_back(50); locSizes.push_back(100);
+	if(quick == false) { locSizes.push_back(200); }
+
+	vector<ull> periodSizes = vector<ull>();
+	periodSizes.push_back(1); periodSizes.push_back(4);
+
+	vector<ull> userSizes = vector<ull>();
+	userSizes.push_back(10); userSizes.push_back(100);
+	if(quick == false) { userSizes.push_back(1000); }
+
+	vector<ull> fieldSizes = vector<ull>();
+	fieldSizes.push_back(4); fieldSizes.push_back(64); fieldSizes.push_back(1024);
+
+	vector<ull> outcomeSizes = vector<ull>();
+	outcomeSizes.push_back(10); outcomeSizes.push_back(100); outcomeSizes.push_back(1000);
+
+	vector<BenchmarkCase*> cases = vector<BenchmarkCase*>();
+
+	foreach_const(vector<ull>, assignmentSizes, iterN)
+	{
+		cases.push_back(new MinimumCostAssignmentCase(MakeSize(0, 0, *iterN)));
+		cases.push_back(new RealMinimumCostAssignmentCase(MakeSize(0, 0, *iterN)));
+		cases.push_back(new MaximumWeightAssignmentCase(MakeSize(0, 0, *iterN)));
+		cases.push_back(new ApproximateAssignmentCase(MakeSize(0, 0, *iterN), 0.05, 100));
+		cases.push_back(new ApproximateAssignmentCase(MakeSize(0, 0, *iterN), 0.01, 500));
+	}
+
+	foreach_const(vector<ull>, periodSizes, iterT)
+	{
+		foreach_const(vector<ull>, locSizes, iterL)
+		{
+			cases.push_back(new MultiplySquareMatricesCase(MakeSize(*iterL, *iterT, 0)));
+			cases.push_back(new SteadyStateVectorCase(MakeSize(*iterL, *iterT, 1)));
+		}
+	}
+
+	// the knowledge construction (counting only) supports a single time period
+	foreach_const(vector<ull>, userSizes, iterN)
+	{
+		foreach_const(vector<ull>, locSizes, iterL) { cases.push_back(new GibbsSamplingCase(MakeSize(*iterL, 1, *iterN))); }
+	}
+
+	foreach_const(vector<ull>, outcomeSizes, iterL)
+	{
+		cases.push_back(new RNGSamplingCase(MakeSize(*iterL, 0, 0), RNGSamplingCase::LinearScan));
+		cases.push_back(new RNGSamplingCase(MakeSize(*iterL, 0, 0), RNGSamplingCase::AliasMethod));
+		cases.push_back(new RNGSamplingCase(MakeSize(*iterL, 0, 0), RNGSamplingCase::Dirichlet));
+	}
+
+	foreach_const(vector<ull>, fieldSizes, iterN) { cases.push_back(new ParseFieldsCase(MakeSize(0, 0, *iterN))); }
+
+	foreach_const(vector<ull>, periodSizes, iterT)
+	{
+		foreach_const(vector<ull>, locSizes, iterL)
+		{
+			// the size of the file grows with N * (L * T)^2
+			ull numUsers = (*iterL) * (*iterT) > 100 ? 10 : 100;
+
+			cases.push_back(new ContextFileCase(MakeSize(*iterL, *iterT, numUsers), true, "."));
+			cases.push_back(new ContextFileCase(MakeSize(*iterL, *iterT, numUsers), false, "."));
+		}
+	}
+
+	BenchmarkRunner runner(minSeconds);
+	runner.PrintHeader();
+
+	bool success = true;
+	foreach_const(vector<BenchmarkCase*>, cases, iter)
+	{
+		BenchmarkCase* benchmark = *iter;
+		if(KernelSelected(benchmark->GetKernel(), filter) == true)
+		{
+			if(runner.Run(benchmark) == false) { success = false; }
+		}
+		delete benchmark;
+	}
+	cases.clear();
+
+	return success == true ? 0 : 1;
+}
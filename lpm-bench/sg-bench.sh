@@ -0,0 +1,71 @@
+#!/bin/sh
+
+# End-to-end sg-LPM benchmark: generates a synthetic dataset of N users, T timestamps and L locations (see 'lpm-bench generate'),
+# then runs the sg-LPM setup (aggregate statistics, knowledge, clustering) and a fixed number of generation iterations.
+# sg-LPM reports the time spent in each stage and the number of synthetic traces generated per second.
+#
+# Usage: sh sg-bench.sh <work directory> <N> <T> <L> [iterations] [seed]
+#
+# The executables are expected in 'build' (lpm-bench) and '../sg-LPM/build' (sg-LPM), see the 'comp.sh' scripts.
+# The clustering uses '../sg-LPM/cluto/do-cluto.sh', another script can be given in the CLUTO_SCRIPT environment variable.
+
+if [ -z "$4" ]; then
+	echo "Usage: sh sg-bench.sh <work directory> <N> <T> <L> [iterations] [seed]";
+	exit 1;
+fi
+
+work="$1";
+numUsers="$2";
+numTimes="$3";
+numLoc="$4";
+
+iterations="3";
+if ! [ -z "$5" ]; then
+	iterations="$5";
+fi
+
+seed="1";
+if ! [ -z "$6" ]; then
+	seed="$6";
+fi
+
+benchDir=`cd \`dirname "$0"\` && pwd`
+sgDir="$benchDir/../sg-LPM"
+
+generator="$benchDir/build/lpm-bench"
+sg="$sgDir/build/sg-LPM"
+
+clutoScript="$sgDir/cluto/do-cluto.sh"
+if ! [ -z "$CLUTO_SCRIPT" ]; then
+	clutoScript="$CLUTO_SCRIPT";
+fi
+
+mkdir -p "$work"
+work=`cd "$work" && pwd`
+
+# a fresh dataset (and thus no cached setup artifacts)
+rm -rf "$work/data" "$work/run" "$work/cluto"
+mkdir -p "$work/data/out" "$work/run/x/y" "$work/cluto"
+
+echo "Generating the dataset (N = $numUsers, T = $numTimes, L = $numLoc)..."
+start=`date +%s`
+"$generator" generate "$work/data/input" "$numUsers" "$numTimes" "$numLoc" "$seed" || exit 1
+echo "Dataset generated in `expr \`date +%s\` - $start` seconds."
+
+# sg-LPM invokes the clustering script relatively to its working directory (see CLUTO_SCRIPT_REL_PATH), and runs it directly
+cp -p "$clutoScript" "$work/cluto/do-cluto.sh"
+chmod +x "$work/cluto/do-cluto.sh"
+PATH="$sgDir/cluto:$PATH"
+export PATH
+
+echo "Running sg-LPM ($iterations iterations)..."
+cd "$work/run/x/y" && "$sg" "$work/data/input" "$work/data/out" 1 "$numUsers" "$numTimes" "$numLoc" 0.4 0.5 1.0 1.0 "$seed" "$iterations" > "$work/run/stdout" 2>&1
+status="$?"
+
+if [ "$status" -ne 0 ]; then
+	echo "sg-LPM failed (exit code $status), see $work/run/stdout and $work/data/out/output";
+	tail -5 "$work/run/stdout";
+	exit 1;
+fi
+
+grep "SG Timing" "$work/run/stdout"
@@ -19,6 +19,7 @@ CPP_SRCS += \
 ../source/Event.cpp \
 ../source/EventFormatter.cpp \
 ../source/EventParser.cpp \
+../source/ExecutionContext.cpp \
 ../source/ExampleApplicationOperations.cpp \
 ../source/ExampleLPPMOperations.cpp \
 ../source/ExampleTraceGeneratorOperations.cpp \
@@ -26,6 +27,7 @@ CPP_SRCS += \
 ../source/File.cpp \
 ../source/FilterOperation.cpp \
 ../source/InputOperation.cpp \
+../source/Instrumentation.cpp \
 ../source/LPM.cpp \
 ../source/LPPMOperation.cpp \
 ../source/LineParser.cpp \
@@ -41,8 +43,10 @@ CPP_SRCS += \
 ../source/Schedule.cpp \
 ../source/ScheduleBuilder.cpp \
 ../source/Schedules.cpp \
+../source/SimilarityCandidateIndex.cpp \
 ../source/StoreContextOperation.cpp \
 ../source/StrongAttackOperation.cpp \
+../source/Threads.cpp \
 ../source/TimePartitioning.cpp \
 ../source/Trace.cpp \
 ../source/TraceGeneratorOperation.cpp \
@@ -67,6 +71,7 @@ OBJS += \
 ./source/Event.o \
 ./source/EventFormatter.o \
 ./source/EventParser.o \
+./source/ExecutionContext.o \
 ./source/ExampleApplicationOperations.o \
 ./source/ExampleLPPMOperations.o \
 ./source/ExampleTraceGeneratorOperations.o \
@@ -74,6 +79,7 @@ OBJS += \
 ./source/File.o \
 ./source/FilterOperation.o \
 ./source/InputOperation.o \
+./source/Instrumentation.o \
 ./source/LPM.o \
 ./source/LPPMOperation.o \
 ./source/LineParser.o \
@@ -89,8 +95,10 @@ OBJS += \
 ./source/Schedule.o \
 ./source/ScheduleBuilder.o \
 ./source/Schedules.o \
+./source/SimilarityCandidateIndex.o \
 ./source/StoreContextOperation.o \
 ./source/StrongAttackOperation.o \
+./source/Threads.o \
 ./source/TimePartitioning.o \
 ./source/Trace.o \
 ./source/TraceGeneratorOperation.o \
@@ -115,6 +123,7 @@ CPP_DEPS += \
 ./source/Event.d \
 ./source/EventFormatter.d \
 ./source/EventParser.d \
+./source/ExecutionContext.d \
 ./source/ExampleApplicationOperations.d \
 ./source/ExampleLPPMOperations.d \
 ./source/ExampleTraceGeneratorOperations.d \
@@ -122,6 +131,7 @@ CPP_DEPS += \
 ./source/File.d \
 ./source/FilterOperation.d \
 ./source/InputOperation.d \
+./source/Instrumentation.d \
 ./source/LPM.d \
 ./source/LPPMOperation.d \
 ./source/LineParser.d \
@@ -137,8 +147,10 @@ CPP_DEPS += \
 ./source/Schedule.d \
 ./source/ScheduleBuilder.d \
 ./source/Schedules.d \
+./source/SimilarityCandidateIndex.d \
 ./source/StoreContextOperation.d \
 ./source/StrongAttackOperation.d \
+./source/Threads.d \
 ./source/TimePartitioning.d \
 ./source/Trace.d \
 ./source/TraceGeneratorOperation.d \
@@ -152,7 +164,7 @@ CPP_DEPS += \
 source/%.o: ../source/%.cpp
 	@echo 'Building file: $<'
 	@echo 'Invoking: GCC C++ Compiler'
-	g++ -m64 -O3 -Wall -c -fmessage-length=0 -MMD -MP -MF"$(@:%.o=%.d)" -MT"$(@:%.o=%.d)" -o"$@" "$<"
+	g++ -m64 -pthread -O3 -Wall -c -fmessage-length=0 -MMD -MP -MF"$(@:%.o=%.d)" -MT"$(@:%.o=%.d)" -o"$@" "$<"
 	@echo 'Finished building: $<'
 	@echo ' '
 
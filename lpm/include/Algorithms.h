@@ -7,6 +7,13 @@
 #include "Defs.h"
 #include "Private.h"
 
+// smallest (relative) regularization of ApproximateMaximumWeightAssignment(), below it the kernel underflows
+#define SINKHORN_MIN_REGULARIZATION (1.0 / 700.0)
+
+// ApproximateMaximumWeightAssignment() stops once the marginals of the transport plan are within this tolerance (checked every SINKHORN_CHECK_INTERVAL iterations)
+#define SINKHORN_TOLERANCE 1e-6
+#define SINKHORN_CHECK_INTERVAL 10
+
 namespace lpm {
 
 //!
@@ -36,6 +43,15 @@ class Algorithms
     //See http://csclab.murraystate.edu/bob.pilgrim/445/munkres.html for the algorithm itself.
     static void MinimumCostAssignment(ll* costMatrix, ll numItems, ll* assignment);
 
+    //Floating-point version (shortest augmenting path Hungarian algorithm with dual potentials, O(n^3)), see Jonker & Volgenant (1987).
+    //Works directly on real-valued costs (e.g. negative log-likelihoods), i.e. without scaling them to integers. assignment[i] is the column assigned to row i.
+    static void MinimumCostAssignment(const double* costMatrix, ull numItems, ll* assignment);
+
+    //Approximate maximum weight assignment by entropic optimal transport: Sinkhorn iterations (O(n^2) each) on the kernel exp(w / (regularization * range of w)),
+    //then greedy rounding of the transport plan to a permutation. The regularization is relative to the range of the weights (the smaller, the closer to the
+    //maximum weight but the slower the convergence). Weights may be -infinity (forbidden pairs). assignment[i] is the column assigned to row i.
+    static void ApproximateMaximumWeightAssignment(const double* weightMatrix, ull numItems, ll* assignment, double regularization, ull iterations);
+
     static int MaximumWeightAssignment(const ll numItems, ll* weight, ll* mapping);
 
     static void MultiplySquareMatrices(const double* leftMatrix, const double* rightMatrix, ull dimension, double* resultMatrix);
@@ -44,6 +60,19 @@ class Algorithms
 
     static bool GetTransitionVectorOfSubChain(double* fullChainTransitionMatrix, ull tp1, ull loc1, ull tp2, double** transitionVector, bool inclDummyTPs = false);
 
+    //Gelman-Rubin potential scale reduction factor (R-hat) of a scalar quantity given one trace per chain (only the first n values of each trace are used, n being the length of the shortest trace).
+    //Returns 0 if it cannot be computed (i.e. less than 2 chains or less than 2 values per chain).
+    static double ComputePotentialScaleReduction(const vector<vector<double> >& traces);
+
+    //Effective sample size of a scalar quantity over all chains: sum of the per-chain ESS, estimated with Geyer's initial positive sequence of autocorrelations.
+    static double ComputeEffectiveSampleSize(const vector<vector<double> >& traces);
+
+    //Dot product of two vectors of n doubles (e.g. expected distance of a localization row). Uses independent partial sums so that the loop is vectorized.
+    static double DotProduct(const double* x, const double* y, ull n);
+
+    //Index of the first maximum of a vector of n doubles (0 if n is 0). The maximum is found with independent partial maxima so that the loop is vectorized.
+    static ull ArgMax(const double* x, ull n);
+
 };
 
 } // namespace lpm
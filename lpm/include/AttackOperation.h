@@ -89,6 +89,18 @@ class AttackOperation : public Operation<TraceSet, AttackOutput>
 
     void SetLPPMFlags(LPPMFlags flags);
 
+    //! 
+    //! \brief Returns whether the attack processes each user independently of the other users
+    //!
+    //! The output of a per-user attack for a given user does not depend on which other users are attacked along with it.
+    //! Such attacks can be run on successive batches of users (see ScheduleBuilder::SetStreamingBatchSize()).
+    //!
+    //! \note The LPPM flags (see SetPDFs() and SetLPPMFlags()) must be set before the call.
+    //!
+    //! \return true or false, depending on whether the attack is per-user (the default implementation returns false)
+    //!
+    virtual bool IsPerUser() const;
+
 
   protected:
     LPPMFlags lppmFlags;
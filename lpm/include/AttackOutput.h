@@ -81,6 +81,34 @@ class AttackOutput : public Reference<AttackOutput>
     void SetGenericReconstructionObjects(double* distribution, double* sigma, double* pseudonyms, set<ull>& pseudonymsSet);
 
 
+  private:
+    bool genericRecDiagnostics;
+
+    double genericRecMeanLocationRHat;
+
+    double genericRecMeanLocationESS;
+
+    double genericRecExposureRHat;
+
+    double genericRecExposureESS;
+
+
+  public:
+    //!
+    //! \brief Gets the convergence diagnostics of the chains of the generic reconstruction
+    //!
+    //! The diagnostics are computed on two scalar summaries of the sub-samples (their mean location index and their proportion of exposed events):
+    //! the Gelman-Rubin R-hat (0 if it cannot be computed, e.g. with a single chain; values close to 1 indicate that the chains agree) and
+    //! the effective sample size over all chains (see Algorithms::ComputePotentialScaleReduction() and Algorithms::ComputeEffectiveSampleSize()).
+    //! Any of the output pointers may be NULL.
+    //!
+    //! \return true if the generic reconstruction was run (and the diagnostics are set), false otherwise
+    //!
+    bool GetGenericReconstructionDiagnostics(double* meanLocationRHat, double* meanLocationESS, double* exposureRHat, double* exposureESS) const;
+
+    void SetGenericReconstructionDiagnostics(double meanLocationRHat, double meanLocationESS, double exposureRHat, double exposureESS);
+
+
   private:
     ObservedEvent** observedMatrix;
 
@@ -10,6 +10,9 @@ using namespace std;
 #include "Private.h"
 #include "Metrics.h"
 
+// number of candidates (per requested neighbor) whose exact similarity is computed by the similarity operations, see SetCandidateNeighbors()
+#define SIMILARITY_CANDIDATES_PER_NEIGHBOR 2
+
 namespace lpm { class MetricDistance; } 
 namespace lpm { class Context; } 
 namespace lpm { class File; } 
@@ -78,9 +81,26 @@ class AbsoluteSimilarityAnalysisOperation : public ContextAnalysisOperation
     //!
     virtual bool Execute(const Context* input, File* output);
 
+    //!
+    //! \brief Sets the number of most similar followers output for each leader
+    //!
+    //! By default (0), the similarity of every (leader, follower) pair is computed and output.
+    //! Otherwise, the users are indexed by a SimilarityCandidateIndex of their stationary distributions, and the similarity is only computed
+    //! for the candidate pairs of the index (SIMILARITY_CANDIDATES_PER_NEIGHBOR times \a neighbors candidates per user, instead of all the users).
+    //! Only the \a neighbors most similar followers of each leader (by zeroth-order similarity) are then output (in decreasing order of similarity).
+    //!
+    //! \param[in] neighbors 	ull, the number of followers output per leader (0 for all the pairs).
+    //!
+    //! \return nothing
+    //!
+    void SetCandidateNeighbors(ull neighbors);
+
+
   private:
     bool zerothOrderOnly;
 
+    ull candidateNeighbors;
+
 };
 class HiddenSemanticsSimilarityAnalysisOperation : public ContextAnalysisOperation 
 {
@@ -108,9 +128,44 @@ class HiddenSemanticsSimilarityAnalysisOperation : public ContextAnalysisOperati
 
     bool zerothOrderOnly;
 
+    ull approximationIterations;
+
+    double approximationRegularization;
+
+    ull candidateNeighbors;
+
   public:
     void SetLimits(ull iterations = 100, ull seconds = 30);
 
+    //!
+    //! \brief Sets whether the best assignments of the locations of two users are approximated
+    //!
+    //! By default, the assignments are exact (Hungarian algorithm, O(L^3) per pair of users and time period).
+    //! Otherwise, they are approximated by entropic optimal transport (see Algorithms::ApproximateMaximumWeightAssignment()),
+    //! in O(L^2) per Sinkhorn iteration, which is faster for large sets of locations.
+    //!
+    //! \param[in] iterations 	ull, the maximum number of Sinkhorn iterations (0 for the exact assignments).
+    //! \param[in] regularization 	double, the entropic regularization, relative to the range of the weights.
+    //!
+    //! \return nothing
+    //!
+    void SetApproximation(ull iterations = 100, double regularization = 0.01);
+
+    //!
+    //! \brief Sets the number of most similar followers output for each leader
+    //!
+    //! By default (0), the similarity of every (leader, follower) pair is computed and output.
+    //! Otherwise, the users are indexed by a SimilarityCandidateIndex of their stationary distributions,
+    //! sorted within each time period (as the similarity is invariant to the semantics of the locations), and the similarity is only computed
+    //! for the candidate pairs of the index (SIMILARITY_CANDIDATES_PER_NEIGHBOR times \a neighbors candidates per user, instead of all the users).
+    //! Only the \a neighbors most similar followers of each leader (by zeroth-order similarity) are then output (in decreasing order of similarity).
+    //!
+    //! \param[in] neighbors 	ull, the number of followers output per leader (0 for all the pairs).
+    //!
+    //! \return nothing
+    //!
+    void SetCandidateNeighbors(ull neighbors);
+
 };
 
 } // namespace lpm
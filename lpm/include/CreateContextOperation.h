@@ -19,9 +19,13 @@ using namespace std;
 #define KC_DEFAULT_GS_ITERATIONS 10
 #define KC_NO_LIMITS 0
 
+// no cutoff radius: the distance kernel of ComputeAggregateStatistics() covers all the pairs of locations
+#define KC_NO_KERNEL_CUTOFF 0.0
+
 namespace lpm { class File; } 
 namespace lpm { struct TraceVector; } 
 namespace lpm { class UserProfile; } 
+namespace lpm { class RNGStream; } 
 
 namespace lpm {
 
@@ -55,10 +59,18 @@ class CreateContextOperation : public Operation<KnowledgeInput, Context>
 
 
   private:
+    class KnowledgeConstructionTask;
+
     ull maxGSPerUser;
 
     ull maxSecondsPerUser;
 
+    ull numThreads;
+
+    File* countsOutputFile;
+
+    double kernelCutoff;
+
 
   public:
     //! \brief Executes the knowledge construction
@@ -87,19 +99,111 @@ class CreateContextOperation : public Operation<KnowledgeInput, Context>
     //!
     bool SetLimits(ull maxSamples = KC_DEFAULT_GS_ITERATIONS, ull maxSeconds = KC_NO_LIMITS);
 
+    //!
+    //! \brief Sets the number of threads used to construct the knowledge (the users are processed in parallel)
+    //!
+    //! \param[in] numThreads 	ull, the maximum number of threads (0 to use Parameters::GetThreadsCount(), 1 to process the users sequentially).
+    //!
+    //! \note The limits set by \a SetLimits() apply to each user, independently of the thread processing it.
+    //!
+    //! \return nothing
+    //!
+    void SetThreadsCount(ull numThreads = 0);
+
+    //!
+    //! \brief Sets the file to which \a Execute() and \a UpdateKnowledge() write the transitions count of each user
+    //!
+    //! The transitions count written for a user is the sum of its (input) transitions count and of the transitions observed in its learning traces.
+    //! The file has the format of a transitions count file, so that it can be given as \a transitionsCountFile to a later call to \a UpdateKnowledge().
+    //!
+    //! \param[in] countsFile 	[optional] File*, the output file (NULL to not write the transitions count).
+    //!
+    //! \return nothing
+    //!
+    void SetTransitionsCountOutput(File* countsFile = NULL);
+
+    //!
+    //! \brief Updates the knowledge with new learning traces
+    //!
+    //! Only the users observed in the new learning traces are re-derived (their profile is replaced in \a context), the other profiles are left as they are.
+    //!
+    //! \param[in] input 	KnowledgeInput*, input object: the learning traces are the new traces only and the transitions count file is the one
+    //! written (see \a SetTransitionsCountOutput()) when the knowledge was last constructed or updated.
+    //! \param[in,out] context 	Context*, the knowledge to update.
+    //!
+    //! \note With the counting-only construction, the updated knowledge is the one a full construction (on all the learning traces) would produce.
+    //! \note The update is refused (ERROR_CODE_INCONSISTENT_TIME_PARTITIONING_USAGE) if the time partitioning has dummy time periods: the transitions
+    //! count file only covers the non-dummy time periods, so the transitions into or out of a dummy time period of the previous learning traces are unknown.
+    //!
+    //! \return true or false, depending on whether the call is successful
+    //!
+    bool UpdateKnowledge(const KnowledgeInput* input, Context* context);
+
 
+    //!
+    //! \brief Sets the cutoff radius of the distance kernel of \a ComputeAggregateStatistics()
+    //!
+    //! The kernel weights each pair of locations by the inverse square of their distance (at least 1). Beyond the cutoff radius, the weight is zero:
+    //! the kernel is then sparse and only the locations within the radius of each location are visited (through a grid of the locations).
+    //!
+    //! \param[in] radius 	[optional] double, the cutoff radius (in the unit of the coordinates of the locations file), or KC_NO_KERNEL_CUTOFF.
+    //!
+    //! \return nothing
+    //!
+    void SetDistanceKernelCutoff(double radius = KC_NO_KERNEL_CUTOFF);
+
+    //!
+    //! \brief Computes the aggregate statistics (transition matrix and steady-state vector) of the given traces
+    //!
+    //! The transitions observed in the traces (plus a uniform prior) are mixed with a distance kernel over the coordinates of the locations
+    //! (see \a SetDistanceKernelCutoff()). The rows of the transition matrix are computed in parallel (see \a SetThreadsCount()).
+    //!
+    //! \param[in] tracesFile 	File*, the traces file.
+    //! \param[in] locationsFile 	File*, the locations file (one line 'x, y' per location, in increasing order of locationstamps).
+    //! \param[out] outTransitionMatrix 	double**, the transition matrix (allocated with Allocate()).
+    //! \param[out] outSteadyStateVector 	double**, the steady-state vector (allocated with Allocate()).
+    //!
+    //! \note The time partitioning must have a single time period.
+    //!
+    //! \return true or false, depending on whether the call is successful
+    //!
     bool ComputeAggregateStatistics(File* tracesFile, File* locationsFile, double** outTransitionMatrix, double** outSteadyStateVector) const;
 
+  protected:
+    //!
+    //! \brief Computes the steady-state vector of the given transition matrix (by repeated squaring)
+    //!
+    //! \param[in] transitionMatrix 	double*, the transition matrix (over the states of all time periods, including the dummy ones).
+    //! \param[in,out] steadyStateVector 	double*, the output vector.
+    //!
+    //! \return nothing
+    //!
+    void ComputeSteadyStateVector(const double* transitionMatrix, double* steadyStateVector) const;
+
+    //!
+    //! \brief Derives the profile of a user from its learning traces and prior transitions count
+    //!
+    //! \param[in] learningTraces 	vector<TraceVector>&, the learning traces of the user.
+    //! \param[in] priorTransitionsCount 	double*, the prior transitions count of the user.
+    //! \param[in,out] profile 	UserProfile*, the profile to fill.
+    //! \param[in] stream 	RNGStream*, the random stream to draw from.
+    //!
+    //! \return true or false, depending on whether the call is successful
+    //!
+    bool DoGibbsSampling(vector<TraceVector>& learningTraces, double* priorTransitionsCount, UserProfile* profile, RNGStream* stream) const;
+
   private:
-    inline bool TransitionMatrixFromCountMatrix(const double* count, double* alpha, double* theta, double* transitionMatrix, bool sample = true) const;
+    inline bool TransitionMatrixFromCountMatrix(const double* count, double* alpha, double* theta, double* transitionMatrix, RNGStream* stream, bool sample = true) const;
 
     inline void GetIntermediaryTransitionVector(map<ull, double*>& cache, const double* transitionMatrix, ull loc1, ull loc3, ull tp1, ull tp2, ull tp3, double** vector) const;
 
-    inline void ComputeSteadyStateVector(const double* transitionMatrix, double* steadyStateVector) const;
+    bool RunGibbsSampling(const map<ull, vector<TraceVector> >& learningTraces, const map<ull, double*>& priorTransitionsCount, const set<ull>& users, Context* context) const;
+
+    bool AddObservedTransitionsCount(const map<ull, vector<TraceVector> >& learningTraces, map<ull, double*>& transitionsCount) const;
 
-    bool DoGibbsSampling(vector<TraceVector>& learningTraces, double* priorTransitionsCount, UserProfile* profile) const;
+    bool WriteTransitionsCount(const map<ull, double*>& transitionsCount, File* countsFile) const;
 
-    bool ReadKnowledgeFiles(const KnowledgeInput* input, map<ull, vector<TraceVector> >& learningTraces, map<ull, double*>& priorTransitionsCount, bool** transitionsFeasibilityMatrix = NULL);
+    bool ReadKnowledgeFiles(const KnowledgeInput* input, map<ull, vector<TraceVector> >& learningTraces, map<ull, double*>& priorTransitionsCount, bool** transitionsFeasibilityMatrix = NULL, map<ull, double*>* rawTransitionsCount = NULL);
 
     bool ReadTransitionsFeasibility(const File* transFeasibilityFile, bool* transFeasibilityMatrix);
 
@@ -10,6 +10,7 @@ using namespace std;
 
 #include "Defs.h"
 #include "Log.h"
+#include "Threads.h"
 
 #define NO_ERROR 0
 
@@ -58,6 +59,13 @@ class Errors : public Singleton<Errors>
   public:
     Errors();
 
+    //!
+    //! \brief Returns the error state of the execution context active on the calling thread (see ExecutionContext), or the global one if none
+    //!
+    //! \return Errors*, the error state
+    //!
+    static Errors* GetInstance();
+
 
   private:
     ull lastErrorCode;
@@ -68,6 +76,8 @@ class Errors : public Singleton<Errors>
 
     string lastErrorDetails;
 
+    Mutex mutex;
+
 
   public:
     //! 
@@ -9,6 +9,9 @@
 #include "LPPMOperation.h"
 #include <string>
 using namespace std;
+#include <vector>
+using namespace std;
+#include "RNG.h"
 
 #include "Defs.h"
 #include "Private.h"
@@ -34,6 +37,13 @@ class DefaultServiceQualityMetricDistance : public ServiceQualityMetricDistance
 //! (controlled by the parameter \a obfLevel), fake injection (controlled by the parameters \a fakeInjectionAlgorithm and \a fakeInjectionProb), and, hiding
 //! (controlled by the parameter \a hidingProb).
 //!
+//! The obfuscation groups are the ranges of 2^obfLevel consecutive locations (starting from the first locationstamp). With the
+//! \a GeneralStatisticsSelection fake injection, the average (over the profiles of the context) steady-state vector of each time period,
+//! its sum over each obfuscation group and its alias table (to draw the fake locations) are computed once per context (at first use after
+//! SetContext()), so that PDF() is computed in constant time.
+//!
+//! \note The profiles of the context must not change while it is set (otherwise, the context must be set again).
+//!
 class DefaultLPPMOperation : public LPPMOperation 
 {
   public:
@@ -44,9 +54,9 @@ class DefaultLPPMOperation : public LPPMOperation
 
 
   private:
-    void ObfuscateLocation(ull location, set<ull>& obfucatedSet) const;
+    void ObfuscateLocation(ull location, ull* firstLocation, ull* lastLocation) const;
 
-    void ComputeGeneralStatistics(ull tp, double** avg) const;
+    void ComputeGeneralStatistics() const;
 
 
   public:
@@ -64,10 +74,33 @@ class DefaultLPPMOperation : public LPPMOperation
 
     double hidingProbability;
 
+    mutable Mutex statisticsMutex;
+
+    mutable bool statisticsComputed;
+
+    // average steady-state vector of time period tp at GET_INDEX(tp - minPeriod, loc - minLoc, numLoc)
+    mutable vector<double> generalStatistics;
+
+    // sum of the average steady-state vector of time period tp over the obfuscation group g at GET_INDEX(tp - minPeriod, g, numGroups)
+    mutable vector<double> groupStatistics;
+
+    mutable vector<AliasTable> fakeLocationTables;
+
 
   public:
     virtual string GetDetailString();
 
+    //!
+    //! \brief Sets the context (background knowledge of the adversary)
+    //!
+    //! \note The general statistics of the previous context (if any) are discarded.
+    //!
+    //! \param[in] newContext 	Context*, the new context
+    //!
+    //! \return nothing
+    //!
+    virtual void SetContext(Context* newContext);
+
 };
 class PseudonymChangeLPPMOperation : public LPPMOperation 
 {
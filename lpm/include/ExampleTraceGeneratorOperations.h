@@ -5,6 +5,10 @@
 //! \file
 //!
 #include "TraceGeneratorOperation.h"
+#include <map>
+using namespace std;
+
+#include "RNG.h"
 
 #include "Defs.h"
 #include "Private.h"
@@ -31,10 +35,42 @@ class KnowledgeSamplingTraceGeneratorOperation : public TraceGeneratorOperation
 
     virtual bool Execute(const TraceGeneratorInput* input, File* output);
 
+    //!
+    //! \brief Generates a trace of the user of the given profile and adds it to the given trace set
+    //!
+    //! \note The rows of the steady-state vector and of the transition matrix which are sampled are turned into alias tables the first
+    //! time they are needed, and kept by the operation (for each user) for the next traces, so that a trace costs O(T) once the tables
+    //! are built. The tables of a user are rebuilt if its profile (i.e. its steady-state vector or its transition matrix) changes.
+    //!
+    //! \param[in] profile 	const UserProfile*, the profile of the user.
+    //! \param[in,out] traces 	TraceSet*, the trace set to which the events of the trace are added.
+    //!
+    //! \return true or false, depending on whether the call is successful
+    //!
     bool GenerateUserTrace(const UserProfile* profile, TraceSet* traces);
 
   protected:
     bool usePiOnly;
+
+
+  private:
+    //!
+    //! \brief Alias tables of the profile of a user
+    //!
+    struct SamplingTables 
+    {
+        // the vectors of the profile from which the tables are built
+        const double* steadyStateVector;
+
+        const double* transitionMatrix;
+
+        map<ull, AliasTable> steadyStateTables; // tp -> table
+
+        map<pair<pair<ull, ull>, ull>, AliasTable> transitionTables; // ((tp1, tp2), loc1) -> table
+
+    };
+
+    map<ull, SamplingTables> samplingTables; // user -> tables
 };
 //!
 //! \brief Represents the input of the knowledge sampling trace generator
@@ -0,0 +1,141 @@
+#ifndef LPM_EXECUTIONCONTEXT_H
+#define LPM_EXECUTIONCONTEXT_H
+
+//!
+//! \file
+//!
+#include "Reference.h"
+#include "RNG.h"
+
+#include "Defs.h"
+
+namespace lpm { class Parameters; }
+namespace lpm { class Errors; }
+namespace lpm { class Log; }
+
+namespace lpm {
+
+//!
+//! \brief State under which schedules and operations are executed
+//!
+//! An execution context carries the parameters (users, timestamps, locationstamps, time partitioning, threads), the error state,
+//! the RNG stream and (optionally) the log sink used by the library. Once activated on a thread (see ScopedExecutionContext),
+//! Parameters::GetInstance(), Errors::GetInstance() and Log::GetInstance() return the objects of the context, and the RNG draws from
+//! the stream of the context, instead of the global ones. Threads::ParallelFor() runs its workers under the context of the caller.
+//!
+//! Hence, several independent schedules (or knowledge constructions) can run concurrently in one process, each under its own context,
+//! or a computation can temporarily run with different parameters without modifying the global ones.
+//!
+//! \note The memory facilities (see Memory), the instrumentation and LPM itself remain shared by all the contexts (they are thread-safe).
+//!
+class ExecutionContext : public Reference<ExecutionContext>
+{
+  public:
+    //!
+    //! \brief Creates a context from the current one
+    //!
+    //! The parameters are a copy of the current parameters (those of the active context, or the global ones), the error state is empty,
+    //! the RNG stream is a new stream of the current RNG (see RNG::CreateStream()), and the global log is used (see SetLog()).
+    //!
+    //! \note The time partitioning is shared with the current parameters, which should not change it while the context is in use.
+    //!
+    ExecutionContext();
+
+    virtual ~ExecutionContext();
+
+    //!
+    //! \brief Returns the parameters of the context
+    //!
+    //! \return Parameters*, the parameters (owned by the context)
+    //!
+    Parameters* GetParameters() const;
+
+    //!
+    //! \brief Returns the error state of the context
+    //!
+    //! \return Errors*, the error state (owned by the context)
+    //!
+    Errors* GetErrors() const;
+
+    //!
+    //! \brief Returns the RNG stream of the context
+    //!
+    //! \return RNGStream*, the stream (owned by the context)
+    //!
+    RNGStream* GetStream();
+
+    //!
+    //! \brief Sets the log sink of the context
+    //!
+    //! \param[in] log 	Log*, the log (the context takes ownership of it), or NULL to use the global log.
+    //!
+    //! \return nothing
+    //!
+    void SetLog(Log* log);
+
+    //!
+    //! \brief Returns the log sink of the context
+    //!
+    //! \return Log*, the log of the context (NULL if the global log is used)
+    //!
+    Log* GetLog() const;
+
+    //!
+    //! \brief Returns the context active on the calling thread
+    //!
+    //! \return ExecutionContext*, the active context (NULL if none, i.e. the global objects are used)
+    //!
+    static ExecutionContext* GetCurrent();
+
+    //!
+    //! \brief Sets the context active on the calling thread
+    //!
+    //! \note Unlike ScopedExecutionContext, this does not change the RNG stream of the thread (e.g. for workers sharing the context of a caller).
+    //!
+    //! \param[in] context 	ExecutionContext*, the context (NULL for the global objects).
+    //!
+    //! \return ExecutionContext*, the context previously active on the calling thread
+    //!
+    static ExecutionContext* SetCurrent(ExecutionContext* context);
+
+
+  private:
+    ExecutionContext(const ExecutionContext& source);
+
+    ExecutionContext& operator=(const ExecutionContext& source);
+
+    Parameters* parameters;
+
+    Errors* errors;
+
+    Log* log;
+
+    RNGStream stream;
+
+};
+//!
+//! \brief Activates an ExecutionContext on the calling thread for the lifetime of the object (i.e. until the end of the enclosing scope)
+//!
+//! While the context is active, the RNG draws from the stream of the context on the calling thread.
+//!
+class ScopedExecutionContext
+{
+  public:
+    explicit ScopedExecutionContext(ExecutionContext* context);
+
+    ~ScopedExecutionContext();
+
+
+  private:
+    ScopedExecutionContext(const ScopedExecutionContext& source);
+
+    ScopedExecutionContext& operator=(const ScopedExecutionContext& source);
+
+    ExecutionContext* previousContext;
+
+    RNGStream* previousStream;
+
+};
+
+} // namespace lpm
+#endif
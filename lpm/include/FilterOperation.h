@@ -65,7 +65,7 @@ class FilterOperation : public Operation<TraceSet, TraceSet>, public FilterFunct
     //!
     //! \return nothing
     //!
-    void SetContext(Context* newContext);
+    virtual void SetContext(Context* newContext);
 
     //! 
     //! \brief Filters the input event
@@ -0,0 +1,225 @@
+#ifndef LPM_INSTRUMENTATION_H
+#define LPM_INSTRUMENTATION_H
+
+//!
+//! \file
+//!
+#include "Singleton.h"
+#include "Threads.h"
+#include <string>
+#include <map>
+#include <fstream>
+using namespace std;
+
+#include "Defs.h"
+
+namespace lpm {
+
+//!
+//! \brief Counters maintained by the instrumentation
+//!
+//! \see Instrumentation
+//!
+enum InstrumentationCounter
+{
+  EventsReadCounter = 0, // events parsed from the input trace files
+  EventsProcessedCounter, // events filtered by the application and LPPM operations
+  TrellisCellsCounter, // cells (user, time, location) of the trellises computed by the attacks
+  BytesReadCounter, // bytes read through File
+  BytesWrittenCounter, // bytes written through File
+  GibbsIterationsCounter, // iterations of the Gibbs sampling (knowledge construction)
+  InstrumentationCountersCount
+};
+
+//!
+//! \brief Formats of the snapshots written by the instrumentation
+//!
+enum InstrumentationFormat
+{
+  JSONInstrumentationFormat = 0, // one JSON object per snapshot (and per line)
+  CSVInstrumentationFormat // one row per timer/counter and per snapshot
+};
+
+//!
+//! \brief Collects timings and counters of the library
+//!
+//! Singleton class which accumulates named timers (see ScopedTimer) and the counters listed in InstrumentationCounter.
+//! The instrumentation is disabled by default (in which case recording is a no-op); it is enabled by SetEnabled() or SetOutput().
+//! Once an output is set, snapshots of the timers and counters (along with the allocation statistics of Memory) are written
+//! every given number of seconds by a background thread, and a last snapshot is written when the program exits.
+//! Timings and counters can be recorded concurrently from several threads.
+//!
+class Instrumentation : public Singleton<Instrumentation>
+{
+friend class Singleton<Instrumentation>;
+  private:
+    Instrumentation();
+
+
+  public:
+    virtual ~Instrumentation();
+
+    //!
+    //! \brief Enables/Disables the instrumentation
+    //!
+    //! \param[in] state 	bool determining whether to enable or disable the recording of timings and counters.
+    //!
+    //! \return nothing
+    //!
+    void SetEnabled(bool state);
+
+    //!
+    //! \brief Returns whether the instrumentation is enabled
+    //!
+    //! \return true if it is enabled, false otherwise
+    //!
+    bool IsEnabled() const;
+
+    //!
+    //! \brief Sets the file to which the snapshots are written (and enables the instrumentation)
+    //!
+    //! The file is truncated and each snapshot is appended to it.
+    //!
+    //! \param[in] filePath 	string, the path of the output file.
+    //! \param[in] format 	InstrumentationFormat, the format of the snapshots.
+    //! \param[in] intervalSeconds 	ull, the number of seconds between two periodic snapshots (0 to only write a snapshot at exit).
+    //!
+    //! \return true if the file could be opened, false otherwise
+    //!
+    bool SetOutput(string filePath, InstrumentationFormat format = JSONInstrumentationFormat, ull intervalSeconds = 0);
+
+    //!
+    //! \brief Records the given duration under the timer \a name
+    //!
+    //! \param[in] name 	string, the name of the timer.
+    //! \param[in] seconds 	double, the duration.
+    //!
+    //! \return nothing
+    //!
+    void AddTime(const string& name, double seconds);
+
+    //!
+    //! \brief Adds the given value to a counter
+    //!
+    //! \param[in] counter 	InstrumentationCounter, the counter.
+    //! \param[in] value 	ull, the value to add.
+    //!
+    //! \return nothing
+    //!
+    void AddToCounter(InstrumentationCounter counter, ull value);
+
+    //!
+    //! \brief Returns the value of a counter
+    //!
+    //! \param[in] counter 	InstrumentationCounter, the counter.
+    //!
+    //! \return the value of the counter
+    //!
+    ull GetCounter(InstrumentationCounter counter) const;
+
+    //!
+    //! \brief Returns the statistics of the timer \a name
+    //!
+    //! \param[in] name 	string, the name of the timer.
+    //! \param[out] count 	ull*, the number of recorded durations (ignored if NULL).
+    //! \param[out] seconds 	double*, the sum of the recorded durations (ignored if NULL).
+    //!
+    //! \return true if the timer exists, false otherwise
+    //!
+    bool GetTimer(const string& name, ull* count, double* seconds) const;
+
+    //!
+    //! \brief Writes a snapshot of the timers and counters to the output file
+    //!
+    //! \return true if the snapshot was written, false otherwise (e.g. if no output is set)
+    //!
+    bool WriteSnapshot();
+
+    //!
+    //! \brief Stops the periodic snapshots and writes a last snapshot
+    //!
+    //! \note This is called automatically when the program exits.
+    //!
+    //! \return nothing
+    //!
+    void Stop();
+
+    //!
+    //! \brief Returns the value of a monotonic high-resolution clock
+    //!
+    //! \return the time in seconds (relative to an arbitrary origin)
+    //!
+    static double GetTime();
+
+
+  private:
+    struct TimerStatistics
+    {
+      ull count;
+      double seconds;
+      double maxSeconds;
+    };
+
+    static void* RunSnapshotThread(void* arg);
+
+    static void StopAtExit();
+
+    static string GetCounterName(InstrumentationCounter counter);
+
+    static string EscapeString(const string& str, InstrumentationFormat format);
+
+    mutable Mutex mutex;
+
+    bool enabled;
+
+    map<string, TimerStatistics> timers;
+
+    ull counters[InstrumentationCountersCount];
+
+    ofstream outputFile;
+
+    InstrumentationFormat outputFormat;
+
+    ull snapshotInterval;
+
+    ull snapshotsCount;
+
+    double startTime;
+
+    pthread_t snapshotThread;
+
+    bool threadRunning;
+
+    volatile bool stopRequested;
+
+    bool atExitRegistered;
+
+};
+//!
+//! \brief Records the time spent in the enclosing scope under the given timer name
+//!
+//! \see Instrumentation
+//!
+class ScopedTimer
+{
+  public:
+    explicit ScopedTimer(const string& name);
+
+    ~ScopedTimer();
+
+
+  private:
+    ScopedTimer(const ScopedTimer& source);
+
+    ScopedTimer& operator=(const ScopedTimer& source);
+
+    string timerName;
+
+    double startTime;
+
+    bool enabled;
+
+};
+
+} // namespace lpm
+#endif
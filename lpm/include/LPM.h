@@ -89,10 +89,16 @@ class LPM : public Singleton<LPM>
 
 
   private:
+    class BranchTask;
+
     bool RunSubschedule(const Schedule* subschedule, State* state) const;
 
     bool DoOutput(const Schedule* schedule, SchedulePosition currentPosition, string outputFilePath, const TraceSet* currentTraceSet) const;
 
+    bool CanStream(const Schedule* schedule, SchedulePosition currentPosition, const FilterFunction* lppmPDF) const;
+
+    bool RunStreamingStages(const Schedule* schedule, SchedulePosition currentPosition, Context* context, TraceSet* actualTraceSet, TraceSet* currentTraceSet, FilterFunction* appPDF, FilterFunction* lppmPDF, string outputPrefix) const;
+
     void LogParameters() const;
 
 
@@ -104,10 +110,30 @@ class LPM : public Singleton<LPM>
     //! \param[in] outputFile 	File*, the output file.
     //! \param[in] maxGSIterationsPerUser [optional] ull, the maximum number of Gibbs sampling iterations, for each user.
     //! \param[in] maxSecondsPerUser [optional] ull, the maximum number of seconds to spend in the Gibbs sampling procedure, for each user.
+    //! \param[in] outputCountsFile [optional] File*, the file to which the transitions count of each user are written (for later calls to \a UpdateKnowledge()).
     //!
     //! \return true or false, depending on whether the call is successful (i.e. whether the knowledge is constructed successfully)
     //!
-    bool RunKnowledgeConstruction(const KnowledgeInput* knowledgeFiles, File* outputFile, ull maxGSIterationsPerUser = KC_DEFAULT_GS_ITERATIONS, ull maxSecondsPerUser = KC_NO_LIMITS) const;
+    bool RunKnowledgeConstruction(const KnowledgeInput* knowledgeFiles, File* outputFile, ull maxGSIterationsPerUser = KC_DEFAULT_GS_ITERATIONS, ull maxSecondsPerUser = KC_NO_LIMITS, File* outputCountsFile = NULL) const;
+
+    //! 
+    //! \brief Updates a knowledge with new learning traces
+    //!
+    //! Only the users observed in the new learning traces are re-derived, the profiles of the other users are copied from \a knowledgeFile.
+    //!
+    //! \param[in] newKnowledgeFiles 	KnowledgeInput*, the new learning traces, and, as transitions count file, the transitions count written by 
+    //! the previous construction (or update) of the knowledge.
+    //! \param[in] knowledgeFile 	File*, the knowledge to update.
+    //! \param[in] outputFile 	File*, the output (updated) knowledge file.
+    //! \param[in] outputCountsFile 	File*, the file to which the updated transitions count are written (may be NULL).
+    //! \param[in] maxGSIterationsPerUser [optional] ull, the maximum number of Gibbs sampling iterations, for each user.
+    //! \param[in] maxSecondsPerUser [optional] ull, the maximum number of seconds to spend in the Gibbs sampling procedure, for each user.
+    //!
+    //! \note The time partitioning must not have dummy time periods (see CreateContextOperation::UpdateKnowledge()).
+    //!
+    //! \return true or false, depending on whether the call is successful (i.e. whether the knowledge is updated successfully)
+    //!
+    bool UpdateKnowledge(const KnowledgeInput* newKnowledgeFiles, const File* knowledgeFile, File* outputFile, File* outputCountsFile, ull maxGSIterationsPerUser = KC_DEFAULT_GS_ITERATIONS, ull maxSecondsPerUser = KC_NO_LIMITS) const;
 
     bool RunContextAnalysisSchedule(ContextAnalysisSchedule* schedule, const File* contextFile, string outputFileName) const;
 
@@ -5,17 +5,30 @@
 //! \file
 //!
 #include "Singleton.h"
+#include "Threads.h"
 #include <string>
+#include <fstream>
+#include <time.h>
 using namespace std;
 
 #include "Defs.h"
 
 namespace lpm {
 
+// number of messages which can be pending in the ring buffer of the log (must be a power of 2)
+#define LOG_RING_BUFFER_SIZE 4096
+
+// interval (in microseconds) at which the writer thread of the log writes the pending messages
+#define LOG_WRITER_INTERVAL_MICROSECONDS 20000
+
 //!
 //! \brief Provides the logging facilities
 //!
 //! Singleton class which provides convenient methods to log information, warnings and errors to file.
+//! Messages can be appended concurrently from several threads: they are pushed (without locking) to a bounded ring buffer,
+//! and formatted and written to the file in batches by a background thread. Messages below the minimum level (see SetLevel())
+//! are discarded before any work is done, and callers building expensive messages can check IsEnabled() beforehand.
+//! Errors (and crashes) flush the pending messages immediately, as does the exit of the program.
 //!
 
 class Log : public Singleton<Log> 
@@ -25,6 +38,13 @@ class Log : public Singleton<Log>
 
     virtual ~Log();
 
+    //!
+    //! \brief Returns the log of the execution context active on the calling thread (see ExecutionContext), or the global log if none (or if the context has no log)
+    //!
+    //! \return Log*, the log
+    //!
+    static Log* GetInstance();
+
     //! 
     //! \brief Appends a message to the log
     //
@@ -41,6 +61,17 @@ class Log : public Singleton<Log>
 
 
   private:
+    //!
+    //! \brief Slot of the ring buffer of the log
+    //!
+    struct LogRecord
+    {
+      volatile ull sequence;
+      time_t time;
+      ushort level;
+      string message;
+    };
+
     ofstream logFile;
 
     ofstream crashLogFile;
@@ -49,6 +80,26 @@ class Log : public Singleton<Log>
 
     bool enabled;
 
+    ushort minimumSeverity;
+
+    Mutex mutex;
+
+    LogRecord* ringBuffer;
+
+    volatile ull enqueuePosition;
+
+    ull dequeuePosition;
+
+    time_t lastTime;
+
+    string lastTimeString;
+
+    pthread_t writerThread;
+
+    bool writerRunning;
+
+    volatile bool stopRequested;
+
 
   public:
     static const ushort warningLevel;
@@ -57,6 +108,8 @@ class Log : public Singleton<Log>
 
     static const ushort infoLevel;
 
+    static const ushort debugLevel;
+
     //!
     //! \brief Sets the output file name
     //!
@@ -75,6 +128,28 @@ class Log : public Singleton<Log>
     //! \return nothing
     void SetEnabled(bool state);
 
+    //!
+    //! \brief Sets the minimum level of the messages which are logged
+    //!
+    //! \param[in] level 	ushort, the minimum level (in increasing order of seriousness: Log::debugLevel, Log::infoLevel (default), Log::warningLevel, Log::errorLevel).
+    //!
+    //! \return nothing
+    void SetLevel(ushort level);
+
+    //!
+    //! \brief Returns whether the messages of the given level are logged
+    //!
+    //! \param[in] level 	ushort, the level of the messages.
+    //!
+    //! \return true if the log is enabled and \a level is at least the minimum level, false otherwise
+    bool IsEnabled(ushort level = Log::infoLevel) const;
+
+    //!
+    //! \brief Writes the pending messages to the log file
+    //!
+    //! \return nothing
+    void Flush();
+
     //!
     //! \brief Registers an error
     //
@@ -95,7 +170,17 @@ class Log : public Singleton<Log>
 
 
   private:
-    bool GetTimeString(string& timeString) const;
+    bool GetTimeString(string& timeString, time_t t) const;
+
+    static ushort GetSeverity(ushort level);
+
+    void WritePendingMessages();
+
+    void StopWriter();
+
+    static void* RunWriterThread(void* arg);
+
+    static void StopAtExit();
 
 };
 
@@ -5,6 +5,7 @@
 //! \file
 //!
 #include "Singleton.h"
+#include "Threads.h"
 #include <map>
 using namespace std;
 #include <string>
@@ -24,6 +25,7 @@ namespace lpm {
 //!
 //! \note The methods of the class, except the Report() method should never be called directly.
 //! The \a Allocate and \a Free macros defined in \a Defs.h should be used instead !
+//! \note The bookkeeping is protected by a mutex so that worker threads (see Threads) can allocate and free memory.
 //! 
 //! \see Reference, AllocateChunk(), FreeChunk(), UpdateReference(), Report()
 //!
@@ -41,6 +43,12 @@ class Memory : public Singleton<Memory>
 
     map<void*, string> chunks;
 
+    Mutex mutex;
+
+    ull allocationsCount;
+
+    ull allocatedBytes;
+
 
   public:
     void* AllocateChunk(ull bytes, const char* file, int line);
@@ -49,8 +57,22 @@ class Memory : public Singleton<Memory>
 
     void UpdateReference(void* object, ull newCount);
 
+    unsigned long UpdateReferenceCount(void* object, unsigned long* refCount, bool increment);
+
     void Report();
 
+    //!
+    //! \brief Returns the number of chunks and bytes allocated (with AllocateChunk()) since the creation of the singleton
+    //!
+    //! The counts are cumulative (freeing a chunk does not decrease them): the allocations done by a piece of code are obtained as the difference of two calls.
+    //!
+    //! \param[out] allocations 	ull*, the number of chunks allocated (can be NULL).
+    //! \param[out] bytes 	ull*, the number of bytes allocated (can be NULL).
+    //!
+    //! \return nothing
+    //!
+    void GetAllocationStatistics(ull* allocations, ull* bytes);
+
 };
 
 } // namespace lpm
@@ -57,6 +57,16 @@ class MetricOperation : public Operation<AttackOutput, File>
 
     virtual string GetTypeString() const = 0;
 
+    //! 
+    //! \brief Returns whether the metric writes its output user by user
+    //!
+    //! The output of a per-user metric consists of independent lines (one per user). Hence, the outputs of successive executions
+    //! on disjoint batches of users can be appended to one another (see ScheduleBuilder::SetStreamingBatchSize()).
+    //!
+    //! \return true or false, depending on whether the metric is per-user (the default implementation returns false)
+    //!
+    virtual bool IsPerUser() const;
+
 };
 //! 
 //! \brief Base class for all metric distance functions (used by distortion-based metrics).
@@ -78,6 +88,20 @@ class MetricDistance
     //!
     virtual double ComputeDistance(ull firstLocation, ull secondLocation) const = 0;
 
+    //! 
+    //! \brief Computes the distances between a location and all the locations
+    //!
+    //! The default implementation calls ComputeDistance() for each location. Distance functions which can do better
+    //! (e.g. those holding a precomputed distance matrix) should override it, as metrics use it for their inner loops.
+    //!
+    //! \param[in] firstLocation 	ull, the location.
+    //! \param[out] row 	double*, the distances: row[loc - minLoc] is the distance between \a firstLocation and \a loc, for each location loc
+    //!	of the locationstamps range (see Parameters::GetLocationstampsRange()).
+    //!
+    //! \return nothing
+    //!
+    virtual void ComputeDistanceRow(ull firstLocation, double* row) const;
+
 };
 
 } // namespace lpm
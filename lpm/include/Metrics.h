@@ -42,6 +42,8 @@ class DistortionMetricOperation : public MetricOperation
 
     virtual string GetTypeString() const;
 
+    virtual bool IsPerUser() const;
+
 };
 class EntropyMetricOperation : public MetricOperation 
 {
@@ -54,6 +56,8 @@ class EntropyMetricOperation : public MetricOperation
 
     virtual string GetTypeString() const;
 
+    virtual bool IsPerUser() const;
+
 };
 class MostLikelyLocationDistortionMetricOperation : public DistortionMetricOperation 
 {
@@ -103,6 +107,8 @@ class DefaultMetricDistance : public MetricDistance
   public:
     virtual double ComputeDistance(ull firstLocation, ull secondLocation) const;
 
+    virtual void ComputeDistanceRow(ull firstLocation, double* row) const;
+
 };
 class MostLikelyTraceDistortionMetricOperation : public DistortionMetricOperation 
 {
@@ -115,6 +121,8 @@ class MostLikelyTraceDistortionMetricOperation : public DistortionMetricOperatio
 
     virtual string GetTypeString() const;
 
+    virtual bool IsPerUser() const;
+
 };
 class DensityMetricOperation : public MetricOperation 
 {
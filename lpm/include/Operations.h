@@ -7,6 +7,7 @@
 #include <string>
 using namespace std;
 #include "Reference.h"
+#include "Instrumentation.h"
 
 #include "Defs.h"
 
@@ -42,6 +43,18 @@ class Operation : public Reference<Operation<InputType, OutputType> >
     //!
     virtual bool Execute(const InputType* input, OutputType* output) = 0;
 
+    //! 
+    //! \brief Executes the operation and records its duration
+    //!
+    //! Calls Execute() and, if the instrumentation is enabled, records the time it took under the timer '<operation name>::Execute' (see Instrumentation).
+    //!
+    //! \tparam[[in] input 	InputType* to the input object of the operation.
+    //! \tparam[[in,out] output 	OutputType* to the output object of the operation.
+    //!
+    //! \return true if the operation is successful, false otherwise
+    //!
+    bool TimedExecute(const InputType* input, OutputType* output);
+
     //! 
     //! \brief Gets a detailed string of the operation
     //!
@@ -67,6 +80,20 @@ Operation<InputType, OutputType>::~Operation()
   // Bouml preserved body end 0005A591
 }
 
+template<typename InputType, typename OutputType>
+bool Operation<InputType, OutputType>::TimedExecute(const InputType* input, OutputType* output) 
+{
+  // Bouml preserved body begin 000E3891
+
+	if(Instrumentation::GetInstance()->IsEnabled() == false) { return Execute(input, output); }
+
+	ScopedTimer timer(operationName + "::Execute");
+
+	return Execute(input, output);
+
+  // Bouml preserved body end 000E3891
+}
+
 
 } // namespace lpm
 #endif
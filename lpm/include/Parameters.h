@@ -66,12 +66,34 @@ class Parameters : public Singleton<Parameters>
 
     TPInfo tpInfo;
 
+    ull numThreads;
+
+    bool ownsTimePartitioning;
+
 
   public:
     Parameters();
 
     ~Parameters();
 
+    //!
+    //! \brief Returns the parameters of the execution context active on the calling thread (see ExecutionContext), or the global parameters if none
+    //!
+    //! \return Parameters*, the parameters
+    //!
+    static Parameters* GetInstance();
+
+    //!
+    //! \brief Copies the given parameters
+    //!
+    //! \note The time partitioning is shared with \a source (which keeps ownership of it).
+    //!
+    //! \param[in] source 	Parameters*, the parameters to copy.
+    //!
+    //! \return true or false, depending on whether the call is successful
+    //!
+    bool CopyFrom(const Parameters* source);
+
     bool GetUsersSet(set<ull>& users);
 
     ull GetUsersCount();
@@ -100,6 +122,22 @@ class Parameters : public Singleton<Parameters>
 
     bool GetTimePeriodInfo(ull* numPeriods, TPInfo* tpInfo = NULL);
 
+    //!
+    //! \brief Returns the number of threads used by the parallel computations of the library
+    //!
+    //! \return ull, the number of threads (defaults to the number of online processors)
+    //!
+    ull GetThreadsCount() const;
+
+    //!
+    //! \brief Sets the number of threads used by the parallel computations of the library
+    //!
+    //! \param[in] count 	ull, the number of threads (1 disables multi-threading).
+    //!
+    //! \return true or false, depending on whether the call is successful
+    //!
+    bool SetThreadsCount(ull count);
+
 
   private:
     bool InitializeTPInfo(TPNode* partitioning);
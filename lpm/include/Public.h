@@ -3,6 +3,8 @@
 
 #include "Errors.h"
 #include "Log.h"
+#include "Instrumentation.h"
+#include "ExecutionContext.h"
 #include "File.h"
 
 #include "Context.h"
@@ -26,6 +28,7 @@
 #include "ExampleLPPMOperations.h"
 #include "ExampleTraceGeneratorOperations.h"
 #include "ContextAnalysisOperations.h"
+#include "SimilarityCandidateIndex.h"
 
 #include "WeakAttackOperation.h"
 #include "StrongAttackOperation.h"
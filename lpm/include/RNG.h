@@ -7,40 +7,279 @@
 //! See: http://www.gnu.org/software/gsl/.
 //!
 #include "Singleton.h"
+#include "Threads.h"
 
 #include "Defs.h"
 namespace lpm {
 
+//!
+//! \brief Stream of pseudo-random numbers (xoshiro256++ engine)
+//!
+//! A stream is a small, copyable object which is not thread-safe by itself: each thread (or each independent unit of work)
+//! should use its own stream. Independent streams are obtained from RNG::CreateStream() (or by jumping ahead with Jump()),
+//! so that the output of a run only depends on the seed of the RNG, and not on the way the work is scheduled on the threads.
+//!
+//! \see RNG
+//!
+class RNGStream
+{
+  public:
+    RNGStream();
+
+    explicit RNGStream(uint64 seed);
+
+    //!
+    //! \brief Seeds the stream (the 256 bits of state are expanded from \a seed with splitmix64)
+    //!
+    //! \param[in] seed 	uint64, the seed.
+    //!
+    //! \return nothing
+    //!
+    void Seed(uint64 seed);
+
+    //!
+    //! \brief Advances the stream by 2^128 steps
+    //!
+    //! This is equivalent to 2^128 calls to GetRandomUINT64() and is used to generate non-overlapping sub-streams.
+    //!
+    //! \return nothing
+    //!
+    void Jump();
+
+    //!
+    //! \brief Advances the stream by 2^192 steps
+    //!
+    //! This is used to generate non-overlapping streams, each of which can itself be split into 2^64 sub-streams with Jump().
+    //!
+    //! \return nothing
+    //!
+    void LongJump();
+
+    //!
+    //! \brief Returns a uniform random 64 bits unsigned integer
+    //!
+    //! \return uint64, the number generated
+    //!
+    uint64 GetRandomUINT64();
+
+    //!
+    //! \brief Returns a uniform random double in ]0; 1[ (with 52 bits of precision)
+    //!
+    //! \return double, the number generated
+    //!
+    double GetUniformRandomDouble();
+
+    //!
+    //! \brief Fills the given array with uniform random doubles in ]0; 1[
+    //!
+    //! \param[in,out] output 	double*, the output array (an array of \a count doubles).
+    //! \param[in] count 	ull, the number of doubles to generate.
+    //!
+    //! \return nothing
+    //!
+    void FillUniform(double* output, ull count);
+
+    //!
+    //! \brief Returns a uniform random unsigned long long (\a ull) between \a min and \a max (inclusive)
+    //!
+    //! \param[in] min 	ull, the lower bound.
+    //! \param[in] max 	ull, the upper bound.
+    //!
+    //! \return ull, the number generated
+    //!
+    ull GetUniformRandomULLBetween(ull min, ull max);
+
+    //!
+    //! \brief Returns a random permutation of the given \a input array
+    //!
+    //! \param[in] input 	ull*, the input array (an array of \a count \a ulls).
+    //! \param[in] count 	ull, the number of elements in the \a input array
+    //! \param[in,out] output ull*, the output array (an array of \a count \a ull numbers) which will be filled with the output permutation (if the call is successful).
+    //!
+    //! \return true or false, depending on whether the call is successful
+    //!
+    bool RandomPermutation(const ull* input, const ull count, ull* output);
+
+    //!
+    //! \brief Samples (returns an index) from the given probability vector
+    //!
+    //! \param[in] probVector 	double*, the probability vector (an array of \a length \a doubles).
+    //! \param[in] length 	ull, the number of elements in the probability vector
+    //!
+    //! \return ull, the sampled index
+    //!
+    ull SampleIndexFromVector(const double* probVector, ull length);
+
+    double GetGaussianRandomDouble(double sigma);
+
+    //!
+    //! \brief Fills the given array with standard normal random doubles (Box-Muller transform on bulk uniforms)
+    //!
+    //! \param[in,out] output 	double*, the output array (an array of \a count doubles).
+    //! \param[in] count 	ull, the number of doubles to generate.
+    //!
+    //! \return nothing
+    //!
+    void FillGaussian(double* output, ull count);
+
+    double GetGammaRandomDouble(double a, double b);
+
+    //!
+    //! \brief Draws one Gamma(\a alpha[i], 1) variate per entry and returns its logarithm
+    //!
+    //! The variates are drawn in batches (Marsaglia-Tsang, with the rejected entries redrawn in the next batch). For \a alpha[i] < 1,
+    //! a Gamma(\a alpha[i] + 1, 1) variate is boosted by U^(1 / \a alpha[i]) in the log domain, which cannot underflow.
+    //! Entries with \a alpha[i] <= 0 are set to -HUGE_VAL (i.e. log(0)).
+    //!
+    //! \param[in] alpha 	double*, the shape parameters (an array of \a K doubles).
+    //! \param[in] K 	ull, the number of variates.
+    //! \param[in,out] logGamma 	double*, the output array (an array of \a K doubles).
+    //!
+    //! \return nothing
+    //!
+    void GetGammaRandomLogSample(const double* alpha, ull K, double* logGamma);
+
+    void GetDirichletRandomSample(const double* alpha, ull K, double* theta);
+
+
+  private:
+    inline uint64 Next();
+
+    void JumpBy(const uint64* polynomial);
+
+    uint64 state[4];
+
+};
+//!
+//! \brief Walker alias table of a discrete distribution
+//!
+//! Once built (in O(length)), the table samples an index of the distribution in constant time, instead of the linear scan done by
+//! RNG::SampleIndexFromVector(). It is meant to be built once and cached for distributions which are sampled many times.
+//!
+class AliasTable
+{
+  public:
+    AliasTable();
+
+    //!
+    //! \brief Builds the table of the given probability vector (Vose's method)
+    //!
+    //! \note The vector does not need to be normalized, but its elements must be non-negative and sum up to a positive value.
+    //!
+    //! \param[in] probVector 	double*, the probability vector (an array of \a length \a doubles).
+    //! \param[in] length 	ull, the number of elements in the probability vector.
+    //!
+    //! \return true or false, depending on whether the call is successful
+    //!
+    bool Build(const double* probVector, ull length);
+
+    //!
+    //! \brief Returns the number of elements of the distribution (0 if the table has not been built)
+    //!
+    //! \return ull, the number of elements
+    //!
+    ull GetLength() const;
+
+    //!
+    //! \brief Samples an index in the range \[\a 0; \a length - 1\] using the given stream
+    //!
+    //! \param[in] stream 	RNGStream*, the random stream to draw from.
+    //!
+    //! \return ull, the sampled index
+    //!
+    ull Sample(RNGStream* stream) const;
+
+    //!
+    //! \brief Samples an index in the range \[\a 0; \a length - 1\] using the shared stream of the RNG
+    //!
+    //! \return ull, the sampled index
+    //!
+    ull Sample() const;
+
+
+  private:
+    inline ull Lookup(double u) const;
+
+    vector<double> threshold;
+
+    vector<ull> alias;
+
+};
 //!
 //! \brief Implements random number generating facilities
 //!
 //! Singleton class which provides convenient methods to generate random numbers (integers and real numbers) uniformly or
 //! according to a distribution (e..g Normal, Gamma), and, to sample from a distribution (e.g. Dirichlet).
 //!
-class RNG : public Singleton<RNG> 
+//! The methods of the singleton draw from a shared (mutex protected) stream and are thus safe to call from several threads.
+//! Computations which draw many numbers in parallel should rather obtain their own streams with CreateStream().
+//!
+class RNG : public Singleton<RNG>
 {
 friend class Singleton<RNG>;
   private:
     RNG();
 
-    inline uint64 RandomUINT64() const;
-
 
   public:
-    //! 
+    //!
+    //! \brief Seeds the generator (e.g. to make a run reproducible)
+    //!
+    //! \param[in] seed 	uint64, the seed.
+    //!
+    //! \return nothing
+    //!
+    void SetSeed(uint64 seed);
+
+    //!
+    //! \brief Returns the seed of the generator
+    //!
+    //! \return uint64, the seed (by default, derived from the current time)
+    //!
+    uint64 GetSeed() const;
+
+    //!
+    //! \brief Returns a new independent stream
+    //!
+    //! The returned stream starts at the current position of the shared stream, which is then jumped ahead by 2^192 steps.
+    //! Hence, the sequence of streams returned only depends on the seed and the order of the calls.
+    //!
+    //! \note If the calling thread has its own stream (see SetThreadStream()), the returned stream is a sub-stream of it (jumped ahead by 2^128 steps).
+    //!
+    //! \return RNGStream, the new stream
+    //!
+    RNGStream CreateStream();
+
+    //!
+    //! \brief Sets the stream used by the calling thread
+    //!
+    //! While set, the methods of the singleton called from this thread draw from the given stream (without locking) instead of the shared stream,
+    //! and CreateStream() returns sub-streams of it. This makes the numbers drawn by a unit of work independent of the other threads.
+    //!
+    //! \param[in] stream 	RNGStream*, the stream (NULL to use the shared stream again).
+    //!
+    //! \return RNGStream*, the stream previously used by the calling thread (NULL if it used the shared stream)
+    //!
+    RNGStream* SetThreadStream(RNGStream* stream);
+
+    //!
     //! \brief Returns a uniform random double in ]0; 1[
     //!
     //! \return double, the number generated
     //!
     double GetUniformRandomDouble() const;
 
+    //!
+    //! \brief Fills the given array with uniform random doubles in ]0; 1[
+    //!
+    //! \param[in,out] output 	double*, the output array (an array of \a count doubles).
+    //! \param[in] count 	ull, the number of doubles to generate.
+    //!
+    //! \return nothing
+    //!
+    void FillUniform(double* output, ull count) const;
 
-  private:
-    inline ull GetUniformRandomULL() const;
-
-
-  public:
-    //! 
+    //!
     //! \brief Returns a uniform random unsigned long long (\a ull) between \a min and \a max (inclusive)
     //!
     //! \param[in] min 	ull, the lower bound.
@@ -50,7 +289,7 @@ friend class Singleton<RNG>;
     //!
     ull GetUniformRandomULLBetween(ull min, ull max) const;
 
-    //! 
+    //!
     //! \brief Returns a random permutation of the given \a input array
     //!
     //! \param[in] input 	ull*, the input array (an array of \a count \a ulls).
@@ -61,7 +300,7 @@ friend class Singleton<RNG>;
     //!
     bool RandomPermutation(const ull* input, const ull count, ull* output) const;
 
-    //! 
+    //!
     //! \brief Samples (returns an index) from the given probability vector
     //!
     //! Samples an index in the range \[\a 0; \a length - 1\] according to the probabilities given by \a probVector.
@@ -75,19 +314,17 @@ friend class Singleton<RNG>;
     //!
     ull SampleIndexFromVector(double* probVector, ull length) const;
 
+    void GetDirichletRandomSample(const double* alpha, ull K, double* theta) const;
 
-  private:
-    inline double GetGaussianRandomDouble(double sigma) const;
-
-    inline double GetGammaRandomDouble(double a, double b) const;
+    void GetDirichletExpectedValue(double* alpha, ull K, double* theta) const;
 
-    inline void GetDirichletRandomSampleSmall(const double* alpha, ull K, double* theta) const;
 
+  private:
+    mutable Mutex mutex;
 
-  public:
-    void GetDirichletRandomSample(const double* alpha, ull K, double* theta) const;
+    mutable RNGStream stream;
 
-    void GetDirichletExpectedValue(double* alpha, ull K, double* theta) const;
+    uint64 seed;
 
 };
 
@@ -21,6 +21,8 @@ namespace lpm {
 //! When the object is no longer used, \a Release() should be called.
 //!
 //! \note Newly created reference counted objects (e.g. just after a \a new) have \a refCount = 0.
+//! \note The reference count is updated atomically, so that objects shared by several threads (e.g. by the concurrent branches of a schedule)
+//! can be referenced and released from any of them. Only debug builds also record the count in the bookkeeping of the Memory singleton (under its lock).
 //! \note If \a AddRef() has been called and \a refCount = 1, we say the caller \a owns (exclusively) the object.
 //!
 //! \see AddRef(), Release()
@@ -101,10 +103,13 @@ void Reference<T>::AddRef()
 {
   // Bouml preserved body begin 0001F611
 
-	DEBUG_VERIFY(refCount > 0);
-	refCount++;
-
-	Memory::GetInstance()->UpdateReference(static_cast<void*>(referencedObject), refCount);
+#ifdef DEBUG
+	// the count is checked and recorded under the lock of the Memory singleton
+	Memory::GetInstance()->UpdateReferenceCount(static_cast<void*>(referencedObject), &refCount, true);
+#else
+	unsigned long count = __sync_add_and_fetch(&refCount, 1);
+	DEBUG_VERIFY(count > 1);
+#endif
 
   // Bouml preserved body end 0001F611
 }
@@ -123,12 +128,15 @@ void Reference<T>::Release()
 {
   // Bouml preserved body begin 0001F691
 
-	DEBUG_VERIFY(refCount > 0);
-
-	Memory::GetInstance()->UpdateReference(static_cast<void*>(referencedObject), refCount);
+#ifdef DEBUG
+	// the count is checked and recorded under the lock of the Memory singleton
+	unsigned long count = Memory::GetInstance()->UpdateReferenceCount(static_cast<void*>(referencedObject), &refCount, false);
+#else
+	unsigned long count = __sync_sub_and_fetch(&refCount, 1);
+	DEBUG_VERIFY(count + 1 > 0); // the count was positive
+#endif
 
-	refCount--;
-	if(refCount == 0)
+	if(count == 0) // this thread released the last reference
 	{
 		delete referencedObject;
 	}
@@ -114,6 +114,8 @@ class Schedule : public Reference<Schedule>
 
     FilterFunction* lppmPDF;
 
+    ull streamingBatchSize;
+
 
 friend class LPM;
 friend class ScheduleBuilder;
@@ -231,6 +231,25 @@ class ScheduleBuilder
     //!
     bool SetMetricType(MetricType type, MetricDistance* distance = NULL);
 
+    //! 
+    //! \brief Sets the number of users per batch when streaming the users through the stages of the schedule
+    //!
+    //! When streaming, the users flow through the application, LPPM, attack and metric stages in successive batches of \a batchSize users,
+    //! and the intermediary results of a batch (exposed and observed traces, attack output) are released as soon as the metric has consumed them.
+    //! The peak memory usage of these stages is thus bounded by the batch size instead of the number of users.
+    //!
+    //! \note Streaming only takes place if the LPPM neither anonymizes nor changes pseudonyms, if the attack and the metric are per-user
+    //! (see AttackOperation::IsPerUser() and MetricOperation::IsPerUser()), and if no intermediary output or branching follows the position
+    //! from which the users are streamed. Otherwise, the stages run on all users at once (as when streaming is disabled).
+    //!
+    //! \note This method must be called before ForkSchedule(): the branches inherit the batch size (which can then be changed through their own builders).
+    //!
+    //! \param[in] batchSize 	ull, the number of users per batch (0 disables streaming, which is the default).
+    //!
+    //! \return true or false, depending on whether the call is successful
+    //!
+    bool SetStreamingBatchSize(ull batchSize);
+
 
   private:
     bool wasForked;
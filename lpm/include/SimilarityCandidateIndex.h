@@ -0,0 +1,127 @@
+#ifndef LPM_SIMILARITYCANDIDATEINDEX_H
+#define LPM_SIMILARITYCANDIDATEINDEX_H
+
+//!
+//! \file
+//!
+#include <vector>
+using namespace std;
+
+#include "Defs.h"
+#include "Private.h"
+
+// default banding of the signatures (bands * rows per band hashes per vector): two vectors whose weighted Jaccard similarity is s
+// collide in at least one band with probability 1 - (1 - s^rows)^bands (i.e. the threshold is around (1 / bands)^(1 / rows) = 0.5)
+#define SIMILARITY_INDEX_DEFAULT_BANDS 16
+#define SIMILARITY_INDEX_DEFAULT_ROWS_PER_BAND 4
+
+// maximum number of vectors with which a vector is paired in each bucket (bounds the work on large buckets, e.g. of identical vectors)
+#define SIMILARITY_INDEX_MAX_BUCKET_WINDOW 256
+
+namespace lpm {
+
+//!
+//! \brief Locality-sensitive hashing index of non-negative vectors (e.g. the steady-state vectors of the users)
+//!
+//! Each vector is sketched by consistent weighted sampling (weighted MinHash, see Ioffe, "Improved Consistent Sampling, Weighted Minhash
+//! and L1 Sketching", ICDM 2010): the probability that two vectors have the same hash is their weighted Jaccard similarity
+//! sum_i min(x_i, y_i) / sum_i max(x_i, y_i). For probability vectors, it is a monotonic function of their overlap sum_i min(x_i, y_i).
+//!
+//! The hashes are grouped in bands; the vectors which share all the hashes of at least one band are candidate pairs, which avoids the
+//! exhaustive comparison of all the pairs of vectors. The candidates can be filtered by their estimated similarity, or restricted to the
+//! nearest neighbors of each vector, before their exact similarity is computed.
+//!
+//! \note The random variates of the hashes are tabulated (3 doubles per hash and per dimension).
+//!
+class SimilarityCandidateIndex
+{
+  public:
+    //!
+    //! \brief Creates an empty index
+    //!
+    //! \param[in] dimension 	ull, the dimension of the vectors.
+    //! \param[in] seed 	uint64, the seed of the hash functions (the vectors are comparable only within an index).
+    //! \param[in] bands 	ull, the number of bands.
+    //! \param[in] rowsPerBand 	ull, the number of hashes per band.
+    //!
+    SimilarityCandidateIndex(ull dimension, uint64 seed, ull bands = SIMILARITY_INDEX_DEFAULT_BANDS, ull rowsPerBand = SIMILARITY_INDEX_DEFAULT_ROWS_PER_BAND);
+
+    virtual ~SimilarityCandidateIndex();
+
+    //!
+    //! \brief Adds a vector to the index
+    //!
+    //! \param[in] weights 	const double*, the vector (of the dimension of the index, with non-negative entries).
+    //!
+    //! \return the index of the vector (i.e. the number of vectors added before it)
+    //!
+    ull AddVector(const double* weights);
+
+    //!
+    //! \brief Returns the number of vectors of the index
+    //!
+    //! \return the number of vectors
+    //!
+    ull GetVectorsCount() const;
+
+    //!
+    //! \brief Estimates the weighted Jaccard similarity of two vectors of the index
+    //!
+    //! \param[in] first 	ull, the index of the first vector.
+    //! \param[in] second 	ull, the index of the second vector.
+    //!
+    //! \return the proportion of the hashes of the vectors which are equal
+    //!
+    double EstimateSimilarity(ull first, ull second) const;
+
+    //!
+    //! \brief Returns the candidate pairs whose estimated similarity is at least the given threshold
+    //!
+    //! \param[in] minSimilarity 	double, the threshold on the estimated similarity (see EstimateSimilarity()).
+    //! \param[out] pairs 	vector<pair<ull, ull> >&, the pairs (first < second, sorted).
+    //!
+    //! \return nothing
+    //!
+    void GetCandidatePairs(double minSimilarity, vector<pair<ull, ull> >& pairs) const;
+
+    //!
+    //! \brief Returns the nearest neighbors of each vector among its candidates
+    //!
+    //! \param[in] neighbors 	ull, the maximum number of neighbors per vector.
+    //! \param[out] neighborsLists 	vector<vector<ull> >&, for each vector, its neighbors (by decreasing estimated similarity).
+    //!
+    //! \return nothing
+    //!
+    void GetNearestNeighbors(ull neighbors, vector<vector<ull> >& neighborsLists) const;
+
+
+  private:
+    SimilarityCandidateIndex(const SimilarityCandidateIndex& source);
+
+    SimilarityCandidateIndex& operator=(const SimilarityCandidateIndex& source);
+
+    void GetCollidingPairs(vector<pair<ull, ull> >& pairs) const;
+
+    ull dimension;
+
+    ull bands;
+
+    ull rowsPerBand;
+
+    ull numHashes;
+
+    // random variates of the hashes: hash h of dimension i at GET_INDEX(h, i, dimension)
+    vector<double> gammaRates;
+
+    vector<double> logGammaScales;
+
+    vector<double> offsets;
+
+    vector<uint64> signatures;
+
+    ull numVectors;
+
+};
+
+} // namespace lpm
+#endif
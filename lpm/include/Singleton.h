@@ -4,6 +4,8 @@
 //!
 //! \file
 //!
+#include <pthread.h>
+
 #include "Defs.h"
 
 namespace lpm {
@@ -11,6 +13,8 @@ namespace lpm {
 //!
 //! \brief Implements the base Singleton functionality using templates
 //!
+//! The instance is created on the first call to GetInstance(), which is safe to call concurrently from several threads.
+//! Other objects of type \a T (e.g. those owned by an ExecutionContext) can be created and destroyed as usual, they are not the instance.
 //!
 template<typename T>
 class Singleton 
@@ -18,6 +22,14 @@ class Singleton
   private:
     static T* singletonObject;
 
+    // instance visible to the other threads (set once the instance is fully constructed)
+    static T* volatile publishedObject;
+
+    static pthread_mutex_t creationMutex;
+
+    // set (on the creating thread only) while GetInstance() constructs the instance
+    static __thread bool creating;
+
 
   public:
     explicit Singleton();
@@ -35,11 +47,25 @@ class Singleton
 template<typename T>
 T* Singleton<T>::singletonObject = NULL;
 
+template<typename T>
+T* volatile Singleton<T>::publishedObject = NULL;
+
+// recursive: the constructor of the instance may (indirectly) get the instance
+template<typename T>
+pthread_mutex_t Singleton<T>::creationMutex = PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP;
+
+template<typename T>
+__thread bool Singleton<T>::creating = false;
+
 template<typename T>
 Singleton<T>::Singleton() 
 {
   // Bouml preserved body begin 00023E91
+
+	if(creating == false) { return; } // not the instance
+
 	DEBUG_VERIFY(singletonObject == NULL);
+	creating = false;
 
 #ifdef UGLY_TRICK
 	ll singletonPartOffset = (ll)((T*)1) - (ll)(Singleton<T>*)((T*)1);
@@ -56,8 +82,11 @@ Singleton<T>::~Singleton()
 {
   // Bouml preserved body begin 00023F11
 
-	DEBUG_VERIFY(singletonObject != NULL);
-	delete singletonObject;
+	if(singletonObject != NULL && static_cast<Singleton<T>*>(singletonObject) == this)
+	{
+		singletonObject = NULL;
+		publishedObject = NULL;
+	}
 
   // Bouml preserved body end 00023F11
 }
@@ -71,8 +100,28 @@ template<typename T>
 T* Singleton<T>::GetInstance()
 {
   // Bouml preserved body begin 0001F511
-	if(singletonObject == NULL) { new T(); }
-	return singletonObject;
+
+	T* object = publishedObject;
+	__sync_synchronize();
+
+	if(object != NULL) { return object; }
+
+	pthread_mutex_lock(&creationMutex);
+
+	if(singletonObject == NULL)
+	{
+		creating = true;
+		new T();
+		creating = false;
+
+		__sync_synchronize();
+		publishedObject = singletonObject;
+	}
+	object = singletonObject;
+
+	pthread_mutex_unlock(&creationMutex);
+
+	return object;
 
   // Bouml preserved body end 0001F511
 }
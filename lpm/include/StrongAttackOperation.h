@@ -13,6 +13,7 @@ using namespace std;
 #include "Defs.h"
 #include "Private.h"
 #include "Metrics.h"
+#include "RNG.h"
 
 
 namespace lpm { class TraceSet; } 
@@ -48,7 +49,7 @@ class StrongAttackOperation : public AttackOperation
 
         ObservedEvent** observedMatrix;
 
-        vector<ull> users;
+        const vector<ull>* users;
 
         ull user;
 
@@ -60,12 +61,68 @@ class StrongAttackOperation : public AttackOperation
 
         ull tmIdx;
 
+        RNGStream* stream;
+
     };
-    
+    //!
+    //! \brief State of one Metropolis-Hastings chain of the generic reconstruction
+    //!
+    //! Each chain owns its current sample, its random stream and its counts; the other members are shared (read-only) by all chains.
+    //!
+    struct GenericReconstructionChain 
+    {
+        ull chainIdx;
+
+        RNGStream stream;
+
+        ull* currentSampleA;
+
+        bool* currentSampleX;
+
+        ull* currentSampleSigma;
+
+        double* dist;
+
+        double* nyms;
+
+        double* sigma;
+
+        ull targetSubSamples;
+
+        ull subSamples;
+
+        ull steps;
+
+        vector<double> meanLocationTrace;
+
+        vector<double> exposureTrace;
+
+        bool randomWalkFromHint;
+
+        ObservedEvent** observedMatrix;
+
+        const vector<ull>* users;
+
+        const map<ull, UserProfile*>* profiles;
+
+        const map<ull, ull>* pseudonymsToIdxMap;
+
+        ull startTime;
+
+    };
+    class GenericReconstructionChainTask;
+
     bool viterbiInsteadOfAlphaBeta;
 
   public:
-    StrongAttackOperation(bool genericRec = false, ull genericRecSamples = 500, bool viterbiNotAlphaBeta = false);
+    //!
+    //! \param[in] genericRec 	[optional] bool, whether to run the generic (MCMC) reconstruction.
+    //! \param[in] genericRecSamples 	[optional] ull, the number of i.i.d. sub-samples to collect (over all chains).
+    //! \param[in] viterbiNotAlphaBeta 	[optional] bool, whether to use the Viterbi algorithm instead of the forward-backward algorithm.
+    //! \param[in] genericRecChains 	[optional] ull, the number of independent chains of the generic reconstruction (each chain runs on its own thread).
+    //! \param[in] genericRecMaxSeconds 	[optional] ull, the wall-clock budget (in seconds) of the generic reconstruction (0 for no limit).
+    //!
+    StrongAttackOperation(bool genericRec = false, ull genericRecSamples = 500, bool viterbiNotAlphaBeta = false, ull genericRecChains = 1, ull genericRecMaxSeconds = 0);
 
     ~StrongAttackOperation();
 
@@ -73,6 +130,16 @@ class StrongAttackOperation : public AttackOperation
 
     virtual bool Execute(const TraceSet* input, AttackOutput* output);
 
+    //!
+    //! \brief Returns whether the attack processes each user independently of the other users
+    //!
+    //! This is the case when the Viterbi algorithm is used (without the generic reconstruction) and the LPPM neither anonymizes nor changes pseudonyms:
+    //! each user is then tracked on his own observed trace.
+    //!
+    //! \return true or false, depending on whether the attack is per-user
+    //!
+    virtual bool IsPerUser() const;
+
     void SetGenericReconstructionHint(const TraceSet* actual, const TraceSet* exposed, ull* sigma);
 
 
@@ -89,10 +156,16 @@ class StrongAttackOperation : public AttackOperation
 
     bool GenericReconstruction(const TraceSet* traces, const map<ull, ull>& userToPseudonymMap, const ull* mostLikelyTrace, AttackOutput* output);
 
+    bool RunGenericReconstructionChain(GenericReconstructionChain* chain) const;
+
     bool genericReconstruction;
 
     ull genericReconstructionSamples;
 
+    ull genericReconstructionChains;
+
+    ull genericReconstructionMaxSeconds;
+
 };
 
 } // namespace lpm
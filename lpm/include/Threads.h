@@ -0,0 +1,125 @@
+#ifndef LPM_THREADS_H
+#define LPM_THREADS_H
+
+//!
+//! \file
+//!
+#include <pthread.h>
+
+#include "Defs.h"
+
+namespace lpm {
+
+//!
+//! \brief Wraps a (non-recursive) pthread mutex
+//!
+//! \see ScopedLock
+//!
+class Mutex
+{
+  public:
+    Mutex();
+
+    ~Mutex();
+
+    void Lock();
+
+    void Unlock();
+
+
+  private:
+    Mutex(const Mutex& source);
+
+    Mutex& operator=(const Mutex& source);
+
+    pthread_mutex_t mutex;
+
+};
+//!
+//! \brief Locks a Mutex for the lifetime of the object (i.e. until the end of the enclosing scope)
+//!
+class ScopedLock
+{
+  public:
+    explicit ScopedLock(Mutex& mutex);
+
+    ~ScopedLock();
+
+
+  private:
+    ScopedLock(const ScopedLock& source);
+
+    ScopedLock& operator=(const ScopedLock& source);
+
+    Mutex& lockedMutex;
+
+};
+//!
+//! \brief Unit of work executed by Threads::ParallelFor()
+//!
+//! Implementations should only write to state owned by the given \a index (or by the given \a thread),
+//! all other state should be treated as read-only.
+//!
+//! \note Threads::ParallelFor() leaves the RNG alone and hands the indices out dynamically: tasks which draw random numbers
+//! should carry one stream per index, created in index order by the caller (see RNG::CreateStream()) and installed with RNG::SetThreadStream().
+//!
+class ParallelTask
+{
+  public:
+    virtual ~ParallelTask();
+
+    //!
+    //! \brief Runs the task for the given index
+    //!
+    //! \param[in] index 	ull, the index in [0; count[ to process.
+    //! \param[in] thread 	ull, the id in [0; numThreads[ of the thread running the task (e.g. to select per-thread scratch space).
+    //!
+    //! \return nothing
+    //!
+    virtual void Run(ull index, ull thread) = 0;
+
+};
+//!
+//! \brief Provides basic (pthread based) multi-threading facilities
+//!
+//! Static class used by the operations of the library to spread independent computations over several threads.
+//!
+//! \note The Memory, Errors and Log singletons are safe to use from worker threads, the other singletons (e.g. Parameters) should only be read.
+//!
+class Threads
+{
+  public:
+    //!
+    //! \brief Returns the number of online processors (at least 1)
+    //!
+    //! \return ull, the number of online processors
+    //!
+    static ull GetProcessorsCount();
+
+    //!
+    //! \brief Runs task->Run(index, thread) for each index in [0; count[ using several threads
+    //!
+    //! Indices are handed out dynamically to the threads. The calling thread takes part in the computation (as thread 0).
+    //!
+    //! \param[in] count 	ull, the number of indices.
+    //! \param[in] task 	ParallelTask*, the task to run.
+    //! \param[in] numThreads 	[optional] ull, the number of threads to use (if 0, Parameters::GetThreadsCount() is used).
+    //!
+    //! \return true or false, depending on whether the call is successful
+    //!
+    static bool ParallelFor(ull count, ParallelTask* task, ull numThreads = 0);
+
+    //!
+    //! \brief Returns the number of threads ParallelFor() would use for \a count indices
+    //!
+    //! \param[in] count 	ull, the number of indices.
+    //! \param[in] numThreads 	[optional] ull, the number of threads requested (if 0, Parameters::GetThreadsCount() is used).
+    //!
+    //! \return ull, the number of threads
+    //!
+    static ull GetEffectiveThreadsCount(ull count, ull numThreads = 0);
+
+};
+
+} // namespace lpm
+#endif
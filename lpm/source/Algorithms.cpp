@@ -223,6 +223,200 @@ void Algorithms::MinimumCostAssignment(ll* costMatrix, ll numItems, ll* assignme
   // Bouml preserved body end 000C5291
 }
 
+//Floating-point version (shortest augmenting path Hungarian algorithm with dual potentials, O(n^3)), see Jonker & Volgenant (1987).
+//Works directly on real-valued costs (e.g. negative log-likelihoods), i.e. without scaling them to integers. assignment[i] is the column assigned to row i.
+void Algorithms::MinimumCostAssignment(const double* costMatrix, ull numItems, ll* assignment)
+{
+  // Bouml preserved body begin 000E1611
+
+	VERIFY(costMatrix != NULL && assignment != NULL);
+
+	ull n = numItems;
+	if(n == 0) { return; }
+
+	// Note: rows and columns are 1-based below, index 0 being a virtual column used to start each augmentation
+	ull vectorByteSize = (n + 1) * sizeof(double);
+	double* u = (double*)Allocate(vectorByteSize); // row potentials
+	double* v = (double*)Allocate(vectorByteSize); // column potentials
+	double* minSlack = (double*)Allocate(vectorByteSize);
+	VERIFY(u != NULL && v != NULL && minSlack != NULL);
+	memset(u, 0, vectorByteSize); memset(v, 0, vectorByteSize);
+
+	ull indexByteSize = (n + 1) * sizeof(ull);
+	ull* rowOfColumn = (ull*)Allocate(indexByteSize); // row assigned to each column (0 if none)
+	ull* way = (ull*)Allocate(indexByteSize); // previous column on the alternating path
+	bool* used = (bool*)Allocate((n + 1) * sizeof(bool));
+	VERIFY(rowOfColumn != NULL && way != NULL && used != NULL);
+	memset(rowOfColumn, 0, indexByteSize); memset(way, 0, indexByteSize);
+
+	for(ull i = 1; i <= n; i++)
+	{
+		// augment the assignment with row i using a shortest (reduced cost) path
+		rowOfColumn[0] = i;
+		ull j0 = 0;
+
+		for(ull j = 0; j <= n; j++) { minSlack[j] = DBL_MAX; used[j] = false; }
+
+		do
+		{
+			used[j0] = true;
+			ull i0 = rowOfColumn[j0];
+			const double* costRow = &costMatrix[GET_INDEX(i0 - 1, 0, n)];
+
+			double delta = DBL_MAX; ull j1 = 0;
+			for(ull j = 1; j <= n; j++)
+			{
+				if(used[j] == true) { continue; }
+
+				double reducedCost = costRow[j - 1] - u[i0] - v[j];
+				if(reducedCost < minSlack[j]) { minSlack[j] = reducedCost; way[j] = j0; }
+				if(minSlack[j] < delta) { delta = minSlack[j]; j1 = j; }
+			}
+			VERIFY(j1 != 0); // costs must be finite
+
+			// update the potentials
+			for(ull j = 0; j <= n; j++)
+			{
+				if(used[j] == true) { u[rowOfColumn[j]] += delta; v[j] -= delta; }
+				else { minSlack[j] -= delta; }
+			}
+
+			j0 = j1;
+		}
+		while(rowOfColumn[j0] != 0);
+
+		// flip the alternating path
+		do
+		{
+			ull j1 = way[j0];
+			rowOfColumn[j0] = rowOfColumn[j1];
+			j0 = j1;
+		}
+		while(j0 != 0);
+	}
+
+	for(ull j = 1; j <= n; j++)
+	{
+		assignment[rowOfColumn[j] - 1] = (ll)(j - 1);
+	}
+
+	// cleanup
+	Free(u); Free(v); Free(minSlack);
+	Free(rowOfColumn); Free(way); Free(used);
+
+  // Bouml preserved body end 000E1611
+}
+
+//Approximate maximum weight assignment by entropic optimal transport: Sinkhorn iterations (O(n^2) each) on the kernel exp(w / (regularization * range of w)),
+//then greedy rounding of the transport plan to a permutation. The regularization is relative to the range of the weights (the smaller, the closer to the
+//maximum weight but the slower the convergence). Weights may be -infinity (forbidden pairs). assignment[i] is the column assigned to row i.
+void Algorithms::ApproximateMaximumWeightAssignment(const double* weightMatrix, ull numItems, ll* assignment, double regularization, ull iterations)
+{
+  // Bouml preserved body begin 000E4A91
+
+	VERIFY(weightMatrix != NULL && assignment != NULL && regularization > 0.0);
+
+	ull n = numItems;
+	if(n == 0) { return; }
+
+	// range of the finite weights
+	double minWeight = DBL_MAX; double maxWeight = -DBL_MAX;
+	for(ull i = 0; i < n * n; i++)
+	{
+		double w = weightMatrix[i];
+		if(w >= -DBL_MAX && w <= DBL_MAX) { minWeight = MIN(minWeight, w); maxWeight = MAX(maxWeight, w); }
+	}
+	double range = (maxWeight > minWeight) ? (maxWeight - minWeight) : 1.0;
+	double scale = 1.0 / (MAX(regularization, SINKHORN_MIN_REGULARIZATION) * range);
+
+	// kernel (the plan is diag(u) * kernel * diag(v))
+	ull matrixByteSize = n * n * sizeof(double);
+	double* kernel = (double*)Allocate(matrixByteSize);
+	VERIFY(kernel != NULL);
+	for(ull i = 0; i < n * n; i++)
+	{
+		double w = weightMatrix[i];
+		if(w >= -DBL_MAX && w <= DBL_MAX) { kernel[i] = exp((w - maxWeight) * scale); }
+		else { kernel[i] = (w > 0.0) ? 1.0 : 0.0; } // +infinity / -infinity (or NaN)
+	}
+
+	ull vectorByteSize = n * sizeof(double);
+	double* u = (double*)Allocate(vectorByteSize);
+	double* v = (double*)Allocate(vectorByteSize);
+	double* columnSums = (double*)Allocate(vectorByteSize);
+	VERIFY(u != NULL && v != NULL && columnSums != NULL);
+	for(ull j = 0; j < n; j++) { u[j] = 1.0; v[j] = 1.0; }
+
+	// Sinkhorn iterations (every row and column of the plan must sum up to 1)
+	for(ull iteration = 0; iteration < iterations; iteration++)
+	{
+		for(ull i = 0; i < n; i++)
+		{
+			double sum = DotProduct(&kernel[GET_INDEX(i, 0, n)], v, n);
+			u[i] = (sum > 0.0) ? 1.0 / sum : 0.0;
+		}
+
+		memset(columnSums, 0, vectorByteSize);
+		for(ull i = 0; i < n; i++)
+		{
+			const double* kernelRow = &kernel[GET_INDEX(i, 0, n)]; double ui = u[i];
+			for(ull j = 0; j < n; j++) { columnSums[j] += ui * kernelRow[j]; }
+		}
+		for(ull j = 0; j < n; j++) { v[j] = (columnSums[j] > 0.0) ? 1.0 / columnSums[j] : 0.0; }
+
+		// the columns are now exact, check the rows
+		if((iteration + 1) % SINKHORN_CHECK_INTERVAL == 0)
+		{
+			double maxError = 0.0;
+			for(ull i = 0; i < n; i++)
+			{
+				double rowSum = u[i] * DotProduct(&kernel[GET_INDEX(i, 0, n)], v, n);
+				if(u[i] != 0.0) { maxError = MAX(maxError, fabs(rowSum - 1.0)); }
+			}
+
+			if(maxError < SINKHORN_TOLERANCE) { break; }
+		}
+	}
+
+	// greedy rounding: the rows are assigned in decreasing order of their largest plan entry, each to its best free column
+	for(ull i = 0; i < n; i++)
+	{
+		double* kernelRow = &kernel[GET_INDEX(i, 0, n)];
+		for(ull j = 0; j < n; j++) { kernelRow[j] *= v[j]; } // the plan, up to the scaling of the row
+
+		ull best = ArgMax(kernelRow, n);
+		assignment[i] = (ll)best;
+		columnSums[i] = u[i] * kernelRow[best]; // (reuse as the largest entry of the row)
+	}
+
+	vector<pair<double, ull> > rowsOrder = vector<pair<double, ull> >(n);
+	for(ull i = 0; i < n; i++) { rowsOrder[i] = pair<double, ull>(-columnSums[i], i); }
+	sort(rowsOrder.begin(), rowsOrder.end());
+
+	vector<bool> columnAssigned = vector<bool>(n, false);
+	for(ull k = 0; k < n; k++)
+	{
+		ull i = rowsOrder[k].second;
+		if(columnAssigned[assignment[i]] == true)
+		{
+			const double* planRow = &kernel[GET_INDEX(i, 0, n)];
+
+			ll best = -1;
+			for(ull j = 0; j < n; j++)
+			{
+				if(columnAssigned[j] == false && (best == -1 || planRow[j] > planRow[best])) { best = j; }
+			}
+			assignment[i] = best;
+		}
+		columnAssigned[assignment[i]] = true;
+	}
+
+	// cleanup
+	Free(kernel); Free(u); Free(v); Free(columnSums);
+
+  // Bouml preserved body end 000E4A91
+}
+
 int Algorithms::MaximumWeightAssignment(const ll numItems, ll* weight, ll* mapping)
 
 {
@@ -875,4 +1069,153 @@ bool Algorithms::GetTransitionVectorOfSubChain(double* fullChainTransitionMatrix
 }
 
 
+//Gelman-Rubin potential scale reduction factor (R-hat) of a scalar quantity given one trace per chain (only the first n values of each trace are used, n being the length of the shortest trace).
+//Returns 0 if it cannot be computed (i.e. less than 2 chains or less than 2 values per chain).
+double Algorithms::ComputePotentialScaleReduction(const vector<vector<double> >& traces)
+{
+  // Bouml preserved body begin 000E1691
+
+	ull m = traces.size();
+	if(m < 2) { return 0.0; }
+
+	ull n = traces[0].size();
+	foreach_const(vector<vector<double> >, traces, iter) { n = MIN(n, iter->size()); }
+	if(n < 2) { return 0.0; }
+
+	vector<double> means = vector<double>(m, 0.0);
+	double withinVar = 0.0; // W
+	for(ull c = 0; c < m; c++)
+	{
+		const vector<double>& trace = traces[c];
+
+		double mean = 0.0;
+		for(ull i = 0; i < n; i++) { mean += trace[i]; }
+		mean /= (double)n;
+
+		double var = 0.0;
+		for(ull i = 0; i < n; i++) { var += (trace[i] - mean) * (trace[i] - mean); }
+		var /= (double)(n - 1);
+
+		means[c] = mean;
+		withinVar += var;
+	}
+	withinVar /= (double)m;
+
+	double grandMean = 0.0;
+	for(ull c = 0; c < m; c++) { grandMean += means[c]; }
+	grandMean /= (double)m;
+
+	double betweenVar = 0.0; // B
+	for(ull c = 0; c < m; c++) { betweenVar += (means[c] - grandMean) * (means[c] - grandMean); }
+	betweenVar *= (double)n / (double)(m - 1);
+
+	if(withinVar == 0.0) { return (betweenVar == 0.0) ? 1.0 : DBL_MAX; }
+
+	double pooledVar = ((double)(n - 1) / (double)n) * withinVar + betweenVar / (double)n;
+
+	return sqrt(pooledVar / withinVar);
+
+  // Bouml preserved body end 000E1691
+}
+
+//Effective sample size of a scalar quantity over all chains: sum of the per-chain ESS, estimated with Geyer's initial positive sequence of autocorrelations.
+double Algorithms::ComputeEffectiveSampleSize(const vector<vector<double> >& traces)
+{
+  // Bouml preserved body begin 000E1711
+
+	double ess = 0.0;
+
+	foreach_const(vector<vector<double> >, traces, iter)
+	{
+		const vector<double>& trace = *iter;
+
+		ull n = trace.size();
+		if(n == 0) { continue; }
+
+		double mean = 0.0;
+		for(ull i = 0; i < n; i++) { mean += trace[i]; }
+		mean /= (double)n;
+
+		double var = 0.0;
+		for(ull i = 0; i < n; i++) { var += (trace[i] - mean) * (trace[i] - mean); }
+		var /= (double)n;
+
+		if(var == 0.0) { ess += 1.0; continue; } // a constant trace carries the information of a single sample
+
+		// tau = -1 + 2 * sum_k (rho_2k + rho_2k+1), summed as long as the pairs are positive
+		double tau = -1.0;
+		for(ull lag = 0; lag + 1 < n; lag += 2)
+		{
+			double pair = 0.0;
+			for(ull l = lag; l <= lag + 1; l++)
+			{
+				double autocov = 0.0;
+				for(ull i = 0; i + l < n; i++) { autocov += (trace[i] - mean) * (trace[i + l] - mean); }
+				pair += autocov / ((double)n * var);
+			}
+
+			if(pair <= 0.0) { break; }
+			tau += 2.0 * pair;
+		}
+
+		ess += (double)n / MAX(tau, 1.0 / (double)n);
+	}
+
+	return ess;
+
+  // Bouml preserved body end 000E1711
+}
+
+//Dot product of two vectors of n doubles (e.g. expected distance of a localization row). Uses independent partial sums so that the loop is vectorized.
+double Algorithms::DotProduct(const double* x, const double* y, ull n)
+{
+  // Bouml preserved body begin 000E4491
+
+	double sum0 = 0.0; double sum1 = 0.0; double sum2 = 0.0; double sum3 = 0.0;
+
+	ull i = 0;
+	for(; i + 4 <= n; i += 4)
+	{
+		sum0 += x[i] * y[i];
+		sum1 += x[i + 1] * y[i + 1];
+		sum2 += x[i + 2] * y[i + 2];
+		sum3 += x[i + 3] * y[i + 3];
+	}
+	for(; i < n; i++) { sum0 += x[i] * y[i]; }
+
+	return (sum0 + sum1) + (sum2 + sum3);
+
+  // Bouml preserved body end 000E4491
+}
+
+//Index of the first maximum of a vector of n doubles (0 if n is 0). The maximum is found with independent partial maxima so that the loop is vectorized.
+ull Algorithms::ArgMax(const double* x, ull n)
+{
+  // Bouml preserved body begin 000E4511
+
+	if(n == 0) { return 0; }
+
+	double max0 = x[0]; double max1 = x[0]; double max2 = x[0]; double max3 = x[0];
+
+	ull i = 0;
+	for(; i + 4 <= n; i += 4)
+	{
+		max0 = (x[i] > max0) ? x[i] : max0;
+		max1 = (x[i + 1] > max1) ? x[i + 1] : max1;
+		max2 = (x[i + 2] > max2) ? x[i + 2] : max2;
+		max3 = (x[i + 3] > max3) ? x[i + 3] : max3;
+	}
+	for(; i < n; i++) { max0 = (x[i] > max0) ? x[i] : max0; }
+
+	double max = MAX(MAX(max0, max1), MAX(max2, max3));
+
+	// first index at which the maximum is reached
+	for(i = 0; i < n; i++) { if(x[i] == max) { return i; } }
+
+	return 0; // only if x contains NaNs
+
+  // Bouml preserved body end 000E4511
+}
+
+
 } // namespace lpm
@@ -15,6 +15,7 @@ AttackOperation::AttackOperation(string name) : Operation<TraceSet, AttackOutput
 	context = NULL;
 	applicationPDF = NULL;
 	lppmPDF = NULL;
+	lppmFlags = NoFlags;
 
   // Bouml preserved body end 00049491
 }
@@ -75,9 +76,13 @@ void AttackOperation::SetContext(const Context* newContext)
 {
   // Bouml preserved body begin 00052191
 
+	Context* previousContext = context;
+
 	context = const_cast<Context*>(newContext);
 	context->AddRef();
 
+	if(previousContext != NULL) { previousContext->Release(); } // the attack may be run successively with different contexts
+
   // Bouml preserved body end 00052191
 }
 
@@ -90,5 +95,19 @@ void AttackOperation::SetLPPMFlags(LPPMFlags flags)
   // Bouml preserved body end 000CF211
 }
 
+//! 
+//! \brief Returns whether the attack processes each user independently of the other users
+//!
+//! \return true or false, depending on whether the attack is per-user (the default implementation returns false)
+//!
+bool AttackOperation::IsPerUser() const 
+{
+  // Bouml preserved body begin 000E2A91
+
+	return false;
+
+  // Bouml preserved body end 000E2A91
+}
+
 
 } // namespace lpm
@@ -20,6 +20,12 @@ AttackOutput::AttackOutput()
 	genericRecPseudonyms = NULL;
 	genericRecPseudonymsSet = set<ull>();
 
+	genericRecDiagnostics = false;
+	genericRecMeanLocationRHat = 0.0;
+	genericRecMeanLocationESS = 0.0;
+	genericRecExposureRHat = 0.0;
+	genericRecExposureESS = 0.0;
+
   // Bouml preserved body end 00094411
 }
 
@@ -154,6 +160,35 @@ void AttackOutput::SetGenericReconstructionObjects(double* distribution, double*
   // Bouml preserved body end 000D0D91
 }
 
+bool AttackOutput::GetGenericReconstructionDiagnostics(double* meanLocationRHat, double* meanLocationESS, double* exposureRHat, double* exposureESS) const 
+{
+  // Bouml preserved body begin 000E5111
+
+	if(genericRecDiagnostics == false) { return false; }
+
+	if(meanLocationRHat != NULL) { *meanLocationRHat = genericRecMeanLocationRHat; }
+	if(meanLocationESS != NULL) { *meanLocationESS = genericRecMeanLocationESS; }
+	if(exposureRHat != NULL) { *exposureRHat = genericRecExposureRHat; }
+	if(exposureESS != NULL) { *exposureESS = genericRecExposureESS; }
+
+	return true;
+
+  // Bouml preserved body end 000E5111
+}
+
+void AttackOutput::SetGenericReconstructionDiagnostics(double meanLocationRHat, double meanLocationESS, double exposureRHat, double exposureESS) 
+{
+  // Bouml preserved body begin 000E5191
+
+	genericRecDiagnostics = true;
+	genericRecMeanLocationRHat = meanLocationRHat;
+	genericRecMeanLocationESS = meanLocationESS;
+	genericRecExposureRHat = exposureRHat;
+	genericRecExposureESS = exposureESS;
+
+  // Bouml preserved body end 000E5191
+}
+
 bool AttackOutput::GetObservedMatrix(ObservedEvent** matrix) const 
 {
   // Bouml preserved body begin 000DAD91
@@ -3,6 +3,11 @@
 #include "../include/MetricOperation.h"
 #include "../include/Context.h"
 #include "../include/File.h"
+#include "../include/Threads.h"
+#include "../include/SimilarityCandidateIndex.h"
+
+// rows of distances are read by blocks of at most that many bytes (see PredictabilityAnalysisOperation::Execute())
+#define PREDICTABILITY_DISTANCE_ROWS_MAX_BYTES (128 * 1024 * 1024)
 
 namespace lpm {
 
@@ -52,16 +57,28 @@ bool PredictabilityAnalysisOperation::Execute(const Context* input, File* output
 
 	ull numStates = numPeriods * numLoc;
 
-	// compute max distance
+	// the distances are read by blocks of rows (see MetricDistance::ComputeDistanceRow()): if all the rows fit in
+	// PREDICTABILITY_DISTANCE_ROWS_MAX_BYTES, there is a single block computed once, otherwise the blocks are recomputed for each user
+	ull blockNumRows = MAX(1, MIN(numLoc, PREDICTABILITY_DISTANCE_ROWS_MAX_BYTES / (numLoc * sizeof(double))));
+	ull numBlocks = (numLoc + blockNumRows - 1) / blockNumRows;
+
+	double* distances = (double*)Allocate(blockNumRows * numLoc * sizeof(double));
+	VERIFY(distances != NULL);
+
+	// max distance (this leaves the last block in distances)
 	double maxDistance = 0.0;
-	for(ull loc = minLoc; loc <= maxLoc; loc++)
+	for(ull block = 0; block < numBlocks; block++)
 	{
-		for(ull loc2 = minLoc; loc2 <= maxLoc; loc2++)
+		ull blockMinLoc = minLoc + block * blockNumRows;
+		ull blockMaxLoc = MIN(maxLoc, blockMinLoc + blockNumRows - 1);
+		for(ull loc = blockMinLoc; loc <= blockMaxLoc; loc++)
 		{
-			double distance = distanceFunction->ComputeDistance(loc, loc2);
-			if(distance > maxDistance)
+			double* distanceRow = &distances[GET_INDEX((loc - blockMinLoc), 0, numLoc)];
+			distanceFunction->ComputeDistanceRow(loc, distanceRow);
+
+			for(ull locIdx = 0; locIdx < numLoc; locIdx++)
 			{
-				maxDistance = distance;
+				if(distanceRow[locIdx] > maxDistance) { maxDistance = distanceRow[locIdx]; }
 			}
 		}
 	}
@@ -107,65 +124,64 @@ bool PredictabilityAnalysisOperation::Execute(const Context* input, File* output
 		}
 		VERIFY(abs(sum - 1) < EPSILON);
 
-		// zeroth-order
-		for(ull tp = minPeriod; tp <= maxPeriod; tp++)
+		for(ull block = 0; block < numBlocks; block++)
 		{
-			double proptp = tpInfo.propTPVector[(tp - minPeriod)];
+			ull blockMinLoc = minLoc + block * blockNumRows;
+			ull blockMaxLoc = MIN(maxLoc, blockMinLoc + blockNumRows - 1);
+			if(numBlocks > 1)
+			{
+				for(ull loc = blockMinLoc; loc <= blockMaxLoc; loc++) { distanceFunction->ComputeDistanceRow(loc, &distances[GET_INDEX((loc - blockMinLoc), 0, numLoc)]); }
+			}
 
-			for(ull loc = minLoc; loc <= maxLoc; loc++)
+			// zeroth-order
+			for(ull tp = minPeriod; tp <= maxPeriod; tp++)
 			{
-				ull idxr = GET_INDEX((tp - minPeriod), (loc - minLoc), numLoc);
-				for(ull loc2 = minLoc; loc2 <= maxLoc; loc2++)
+				double proptp = tpInfo.propTPVector[(tp - minPeriod)];
+
+				const double* tpConditional = &tpConditionalSteadyStateVector[GET_INDEX((tp - minPeriod), 0, numLoc)];
+
+				for(ull loc = blockMinLoc; loc <= blockMaxLoc; loc++)
 				{
-					double distance = distanceFunction->ComputeDistance(loc, loc2);
+					const double* distanceRow = &distances[GET_INDEX((loc - blockMinLoc), 0, numLoc)];
 
-					if(distance > 0.0)
-					{
-						ull idxp = GET_INDEX((tp - minPeriod), (loc2 - minLoc), numLoc);
-						epred0 += proptp * tpConditionalSteadyStateVector[idxr] * tpConditionalSteadyStateVector[idxp] * distance;
-					}
+					// expected distance between loc and the location predicted at tp
+					epred0 += proptp * tpConditional[(loc - minLoc)] * Algorithms::DotProduct(distanceRow, tpConditional, numLoc);
 				}
 			}
-		}
-		if(normalize == true) { epred0 = epred0 / maxDistance; }
 
-		// first-order
-		for(ull tp = minPeriod; tp <= maxPeriod; tp++)
-		{
-			for(ull loc = minLoc; loc <= maxLoc; loc++)
+			// first-order
+			for(ull tp = minPeriod; tp <= maxPeriod; tp++)
 			{
-				ull idx = GET_INDEX((tp - minPeriod), (loc - minLoc), numLoc);
-				double stationaryProb = adjustedSteadyStateVector[idx];
-
-				ull state1Idx = GET_INDEX((tp - minPeriod), (loc - minLoc), numLoc);
-
-				for(ull tp2 = minPeriod; tp2 <= maxPeriod; tp2++)
+				for(ull loc = minLoc; loc <= maxLoc; loc++)
 				{
-					if(tpInfo.propTransMatrix[GET_INDEX(tp - minPeriod, tp2 - minPeriod, numPeriods)] == 0) { continue; } // if the time period transition is not possible (has prob. 0), skip it.
+					ull idx = GET_INDEX((tp - minPeriod), (loc - minLoc), numLoc);
+					double stationaryProb = adjustedSteadyStateVector[idx];
 
-					double* transitionVector = NULL;
-					VERIFY(Algorithms::GetTransitionVectorOfSubChain(transitionMatrix, tp, loc, tp2, &transitionVector, false) == true);
+					ull state1Idx = GET_INDEX((tp - minPeriod), (loc - minLoc), numLoc);
 
-					for(ull loc2 = minLoc; loc2 <= maxLoc; loc2++)
+					for(ull tp2 = minPeriod; tp2 <= maxPeriod; tp2++)
 					{
-						ull state2Idx = GET_INDEX((tp2 - minPeriod), (loc2 - minLoc), numLoc);
-						ull fullChainIdx = GET_INDEX(state1Idx, state2Idx, numStates);
+						if(tpInfo.propTransMatrix[GET_INDEX(tp - minPeriod, tp2 - minPeriod, numPeriods)] == 0) { continue; } // if the time period transition is not possible (has prob. 0), skip it.
 
-						for(ull loc3 = minLoc; loc3 <= maxLoc; loc3++)
+						double* transitionVector = NULL;
+						VERIFY(Algorithms::GetTransitionVectorOfSubChain(transitionMatrix, tp, loc, tp2, &transitionVector, false) == true);
+
+						for(ull loc2 = blockMinLoc; loc2 <= blockMaxLoc; loc2++)
 						{
-							double distance = distanceFunction->ComputeDistance(loc2, loc3);
+							ull state2Idx = GET_INDEX((tp2 - minPeriod), (loc2 - minLoc), numLoc);
+							ull fullChainIdx = GET_INDEX(state1Idx, state2Idx, numStates);
 
-							if(distance > 0.0)
-							{
-								epred1 += stationaryProb * transitionMatrix[fullChainIdx] * transitionVector[(loc3 - minLoc)] * distance;
-							}
+							const double* distanceRow = &distances[GET_INDEX((loc2 - blockMinLoc), 0, numLoc)];
+
+							epred1 += stationaryProb * transitionMatrix[fullChainIdx] * Algorithms::DotProduct(distanceRow, transitionVector, numLoc);
 						}
-					}
 
-					Free(transitionVector);
+						Free(transitionVector);
+					}
 				}
 			}
 		}
+		if(normalize == true) { epred0 = epred0 / maxDistance; }
 
 		if(normalize == true) { epred1 = epred1 / maxDistance; }
 
@@ -178,6 +194,8 @@ bool PredictabilityAnalysisOperation::Execute(const Context* input, File* output
 		output->WriteLine(ss.str());
 	}
 
+	Free(distances);
+
 	return true;
 
   // Bouml preserved body end 000B9A11
@@ -320,12 +338,39 @@ bool RandomnessAnalysisOperation::Execute(const Context* input, File* output)
   // Bouml preserved body end 000B9991
 }
 
+// candidates of each user for the similarity operations (indices of the other users, in increasing order): its nearest neighbors in a
+// SimilarityCandidateIndex of the given vectors (numStates entries per user). If blockSize is not 0, the entries of each block (e.g. of each
+// time period) are sorted before being indexed, so that the candidates do not depend on the order of the locations.
+static void GetSimilarityCandidates(const double* vectors, ull Nusers, ull numStates, ull blockSize, ull candidatesPerUser, vector<vector<ull> >& candidates)
+{
+	SimilarityCandidateIndex index(numStates, RNG::GetInstance()->CreateStream().GetRandomUINT64());
+
+	vector<double> sortedVector = vector<double>(numStates);
+	for(ull userIndex = 0; userIndex < Nusers; userIndex++)
+	{
+		const double* vector = &vectors[GET_INDEX(userIndex, 0, numStates)];
+		if(blockSize != 0)
+		{
+			memcpy(&sortedVector[0], vector, numStates * sizeof(double));
+			for(ull start = 0; start < numStates; start += blockSize) { sort(sortedVector.begin() + start, sortedVector.begin() + MIN(start + blockSize, numStates)); }
+
+			vector = &sortedVector[0];
+		}
+
+		index.AddVector(vector);
+	}
+
+	index.GetNearestNeighbors(candidatesPerUser, candidates);
+	for(ull userIndex = 0; userIndex < Nusers; userIndex++) { sort(candidates[userIndex].begin(), candidates[userIndex].end()); }
+}
+
 AbsoluteSimilarityAnalysisOperation::AbsoluteSimilarityAnalysisOperation(string name, bool zerothOnly, MetricDistance* distance)
 					: ContextAnalysisOperation(name, distance)
 {
   // Bouml preserved body begin 000B9C91
 
 	 zerothOrderOnly = zerothOnly;
+	 candidateNeighbors = 0; // all the pairs
 
   // Bouml preserved body end 000B9C91
 }
@@ -367,75 +412,78 @@ bool AbsoluteSimilarityAnalysisOperation::Execute(const Context* input, File* ou
 
 	bool isDefaultDistance = (dynamic_cast<DefaultMetricDistance*>(distanceFunction) != NULL);
 
+	ull Nusers = profiles.size();
+
+	vector<ull> users = vector<ull>();
+	vector<double*> transitionMatrices = vector<double*>();
+	vector<double> adjustedSteadyStateVectors = vector<double>(Nusers * numStates);
 	pair_foreach_const(map<ull, UserProfile*>, profiles, iterProfiles)
 	{
-		ull user1 = iterProfiles->first;
-		UserProfile* profile1 = iterProfiles->second;
+		ull userIndex = users.size();
+		users.push_back(iterProfiles->first);
+		UserProfile* profile = iterProfiles->second;
 
-		double* steadyStateVector1 = NULL;
-		double* transitionMatrix1 = NULL;
+		double* steadyStateVector = NULL;
+		double* transitionMatrix = NULL;
 
-		VERIFY(profile1->GetSteadyStateVector(&steadyStateVector1) == true);
-		VERIFY(profile1->GetTransitionMatrix(&transitionMatrix1) == true);
+		VERIFY(profile->GetSteadyStateVector(&steadyStateVector) == true);
+		VERIFY(profile->GetTransitionMatrix(&transitionMatrix) == true);
+		transitionMatrices.push_back(transitionMatrix);
 
-		// compute the adjusted stationary distribution for user1 (called \twidle{\pi})
-		double* adjustedSteadyStateVector1 = (double*)Allocate(numPeriods * numLoc * sizeof(double));
-		double sum1 = 0.0;
+		// compute the adjusted stationary distribution of the user (called \twidle{\pi})
+		double* adjustedSteadyStateVector = &adjustedSteadyStateVectors[GET_INDEX(userIndex, 0, numStates)];
+		double sum = 0.0;
 		for(ull tp = minPeriod; tp <= maxPeriod; tp++)
 		{
 			double pitp = 0.0;
 			for(ull loc = minLoc; loc <= maxLoc; loc++)
 			{
 				ull idx = GET_INDEX((tp - minPeriod), (loc - minLoc), numLoc);
-				pitp += steadyStateVector1[idx];
+				pitp += steadyStateVector[idx];
 			}
 
 			for(ull loc = minLoc; loc <= maxLoc; loc++)
 			{
 				ull idx = GET_INDEX((tp - minPeriod), (loc - minLoc), numLoc);
-				double piltp = steadyStateVector1[idx];
-				adjustedSteadyStateVector1[idx] = piltp; // (tpInfo.propTPVector[(tp - minPeriod)] / pitp) * piltp;
-				sum1 += adjustedSteadyStateVector1[idx];
+				double piltp = steadyStateVector[idx];
+				adjustedSteadyStateVector[idx] = piltp; // (tpInfo.propTPVector[(tp - minPeriod)] / pitp) * piltp;
+				sum += adjustedSteadyStateVector[idx];
 			}
 		}
-		VERIFY(abs(sum1 - 1) < EPSILON);
-
+		VERIFY(abs(sum - 1) < EPSILON);
+	}
 
-		pair_foreach_const(map<ull, UserProfile*>, profiles, iterProfiles2)
+	// the followers of each leader: all the users, or the candidates of an index of the stationary distributions (see SetCandidateNeighbors())
+	vector<vector<ull> > followers = vector<vector<ull> >(Nusers);
+	if(candidateNeighbors == 0)
+	{
+		for(ull userIndex = 0; userIndex < Nusers; userIndex++)
 		{
-			ull user2 = iterProfiles2->first;
-			UserProfile* profile2 = iterProfiles2->second;
-
-			double* steadyStateVector2 = NULL;
-			double* transitionMatrix2 = NULL;
-
-			VERIFY(profile2->GetSteadyStateVector(&steadyStateVector2) == true);
-			VERIFY(profile2->GetTransitionMatrix(&transitionMatrix2) == true);
+			for(ull userIndex2 = 0; userIndex2 < Nusers; userIndex2++) { followers[userIndex].push_back(userIndex2); }
+		}
+	}
+	else if(Nusers != 0)
+	{
+		GetSimilarityCandidates(&adjustedSteadyStateVectors[0], Nusers, numStates, 0, candidateNeighbors * SIMILARITY_CANDIDATES_PER_NEIGHBOR, followers);
+	}
 
-			double sim0 = 0.0; double sim1 = 0.0;
+	for(ull userIndex1 = 0; userIndex1 < Nusers; userIndex1++)
+	{
+		ull user1 = users[userIndex1];
+		const double* adjustedSteadyStateVector1 = &adjustedSteadyStateVectors[GET_INDEX(userIndex1, 0, numStates)];
+		const double* transitionMatrix1 = transitionMatrices[userIndex1];
 
-			// compute the adjusted stationary distribution for user2 (called \twidle{\pi})
-			double* adjustedSteadyStateVector2 = (double*)Allocate(numPeriods * numLoc * sizeof(double));
-			double sum2 = 0.0;
-			for(ull tp = minPeriod; tp <= maxPeriod; tp++)
-			{
-				double pitp = 0.0;
-				for(ull loc = minLoc; loc <= maxLoc; loc++)
-				{
-					ull idx = GET_INDEX((tp - minPeriod), (loc - minLoc), numLoc);
-					pitp += steadyStateVector2[idx];
-				}
+		vector<pair<double, ull> > scores = vector<pair<double, ull> >(); // (-sim0, line) of the candidates
+		vector<string> lines = vector<string>();
 
-				for(ull loc = minLoc; loc <= maxLoc; loc++)
-				{
-					ull idx = GET_INDEX((tp - minPeriod), (loc - minLoc), numLoc);
-					double piltp = steadyStateVector2[idx];
-					adjustedSteadyStateVector2[idx] = piltp; // (tpInfo.propTPVector[(tp - minPeriod)] / pitp) * piltp;
-					sum2 += adjustedSteadyStateVector2[idx];
-				}
-			}
-			VERIFY(abs(sum2 - 1) < EPSILON);
+		foreach_const(vector<ull>, followers[userIndex1], iterFollowers)
+		{
+			ull userIndex2 = *iterFollowers;
+			ull user2 = users[userIndex2];
+			const double* adjustedSteadyStateVector2 = &adjustedSteadyStateVectors[GET_INDEX(userIndex2, 0, numStates)];
+			const double* transitionMatrix2 = transitionMatrices[userIndex2];
 
+			double sim0 = 0.0; double sim1 = 0.0;
 
 			if(isDefaultDistance == true) // for now, we implement the metric only for the default distance
 			{
@@ -487,16 +535,21 @@ bool AbsoluteSimilarityAnalysisOperation::Execute(const Context* input, File* ou
 				CODING_ERROR;
 			}
 
-			Free(adjustedSteadyStateVector2);
-
 			stringstream ss("");
 			ss << user1 << DEFAULT_FIELDS_DELIMITER << " " << user2 << ": "; // leader, follower
 			if(zerothOrderOnly == true)	{ ss << sim0; }
 			else { ss << sim0 << DEFAULT_FIELDS_DELIMITER << " " << sim1; }
-			output->WriteLine(ss.str());
+
+			if(candidateNeighbors == 0) { output->WriteLine(ss.str()); }
+			else { scores.push_back(pair<double, ull>(-sim0, lines.size())); lines.push_back(ss.str()); }
 		}
 
-		Free(adjustedSteadyStateVector1);
+		// sparse output: the most similar candidates
+		if(candidateNeighbors != 0)
+		{
+			sort(scores.begin(), scores.end());
+			for(ull k = 0; k < scores.size() && k < candidateNeighbors; k++) { output->WriteLine(lines[scores[k].second]); }
+		}
 	}
 
 	return true;
@@ -504,315 +557,523 @@ bool AbsoluteSimilarityAnalysisOperation::Execute(const Context* input, File* ou
   // Bouml preserved body end 000B9C11
 }
 
+//!
+//! \brief Sets the number of most similar followers output for each leader
+//!
+//! By default (0), the similarity of every (leader, follower) pair is computed and output.
+//! Otherwise, the users are indexed by a SimilarityCandidateIndex of their stationary distributions, and the similarity is only computed
+//! for the candidate pairs of the index (SIMILARITY_CANDIDATES_PER_NEIGHBOR times \a neighbors candidates per user, instead of all the users).
+//! Only the \a neighbors most similar followers of each leader (by zeroth-order similarity) are then output (in decreasing order of similarity).
+//!
+//! \param[in] neighbors 	ull, the number of followers output per leader (0 for all the pairs).
+//!
+//! \return nothing
+//!
+void AbsoluteSimilarityAnalysisOperation::SetCandidateNeighbors(ull neighbors) 
+{
+  // Bouml preserved body begin 000E4F11
+
+	candidateNeighbors = neighbors;
+
+  // Bouml preserved body end 000E4F11
+}
+
 HiddenSemanticsSimilarityAnalysisOperation::HiddenSemanticsSimilarityAnalysisOperation(string name, bool zerothOnly, MetricDistance* distance)
 			: ContextAnalysisOperation(name, distance)
 {
   // Bouml preserved body begin 000C1D91
 
 	SetLimits(); // default values
+	SetApproximation(0); // exact assignments
+	SetCandidateNeighbors(0); // all the pairs
 
 	zerothOrderOnly = zerothOnly;
 
   // Bouml preserved body end 000C1D91
 }
 
-//! 
-//! \brief Execute the operation
-//!
-//! Pure virtual method which executes the operation. 
-//!
-//! \tparam[[in] input 	InputType* to the input object of the operation.
-//! \tparam[[in,out] output 	OutputType* to the output object of the operation.
-//!
-//! \return true if the operation is successful, false otherwise
-//!
-bool HiddenSemanticsSimilarityAnalysisOperation::Execute(const Context* input, File* output) 
+// data of one user shared by all the pairs of HiddenSemanticsSimilarityAnalysisOperation::Execute()
+struct HiddenSemanticsUserData
 {
-  // Bouml preserved body begin 000C1D11
+	const double* steadyStateVector;
+	const double* transitionMatrix;
 
-	VERIFY(input != NULL && output != NULL && output->IsGood());
+	vector<double> logSteadyStateVector; // log2 of the steady-state vector (log2(min(p, q)) = min(log2(p), log2(q)))
+	vector<double> minLogSteadyState; // per time period
+	vector<double> maxSteadyState; // per time period
 
-	Parameters* params = Parameters::GetInstance();
+	vector<double> subChainSums; // subChainSums[GET_INDEX_3D(tp, loc, tp2, numLoc, numPeriods)]: sum of the transitions from (tp, loc) to tp2
+};
 
-	// get location parameters
-	ull minLoc = 0; ull maxLoc = 0;
-	VERIFY(params->GetLocationstampsRange(&minLoc, &maxLoc) == true);
-	ull numLoc = maxLoc - minLoc + 1;
+// computes the similarities of the pairs (first, second) and (second, first) for the second users of the given first user,
+// see HiddenSemanticsSimilarityAnalysisOperation::Execute()
+class HiddenSemanticsSimilarityTask : public ParallelTask
+{
+  public:
+	// the unordered pairs of the first user of index i are pairOffsets[i], ..., pairOffsets[i + 1] - 1, and the second user of the pair
+	// of index p is secondUserIndices[p] (or, if secondUserIndices is NULL, the pairs of the first user are those with all the next users)
+	const ull* pairOffsets;
+	const ull* secondUserIndices;
 
-	// get time period parameters
-	ull numPeriods = 0; TPInfo tpInfo;
-	VERIFY(params->GetTimePeriodInfo(&numPeriods, &tpInfo) == true);
-	ull minPeriod = tpInfo.minPeriod;
-	ull maxPeriod = tpInfo.maxPeriod;
+	ull numLoc;
+	ull numPeriods;
+	const TPInfo* tpInfo;
 
-	ull numStates = numPeriods * numLoc;
+	bool zerothOrderOnly;
+	ull maxIterations;
+	ull maxSeconds;
 
-	RNG* rng = RNG::GetInstance();
+	ull approximationIterations; // 0 for the exact assignments
+	double approximationRegularization;
 
+	const HiddenSemanticsUserData* usersData;
 
-	map<ull, UserProfile*> profiles = map<ull, UserProfile*>();
-	VERIFY(input->GetProfiles(profiles) == true);
+	uint64 seed; // the chains of the pair of index p draw from the stream seeded with seed + p
 
-	bool isDefaultDistance = (dynamic_cast<DefaultMetricDistance*>(distanceFunction) != NULL);
+	// outputs, per unordered pair (firstUserIndex < secondUserIndex)
+	double* sim0s; // leader: first user, follower: second user
+	double* reverseSim0s; // leader: second user, follower: first user (same value, summed in the order of the leader)
+	double* sim1s; // leader: first user, follower: second user
+	double* reverseSim1s; // leader: second user, follower: first user
 
-	pair_foreach_const(map<ull, UserProfile*>, profiles, iterProfiles)
+	// per-thread buffers
+	ll* costMatrices; // numLoc * numLoc per thread (exact assignments)
+	double* weightMatrices; // numLoc * numLoc per thread (approximate assignments)
+	ll* sigmas; // numPeriods * numLoc per thread
+	ll* reverseSigmas; // numPeriods * numLoc per thread
+	ll* chainSigmas; // numLoc per thread
+
+	virtual void Run(ull firstUserIndex, ull thread)
 	{
-		ull user1 = iterProfiles->first;
-		UserProfile* profile1 = iterProfiles->second;
+		const HiddenSemanticsUserData& data1 = usersData[firstUserIndex];
 
-		double* steadyStateVector1 = NULL;
-		double* transitionMatrix1 = NULL;
+		for(ull pairIndex = pairOffsets[firstUserIndex]; pairIndex < pairOffsets[firstUserIndex + 1]; pairIndex++)
+		{
+			ull secondUserIndex = (secondUserIndices != NULL) ? secondUserIndices[pairIndex] : firstUserIndex + 1 + (pairIndex - pairOffsets[firstUserIndex]);
+			const HiddenSemanticsUserData& data2 = usersData[secondUserIndex];
 
-		VERIFY(profile1->GetSteadyStateVector(&steadyStateVector1) == true);
-		VERIFY(profile1->GetTransitionMatrix(&transitionMatrix1) == true);
+			ll* sigma = &sigmas[thread * numPeriods * numLoc];
+			ll* reverseSigma = &reverseSigmas[thread * numPeriods * numLoc];
+			ll* chainSigma = &chainSigmas[thread * numLoc];
 
+			// zeroth-order (symmetric: the best assignment of (second, first) is the inverse of that of (first, second), only the summation order differs)
+			sim0s[pairIndex] = ComputeZerothOrder(data1, data2, thread, sigma);
 
-		pair_foreach_const(map<ull, UserProfile*>, profiles, iterProfiles2)
-		{
-			ull user2 = iterProfiles2->first;
-			UserProfile* profile2 = iterProfiles2->second;
+			for(ull tpIdx = 0; tpIdx < numPeriods; tpIdx++)
+			{
+				for(ull locIdx = 0; locIdx < numLoc; locIdx++) { reverseSigma[GET_INDEX(tpIdx, sigma[GET_INDEX(tpIdx, locIdx, numLoc)], numLoc)] = locIdx; }
+			}
 
-			double* steadyStateVector2 = NULL;
-			double* transitionMatrix2 = NULL;
+			reverseSim0s[pairIndex] = ComputeAssignedOverlap(data2, data1, reverseSigma);
 
-			VERIFY(profile2->GetSteadyStateVector(&steadyStateVector2) == true);
-			VERIFY(profile2->GetTransitionMatrix(&transitionMatrix2) == true);
+			if(zerothOrderOnly == false) // first-order (not symmetric)
+			{
+				RNGStream stream(seed + pairIndex);
 
-			double sim0 = 0.0; double sim1 = 0.0;
+				sim1s[pairIndex] = ComputeFirstOrder(data1, data2, sigma, chainSigma, &stream);
+				reverseSim1s[pairIndex] = ComputeFirstOrder(data2, data1, reverseSigma, chainSigma, &stream);
+			}
+		}
+	}
 
-			if(isDefaultDistance == true) // for now, we implement the metric only for the default distance
-			{
+  private:
+	// best assignment of the locations of user 1 to those of user 2 (sigma[GET_INDEX(tpIdx, locIdx, numLoc)]) for each time period, returns the zeroth-order similarity
+	double ComputeZerothOrder(const HiddenSemanticsUserData& data1, const HiddenSemanticsUserData& data2, ull thread, ll* sigma) const
+	{
+		double sim0 = 0.0; double tmpSim0 = 0.0;
+		for(ull tpIdx = 0; tpIdx < numPeriods; tpIdx++)
+		{
+			double maxOverlapProb = MAX(0.0, MIN(data1.maxSteadyState[tpIdx], data2.maxSteadyState[tpIdx]));
 
-//#define LOG_SEM_SIM 1
-#ifdef LOG_SEM_SIM
-				{
-					Log::GetInstance()->Append("#########################################\n");
-					stringstream info("");
-					info << "Computation for the pair: " <<  user1 << ", " << user2;
-					Log::GetInstance()->Append(info.str());
-				}
-#endif
+			const double* logs1 = &data1.logSteadyStateVector[GET_INDEX(tpIdx, 0, numLoc)];
+			const double* logs2 = &data2.logSteadyStateVector[GET_INDEX(tpIdx, 0, numLoc)];
 
-				if(user1 == user2) { sim0 = 1.0; sim1 = 1.0; }
-				else
+			ll* tpSigma = &sigma[GET_INDEX(tpIdx, 0, numLoc)];
+			if(approximationIterations != 0)
+			{
+				double* weightMatrix = &weightMatrices[thread * numLoc * numLoc];
+				for(ull locIdx = 0; locIdx < numLoc; locIdx++)
 				{
-					ull sigmasArrayByteSize = numPeriods * sizeof(ll*);
-					ll** sigmasArray = (ll**)Allocate(sigmasArrayByteSize);
-					VERIFY(sigmasArray != NULL); memset(sigmasArray, 0, sigmasArrayByteSize);
+					double* weightRow = &weightMatrix[GET_INDEX(locIdx, 0, numLoc)];
+					for(ull locIdx2 = 0; locIdx2 < numLoc; locIdx2++) { weightRow[locIdx2] = MIN(logs1[locIdx], logs2[locIdx2]); }
+				}
 
-					// zeroth-order
-					sim0 = 0.0;
-					for(ull tp = minPeriod; tp <= maxPeriod; tp++)
-					{
-						// Compute the best sigma
-						ull sigmaByteSize = numLoc * sizeof(ll);
-						ll* sigma = (ll*)Allocate(sigmaByteSize);
-						VERIFY(sigma != NULL); memset(sigma, 0, sigmaByteSize);
+				Algorithms::ApproximateMaximumWeightAssignment(weightMatrix, numLoc, tpSigma, approximationRegularization, approximationIterations);
+			}
+			else
+			{
+				double maxVal = MAX(0.0, -MIN(data1.minLogSteadyState[tpIdx], data2.minLogSteadyState[tpIdx])); // max of -log2(w)
 
-						ull wdByteSize = numLoc * numLoc * sizeof(double);
-						double* wd = (double*)Allocate(wdByteSize);
-						VERIFY(wd != NULL); memset(wd, 0, wdByteSize);
+				// make the probability an integer: multiply by 1/minVal
+				const ll bigNumber = (maxVal == 0.0) ? -1 : (ll)(-((double)(1000000/2.0)/maxVal) + 10);
 
-						// fill in the weight matrix
-						double maxVal = 0.0; double maxOverlapProb = 0.0;
-						for(ull loc = minLoc; loc <= maxLoc; loc++)
-						{
-							//stringstream info(""); info.precision(5);
+				ll* costMatrix = &costMatrices[thread * numLoc * numLoc];
+				for(ull locIdx = 0; locIdx < numLoc; locIdx++)
+				{
+					ll* costRow = &costMatrix[GET_INDEX(locIdx, 0, numLoc)];
+					for(ull locIdx2 = 0; locIdx2 < numLoc; locIdx2++)
+					{
+						double w = MIN(logs1[locIdx], logs2[locIdx2]);
 
-							ull idx1 = GET_INDEX((tp - minPeriod), (loc - minLoc), numLoc);
-							for(ull loc2 = minLoc; loc2 <= maxLoc; loc2++)
-							{
-								ull idx2 = GET_INDEX((tp - minPeriod), (loc2 - minLoc), numLoc);
+						// Note: we are transforming the maximization problem (maximum weight assignment) in a minimization problem (minimum cost assignment)
+						costRow[locIdx2] = w > 0 ? 0 : (ll)(w * bigNumber);
+					}
+				}
 
-								ull wIdx = GET_INDEX((loc - minLoc), (loc2 - minLoc), numLoc);
-								double w = min(steadyStateVector1[idx1], steadyStateVector2[idx2]);
+				Algorithms::MinimumCostAssignment(costMatrix, numLoc, tpSigma); // Hungarian (munkres) algorithm to find sigma
+			}
 
-								if(w > maxOverlapProb) { maxOverlapProb = w; }
+			// finally compute the similarity value according to sigma
+			for(ull locIdx = 0; locIdx < numLoc; locIdx++)
+			{
+				VERIFY(tpSigma[locIdx] >= 0 && tpSigma[locIdx] < (ll)numLoc);
 
-								//info << w << (loc2 < maxLoc ? ", " : "");
+				sim0 += MIN(data1.steadyStateVector[GET_INDEX(tpIdx, locIdx, numLoc)], data2.steadyStateVector[GET_INDEX(tpIdx, tpSigma[locIdx], numLoc)]);
+				tmpSim0 += sim0;
+			}
 
-								w = log2(w);
-								wd[wIdx] = w;
+			VERIFY(approximationIterations != 0 || maxOverlapProb <= tmpSim0);
+		}
 
-								double mw = -w;
-								if(mw > maxVal) { maxVal = mw; } // keep track of max
-							}
+		return sim0;
+	}
 
-							//Log::GetInstance()->Append(info.str());
-						}
+	// zeroth-order similarity of user 1 (leader) and user 2 (follower) according to the given assignment (summed in the order of the locations of user 1)
+	double ComputeAssignedOverlap(const HiddenSemanticsUserData& data1, const HiddenSemanticsUserData& data2, const ll* sigma) const
+	{
+		double sim0 = 0.0;
+		for(ull tpIdx = 0; tpIdx < numPeriods; tpIdx++)
+		{
+			for(ull locIdx = 0; locIdx < numLoc; locIdx++)
+			{
+				sim0 += MIN(data1.steadyStateVector[GET_INDEX(tpIdx, locIdx, numLoc)], data2.steadyStateVector[GET_INDEX(tpIdx, sigma[GET_INDEX(tpIdx, locIdx, numLoc)], numLoc)]);
+			}
+		}
 
-						ull costMatrixByteSize = numLoc * numLoc * sizeof(ll);
-						ll* costMatrix = (ll*)Allocate(costMatrixByteSize);
-						VERIFY(costMatrix != NULL); memset(costMatrix, 0, costMatrixByteSize);
+		return sim0;
+	}
 
-						//Log::GetInstance()->Append("***********************");
+	// first-order similarity of user 1 (leader) and user 2 (follower): Metropolis-Hastings over the assignments, starting from sigma
+	double ComputeFirstOrder(const HiddenSemanticsUserData& data1, const HiddenSemanticsUserData& data2, const ll* sigma, ll* newSigma, RNGStream* stream) const
+	{
+		ull numStates = numPeriods * numLoc;
 
-						// make the probability an integer: multiply by 1/minVal
-						const ll bigNumber = (maxVal == 0.0) ? -1 : (ll)(-((double)(1000000/2.0)/maxVal) + 10);
-						for(ull loc = minLoc; loc <= maxLoc; loc++)
-						{
-							//stringstream info(""); info.precision(5);
+		double sim1 = 0.0;
+		for(ull tpIdx = 0; tpIdx < numPeriods; tpIdx++)
+		{
+			for(ull tpIdx2 = 0; tpIdx2 < numPeriods; tpIdx2++)
+			{
+				if(tpInfo->propTransMatrix[GET_INDEX(tpIdx, tpIdx2, numPeriods)] == 0) { continue; } // if the time period transition is not possible (has prob. 0), skip it.
 
-							for(ull loc2 = minLoc; loc2 <= maxLoc; loc2++)
-							{
-								ull wIdx = GET_INDEX((loc - minLoc), (loc2 - minLoc), numLoc);
+				memcpy(newSigma, &sigma[GET_INDEX(tpIdx, 0, numLoc)], numLoc * sizeof(ll)); // copy sigma
 
-								// Note: we are transforming the maximization problem (maximum weight assignment) in a minimization problem (minimum cost assignment)
-								ll c = wd[wIdx] > 0 ? 0 : (ll)(wd[wIdx]*bigNumber);
-								costMatrix[wIdx] = c;
+				double bestScore = 0.0;
+				double oldScore = 0.0;
 
-								//info << c << (loc2 < maxLoc ? ", " : "");
-							}
+				ull step = 1; ull startTime = time(NULL);
+				while(true)
+				{
+					if((maxIterations != 0 && step >= maxIterations) || (maxSeconds != 0 && (time(NULL) - startTime) >= maxSeconds)) { break; }
 
-							//Log::GetInstance()->Append(info.str());
-						}
-						Free(wd); wd = NULL; // free wd
-						//Log::GetInstance()->Append("------------");
+					ull secondPos = 0; ull firstPos = 0;
+					if(step > 1) // at step 1 we don't propose sample, we just compute the similarity score
+					{
+						if(oldScore > bestScore) { bestScore = oldScore; }
 
-						Algorithms::MinimumCostAssignment(costMatrix, numLoc, sigma); // Hungarian (munkres) algorithm to find sigma
-						for(ull loc = minLoc; loc <= maxLoc; loc++)
+						// propose new sample
+						firstPos = stream->GetUniformRandomULLBetween(0, numLoc - 1);
+						do
 						{
-							stringstream info("");
-							VERIFY(sigma[loc - minLoc] >= 0 && sigma[loc - minLoc] < (ll)numLoc);
-#ifdef LOG_SEM_SIM
-							info << "Assignment: loc u1 -> loc u2: " << loc << " -> " << sigma[loc - minLoc] + minLoc;
-							Log::GetInstance()->Append(info.str());
-#endif
+							secondPos = stream->GetUniformRandomULLBetween(0, numLoc - 1);
 						}
+						while(firstPos == secondPos);
 
+						ll tmp = newSigma[firstPos];
+						newSigma[firstPos] = newSigma[secondPos];
+						newSigma[secondPos] = tmp;
+					}
 
-						Free(costMatrix); costMatrix = NULL; // free costMatrix
+					// compute similarity score
+					double newScore = 0.0;
+					for(ull locIdx = 0; locIdx < numLoc; locIdx++)
+					{
+						ull state1Idx = GET_INDEX(tpIdx, locIdx, numLoc);
+						double stationaryProb = data1.steadyStateVector[state1Idx]; // prob. of user1 (leader) being there
 
-						// finally compute the similarity value according to sigma
-						double tmpSim0 = 0.0;
-						for(ull loc = minLoc; loc <= maxLoc; loc++)
+						// rows of the transitions to tp2 (normalized on the fly, see Algorithms::GetTransitionVectorOfSubChain())
+						double transitionToTp2Prob = data1.subChainSums[GET_INDEX_3D(tpIdx, locIdx, tpIdx2, numLoc, numPeriods)];
+						const double* transitions1 = &data1.transitionMatrix[GET_INDEX(state1Idx, GET_INDEX(tpIdx2, 0, numLoc), numStates)];
+
+						ull semanticLocIdx = newSigma[locIdx];
+						ull semanticState1Idx = GET_INDEX(tpIdx, semanticLocIdx, numLoc);
+						double semanticTransitionToTp2Prob = data2.subChainSums[GET_INDEX_3D(tpIdx, semanticLocIdx, tpIdx2, numLoc, numPeriods)];
+						const double* transitions2 = &data2.transitionMatrix[GET_INDEX(semanticState1Idx, GET_INDEX(tpIdx2, 0, numLoc), numStates)];
+
+						for(ull locIdx2 = 0; locIdx2 < numLoc; locIdx2++)
 						{
-							ull idx1 = GET_INDEX((tp - minPeriod), (loc - minLoc), numLoc);
-							ull idx2 = GET_INDEX((tp - minPeriod), sigma[(loc - minLoc)], numLoc);
+							double subTransition1 = transitions1[locIdx2] / transitionToTp2Prob;
+							double subTransition2 = transitions2[newSigma[locIdx2]] / semanticTransitionToTp2Prob;
 
-							sim0 += min(steadyStateVector1[idx1], steadyStateVector2[idx2]);
-							tmpSim0 += sim0;
+							newScore += stationaryProb * transitionToTp2Prob * MIN(subTransition1, subTransition2);
 						}
-
-						VERIFY(maxOverlapProb <= tmpSim0);
-						sigmasArray[tp - minPeriod] = sigma; // save sigma;
 					}
 
-					if(zerothOrderOnly == false)
+					// decide on sample
+					bool accept = step == 1 ? true : (stream->GetUniformRandomDouble() < newScore / oldScore);
+
+					if(accept == false) // reject -> keep previous sample
 					{
-						// first-order
-						sim1 = 0.0;
-						for(ull tp = minPeriod; tp <= maxPeriod; tp++)
-						{
-							// get the proper sigma (starting sample for M-H)
-							ll* sigma = sigmasArray[tp - minPeriod];
+						ll tmp = newSigma[firstPos];
+						newSigma[firstPos] = newSigma[secondPos];
+						newSigma[secondPos] = tmp;
+					}
+					else { oldScore = newScore; }
 
-							for(ull tp2 = minPeriod; tp2 <= maxPeriod; tp2++)
-							{
-								if(tpInfo.propTransMatrix[GET_INDEX(tp - minPeriod, tp2 - minPeriod, numPeriods)] == 0) { continue; } // if the time period transition is not possible (has prob. 0), skip it.
+					step++;
+				}
+
+				sim1 += bestScore;
+			}
+		}
+
+		return sim1;
+	}
+};
 
-								ull sigmaByteSize = numLoc * sizeof(ll);
-								ll* newSigma = (ll*)Allocate(sigmaByteSize);
-								VERIFY(newSigma != NULL);
-								memcpy(newSigma, sigma, sigmaByteSize); // copy sigma
+//! 
+//! \brief Execute the operation
+//!
+//! Pure virtual method which executes the operation. 
+//!
+//! \tparam[[in] input 	InputType* to the input object of the operation.
+//! \tparam[[in,out] output 	OutputType* to the output object of the operation.
+//!
+//! \return true if the operation is successful, false otherwise
+//!
+bool HiddenSemanticsSimilarityAnalysisOperation::Execute(const Context* input, File* output) 
+{
+  // Bouml preserved body begin 000C1D11
 
-								for(ull loc = minLoc; loc <= maxLoc; loc++)	{ newSigma[loc - minLoc] += minLoc; } // to be consistent
+	VERIFY(input != NULL && output != NULL && output->IsGood());
 
-								double bestScore = 0.0;
-								double oldScore = 0.0;
+	Parameters* params = Parameters::GetInstance();
 
-								ull step = 1; ull startTime = time(NULL);
-								while(true)
-								{
-									if((maxIterations != 0 && step >= maxIterations) || (maxSeconds != 0 && (time(NULL) - startTime) >= maxSeconds)) { break; }
-
-									ull secondPos = 0; ull firstPos = 0;
-									if(step > 1) // at step 1 we don't propose sample, we just compute the similarity score
-									{
-										if(oldScore > bestScore) { bestScore = oldScore; }
-
-										// propose new sample
-										firstPos = rng->GetUniformRandomULLBetween(0, numLoc - 1);
-										do
-										{
-											secondPos = rng->GetUniformRandomULLBetween(0, numLoc - 1);
-										}
-										while(firstPos == secondPos);
-										VERIFY(firstPos != secondPos);
-
-										ll tmp = newSigma[firstPos];
-										newSigma[firstPos] = newSigma[secondPos];
-										newSigma[secondPos] = tmp;
-									}
-
-									// compute similarity score
-									double newScore = 0.0;
-									for(ull loc = minLoc; loc <= maxLoc; loc++)
-									{
-										ull state1Idx = GET_INDEX((tp - minPeriod), (loc - minLoc), numLoc);
-
-										ull idxSS = GET_INDEX((tp - minPeriod), (loc - minLoc), numLoc);
-										double stationaryProb = steadyStateVector1[idxSS]; // prob. of user1 (leader) being there
-
-										double transitionToTp2Prob = 0.0;
-										for(ull loc2 = minLoc; loc2 <= maxLoc; loc2++)
-										{
-											ull state2Idx = GET_INDEX((tp2 - minPeriod), (loc2 - minLoc), numLoc);
-											ull idxMat = GET_INDEX(state1Idx, state2Idx, numStates);
-											transitionToTp2Prob += transitionMatrix1[idxMat];
-										}
-
-										double* subTransVector1 = NULL;
-										VERIFY(Algorithms::GetTransitionVectorOfSubChain(transitionMatrix1, tp, loc, tp2, &subTransVector1) == true);
-
-										ull semanticLoc = newSigma[loc - minLoc];
-
-										double* subTransVector2 = NULL;
-										VERIFY(Algorithms::GetTransitionVectorOfSubChain(transitionMatrix2, tp, semanticLoc, tp2, &subTransVector2) == true);
-
-										for(ull loc2 = minLoc; loc2 <= maxLoc; loc2++)
-										{
-											ull semanticLoc2 = newSigma[loc2 - minLoc];
-											newScore += stationaryProb * transitionToTp2Prob *
-														min(subTransVector1[loc2 - minLoc], subTransVector2[semanticLoc2 - minLoc]);
-										}
-
-										Free(subTransVector1);
-										Free(subTransVector2);
-									}
-
-									// decide on sample
-									bool accept = step == 1 ? true : (rng->GetUniformRandomDouble() < newScore / oldScore);
-
-									if(accept == false) // reject -> keep previous sample
-									{
-										ll tmp = newSigma[firstPos];
-										newSigma[firstPos] = newSigma[secondPos];
-										newSigma[secondPos] = tmp;
-									}
-									else { oldScore = newScore; }
-
-									step++;
-								}
-								Free(newSigma); newSigma = NULL;
+	// get location parameters
+	ull minLoc = 0; ull maxLoc = 0;
+	VERIFY(params->GetLocationstampsRange(&minLoc, &maxLoc) == true);
+	ull numLoc = maxLoc - minLoc + 1;
 
-								sim1 += bestScore;
-							}
-						}
+	// get time period parameters
+	ull numPeriods = 0; TPInfo tpInfo;
+	VERIFY(params->GetTimePeriodInfo(&numPeriods, &tpInfo) == true);
+
+	ull numStates = numPeriods * numLoc;
+
+	map<ull, UserProfile*> profiles = map<ull, UserProfile*>();
+	VERIFY(input->GetProfiles(profiles) == true);
+
+	// for now, we implement the metric only for the default distance (otherwise, all the similarities are 0)
+	bool isDefaultDistance = (dynamic_cast<DefaultMetricDistance*>(distanceFunction) != NULL);
+
+	ull Nusers = profiles.size();
+	ull numThreads = Threads::GetEffectiveThreadsCount(Nusers);
+
+	// precompute what each pair needs from the profiles of its users
+	vector<ull> users = vector<ull>();
+	vector<HiddenSemanticsUserData> usersData = vector<HiddenSemanticsUserData>(Nusers);
+	pair_foreach_const(map<ull, UserProfile*>, profiles, iterProfiles)
+	{
+		HiddenSemanticsUserData& data = usersData[users.size()];
+		users.push_back(iterProfiles->first);
+
+		double* steadyStateVector = NULL;
+		double* transitionMatrix = NULL;
+		VERIFY(iterProfiles->second->GetSteadyStateVector(&steadyStateVector) == true);
+		VERIFY(iterProfiles->second->GetTransitionMatrix(&transitionMatrix) == true);
+
+		data.steadyStateVector = steadyStateVector;
+		data.transitionMatrix = transitionMatrix;
+
+		data.logSteadyStateVector = vector<double>(numStates);
+		data.minLogSteadyState = vector<double>(numPeriods);
+		data.maxSteadyState = vector<double>(numPeriods);
+		for(ull tpIdx = 0; tpIdx < numPeriods; tpIdx++)
+		{
+			double minLog = 0.0; double maxProb = 0.0;
+			for(ull locIdx = 0; locIdx < numLoc; locIdx++)
+			{
+				ull idx = GET_INDEX(tpIdx, locIdx, numLoc);
+				double logProb = log2(steadyStateVector[idx]);
+				data.logSteadyStateVector[idx] = logProb;
+
+				if(locIdx == 0 || logProb < minLog) { minLog = logProb; }
+				if(locIdx == 0 || steadyStateVector[idx] > maxProb) { maxProb = steadyStateVector[idx]; }
+			}
+			data.minLogSteadyState[tpIdx] = minLog;
+			data.maxSteadyState[tpIdx] = maxProb;
+		}
+
+		if(zerothOrderOnly == false)
+		{
+			data.subChainSums = vector<double>(numStates * numPeriods);
+			for(ull tpIdx = 0; tpIdx < numPeriods; tpIdx++)
+			{
+				for(ull tpIdx2 = 0; tpIdx2 < numPeriods; tpIdx2++)
+				{
+					if(tpInfo.propTransMatrix[GET_INDEX(tpIdx, tpIdx2, numPeriods)] == 0) { continue; } // not used
+
+					for(ull locIdx = 0; locIdx < numLoc; locIdx++)
+					{
+						const double* transitions = &transitionMatrix[GET_INDEX(GET_INDEX(tpIdx, locIdx, numLoc), GET_INDEX(tpIdx2, 0, numLoc), numStates)];
+
+						double sum = 0.0;
+						for(ull locIdx2 = 0; locIdx2 < numLoc; locIdx2++) { sum += transitions[locIdx2]; }
+						VERIFY(sum != 0.0); // (see Algorithms::GetTransitionVectorOfSubChain())
+
+						data.subChainSums[GET_INDEX_3D(tpIdx, locIdx, tpIdx2, numLoc, numPeriods)] = sum;
 					}
-					for(ull tpIdx = 0; tpIdx < numPeriods; tpIdx++)	{ Free(sigmasArray[tpIdx]); } Free(sigmasArray); // cleanup
 				}
 			}
-			else
+		}
+	}
+
+	// the unordered pairs: all of them, or the candidate pairs of an index of the stationary distributions (see SetCandidateNeighbors())
+	vector<ull> pairOffsets = vector<ull>(Nusers + 1, 0);
+	vector<pair<ull, ull> > candidatePairs = vector<pair<ull, ull> >();
+	vector<ull> secondUserIndices = vector<ull>();
+	if(candidateNeighbors == 0)
+	{
+		for(ull userIndex = 0; userIndex < Nusers; userIndex++) { pairOffsets[userIndex + 1] = pairOffsets[userIndex] + (Nusers - userIndex - 1); }
+	}
+	else if(Nusers != 0)
+	{
+		vector<double> steadyStateVectors = vector<double>(Nusers * numStates);
+		for(ull userIndex = 0; userIndex < Nusers; userIndex++)
+		{
+			memcpy(&steadyStateVectors[GET_INDEX(userIndex, 0, numStates)], usersData[userIndex].steadyStateVector, numStates * sizeof(double));
+		}
+
+		vector<vector<ull> > candidates = vector<vector<ull> >();
+		GetSimilarityCandidates(&steadyStateVectors[0], Nusers, numStates, numLoc, candidateNeighbors * SIMILARITY_CANDIDATES_PER_NEIGHBOR, candidates);
+
+		for(ull userIndex = 0; userIndex < Nusers; userIndex++)
+		{
+			foreach_const(vector<ull>, candidates[userIndex], iterCandidates)
 			{
-				CODING_ERROR;
+				candidatePairs.push_back(pair<ull, ull>(MIN(userIndex, *iterCandidates), MAX(userIndex, *iterCandidates)));
 			}
+		}
+		sort(candidatePairs.begin(), candidatePairs.end());
+		candidatePairs.erase(unique(candidatePairs.begin(), candidatePairs.end()), candidatePairs.end());
 
-			stringstream ss("");
-			ss << user1 << DEFAULT_FIELDS_DELIMITER << " " << user2 << ": "; // leader, follower
-			if(zerothOrderOnly == true)	{ ss << sim0; }
-			else { ss << sim0 << DEFAULT_FIELDS_DELIMITER << " " << sim1; }
-			output->WriteLine(ss.str());
+		for(ull pairIndex = 0; pairIndex < candidatePairs.size(); pairIndex++)
+		{
+			pairOffsets[candidatePairs[pairIndex].first + 1]++;
+			secondUserIndices.push_back(candidatePairs[pairIndex].second);
+		}
+		for(ull userIndex = 0; userIndex < Nusers; userIndex++) { pairOffsets[userIndex + 1] += pairOffsets[userIndex]; }
+	}
+
+	// the similarities are computed once per unordered pair (both directions of the first-order similarity share the assignments of the zeroth-order one)
+	ull numPairs = pairOffsets[Nusers];
+	vector<double> sim0s = vector<double>(numPairs, 0.0);
+	vector<double> reverseSim0s = vector<double>(numPairs, 0.0);
+	vector<double> sim1s = vector<double>(numPairs, 0.0);
+	vector<double> reverseSim1s = vector<double>(numPairs, 0.0);
+
+	if(numPairs != 0 && isDefaultDistance == true)
+	{
+		vector<ll> costMatrices = vector<ll>(approximationIterations == 0 ? numThreads * numLoc * numLoc : 0);
+		vector<double> weightMatrices = vector<double>(approximationIterations != 0 ? numThreads * numLoc * numLoc : 0);
+		vector<ll> sigmas = vector<ll>(numThreads * numStates);
+		vector<ll> reverseSigmas = vector<ll>(numThreads * numStates);
+		vector<ll> chainSigmas = vector<ll>(numThreads * numLoc);
+
+		RNGStream stream = RNG::GetInstance()->CreateStream();
+
+		HiddenSemanticsSimilarityTask task;
+		task.pairOffsets = &pairOffsets[0];
+		task.secondUserIndices = (candidateNeighbors != 0) ? &secondUserIndices[0] : NULL;
+		task.numLoc = numLoc;
+		task.numPeriods = numPeriods;
+		task.tpInfo = &tpInfo;
+		task.zerothOrderOnly = zerothOrderOnly;
+		task.maxIterations = maxIterations;
+		task.maxSeconds = maxSeconds;
+		task.approximationIterations = approximationIterations;
+		task.approximationRegularization = approximationRegularization;
+		task.usersData = &usersData[0];
+		task.seed = stream.GetRandomUINT64();
+		task.sim0s = &sim0s[0];
+		task.reverseSim0s = &reverseSim0s[0];
+		task.sim1s = &sim1s[0];
+		task.reverseSim1s = &reverseSim1s[0];
+		task.costMatrices = (approximationIterations == 0) ? &costMatrices[0] : NULL;
+		task.weightMatrices = (approximationIterations != 0) ? &weightMatrices[0] : NULL;
+		task.sigmas = &sigmas[0];
+		task.reverseSigmas = &reverseSigmas[0];
+		task.chainSigmas = &chainSigmas[0];
+
+		VERIFY(Threads::ParallelFor(Nusers, &task, numThreads) == true);
+	}
+
+	if(candidateNeighbors == 0)
+	{
+		// output (in the order of the (leader, follower) pairs)
+		for(ull userIndex1 = 0; userIndex1 < Nusers; userIndex1++)
+		{
+			for(ull userIndex2 = 0; userIndex2 < Nusers; userIndex2++)
+			{
+				double sim0 = 0.0; double sim1 = 0.0;
+				if(userIndex1 == userIndex2)
+				{
+					if(isDefaultDistance == true) { sim0 = 1.0; sim1 = 1.0; }
+				}
+				else
+				{
+					ull firstIndex = MIN(userIndex1, userIndex2); ull secondIndex = MAX(userIndex1, userIndex2);
+					ull pairIndex = pairOffsets[firstIndex] + (secondIndex - firstIndex - 1);
+
+					sim0 = (userIndex1 < userIndex2) ? sim0s[pairIndex] : reverseSim0s[pairIndex];
+					sim1 = (userIndex1 < userIndex2) ? sim1s[pairIndex] : reverseSim1s[pairIndex];
+				}
+
+				stringstream ss("");
+				ss << users[userIndex1] << DEFAULT_FIELDS_DELIMITER << " " << users[userIndex2] << ": "; // leader, follower
+				if(zerothOrderOnly == true)	{ ss << sim0; }
+				else { ss << sim0 << DEFAULT_FIELDS_DELIMITER << " " << sim1; }
+				output->WriteLine(ss.str());
+			}
+		}
+	}
+	else
+	{
+		// sparse output: the most similar candidates of each leader
+		vector<vector<pair<double, ull> > > userPairs = vector<vector<pair<double, ull> > >(Nusers); // (-sim0, pair index)
+		for(ull pairIndex = 0; pairIndex < numPairs; pairIndex++)
+		{
+			userPairs[candidatePairs[pairIndex].first].push_back(pair<double, ull>(-sim0s[pairIndex], pairIndex));
+			userPairs[candidatePairs[pairIndex].second].push_back(pair<double, ull>(-sim0s[pairIndex], pairIndex));
+		}
+
+		for(ull userIndex1 = 0; userIndex1 < Nusers; userIndex1++)
+		{
+			vector<pair<double, ull> >& pairs = userPairs[userIndex1];
+			sort(pairs.begin(), pairs.end());
+
+			for(ull k = 0; k < pairs.size() && k < candidateNeighbors; k++)
+			{
+				ull pairIndex = pairs[k].second;
+				bool leaderFirst = (candidatePairs[pairIndex].first == userIndex1);
+				ull userIndex2 = leaderFirst == true ? candidatePairs[pairIndex].second : candidatePairs[pairIndex].first;
+
+				stringstream ss("");
+				ss << users[userIndex1] << DEFAULT_FIELDS_DELIMITER << " " << users[userIndex2] << ": "; // leader, follower
+				double sim0 = (leaderFirst == true) ? sim0s[pairIndex] : reverseSim0s[pairIndex];
+				if(zerothOrderOnly == true)	{ ss << sim0; }
+				else { ss << sim0 << DEFAULT_FIELDS_DELIMITER << " " << (leaderFirst == true ? sim1s[pairIndex] : reverseSim1s[pairIndex]); }
+				output->WriteLine(ss.str());
+			}
 		}
 	}
 
@@ -831,5 +1092,51 @@ void HiddenSemanticsSimilarityAnalysisOperation::SetLimits(ull iterations, ull s
   // Bouml preserved body end 000C3711
 }
 
+//!
+//! \brief Sets whether the best assignments of the locations of two users are approximated
+//!
+//! By default, the assignments are exact (Hungarian algorithm, O(L^3) per pair of users and time period).
+//! Otherwise, they are approximated by entropic optimal transport (see Algorithms::ApproximateMaximumWeightAssignment()),
+//! in O(L^2) per Sinkhorn iteration, which is faster for large sets of locations.
+//!
+//! \param[in] iterations 	ull, the maximum number of Sinkhorn iterations (0 for the exact assignments).
+//! \param[in] regularization 	double, the entropic regularization, relative to the range of the weights.
+//!
+//! \return nothing
+//!
+void HiddenSemanticsSimilarityAnalysisOperation::SetApproximation(ull iterations, double regularization) 
+{
+  // Bouml preserved body begin 000E4A11
+
+	VERIFY(regularization > 0.0);
+
+	approximationIterations = iterations;
+	approximationRegularization = regularization;
+
+  // Bouml preserved body end 000E4A11
+}
+
+//!
+//! \brief Sets the number of most similar followers output for each leader
+//!
+//! By default (0), the similarity of every (leader, follower) pair is computed and output.
+//! Otherwise, the users are indexed by a SimilarityCandidateIndex of their stationary distributions,
+//! sorted within each time period (as the similarity is invariant to the semantics of the locations), and the similarity is only computed
+//! for the candidate pairs of the index (SIMILARITY_CANDIDATES_PER_NEIGHBOR times \a neighbors candidates per user, instead of all the users).
+//! Only the \a neighbors most similar followers of each leader (by zeroth-order similarity) are then output (in decreasing order of similarity).
+//!
+//! \param[in] neighbors 	ull, the number of followers output per leader (0 for all the pairs).
+//!
+//! \return nothing
+//!
+void HiddenSemanticsSimilarityAnalysisOperation::SetCandidateNeighbors(ull neighbors) 
+{
+  // Bouml preserved body begin 000E4F91
+
+	candidateNeighbors = neighbors;
+
+  // Bouml preserved body end 000E4F91
+}
+
 
 } // namespace lpm
@@ -5,6 +5,8 @@
 #include "../include/File.h"
 #include "../include/Trace.h"
 #include "../include/UserProfile.h"
+#include "../include/Threads.h"
+#include "../include/Instrumentation.h"
 
 namespace lpm {
 
@@ -13,6 +15,9 @@ CreateContextOperation::CreateContextOperation(string name) : Operation<Knowledg
   // Bouml preserved body begin 00045E11
 
 	SetLimits(1024, 1); // by default spend at most 1024 iterations per user or 1 sec per user
+	SetThreadsCount(); // by default use Parameters::GetThreadsCount() threads
+	SetTransitionsCountOutput(); // by default the transitions count are not written
+	SetDistanceKernelCutoff(); // by default the distance kernel covers all the pairs of locations
 
   // Bouml preserved body end 00045E11
 }
@@ -23,6 +28,208 @@ CreateContextOperation::~CreateContextOperation()
   // Bouml preserved body end 00066D11
 }
 
+// learning traces, prior counts, output profile and random stream of a user processed by the knowledge construction
+struct KnowledgeConstructionWork
+{
+	vector<TraceVector> traces;
+	double* priorTransitionsCount;
+	UserProfile* profile;
+	RNGStream stream;
+};
+
+// runs the Gibbs sampling of the users (one user per index)
+class CreateContextOperation::KnowledgeConstructionTask : public ParallelTask
+{
+  public:
+	KnowledgeConstructionTask(const CreateContextOperation* operation, vector<KnowledgeConstructionWork>* works)
+		: operation(operation), works(works), results(works->size(), 0) { }
+
+	virtual void Run(ull index, ull thread)
+	{
+		KnowledgeConstructionWork& work = (*works)[index];
+		results[index] = (operation->DoGibbsSampling(work.traces, work.priorTransitionsCount, work.profile, &(work.stream)) == true) ? 1 : 0;
+	}
+
+	bool Succeeded() const
+	{
+		foreach_const(vector<int>, results, iter) { if(*iter == 0) { return false; } }
+		return true;
+	}
+
+  private:
+	const CreateContextOperation* operation;
+	vector<KnowledgeConstructionWork>* works;
+	vector<int> results; // one entry per user (not a vector<bool>: threads write distinct entries concurrently)
+};
+
+// grid of the locations (cells of at least the given size, indexed by GET_INDEX(cellX, cellY, numCellsY)), in which the locations
+// within a given radius of a location are found by visiting the cells which intersect the enclosing square
+class LocationGrid
+{
+  public:
+	LocationGrid(const double* coordinatesX, const double* coordinatesY, ull numLoc, double cellSize)
+		: coordinatesX(coordinatesX), coordinatesY(coordinatesY)
+	{
+		VERIFY(numLoc != 0 && cellSize > 0.0);
+
+		minX = *min_element(coordinatesX, coordinatesX + numLoc); double maxX = *max_element(coordinatesX, coordinatesX + numLoc);
+		minY = *min_element(coordinatesY, coordinatesY + numLoc); double maxY = *max_element(coordinatesY, coordinatesY + numLoc);
+
+		// the cells are enlarged if there would be many more cells than locations (e.g. if the radius is small w.r.t. the extent of the area)
+		double extent = MAX(maxX - minX, maxY - minY);
+		this->cellSize = MAX(cellSize, extent / ceil(sqrt((double)numLoc)));
+
+		numCellsX = (ull)floor((maxX - minX) / this->cellSize) + 1;
+		numCellsY = (ull)floor((maxY - minY) / this->cellSize) + 1;
+
+		// counting sort of the locations by cell (in increasing order of locations within a cell)
+		vector<ull> cells = vector<ull>(numLoc);
+		cellStarts = vector<ull>(numCellsX * numCellsY + 1, 0);
+		for(ull loc = 0; loc < numLoc; loc++)
+		{
+			cells[loc] = GET_INDEX(GetCellX(coordinatesX[loc]), GetCellY(coordinatesY[loc]), numCellsY);
+			cellStarts[cells[loc] + 1]++;
+		}
+		for(ull cell = 0; cell < numCellsX * numCellsY; cell++) { cellStarts[cell + 1] += cellStarts[cell]; }
+
+		cellLocations = vector<ull>(numLoc);
+		vector<ull> positions = vector<ull>(cellStarts.begin(), cellStarts.end() - 1);
+		for(ull loc = 0; loc < numLoc; loc++) { cellLocations[positions[cells[loc]]++] = loc; }
+	}
+
+	// appends to neighbors the (increasing) indices of the locations within radius of location locIndex (including locIndex itself)
+	void GetNeighbors(ull locIndex, double radius, vector<ull>& neighbors) const
+	{
+		const double x = coordinatesX[locIndex];
+		const double y = coordinatesY[locIndex];
+		const double squaredRadius = radius * radius;
+
+		ull firstX = GetCellX(x - radius); ull lastX = GetCellX(x + radius);
+		ull firstY = GetCellY(y - radius); ull lastY = GetCellY(y + radius);
+
+		ull first = neighbors.size();
+		for(ull cellX = firstX; cellX <= lastX; cellX++)
+		{
+			for(ull cellY = firstY; cellY <= lastY; cellY++)
+			{
+				ull cell = GET_INDEX(cellX, cellY, numCellsY);
+				for(ull i = cellStarts[cell]; i < cellStarts[cell + 1]; i++)
+				{
+					ull loc = cellLocations[i];
+
+					double dx = coordinatesX[loc] - x;
+					double dy = coordinatesY[loc] - y;
+					if(dx * dx + dy * dy <= squaredRadius) { neighbors.push_back(loc); }
+				}
+			}
+		}
+		sort(neighbors.begin() + first, neighbors.end());
+	}
+
+  private:
+	ull GetCellX(double x) const { return (x <= minX) ? 0 : MIN((ull)floor((x - minX) / cellSize), numCellsX - 1); }
+
+	ull GetCellY(double y) const { return (y <= minY) ? 0 : MIN((ull)floor((y - minY) / cellSize), numCellsY - 1); }
+
+	const double* coordinatesX;
+	const double* coordinatesY;
+	double minX;
+	double minY;
+	double cellSize;
+	ull numCellsX;
+	ull numCellsY;
+	vector<ull> cellStarts; // the locations of cell c are cellLocations[cellStarts[c]], ..., cellLocations[cellStarts[c + 1] - 1]
+	vector<ull> cellLocations;
+};
+
+// computes the rows of the aggregate transition matrix (one location per index): the row of observed transitions (with the prior) is
+// normalized, mixed with the normalized row of the distance kernel (dense, or sparse over the neighbors of the location in the grid), and
+// normalized again
+class AggregateStatisticsTask : public ParallelTask
+{
+  public:
+	virtual void Run(ull locIndex, ull thread)
+	{
+		double* row = &count[GET_INDEX(locIndex, 0, numLoc)];
+
+		double sum = 0.0;
+		for(ull loc = 0; loc < numLoc; loc++) { sum += row[loc]; }
+		VERIFY(sum > 0.0);
+		for(ull loc = 0; loc < numLoc; loc++) { row[loc] /= sum; }
+
+		const double x = coordinatesX[locIndex];
+		const double y = coordinatesY[locIndex];
+
+		if(grid == NULL)
+		{
+			// dense kernel: the squared distances and the weights are computed in vectorizable loops
+			double* kernel = &kernelRows[GET_INDEX(thread, 0, numLoc)];
+			for(ull loc = 0; loc < numLoc; loc++)
+			{
+				double dx = x - coordinatesX[loc];
+				double dy = y - coordinatesY[loc];
+				kernel[loc] = dx * dx + dy * dy;
+			}
+			for(ull loc = 0; loc < numLoc; loc++)
+			{
+				double dist = MAX(sqrt(kernel[loc]), minDist);
+				kernel[loc] = 1.0 / (dist * dist);
+			}
+
+			double kernelSum = 0.0;
+			for(ull loc = 0; loc < numLoc; loc++) { kernelSum += kernel[loc]; }
+			VERIFY(kernelSum > 0.0);
+
+			for(ull loc = 0; loc < numLoc; loc++) { row[loc] = alpha * row[loc] + (1.0 - alpha) * (kernel[loc] / kernelSum); }
+		}
+		else
+		{
+			// sparse kernel: only the neighbors of the location (which include the location itself) have a non-zero weight
+			vector<ull>& neighbors = neighborsLists[thread]; neighbors.clear();
+			grid->GetNeighbors(locIndex, cutoff, neighbors);
+			ull numNeighbors = neighbors.size();
+			VERIFY(numNeighbors != 0);
+
+			vector<double>& kernel = sparseKernels[thread]; kernel.resize(numNeighbors);
+			for(ull k = 0; k < numNeighbors; k++)
+			{
+				double dx = x - coordinatesX[neighbors[k]];
+				double dy = y - coordinatesY[neighbors[k]];
+				kernel[k] = dx * dx + dy * dy;
+			}
+			for(ull k = 0; k < numNeighbors; k++)
+			{
+				double dist = MAX(sqrt(kernel[k]), minDist);
+				kernel[k] = 1.0 / (dist * dist);
+			}
+
+			double kernelSum = 0.0;
+			for(ull k = 0; k < numNeighbors; k++) { kernelSum += kernel[k]; }
+			VERIFY(kernelSum > 0.0);
+
+			for(ull loc = 0; loc < numLoc; loc++) { row[loc] *= alpha; }
+			for(ull k = 0; k < numNeighbors; k++) { row[neighbors[k]] += (1.0 - alpha) * (kernel[k] / kernelSum); }
+		}
+
+		sum = 0.0;
+		for(ull loc = 0; loc < numLoc; loc++) { sum += row[loc]; }
+		VERIFY(sum > 0.0);
+		for(ull loc = 0; loc < numLoc; loc++) { row[loc] /= sum; }
+	}
+
+	double* count;
+	ull numLoc;
+	const double* coordinatesX;
+	const double* coordinatesY;
+	double minDist;
+	double alpha;
+	const LocationGrid* grid; // NULL: dense kernel
+	double cutoff;
+	vector<double> kernelRows; // dense kernel: one row per thread
+	vector<vector<ull> > neighborsLists; // sparse kernel: one list (and kernel) per thread
+	vector<vector<double> > sparseKernels;
+};
+
 //! \brief Executes the knowledge construction
 //! 
 //! \param[in] input 	KnowledgeInput*, input object 
@@ -47,8 +254,11 @@ bool CreateContextOperation::Execute(const KnowledgeInput* input, Context* outpu
 	map<ull, vector<TraceVector> > learningTraces = map<ull, vector<TraceVector> >();
 	map<ull, double*> priorTransitionsCount = map<ull, double*>();
 
+	map<ull, double*> rawTransitionsCount = map<ull, double*>(); // only kept to write the transitions count
+
 	bool* transFeasibilityMatrix = NULL;
-	if(ReadKnowledgeFiles(input, learningTraces, priorTransitionsCount, &transFeasibilityMatrix) == false){ return false; }
+	map<ull, double*>* rawTransitionsCountPtr = (countsOutputFile != NULL) ? &rawTransitionsCount : NULL;
+	if(ReadKnowledgeFiles(input, learningTraces, priorTransitionsCount, &transFeasibilityMatrix, rawTransitionsCountPtr) == false){ return false; }
 
 	// ull Nusers = learningTraces.size();
 	// VERIFY(Nusers != 0 && learningTraces.size() == priorTransitionsCount.size());
@@ -66,51 +276,43 @@ bool CreateContextOperation::Execute(const KnowledgeInput* input, Context* outpu
 
 	ull numStates = numPeriods * numLoc;
 
+	// the users with learning traces (which exist) are processed in parallel
+	set<ull> users = set<ull>();
 	pair_foreach_const(map<ull, vector<TraceVector> >, learningTraces, iter)
 	{
 		ull user = iter->first;
-		vector<TraceVector> traces = iter->second;
 
 		if(Parameters::GetInstance()->UserExists(user) == true) // only process this user if he exists
 		{
 			unknownUsers.erase(user); // we have info for this user, remove it from the set
+			users.insert(user);
+		}
+	}
 
-			VERIFY(priorTransitionsCount.find(user) != priorTransitionsCount.end());
-			double* aprioriTransitionsCount = (priorTransitionsCount.find(user))->second;
-
-			VERIFY(aprioriTransitionsCount != NULL);
-
-			UserProfile* profile = new UserProfile(user);
-			VERIFY(profile != NULL);
-
-			// allocate learning traces for that user for Gibbs sampling
-			ull numTraces = traces.size();
-			VERIFY(numTraces != 0);
+	bool success = RunGibbsSampling(learningTraces, priorTransitionsCount, users, context);
 
-			if(DoGibbsSampling(traces, aprioriTransitionsCount, profile) == false)
-			{
-				profile->Release();
-				Free(aprioriTransitionsCount);
-				pair_foreach_const(map<ull, vector<TraceVector> >, learningTraces, iter2)
-				{ foreach_const(vector<TraceVector>, iter2->second, iterV) { Free((*iterV).trace); } }
+	if(success == true && countsOutputFile != NULL)
+	{
+		success = AddObservedTransitionsCount(learningTraces, rawTransitionsCount) && WriteTransitionsCount(rawTransitionsCount, countsOutputFile);
+	}
 
-				priorTransitionsCount.clear();
-				learningTraces.clear();
-				output->ClearProfiles();
+	pair_foreach_const(map<ull, double*>, rawTransitionsCount, iterR) { Free(iterR->second); }
+	rawTransitionsCount.clear();
 
-				if(transFeasibilityMatrix != NULL) { Free(transFeasibilityMatrix); }
+	pair_foreach_const(map<ull, double*>, priorTransitionsCount, iterC) { Free(iterC->second); }
 
-				return false;
-			}
-
-			Free(aprioriTransitionsCount);
+	if(success == false)
+	{
+		pair_foreach_const(map<ull, vector<TraceVector> >, learningTraces, iter2)
+		{ foreach_const(vector<TraceVector>, iter2->second, iterV) { Free((*iterV).trace); } }
 
+		priorTransitionsCount.clear();
+		learningTraces.clear();
+		output->ClearProfiles();
 
-			context->AddProfile(profile);
-			profile->Release();
-		}
+		if(transFeasibilityMatrix != NULL) { Free(transFeasibilityMatrix); }
 
-		traces.clear();
+		return false;
 	}
 
 	pair_foreach_const(map<ull, vector<TraceVector> >, learningTraces, iter2)
@@ -188,7 +390,8 @@ bool CreateContextOperation::Execute(const KnowledgeInput* input, Context* outpu
 		vector<TraceVector> tvecs = vector<TraceVector>();
 		tvecs.push_back(vec);
 
-		if(DoGibbsSampling(tvecs, aprioriTransitionsCount, unknownProfile) == false)
+		RNGStream unknownStream = RNG::GetInstance()->CreateStream();
+		if(DoGibbsSampling(tvecs, aprioriTransitionsCount, unknownProfile, &unknownStream) == false)
 		{
 			unknownProfile->Release();
 			Free(aprioriTransitionsCount);
@@ -282,14 +485,135 @@ bool CreateContextOperation::SetLimits(ull maxSamples, ull maxSeconds)
   // Bouml preserved body end 0007E411
 }
 
-bool CreateContextOperation::TransitionMatrixFromCountMatrix(const double* count, double* alpha, double* theta, double* transitionMatrix, bool sample) const 
+//!
+//! \brief Sets the number of threads used to construct the knowledge (the users are processed in parallel)
+//!
+//! \param[in] numThreads 	ull, the maximum number of threads (0 to use Parameters::GetThreadsCount(), 1 to process the users sequentially).
+//!
+//! \note The limits set by \a SetLimits() apply to each user, independently of the thread processing it.
+//!
+//! \return nothing
+//!
+void CreateContextOperation::SetThreadsCount(ull numThreads)
+{
+  // Bouml preserved body begin 000E2591
+
+	this->numThreads = numThreads;
+
+  // Bouml preserved body end 000E2591
+}
+
+//!
+//! \brief Sets the file to which \a Execute() and \a UpdateKnowledge() write the transitions count of each user
+//!
+//! The transitions count written for a user is the sum of its (input) transitions count and of the transitions observed in its learning traces.
+//! The file has the format of a transitions count file, so that it can be given as \a transitionsCountFile to a later call to \a UpdateKnowledge().
+//!
+//! \param[in] countsFile 	[optional] File*, the output file (NULL to not write the transitions count).
+//!
+//! \return nothing
+//!
+void CreateContextOperation::SetTransitionsCountOutput(File* countsFile)
+{
+  // Bouml preserved body begin 000E2811
+
+	countsOutputFile = countsFile;
+
+  // Bouml preserved body end 000E2811
+}
+
+//!
+//! \brief Updates the knowledge with new learning traces
+//!
+//! Only the users observed in the new learning traces are re-derived (their profile is replaced in \a context), the other profiles are left as they are.
+//!
+//! \param[in] input 	KnowledgeInput*, input object: the learning traces are the new traces only and the transitions count file is the one
+//! written (see \a SetTransitionsCountOutput()) when the knowledge was last constructed or updated.
+//! \param[in,out] context 	Context*, the knowledge to update.
+//!
+//! \note With the counting-only construction, the updated knowledge is the one a full construction (on all the learning traces) would produce.
+//! \note The update is refused (ERROR_CODE_INCONSISTENT_TIME_PARTITIONING_USAGE) if the time partitioning has dummy time periods: the transitions
+//! count file only covers the non-dummy time periods, so the transitions into or out of a dummy time period of the previous learning traces are unknown.
+//!
+//! \return true or false, depending on whether the call is successful
+//!
+bool CreateContextOperation::UpdateKnowledge(const KnowledgeInput* input, Context* context)
+{
+  // Bouml preserved body begin 000E2791
+
+	if(input == NULL || context == NULL)
+	{
+		SET_ERROR_CODE(ERROR_CODE_INVALID_ARGUMENTS);
+		return false;
+	}
+
+	// the transitions of the previous learning traces which involve a dummy time period are not in the transitions count (see the note above)
+	ull numPeriods = 0; TPInfo tpInfo;
+	VERIFY(Parameters::GetInstance()->GetTimePeriodInfo(&numPeriods, &tpInfo) == true);
+	if(numPeriods != tpInfo.numPeriodsInclDummies)
+	{
+		SET_ERROR_CODE(ERROR_CODE_INCONSISTENT_TIME_PARTITIONING_USAGE);
+		return false;
+	}
+
+	map<ull, vector<TraceVector> > learningTraces = map<ull, vector<TraceVector> >();
+	map<ull, double*> priorTransitionsCount = map<ull, double*>();
+	map<ull, double*> rawTransitionsCount = map<ull, double*>();
+
+	if(ReadKnowledgeFiles(input, learningTraces, priorTransitionsCount, NULL, &rawTransitionsCount) == false){ return false; }
+
+	VERIFY(learningTraces.size() == priorTransitionsCount.size());
+
+	// only the (existing) users observed in the new learning traces need to be re-derived
+	// (the users only found in the transitions count file are given an empty trace)
+	set<ull> users = set<ull>();
+	pair_foreach_const(map<ull, vector<TraceVector> >, learningTraces, iter)
+	{
+		ull user = iter->first;
+		if(Parameters::GetInstance()->UserExists(user) == false) { continue; }
+
+		bool observed = false;
+		foreach_const(vector<TraceVector>, iter->second, iterV)
+		{
+			for(ull i = 0; i < (*iterV).length && observed == false; i++) { if((*iterV).trace[i] != 0) { observed = true; } }
+		}
+
+		if(observed == true) { users.insert(user); }
+	}
+
+	bool success = RunGibbsSampling(learningTraces, priorTransitionsCount, users, context);
+
+	if(success == true && countsOutputFile != NULL)
+	{
+		success = AddObservedTransitionsCount(learningTraces, rawTransitionsCount) && WriteTransitionsCount(rawTransitionsCount, countsOutputFile);
+	}
+
+	pair_foreach_const(map<ull, vector<TraceVector> >, learningTraces, iter2)
+	{ foreach_const(vector<TraceVector>, iter2->second, iterV) { Free((*iterV).trace); } }
+
+	pair_foreach_const(map<ull, double*>, priorTransitionsCount, iterC) { Free(iterC->second); }
+	pair_foreach_const(map<ull, double*>, rawTransitionsCount, iterR) { Free(iterR->second); }
+
+	learningTraces.clear();
+	priorTransitionsCount.clear();
+	rawTransitionsCount.clear();
+
+	stringstream info("");
+	info << "Knowledge update: " << users.size() << " user(s) re-derived!";
+	Log::GetInstance()->Append(info.str());
+
+	return success;
+
+  // Bouml preserved body end 000E2791
+}
+
+bool CreateContextOperation::TransitionMatrixFromCountMatrix(const double* count, double* alpha, double* theta, double* transitionMatrix, RNGStream* stream, bool sample) const 
 {
   // Bouml preserved body begin 000BCF91
 
-	VERIFY(count != NULL && alpha != NULL && theta != NULL && transitionMatrix != NULL);
+	VERIFY(count != NULL && alpha != NULL && theta != NULL && transitionMatrix != NULL && stream != NULL);
 
 	Parameters* params = Parameters::GetInstance();
-	RNG* rng = RNG::GetInstance();
 
 	// get location parameters
 	ull minLoc = 0; ull maxLoc = 0;
@@ -351,7 +675,7 @@ bool CreateContextOperation::TransitionMatrixFromCountMatrix(const double* count
 				ull vectorSize = numLoc * numLoc;
 				if(sample == true)
 				{
-					rng->GetDirichletRandomSample(alpha, vectorSize, theta); // do the actual sampling
+					stream->GetDirichletRandomSample(alpha, vectorSize, theta); // do the actual sampling
 
 					for(ull i=0; i < vectorSize; i++)
 					{
@@ -477,7 +801,7 @@ void CreateContextOperation::ComputeSteadyStateVector(const double* transitionMa
 
 	Free(temp);
 	Free(res);
-
+
 	// check
 	double sum = 0.0;
 	for(ull i = 0; i < numStatesInclDummies; i++) { sum += steadyStateVector[i]; }
@@ -486,11 +810,11 @@ void CreateContextOperation::ComputeSteadyStateVector(const double* transitionMa
   // Bouml preserved body end 0007E511
 }
 
-bool CreateContextOperation::DoGibbsSampling(vector<TraceVector>& learningTraces, double* priorTransitionsCount, UserProfile* profile) const 
+bool CreateContextOperation::DoGibbsSampling(vector<TraceVector>& learningTraces, double* priorTransitionsCount, UserProfile* profile, RNGStream* stream) const 
 {
   // Bouml preserved body begin 0007E491
 
-	if(learningTraces.empty() == true || priorTransitionsCount == NULL || profile == NULL) { return false; }
+	if(learningTraces.empty() == true || priorTransitionsCount == NULL || profile == NULL || stream == NULL) { return false; }
 
 	ull numTraces = learningTraces.size();
 
@@ -498,12 +822,16 @@ bool CreateContextOperation::DoGibbsSampling(vector<TraceVector>& learningTraces
 
 	ull user = profile->GetUser();
 
+	bool logEnabled = Log::GetInstance()->IsEnabled();
+
 	stringstream info("");
-	info << "Starting Gibbs Sampling for user " << user << "!";
-	Log::GetInstance()->Append(info.str());
+	if(logEnabled == true)
+	{
+		info << "Starting Gibbs Sampling for user " << user << "!";
+		Log::GetInstance()->Append(info.str());
+	}
 
 	Parameters* params = Parameters::GetInstance();
-	RNG* rng = RNG::GetInstance();
 
 	// get time parameters
 	//	ull minTime = 0; ull maxTime = 0;
@@ -642,7 +970,7 @@ bool CreateContextOperation::DoGibbsSampling(vector<TraceVector>& learningTraces
 #ifndef KC_COUNTING_ONLY
 
 	// Generate P^{0}
-	if(TransitionMatrixFromCountMatrix(count, alpha, theta, transitionMatrix, true) == false)
+	if(TransitionMatrixFromCountMatrix(count, alpha, theta, transitionMatrix, stream, true) == false)
 	{
 		Free(count); Free(theta); Free(alpha);
 		Free(transitionMatrixSum);
@@ -819,7 +1147,7 @@ bool CreateContextOperation::DoGibbsSampling(vector<TraceVector>& learningTraces
 								VERIFY(Algorithms::GetTransitionVectorOfSubChain(transitionMatrix, prevFilledTp, prevFilledLoc, tp, &tmpProbVector, true) == true);
 							}
 
-							loc = rng->SampleIndexFromVector(tmpProbVector, numLoc) + minLoc; // get sample
+							loc = stream->SampleIndexFromVector(tmpProbVector, numLoc) + minLoc; // get sample
 
 							estimatedTrace[(tm - minTime)] = loc; // fill in the sampled location
 
@@ -844,7 +1172,7 @@ bool CreateContextOperation::DoGibbsSampling(vector<TraceVector>& learningTraces
 							 // use the transition vector (transition probability conditional on the current tp, the next tp, and the current loc)
 							VERIFY(Algorithms::GetTransitionVectorOfSubChain(transitionMatrix, prevFilledTp, prevFilledLoc, tp, &tmpProbVector, true) == true);
 
-							loc = rng->SampleIndexFromVector(tmpProbVector, numLoc) + minLoc; // get sample
+							loc = stream->SampleIndexFromVector(tmpProbVector, numLoc) + minLoc; // get sample
 
 							estimatedTrace[(tm - minTime)] = loc; // fill in the sampled location
 
@@ -964,7 +1292,7 @@ bool CreateContextOperation::DoGibbsSampling(vector<TraceVector>& learningTraces
 
 						NORMALIZE_VECTOR(samplingProbVector, numLoc);
 
-						loc = rng->SampleIndexFromVector(samplingProbVector, numLoc) + minLoc; // get sample
+						loc = stream->SampleIndexFromVector(samplingProbVector, numLoc) + minLoc; // get sample
 
 						estimatedTrace[(tm - minTime)] = loc; // fill in the sampled location
 
@@ -1034,7 +1362,7 @@ bool CreateContextOperation::DoGibbsSampling(vector<TraceVector>& learningTraces
 		}
 
 		// Generate P^{step}
-		VERIFY(TransitionMatrixFromCountMatrix(count, alpha, theta, transitionMatrix, true) == true);
+		VERIFY(TransitionMatrixFromCountMatrix(count, alpha, theta, transitionMatrix, stream, true) == true);
 
 		// Add P^{step} to PSUM
 		for(ull stateIdx1 = 0; stateIdx1 < numStatesInclDummies; stateIdx1++)
@@ -1199,9 +1527,14 @@ bool CreateContextOperation::DoGibbsSampling(vector<TraceVector>& learningTraces
 	if(samplingProbVector != NULL) { Free(samplingProbVector); }
 	foreach_const(vector<TraceVector>, estimatedTraces, iterTV)	{ TraceVector tvec = *iterTV; Free(tvec.trace); }
 
-	info.str("");
-	info << "Finished Gibbs Sampling for user " << user << " after " << step << " iterations (" << (time(NULL) - startTime) << " seconds)!";
-	Log::GetInstance()->Append(info.str());
+	if(logEnabled == true)
+	{
+		info.str("");
+		info << "Finished Gibbs Sampling for user " << user << " after " << step << " iterations (" << (time(NULL) - startTime) << " seconds)!";
+		Log::GetInstance()->Append(info.str());
+	}
+
+	Instrumentation::GetInstance()->AddToCounter(GibbsIterationsCounter, step);
 
 	Free(transitionMatrix);
 	Free(count);
@@ -1351,7 +1684,179 @@ bool CreateContextOperation::DoGibbsSampling(vector<TraceVector>& learningTraces
   // Bouml preserved body end 0007E491
 }
 
-bool CreateContextOperation::ReadKnowledgeFiles(const KnowledgeInput* input, map<ull, vector<TraceVector> >& learningTraces, map<ull, double*>& priorTransitionsCount, bool** transitionsFeasibilityMatrix) 
+bool CreateContextOperation::RunGibbsSampling(const map<ull, vector<TraceVector> >& learningTraces, const map<ull, double*>& priorTransitionsCount, const set<ull>& users, Context* context) const
+{
+  // Bouml preserved body begin 000E2611
+
+	VERIFY(context != NULL);
+
+	RNG* rng = RNG::GetInstance();
+
+	// set up the work of each user: the users are processed in parallel, each with its own profile and random stream
+	vector<KnowledgeConstructionWork> works = vector<KnowledgeConstructionWork>();
+	foreach_const(set<ull>, users, iter)
+	{
+		ull user = *iter;
+
+		map<ull, vector<TraceVector> >::const_iterator tracesIter = learningTraces.find(user);
+		map<ull, double*>::const_iterator countIter = priorTransitionsCount.find(user);
+		VERIFY(tracesIter != learningTraces.end() && countIter != priorTransitionsCount.end());
+
+		KnowledgeConstructionWork work;
+		work.traces = tracesIter->second;
+		work.priorTransitionsCount = countIter->second;
+		work.profile = new UserProfile(user);
+		work.stream = rng->CreateStream();
+
+		VERIFY(work.priorTransitionsCount != NULL && work.profile != NULL);
+
+		// allocate learning traces for that user for Gibbs sampling
+		ull numTraces = work.traces.size();
+		VERIFY(numTraces != 0);
+
+		works.push_back(work);
+	}
+
+	KnowledgeConstructionTask task(this, &works);
+	VERIFY(Threads::ParallelFor(works.size(), &task, numThreads) == true);
+
+	bool success = task.Succeeded();
+
+	// the profiles are added to the context (in users order) by this thread only, replacing the existing ones (if any)
+	foreach_const(vector<KnowledgeConstructionWork>, works, iterW)
+	{
+		if(success == true)
+		{
+			context->RemoveUserProfile(iterW->profile->GetUser());
+			context->AddProfile(iterW->profile);
+		}
+		iterW->profile->Release();
+	}
+	works.clear();
+
+	return success;
+
+  // Bouml preserved body end 000E2611
+}
+
+bool CreateContextOperation::AddObservedTransitionsCount(const map<ull, vector<TraceVector> >& learningTraces, map<ull, double*>& transitionsCount) const
+{
+  // Bouml preserved body begin 000E2691
+
+	Parameters* params = Parameters::GetInstance();
+
+	// get location parameters
+	ull minLoc = 0; ull maxLoc = 0;
+	VERIFY(params->GetLocationstampsRange(&minLoc, &maxLoc) == true);
+	ull numLoc = maxLoc - minLoc + 1;
+
+	// get time period parameters
+	ull numPeriods = 0;  TPInfo tpInfo;
+	VERIFY(params->GetTimePeriodInfo(&numPeriods, &tpInfo) == true);
+	ull minPeriod = tpInfo.minPeriod;
+
+	ull numStates = numPeriods * numLoc;
+
+	// count the transitions exactly as DoGibbsSampling() does, but only keep the non-dummy time periods: a transitions count file has no
+	// dummy time period (hence UpdateKnowledge() refuses partitionings with dummy time periods, see its note)
+	pair_foreach_const(map<ull, vector<TraceVector> >, learningTraces, iter)
+	{
+		map<ull, double*>::iterator countIter = transitionsCount.find(iter->first);
+		VERIFY(countIter != transitionsCount.end());
+
+		double* count = countIter->second;
+
+		foreach_const(vector<TraceVector>, iter->second, iterTV)
+		{
+			TraceVector tvec = *iterTV;
+			ull* trace = tvec.trace;
+			ull minTime = tvec.offset;
+			ull numTimes = tvec.length;
+			ull maxTime = minTime + numTimes - 1;
+
+			for(ull tm = minTime; tm <= maxTime; tm++) // go to maxTime, but with wrap-around
+			{
+				ull nexttm = tm == maxTime ? minTime : (tm + 1); // next timestamp (with wrap-around)
+
+				ull startLoc = trace[(tm - minTime)];
+				ull endLoc = trace[(nexttm - minTime)];
+
+				if(startLoc == 0 || endLoc == 0) { continue; }
+
+				ull startTP = params->LookupTimePeriod(tm, true);
+				ull endTP = params->LookupTimePeriod(nexttm, true);
+				if(startTP == INVALID_TIME_PERIOD || endTP == INVALID_TIME_PERIOD)
+				{
+					SET_ERROR_CODE(ERROR_CODE_INCONSISTENT_TIME_PARTITIONING_USAGE);
+					return false;
+				}
+
+				ull startTPIdx = (startTP - minPeriod); ull endTPIdx = (endTP - minPeriod);
+				if(startTPIdx >= numPeriods || endTPIdx >= numPeriods) { continue; } // dummy time period
+
+				ull startStateIdx = startTPIdx * numLoc + (startLoc - minLoc);
+				ull endStateIdx = endTPIdx * numLoc + (endLoc - minLoc);
+				count[GET_INDEX(startStateIdx, endStateIdx, numStates)]++;
+			}
+		}
+	}
+
+	return true;
+
+  // Bouml preserved body end 000E2691
+}
+
+bool CreateContextOperation::WriteTransitionsCount(const map<ull, double*>& transitionsCount, File* countsFile) const
+{
+  // Bouml preserved body begin 000E2711
+
+	if(countsFile == NULL || countsFile->IsGood() == false)
+	{
+		SET_ERROR_CODE(ERROR_CODE_INVALID_ARGUMENTS);
+		return false;
+	}
+
+	Parameters* params = Parameters::GetInstance();
+
+	// get location parameters
+	ull minLoc = 0; ull maxLoc = 0;
+	VERIFY(params->GetLocationstampsRange(&minLoc, &maxLoc) == true);
+	ull numLoc = maxLoc - minLoc + 1;
+
+	// get time period parameters
+	ull numPeriods = 0;
+	VERIFY(params->GetTimePeriodInfo(&numPeriods, NULL) == true);
+
+	ull numStates = numPeriods * numLoc;
+
+	// the counts are written as integers (see ReadTransitionsCount())
+	vector<ull> values = vector<ull>(numStates * numStates, 0);
+
+	pair_foreach_const(map<ull, double*>, transitionsCount, iter)
+	{
+		const double* count = iter->second;
+		for(ull i = 0; i < numStates * numStates; i++) { values[i] = (ull)(count[i] + 0.5); }
+
+		stringstream line("");
+		line << iter->first;
+		countsFile->WriteLine(line.str());
+
+		countsFile->WriteLine(""); // leave one line empty
+
+		vector<string> lines = vector<string>();
+		VERIFY(LineFormatter<ull>::GetInstance()->FormatMatrix(&values[0], numStates, numStates, lines) == true);
+		foreach_const(vector<string>, lines, lineIter) { countsFile->WriteLine(*lineIter); }
+
+		countsFile->WriteLine("");
+		countsFile->WriteLine("");
+	}
+
+	return true;
+
+  // Bouml preserved body end 000E2711
+}
+
+bool CreateContextOperation::ReadKnowledgeFiles(const KnowledgeInput* input, map<ull, vector<TraceVector> >& learningTraces, map<ull, double*>& priorTransitionsCount, bool** transitionsFeasibilityMatrix, map<ull, double*>* rawTransitionsCount) 
 {
   // Bouml preserved body begin 00081B11
 
@@ -1359,6 +1864,7 @@ bool CreateContextOperation::ReadKnowledgeFiles(const KnowledgeInput* input, map
 
 	learningTraces.clear();
 	priorTransitionsCount.clear();
+	if(rawTransitionsCount != NULL) { rawTransitionsCount->clear(); }
 
 	File* transFeasibilityFile = input->transitionsFeasibilityFile;
 	File* transitionsCountFile = input->transitionsCountFile;
@@ -1534,7 +2040,9 @@ bool CreateContextOperation::ReadKnowledgeFiles(const KnowledgeInput* input, map
 			}
 		}
 
-		Free(transitionsCount);
+		// keep the (non-extended) transitions count if requested
+		if(rawTransitionsCount != NULL) { rawTransitionsCount->insert(pair<ull, double*>(iter->first, transitionsCount)); }
+		else { Free(transitionsCount); }
 	}
 
 	if(transitionsFeasibilityMatrix != NULL) { *transitionsFeasibilityMatrix = transFeasibility; } // retrieve the transitions feasibility matrix
@@ -1932,6 +2440,42 @@ bool CreateContextOperation::ReadLearningTraces(const vector<File*>& learningTra
   // Bouml preserved body end 00081F91
 }
 
+//!
+//! \brief Sets the cutoff radius of the distance kernel of \a ComputeAggregateStatistics()
+//!
+//! The kernel weights each pair of locations by the inverse square of their distance (at least 1). Beyond the cutoff radius, the weight is zero:
+//! the kernel is then sparse and only the locations within the radius of each location are visited (through a grid of the locations).
+//!
+//! \param[in] radius 	[optional] double, the cutoff radius (in the unit of the coordinates of the locations file), or KC_NO_KERNEL_CUTOFF.
+//!
+//! \return nothing
+//!
+void CreateContextOperation::SetDistanceKernelCutoff(double radius)
+{
+  // Bouml preserved body begin 000E5011
+
+	VERIFY(radius >= 0.0);
+
+	kernelCutoff = radius;
+
+  // Bouml preserved body end 000E5011
+}
+
+//!
+//! \brief Computes the aggregate statistics (transition matrix and steady-state vector) of the given traces
+//!
+//! The transitions observed in the traces (plus a uniform prior) are mixed with a distance kernel over the coordinates of the locations
+//! (see \a SetDistanceKernelCutoff()). The rows of the transition matrix are computed in parallel (see \a SetThreadsCount()).
+//!
+//! \param[in] tracesFile 	File*, the traces file.
+//! \param[in] locationsFile 	File*, the locations file (one line 'x, y' per location, in increasing order of locationstamps).
+//! \param[out] outTransitionMatrix 	double**, the transition matrix (allocated with Allocate()).
+//! \param[out] outSteadyStateVector 	double**, the steady-state vector (allocated with Allocate()).
+//!
+//! \note The time partitioning must have a single time period.
+//!
+//! \return true or false, depending on whether the call is successful
+//!
 // This function is modified from original LPM code; it will not work with multiple time periods
 bool CreateContextOperation::ComputeAggregateStatistics(File* tracesFile, File* locationsFile, double** outTransitionMatrix, double** outSteadyStateVector) const
 {
@@ -1971,7 +2515,7 @@ bool CreateContextOperation::ComputeAggregateStatistics(File* tracesFile, File*
 
 	LineParser<double>* parser = LineParser<double>::GetInstance();
 
-	ull loc = minLoc; vector<pair<double, double> > locsXYvec;
+	ull loc = minLoc; vector<double> coordinatesX = vector<double>(); vector<double> coordinatesY = vector<double>();
 	while(locationsFile->IsGood())
 	{
 		string line = "";
@@ -1986,64 +2530,12 @@ bool CreateContextOperation::ComputeAggregateStatistics(File* tracesFile, File*
 		bool parseOk = parser->ParseTwoFields(line, &locx, &locy, &pos, DEFAULT_FIELDS_DELIMITER);
 		VERIFY(parseOk == true && pos == string::npos);
 
-		locsXYvec.push_back(make_pair(locx, locy));
+		coordinatesX.push_back(locx); coordinatesY.push_back(locy);
 
 		loc++;
 	}
 	VERIFY(loc == maxLoc+1);
 
-	// count
-	ull countdByteSize = numStatesInclDummies * numStatesInclDummies * sizeof(ull);
-	double* countd = (double*)Allocate(countdByteSize);
-	VERIFY(countd != NULL);
-	memset(countd, 0, countdByteSize);
-
-	const double minDist = 1.0;
-	for(ull loc1 = minLoc; loc1 <= maxLoc; loc1++)
-	{
-		ull loc1idx = (loc1 - minLoc);
-		double loc1x = locsXYvec[loc1idx].first;
-		double loc1y = locsXYvec[loc1idx].second;
-
-		for(ull loc2 = minLoc; loc2 <= maxLoc; loc2++)
-		{
-			ull loc2idx = (loc2 - minLoc);
-			double loc2x = locsXYvec[loc2idx].first;
-			double loc2y = locsXYvec[loc2idx].second;
-
-
-			ull idx = GET_INDEX(loc1idx, loc2idx, numLoc);
-
-			double dist = sqrt(pow((loc1x - loc2x), 2.0) + pow((loc1y - loc2y), 2.0));
-
-			if(dist < minDist) { dist = minDist; }
-
-			double prob = 1.0 / pow(dist, 2.0);
-
-			countd[idx] = prob;
-		}
-	}
-
-	// renormalize
-	for(ull loc1 = minLoc; loc1 <= maxLoc; loc1++)
-	{
-		ull loc1idx = (loc1 - minLoc);
-		double sum = 0.0;
-		for(ull loc2 = minLoc; loc2 <= maxLoc; loc2++)
-		{
-			ull loc2idx = (loc2 - minLoc);
-			ull idx = GET_INDEX(loc1idx, loc2idx, numLoc);
-			sum += countd[idx];
-		}
-		VERIFY(sum > 0.0);
-		for(ull loc2 = minLoc; loc2 <= maxLoc; loc2++)
-		{
-			ull loc2idx = (loc2 - minLoc);
-			ull idx = GET_INDEX(loc1idx, loc2idx, numLoc);
-			countd[idx] /= sum;
-		}
-	}
-
 	//////// -----------------
 
 
@@ -2051,19 +2543,13 @@ bool CreateContextOperation::ComputeAggregateStatistics(File* tracesFile, File*
 	bool readOk = ReadLearningTraces(tracesFileVector, tracesMap);
 	VERIFY(readOk == true);
 
-	// count
-	ull countByteSize = numStatesInclDummies * numStatesInclDummies * sizeof(ull);
+	// count (with epsilon)
+	ull countByteSize = numStatesInclDummies * numStatesInclDummies * sizeof(double);
 	double* count = (double*)Allocate(countByteSize);
 	VERIFY(count != NULL);
-	memset(count, 0, countByteSize);
 
-	// add epsilon
 	const double epsilon = 1.0 / (double)numLoc;
-	for(ull stateIdx1 = 0; stateIdx1 < numStatesInclDummies; stateIdx1++)
-	{
-		for(ull stateIdx2 = 0; stateIdx2 < numStatesInclDummies; stateIdx2++)
-		{ count[GET_INDEX(stateIdx1, stateIdx2, numStatesInclDummies)] += epsilon; }
-	}
+	fill(count, count + numStatesInclDummies * numStatesInclDummies, epsilon);
 
 	// steady-state vector
 	ull steadyStateVectorByteSize = numStatesInclDummies * sizeof(double);
@@ -2099,6 +2585,7 @@ bool CreateContextOperation::ComputeAggregateStatistics(File* tracesFile, File*
 				if(startTP == INVALID_TIME_PERIOD || endTP == INVALID_TIME_PERIOD)
 				{
 					SET_ERROR_CODE(ERROR_CODE_INCONSISTENT_TIME_PARTITIONING_USAGE);
+					Free(count); Free(steadyStateVector);
 					return false;
 				}
 
@@ -2113,53 +2600,32 @@ bool CreateContextOperation::ComputeAggregateStatistics(File* tracesFile, File*
 		}
 	}
 
-	// normalize the matrix
-	for(ull stateIdx1 = 0; stateIdx1 < numStatesInclDummies; stateIdx1++)
-	{
-		double sum = 0.0;
-		for(ull stateIdx2 = 0; stateIdx2 < numStatesInclDummies; stateIdx2++)
-		{
-			ull index = GET_INDEX(stateIdx1, stateIdx2, numStatesInclDummies);
-			sum += count[index];
-		}
-		VERIFY(sum > 0.0);
-		for(ull stateIdx2 = 0; stateIdx2 < numStatesInclDummies; stateIdx2++)
-		{
-			ull index = GET_INDEX(stateIdx1, stateIdx2, numStatesInclDummies);
-			count[index] /= sum;
-		}
-	}
-
 	////////////////////////// ------------
-	// merge the 2 counts
-	const double alpha = 0.5;
-	for(ull stateIdx1 = 0; stateIdx1 < numStatesInclDummies; stateIdx1++)
-	{
-		for(ull stateIdx2 = 0; stateIdx2 < numStatesInclDummies; stateIdx2++)
-		{
-			ull index = GET_INDEX(stateIdx1, stateIdx2, numStatesInclDummies);
-
-			count[index] = alpha * count[index] + (1.0 - alpha) * countd[index];
-		}
-	}
+	// normalize the counts, merge them with the (normalized) distance kernel, and normalize the result, row by row
+	// (the kernel is never stored as a matrix: with a cutoff radius, only the locations of the grid within the radius are visited)
+	LocationGrid* grid = NULL;
+	if(kernelCutoff != KC_NO_KERNEL_CUTOFF) { grid = new LocationGrid(&coordinatesX[0], &coordinatesY[0], numLoc, kernelCutoff); }
+
+	ull numRowThreads = Threads::GetEffectiveThreadsCount(numLoc, numThreads);
+
+	AggregateStatisticsTask task;
+	task.count = count;
+	task.numLoc = numLoc;
+	task.coordinatesX = &coordinatesX[0];
+	task.coordinatesY = &coordinatesY[0];
+	task.minDist = 1.0;
+	task.alpha = 0.5;
+	task.grid = grid;
+	task.cutoff = kernelCutoff;
+	if(grid == NULL) { task.kernelRows = vector<double>(numRowThreads * numLoc); }
+	task.neighborsLists = vector<vector<ull> >(numRowThreads);
+	task.sparseKernels = vector<vector<double> >(numRowThreads);
+
+	VERIFY(Threads::ParallelFor(numLoc, &task, numThreads) == true);
+
+	if(grid != NULL) { delete grid; }
 	////////////////////////// ------------
 
-	// normalize the matrix
-	for(ull stateIdx1 = 0; stateIdx1 < numStatesInclDummies; stateIdx1++)
-	{
-		double sum = 0.0;
-		for(ull stateIdx2 = 0; stateIdx2 < numStatesInclDummies; stateIdx2++)
-		{
-			ull index = GET_INDEX(stateIdx1, stateIdx2, numStatesInclDummies);
-			sum += count[index];
-		}
-		VERIFY(sum > 0.0);
-		for(ull stateIdx2 = 0; stateIdx2 < numStatesInclDummies; stateIdx2++)
-		{
-			ull index = GET_INDEX(stateIdx1, stateIdx2, numStatesInclDummies);
-			count[index] /= sum;
-		}
-	}
 	ComputeSteadyStateVector(count, steadyStateVector);
 
 	ull maxPeriod = tpInfo.maxPeriod;
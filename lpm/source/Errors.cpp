@@ -2,6 +2,7 @@
 //! \file
 //!
 #include "../include/Errors.h"
+#include "../include/ExecutionContext.h"
 
 namespace lpm {
 
@@ -16,6 +17,23 @@ Errors::Errors()
   // Bouml preserved body end 00099D11
 }
 
+//!
+//! \brief Returns the error state of the execution context active on the calling thread (see ExecutionContext), or the global one if none
+//!
+//! \return Errors*, the error state
+//!
+Errors* Errors::GetInstance()
+{
+  // Bouml preserved body begin 000E4391
+
+	ExecutionContext* context = ExecutionContext::GetCurrent();
+	if(context != NULL) { return context->GetErrors(); }
+
+	return Singleton<Errors>::GetInstance();
+
+  // Bouml preserved body end 000E4391
+}
+
 //! 
 //! \brief Returns the error code of the last error (the most recent one)
 //!
@@ -48,13 +66,17 @@ void Errors::SetErrorCode(ull errorCode, const char* file, int line, string deta
 {
   // Bouml preserved body begin 0002EB91
 
+	ScopedLock lock(mutex);
+
 	lastErrorCode = errorCode;
 	lastErrorFile = file;
 	lastErrorLine = line;
 	lastErrorDetails = details;
 
-	Log::GetInstance()->Append(GetLastErrorMessage(), Log::errorLevel);
-	Log::GetInstance()->RegisterError(GetLastErrorMessage());
+	string message = GetLastErrorMessage();
+
+	Log::GetInstance()->Append(message, Log::errorLevel);
+	Log::GetInstance()->RegisterError(message);
 
   // Bouml preserved body end 0002EB91
 }
@@ -11,7 +11,7 @@ Event::Event()
 {
   // Bouml preserved body begin 0001FD91
 
-	index = nextIndex++;
+	index = __sync_fetch_and_add(&nextIndex, 1); // events may be created concurrently (e.g. by the workers of a parallel task)
 
   // Bouml preserved body end 0001FD91
 }
@@ -53,6 +53,8 @@ DefaultLPPMOperation::DefaultLPPMOperation(ushort obfuscationLevel, double fakeI
 
 	this->flags = (anonymize == true) ? Anonymization : NoFlags;
 
+	statisticsComputed = false;
+
   // Bouml preserved body end 0003EF11
 }
 
@@ -62,48 +64,59 @@ DefaultLPPMOperation::~DefaultLPPMOperation()
   // Bouml preserved body end 0003EF91
 }
 
-void DefaultLPPMOperation::ObfuscateLocation(ull location, set<ull>& obfucatedSet) const 
+// the obfuscation group of the location is the range [firstLocation; lastLocation] (clipped to the locationstamps range)
+void DefaultLPPMOperation::ObfuscateLocation(ull location, ull* firstLocation, ull* lastLocation) const 
 {
   // Bouml preserved body begin 00050711
 
+	VERIFY(firstLocation != NULL && lastLocation != NULL);
+
 	ull minLoc = 0; ull maxLoc = 0;
 	VERIFY(Parameters::GetInstance()->GetLocationstampsRange(&minLoc, &maxLoc) == true);
+	VERIFY(location >= minLoc && location <= maxLoc);
 
-	obfucatedSet.clear();
 	ull numObf = (ull)pow(2, obfuscationLevel);
 
-	ull firstObfLoc = location - ((location - minLoc) % numObf);
-	for(ull i = 0; i < numObf; i++)
-	{
-		ull obf = firstObfLoc + i;
-
-		if(obf >= minLoc && obf <= maxLoc)
-		{
-			obfucatedSet.insert(obf);
-		}
-	}
+	*firstLocation = location - ((location - minLoc) % numObf);
+	*lastLocation = MIN(*firstLocation + (numObf - 1), maxLoc);
 
-	VERIFY(obfuscationLevel != 0 || (obfuscationLevel == 0 && obfucatedSet.size() == 1 && firstObfLoc == location));
+	VERIFY(obfuscationLevel != 0 || (obfuscationLevel == 0 && *firstLocation == location && *lastLocation == location));
 
   // Bouml preserved body end 00050711
 }
 
-void DefaultLPPMOperation::ComputeGeneralStatistics(ull tp, double** avg) const 
+// computes the general statistics tables of the context (if they are not computed yet)
+void DefaultLPPMOperation::ComputeGeneralStatistics() const 
 {
   // Bouml preserved body begin 00050791
 
-	VERIFY(avg != NULL);
+	if(statisticsComputed == true) { __sync_synchronize(); return; }
+
+	ScopedLock lock(statisticsMutex);
+
+	if(statisticsComputed == true) { return; } // computed by another thread in the meantime
+
+	VERIFY(context != NULL);
 
 	ull minLoc = 0; ull maxLoc = 0;
 	VERIFY(Parameters::GetInstance()->GetLocationstampsRange(&minLoc, &maxLoc) == true);
 	ull numLoc = (maxLoc - minLoc + 1);
 
+	ull numPeriods = 0; TPInfo tpInfo;
+	VERIFY(Parameters::GetInstance()->GetTimePeriodInfo(&numPeriods, &tpInfo) == true);
+	ull minPeriod = tpInfo.minPeriod;
+
+	ull numObf = (ull)pow(2, obfuscationLevel);
+	ull numGroups = (numLoc + numObf - 1) / numObf;
+
 	map<ull, UserProfile*> profiles = map<ull, UserProfile*>();
 	VERIFY(context->GetProfiles(profiles) == true);
+	ull profileCount = profiles.size();
+	VERIFY(profileCount != 0);
 
-	ull sizeInBytes = numLoc * sizeof(double);
-	double* tmp = *avg = (double*)Allocate(sizeInBytes);
-	memset(tmp, 0, sizeInBytes);
+	generalStatistics = vector<double>(numPeriods * numLoc, 0.0);
+	groupStatistics = vector<double>(numPeriods * numGroups, 0.0);
+	fakeLocationTables = vector<AliasTable>(numPeriods);
 
 	// for each user
 	pair_foreach_const(map<ull, UserProfile*>, profiles, iter)
@@ -114,26 +127,34 @@ void DefaultLPPMOperation::ComputeGeneralStatistics(ull tp, double** avg) const
 		double* steadyStateVector = NULL;
 		VERIFY(profile->GetSteadyStateVector(&steadyStateVector) == true);
 
-		// get the proper sub-chain steady-state vector according to the time period of the event
-		double* subChainSteadyStateVector = NULL;
-		VERIFY(Algorithms::GetSteadyStateVectorOfSubChain(steadyStateVector, tp, &subChainSteadyStateVector) == true);
-
-		for(ull loc = minLoc; loc <= maxLoc; loc++)
+		for(ull tpIndex = 0; tpIndex < numPeriods; tpIndex++)
 		{
-			ull locIndex = loc - minLoc;
-			tmp[locIndex] += subChainSteadyStateVector[locIndex];
-		}
+			// get the proper sub-chain steady-state vector according to the time period
+			double* subChainSteadyStateVector = NULL;
+			VERIFY(Algorithms::GetSteadyStateVectorOfSubChain(steadyStateVector, minPeriod + tpIndex, &subChainSteadyStateVector) == true);
+
+			double* avg = &generalStatistics[GET_INDEX(tpIndex, 0, numLoc)];
+			for(ull locIndex = 0; locIndex < numLoc; locIndex++) { avg[locIndex] += subChainSteadyStateVector[locIndex]; }
 
-		Free(subChainSteadyStateVector); // free the sub-chain steady-state vector
+			Free(subChainSteadyStateVector); // free the sub-chain steady-state vector
+		}
 	}
 
-	// normalization
-	ull profileCount = profiles.size();
-	for(ull loc = minLoc; loc <= maxLoc; loc++)
+	for(ull tpIndex = 0; tpIndex < numPeriods; tpIndex++)
 	{
-		tmp[loc - minLoc] /= (double)profileCount;
+		// normalization
+		double* avg = &generalStatistics[GET_INDEX(tpIndex, 0, numLoc)];
+		for(ull locIndex = 0; locIndex < numLoc; locIndex++) { avg[locIndex] /= (double)profileCount; }
+
+		// sums over the obfuscation groups (in increasing order of locations)
+		for(ull locIndex = 0; locIndex < numLoc; locIndex++) { groupStatistics[GET_INDEX(tpIndex, locIndex / numObf, numGroups)] += avg[locIndex]; }
+
+		VERIFY(fakeLocationTables[tpIndex].Build(avg, numLoc) == true);
 	}
 
+	__sync_synchronize();
+	statisticsComputed = true; // publish
+
   // Bouml preserved body end 00050791
 }
 
@@ -158,7 +179,6 @@ bool DefaultLPPMOperation::Filter(const Context* context, const ActualEvent* inE
 
 	ull minLoc = 0; ull maxLoc = 0;
 	VERIFY(Parameters::GetInstance()->GetLocationstampsRange(&minLoc, &maxLoc) == true);
-	ull numLoc = (maxLoc - minLoc + 1);
 
 	ull location = inEvent->GetLocationstamp();
 
@@ -185,7 +205,6 @@ bool DefaultLPPMOperation::Filter(const Context* context, const ActualEvent* inE
 				break;
 			case GeneralStatisticsSelection:
 				{
-					double* avg = NULL;
 					ull tp = Parameters::GetInstance()->LookupTimePeriod(timestamp);
 					if(tp == INVALID_TIME_PERIOD)
 					{
@@ -193,11 +212,12 @@ bool DefaultLPPMOperation::Filter(const Context* context, const ActualEvent* inE
 						return false;
 					}
 
-					ComputeGeneralStatistics(tp, &avg);
+					ComputeGeneralStatistics();
 
-					fakeLocation = minLoc + RNG::GetInstance()->SampleIndexFromVector(avg, numLoc);
+					ull numPeriods = 0; TPInfo tpInfo;
+					VERIFY(Parameters::GetInstance()->GetTimePeriodInfo(&numPeriods, &tpInfo) == true);
 
-					Free(avg); // Free
+					fakeLocation = minLoc + fakeLocationTables[tp - tpInfo.minPeriod].Sample();
 
 					VERIFY(fakeLocation >= minLoc && fakeLocation <= maxLoc);
 				}
@@ -216,18 +236,17 @@ bool DefaultLPPMOperation::Filter(const Context* context, const ActualEvent* inE
 	}
 
 	// location obfuscation
-	set<ull> obfucatedLocations = set<ull>();
-	ObfuscateLocation(location, obfucatedLocations);
+	ull firstObfLoc = 0; ull lastObfLoc = 0;
+	ObfuscateLocation(location, &firstObfLoc, &lastObfLoc);
 
 	//stringstream info("");
 	//info << "Obs: " << nym << ", " << timestamp << ", {";
 
-	foreach_const(set<ull>, obfucatedLocations, iter)
+	for(ull obf = firstObfLoc; obf <= lastObfLoc; obf++)
 	{
-		event->AddLocationstamp(*iter);
-		//info << *iter << ", ";
+		event->AddLocationstamp(obf);
+		//info << obf << ", ";
 	}
-	obfucatedLocations.clear();
 
 	//info << "}, " << ((inEvent->GetType() == Actual) ? 0 : 1);
 	//Log::GetInstance()->Append(info.str());
@@ -265,64 +284,44 @@ double DefaultLPPMOperation::PDF(const Context* context, const ActualEvent* inEv
 	{
 		if(inEvent->GetType() == Actual) { return 1.0 - fakeInjectionProbability; }
 		else if(inEvent->GetType() == Exposed) { return hidingProbability; }
+
+		return 0.0;
 	}
 
+	// the locationstamps (sorted) must be exactly an obfuscation group
+	ull min = *(locs.begin()); ull max = *(locs.rbegin());
 
 	if(inEvent->GetType() == Exposed)
 	{
-		ull trueLocation = inEvent->GetLocationstamp();
-		set<ull> locations = set<ull>();
+		ull firstObfLoc = 0; ull lastObfLoc = 0;
+		ObfuscateLocation(inEvent->GetLocationstamp(), &firstObfLoc, &lastObfLoc);
 
-		outEvent->GetLocationstamps(locations);
-
-		set<ull> obfuscatedLocations = set<ull>();
-		ObfuscateLocation(trueLocation, obfuscatedLocations);
-
-		if(locations.size() != obfuscatedLocations.size()) { return 0.0; }
-
-		foreach_const(set<ull>, locations, iter)
-		{
-			ull loc = *iter;
-
-			if(obfuscatedLocations.find(loc) == obfuscatedLocations.end()) { return 0.0; }
-		}
+		if(min != firstObfLoc || max != lastObfLoc || locs.size() != (lastObfLoc - firstObfLoc + 1)) { return 0.0; }
 
 		return 1.0 - hidingProbability;
 	}
 
-	// event is Actual
-	set<ull> locationstamps = set<ull>();
-	outEvent->GetLocationstamps(locationstamps);
-
-	// check that locationstamps is valid according to obfucationLevel
+	// event is Actual: check that the locationstamps are valid according to obfucationLevel
 	ull numObf = (ull)pow(2, obfuscationLevel);
-	ull min = 0; ull max = 0;
-	foreach_const(set<ull>, locationstamps, iter)
-	{
-		if(min == 0) { min = max = *iter; }
-		if(*iter < min) { min = *iter; }
-		if(*iter > max) { max = *iter; }
-	}
 
 	// continuity check
-	if(min + (locationstamps.size() - 1) != max) { return 0.0; }
+	if(min + (locs.size() - 1) != max) { return 0.0; }
 
 	if(((min - minLoc)  % numObf) != 0 && min != minLoc) { return 0.0; }
 
 	if((((max - minLoc) + 1) % numObf) != 0 && max != maxLoc) { return 0.0; }
 
-	if(locationstamps.size() > numObf) { return 0.0; }
+	if(locs.size() > numObf) { return 0.0; }
 
 	switch(fakeInjectionAlgorithm)
 	{
 		case UniformSelection:
 			{
-				return fakeInjectionProbability * ((double)locationstamps.size() / (double)numLoc);
+				return fakeInjectionProbability * ((double)locs.size() / (double)numLoc);
 			}
 			break;
 		case GeneralStatisticsSelection:
 			{
-				double* avg = NULL;
 				ull tp = Parameters::GetInstance()->LookupTimePeriod(trueTimestamp);
 				if(tp == INVALID_TIME_PERIOD)
 				{
@@ -330,17 +329,14 @@ double DefaultLPPMOperation::PDF(const Context* context, const ActualEvent* inEv
 					return false;
 				}
 
-				ComputeGeneralStatistics(tp, &avg);
+				ComputeGeneralStatistics();
 
-				double sum = 0.0;
-				foreach_const(set<ull>, locationstamps, iter)
-				{
-					ull loc = *iter;
-					sum += avg[loc - minLoc];
-				}
-				Free(avg);
+				ull numPeriods = 0; TPInfo tpInfo;
+				VERIFY(Parameters::GetInstance()->GetTimePeriodInfo(&numPeriods, &tpInfo) == true);
 
-				return fakeInjectionProbability * sum;
+				// the locationstamps are the obfuscation group of min
+				ull numGroups = (numLoc + numObf - 1) / numObf;
+				return fakeInjectionProbability * groupStatistics[GET_INDEX(tp - tpInfo.minPeriod, (min - minLoc) / numObf, numGroups)];
 			}
 			break;
 		default:
@@ -352,6 +348,31 @@ double DefaultLPPMOperation::PDF(const Context* context, const ActualEvent* inEv
   // Bouml preserved body end 00042591
 }
 
+//!
+//! \brief Sets the context (background knowledge of the adversary)
+//!
+//! \note The general statistics of the previous context (if any) are discarded.
+//!
+//! \param[in] newContext 	Context*, the new context
+//!
+//! \return nothing
+//!
+void DefaultLPPMOperation::SetContext(Context* newContext) 
+{
+  // Bouml preserved body begin 000E5091
+
+	FilterOperation::SetContext(newContext);
+
+	ScopedLock lock(statisticsMutex);
+
+	statisticsComputed = false; // recomputed at first use
+	generalStatistics.clear();
+	groupStatistics.clear();
+	fakeLocationTables.clear();
+
+  // Bouml preserved body end 000E5091
+}
+
 string DefaultLPPMOperation::GetDetailString() 
 {
   // Bouml preserved body begin 00095E11
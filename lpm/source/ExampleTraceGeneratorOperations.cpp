@@ -59,7 +59,7 @@ bool KnowledgeSamplingTraceGeneratorOperation::Execute(const TraceGeneratorInput
 
 	OutputOperation* outputOperation = new OutputOperation();
 
-	bool success = outputOperation->Execute(traces, output);
+	bool success = outputOperation->TimedExecute(traces, output);
 
 	outputOperation->Release();
 	traces->Release();
@@ -69,6 +69,18 @@ bool KnowledgeSamplingTraceGeneratorOperation::Execute(const TraceGeneratorInput
   // Bouml preserved body end 00096211
 }
 
+//!
+//! \brief Generates a trace of the user of the given profile and adds it to the given trace set
+//!
+//! \note The rows of the steady-state vector and of the transition matrix which are sampled are turned into alias tables the first
+//! time they are needed, and kept by the operation (for each user) for the next traces, so that a trace costs O(T) once the tables
+//! are built. The tables of a user are rebuilt if its profile (i.e. its steady-state vector or its transition matrix) changes.
+//!
+//! \param[in] profile 	const UserProfile*, the profile of the user.
+//! \param[in,out] traces 	TraceSet*, the trace set to which the events of the trace are added.
+//!
+//! \return true or false, depending on whether the call is successful
+//!
 bool KnowledgeSamplingTraceGeneratorOperation::GenerateUserTrace(const UserProfile* profile, TraceSet* traces) 
 {
   // Bouml preserved body begin 00096911
@@ -93,41 +105,59 @@ bool KnowledgeSamplingTraceGeneratorOperation::GenerateUserTrace(const UserProfi
 	VERIFY(transitionMatrix != NULL);
 
 
+	// the sampling tables are built lazily (the first time a row is needed) and kept for the next traces of the user,
+	// so that each step only costs a (constant time) alias table lookup
+	SamplingTables& tables = samplingTables[user];
+	if(tables.steadyStateVector != steadyStateVector || tables.transitionMatrix != transitionMatrix) // new (or changed) profile
+	{
+		tables.steadyStateVector = steadyStateVector;
+		tables.transitionMatrix = transitionMatrix;
+		tables.steadyStateTables.clear();
+		tables.transitionTables.clear();
+	}
+
+	RNG* rng = RNG::GetInstance();
+	RNGStream stream = rng->CreateStream();
+
 	// sample the trace from the markov chain
 	ull prevLoc = minLoc;
+	ull prevtp = INVALID_TIME_PERIOD;
 	for(ull tm = minTime; tm <= maxTime; tm++)
 	{
 		ull nextLoc = minLoc;
 
+		ull tp = Parameters::GetInstance()->LookupTimePeriod(tm);
+		if(tp == INVALID_TIME_PERIOD)
+		{
+			SET_ERROR_CODE(ERROR_CODE_INCONSISTENT_TIME_PARTITIONING_USAGE);
+			return false;
+		}
+
 		if(tm == minTime || usePiOnly == true) // use the steady state vector
 		{
-			ull tp = Parameters::GetInstance()->LookupTimePeriod(tm);
-			if(tp == INVALID_TIME_PERIOD)
+			AliasTable& table = tables.steadyStateTables[tp];
+			if(table.GetLength() == 0)
 			{
-				SET_ERROR_CODE(ERROR_CODE_INCONSISTENT_TIME_PARTITIONING_USAGE);
-				return false;
+				double* subChainSteadyStateVector = NULL;
+				VERIFY(Algorithms::GetSteadyStateVectorOfSubChain(steadyStateVector, tp, &subChainSteadyStateVector) == true);
+				VERIFY(table.Build(subChainSteadyStateVector, numLoc) == true);
+				Free(subChainSteadyStateVector);
 			}
 
-			double* subChainSteadyStateVector = NULL;
-			VERIFY(Algorithms::GetSteadyStateVectorOfSubChain(steadyStateVector, tp, &subChainSteadyStateVector) == true);
-			nextLoc = minLoc + RNG::GetInstance()->SampleIndexFromVector(subChainSteadyStateVector, numLoc);
-			Free(subChainSteadyStateVector);
+			nextLoc = minLoc + table.Sample(&stream);
 		}
 		else // use the transition matrix
 		{
-			ull tp1 = Parameters::GetInstance()->LookupTimePeriod(tm - 1);
-			ull tp2 = Parameters::GetInstance()->LookupTimePeriod(tm);
-
-			if(tp1 == INVALID_TIME_PERIOD || tp2 == INVALID_TIME_PERIOD)
+			AliasTable& table = tables.transitionTables[make_pair(make_pair(prevtp, tp), prevLoc)];
+			if(table.GetLength() == 0)
 			{
-				SET_ERROR_CODE(ERROR_CODE_INCONSISTENT_TIME_PARTITIONING_USAGE);
-				return false;
+				double* transitionVector = NULL;
+				VERIFY(Algorithms::GetTransitionVectorOfSubChain(transitionMatrix, prevtp, prevLoc, tp, &transitionVector) == true);
+				VERIFY(table.Build(transitionVector, numLoc) == true);
+				Free(transitionVector);
 			}
 
-			double* transitionVector = NULL;
-			VERIFY(Algorithms::GetTransitionVectorOfSubChain(transitionMatrix, tp1, prevLoc, tp2, &transitionVector) == true);
-			nextLoc = minLoc + RNG::GetInstance()->SampleIndexFromVector(transitionVector, numLoc);
-			Free(transitionVector);
+			nextLoc = minLoc + table.Sample(&stream);
 		}
 
 		ActualEvent* actualEvent = new ActualEvent(user, tm, nextLoc);
@@ -135,6 +165,7 @@ bool KnowledgeSamplingTraceGeneratorOperation::GenerateUserTrace(const UserProfi
 		actualEvent->Release(); // release ownership
 
 		prevLoc = nextLoc;
+		prevtp = tp;
 	}
 
 	return true;
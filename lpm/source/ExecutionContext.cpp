@@ -0,0 +1,180 @@
+//!
+//! \file
+//!
+#include "../include/ExecutionContext.h"
+#include "../include/Parameters.h"
+#include "../include/Errors.h"
+#include "../include/Log.h"
+
+namespace lpm {
+
+// context active on the calling thread (see ExecutionContext::SetCurrent())
+static __thread ExecutionContext* currentContext = NULL;
+
+//!
+//! \brief Creates a context from the current one
+//!
+//! The parameters are a copy of the current parameters (those of the active context, or the global ones), the error state is empty,
+//! the RNG stream is a new stream of the current RNG (see RNG::CreateStream()), and the global log is used (see SetLog()).
+//!
+//! \note The time partitioning is shared with the current parameters, which should not change it while the context is in use.
+//!
+ExecutionContext::ExecutionContext()
+{
+  // Bouml preserved body begin 000E3D11
+
+	parameters = new Parameters();
+	VERIFY(parameters->CopyFrom(Parameters::GetInstance()) == true);
+
+	errors = new Errors();
+	log = NULL;
+
+	stream = RNG::GetInstance()->CreateStream();
+
+  // Bouml preserved body end 000E3D11
+}
+
+ExecutionContext::~ExecutionContext()
+{
+  // Bouml preserved body begin 000E3D91
+
+	DEBUG_VERIFY(currentContext != this);
+
+	delete parameters;
+	delete errors;
+	if(log != NULL) { delete log; }
+
+  // Bouml preserved body end 000E3D91
+}
+
+//!
+//! \brief Returns the parameters of the context
+//!
+//! \return Parameters*, the parameters (owned by the context)
+//!
+Parameters* ExecutionContext::GetParameters() const
+{
+  // Bouml preserved body begin 000E3E11
+
+	return parameters;
+
+  // Bouml preserved body end 000E3E11
+}
+
+//!
+//! \brief Returns the error state of the context
+//!
+//! \return Errors*, the error state (owned by the context)
+//!
+Errors* ExecutionContext::GetErrors() const
+{
+  // Bouml preserved body begin 000E3E91
+
+	return errors;
+
+  // Bouml preserved body end 000E3E91
+}
+
+//!
+//! \brief Returns the RNG stream of the context
+//!
+//! \return RNGStream*, the stream (owned by the context)
+//!
+RNGStream* ExecutionContext::GetStream()
+{
+  // Bouml preserved body begin 000E3F11
+
+	return &stream;
+
+  // Bouml preserved body end 000E3F11
+}
+
+//!
+//! \brief Sets the log sink of the context
+//!
+//! \param[in] log 	Log*, the log (the context takes ownership of it), or NULL to use the global log.
+//!
+//! \return nothing
+//!
+void ExecutionContext::SetLog(Log* log)
+{
+  // Bouml preserved body begin 000E3F91
+
+	if(this->log != NULL && this->log != log) { delete this->log; }
+
+	this->log = log;
+
+  // Bouml preserved body end 000E3F91
+}
+
+//!
+//! \brief Returns the log sink of the context
+//!
+//! \return Log*, the log of the context (NULL if the global log is used)
+//!
+Log* ExecutionContext::GetLog() const
+{
+  // Bouml preserved body begin 000E4011
+
+	return log;
+
+  // Bouml preserved body end 000E4011
+}
+
+//!
+//! \brief Returns the context active on the calling thread
+//!
+//! \return ExecutionContext*, the active context (NULL if none, i.e. the global objects are used)
+//!
+ExecutionContext* ExecutionContext::GetCurrent()
+{
+  // Bouml preserved body begin 000E4091
+
+	return currentContext;
+
+  // Bouml preserved body end 000E4091
+}
+
+//!
+//! \brief Sets the context active on the calling thread
+//!
+//! \note Unlike ScopedExecutionContext, this does not change the RNG stream of the thread (e.g. for workers sharing the context of a caller).
+//!
+//! \param[in] context 	ExecutionContext*, the context (NULL for the global objects).
+//!
+//! \return ExecutionContext*, the context previously active on the calling thread
+//!
+ExecutionContext* ExecutionContext::SetCurrent(ExecutionContext* context)
+{
+  // Bouml preserved body begin 000E4111
+
+	ExecutionContext* previousContext = currentContext;
+	currentContext = context;
+
+	return previousContext;
+
+  // Bouml preserved body end 000E4111
+}
+
+ScopedExecutionContext::ScopedExecutionContext(ExecutionContext* context)
+{
+  // Bouml preserved body begin 000E4191
+
+	previousContext = ExecutionContext::SetCurrent(context);
+	previousStream = RNG::GetInstance()->SetThreadStream(context != NULL ? context->GetStream() : NULL);
+
+  // Bouml preserved body end 000E4191
+}
+
+ScopedExecutionContext::~ScopedExecutionContext()
+{
+  // Bouml preserved body begin 000E4211
+
+	RNG::GetInstance()->SetThreadStream(previousStream);
+	ExecutionContext::SetCurrent(previousContext);
+
+  // Bouml preserved body end 000E4211
+}
+
+
+} // namespace lpm
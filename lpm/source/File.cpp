@@ -2,6 +2,7 @@
 //! \file
 //!
 #include "../include/File.h"
+#include "../include/Instrumentation.h"
 
 namespace lpm {
 
@@ -116,6 +117,8 @@ bool File::ReadNextLine(string& line) const
 
 	getline(GetStream(), line);
 
+	Instrumentation::GetInstance()->AddToCounter(BytesReadCounter, line.length() + 1); // + 1 for the end of line
+
 	ull lastPos = line.length() - 1;
 	if(line.empty() == false && line.at(lastPos) == '\r')
 	{
@@ -158,6 +161,8 @@ bool File::WriteLine(string line) const
 
 	GetStream() << line << endl;
 
+	Instrumentation::GetInstance()->AddToCounter(BytesWrittenCounter, line.length() + 1);
+
 	return true;
 
   // Bouml preserved body end 00081C11
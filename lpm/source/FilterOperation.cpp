@@ -4,6 +4,7 @@
 #include "../include/FilterOperation.h"
 #include "../include/Context.h"
 #include "../include/Event.h"
+#include "../include/Instrumentation.h"
 
 namespace lpm {
 
@@ -49,6 +50,8 @@ bool FilterOperation::Execute(const TraceSet* input, TraceSet* output)
 		vector<Event*> events = vector<Event*>();
 		trace->GetEvents(events);
 
+		Instrumentation::GetInstance()->AddToCounter(EventsProcessedCounter, events.size());
+
 		foreach_const(vector<Event*>, events, iter)
 		{
 			Event* inEvent = *iter;
@@ -84,9 +87,13 @@ void FilterOperation::SetContext(Context* newContext)
 {
   // Bouml preserved body begin 00047991
 
+	Context* previousContext = context;
+
 	context = newContext;
 	context->AddRef();
 
+	if(previousContext != NULL) { previousContext->Release(); } // the operation may be run successively with different contexts
+
   // Bouml preserved body end 00047991
 }
 
@@ -3,6 +3,7 @@
 //!
 #include "../include/InputOperation.h"
 #include "../include/Event.h"
+#include "../include/Instrumentation.h"
 
 namespace lpm {
 
@@ -54,6 +55,7 @@ bool InputOperation::Execute(const File* input, TraceSet* output)
 			CODING_ERROR; break;
 	}
 
+	ull eventsCount = 0;
 	while(input->IsEOF() == false)
 	{
 		Event* event = NULL;
@@ -109,10 +111,13 @@ bool InputOperation::Execute(const File* input, TraceSet* output)
 		}
 
 		const_cast<InputOperation*>(this)->UpdateInputInfo(event);
+		eventsCount++;
 
 		event->Release();
 	}
 
+	Instrumentation::GetInstance()->AddToCounter(EventsReadCounter, eventsCount);
+
 	if(outputTraceSet->IsEmpty() == true)
 	{
 		SET_ERROR_CODE(ERROR_CODE_EMPTY_TRACE);
@@ -0,0 +1,469 @@
+//!
+//! \file
+//!
+#include "../include/Instrumentation.h"
+#include "../include/Memory.h"
+
+#include <time.h>
+#include <unistd.h>
+#include <iomanip>
+
+// granularity (in microseconds) at which the snapshot thread checks whether it should write a snapshot or stop
+#define INSTRUMENTATION_POLL_MICROSECONDS 100000
+
+namespace lpm {
+
+Instrumentation::Instrumentation()
+{
+  // Bouml preserved body begin 000E2F91
+
+	enabled = false;
+	timers = map<string, TimerStatistics>();
+	for(ull i = 0; i < InstrumentationCountersCount; i++) { counters[i] = 0; }
+
+	outputFormat = JSONInstrumentationFormat;
+	snapshotInterval = 0;
+	snapshotsCount = 0;
+	startTime = GetTime();
+
+	threadRunning = false;
+	stopRequested = false;
+	atExitRegistered = false;
+
+  // Bouml preserved body end 000E2F91
+}
+
+Instrumentation::~Instrumentation()
+{
+  // Bouml preserved body begin 000E3011
+
+	Stop();
+
+	timers.clear();
+
+  // Bouml preserved body end 000E3011
+}
+
+//!
+//! \brief Enables/Disables the instrumentation
+//!
+//! \param[in] state 	bool determining whether to enable or disable the recording of timings and counters.
+//!
+//! \return nothing
+//!
+void Instrumentation::SetEnabled(bool state)
+{
+  // Bouml preserved body begin 000E3091
+
+	enabled = state;
+
+  // Bouml preserved body end 000E3091
+}
+
+//!
+//! \brief Returns whether the instrumentation is enabled
+//!
+//! \return true if it is enabled, false otherwise
+//!
+bool Instrumentation::IsEnabled() const
+{
+  // Bouml preserved body begin 000E3111
+
+	return enabled;
+
+  // Bouml preserved body end 000E3111
+}
+
+//!
+//! \brief Sets the file to which the snapshots are written (and enables the instrumentation)
+//!
+//! The file is truncated and each snapshot is appended to it.
+//!
+//! \param[in] filePath 	string, the path of the output file.
+//! \param[in] format 	InstrumentationFormat, the format of the snapshots.
+//! \param[in] intervalSeconds 	ull, the number of seconds between two periodic snapshots (0 to only write a snapshot at exit).
+//!
+//! \return true if the file could be opened, false otherwise
+//!
+bool Instrumentation::SetOutput(string filePath, InstrumentationFormat format, ull intervalSeconds)
+{
+  // Bouml preserved body begin 000E3191
+
+	// stop the thread of the previous output (if any)
+	if(threadRunning == true)
+	{
+		stopRequested = true;
+		pthread_join(snapshotThread, NULL);
+		threadRunning = false;
+		stopRequested = false;
+	}
+
+	{
+		ScopedLock lock(mutex);
+
+		if(outputFile.is_open() == true) { outputFile.close(); }
+
+		outputFile.open(filePath.c_str(), ofstream::out | ofstream::trunc);
+		if(outputFile.is_open() == false) { return false; }
+
+		outputFormat = format;
+		snapshotInterval = intervalSeconds;
+		snapshotsCount = 0;
+	}
+
+	enabled = true;
+
+	if(atExitRegistered == false)
+	{
+		// make sure the other singletons used by the last snapshot exist before the handler is registered
+		Memory::GetInstance();
+
+		atexit(StopAtExit);
+		atExitRegistered = true;
+	}
+
+	if(intervalSeconds != 0)
+	{
+		if(pthread_create(&snapshotThread, NULL, RunSnapshotThread, this) == 0) { threadRunning = true; }
+	}
+
+	return true;
+
+  // Bouml preserved body end 000E3191
+}
+
+//!
+//! \brief Records the given duration under the timer \a name
+//!
+//! \param[in] name 	string, the name of the timer.
+//! \param[in] seconds 	double, the duration.
+//!
+//! \return nothing
+//!
+void Instrumentation::AddTime(const string& name, double seconds)
+{
+  // Bouml preserved body begin 000E3211
+
+	if(enabled == false) { return; }
+
+	ScopedLock lock(mutex);
+
+	map<string, TimerStatistics>::iterator iter = timers.find(name);
+	if(iter == timers.end())
+	{
+		TimerStatistics statistics;
+		statistics.count = 0; statistics.seconds = 0.0; statistics.maxSeconds = 0.0;
+
+		iter = timers.insert(pair<string, TimerStatistics>(name, statistics)).first;
+	}
+
+	TimerStatistics& statistics = iter->second;
+	statistics.count++;
+	statistics.seconds += seconds;
+	if(seconds > statistics.maxSeconds) { statistics.maxSeconds = seconds; }
+
+  // Bouml preserved body end 000E3211
+}
+
+//!
+//! \brief Adds the given value to a counter
+//!
+//! \param[in] counter 	InstrumentationCounter, the counter.
+//! \param[in] value 	ull, the value to add.
+//!
+//! \return nothing
+//!
+void Instrumentation::AddToCounter(InstrumentationCounter counter, ull value)
+{
+  // Bouml preserved body begin 000E3291
+
+	if(enabled == false) { return; }
+
+	DEBUG_VERIFY(counter < InstrumentationCountersCount);
+
+	__sync_fetch_and_add(&counters[counter], value);
+
+  // Bouml preserved body end 000E3291
+}
+
+//!
+//! \brief Returns the value of a counter
+//!
+//! \param[in] counter 	InstrumentationCounter, the counter.
+//!
+//! \return the value of the counter
+//!
+ull Instrumentation::GetCounter(InstrumentationCounter counter) const
+{
+  // Bouml preserved body begin 000E3311
+
+	VERIFY(counter < InstrumentationCountersCount);
+
+	return counters[counter];
+
+  // Bouml preserved body end 000E3311
+}
+
+//!
+//! \brief Returns the statistics of the timer \a name
+//!
+//! \param[in] name 	string, the name of the timer.
+//! \param[out] count 	ull*, the number of recorded durations (ignored if NULL).
+//! \param[out] seconds 	double*, the sum of the recorded durations (ignored if NULL).
+//!
+//! \return true if the timer exists, false otherwise
+//!
+bool Instrumentation::GetTimer(const string& name, ull* count, double* seconds) const
+{
+  // Bouml preserved body begin 000E3391
+
+	ScopedLock lock(mutex);
+
+	map<string, TimerStatistics>::const_iterator iter = timers.find(name);
+	if(iter == timers.end()) { return false; }
+
+	if(count != NULL) { *count = iter->second.count; }
+	if(seconds != NULL) { *seconds = iter->second.seconds; }
+
+	return true;
+
+  // Bouml preserved body end 000E3391
+}
+
+//!
+//! \brief Writes a snapshot of the timers and counters to the output file
+//!
+//! \return true if the snapshot was written, false otherwise (e.g. if no output is set)
+//!
+bool Instrumentation::WriteSnapshot()
+{
+  // Bouml preserved body begin 000E3411
+
+	ull allocations = 0; ull allocatedBytes = 0;
+	Memory::GetInstance()->GetAllocationStatistics(&allocations, &allocatedBytes);
+
+	ScopedLock lock(mutex);
+
+	if(outputFile.is_open() == false) { return false; }
+
+	snapshotsCount++;
+	double elapsed = GetTime() - startTime;
+
+	// counters (including the allocation statistics of Memory)
+	typedef vector<pair<string, ull> > CounterValues;
+	CounterValues values = CounterValues();
+	for(ull i = 0; i < InstrumentationCountersCount; i++)
+	{
+		InstrumentationCounter counter = (InstrumentationCounter)i;
+		values.push_back(pair<string, ull>(GetCounterName(counter), counters[counter]));
+	}
+	values.push_back(pair<string, ull>("allocations", allocations));
+	values.push_back(pair<string, ull>("allocated bytes", allocatedBytes));
+
+	stringstream ss("");
+	ss << fixed << setprecision(6);
+
+	if(outputFormat == JSONInstrumentationFormat)
+	{
+		ss << "{\"snapshot\": " << snapshotsCount << ", \"elapsed\": " << elapsed << ", \"timers\": {";
+
+		bool first = true;
+		pair_foreach_const(map<string, TimerStatistics>, timers, iter)
+		{
+			if(first == false) { ss << ", "; }
+			first = false;
+
+			ss << "\"" << EscapeString(iter->first, outputFormat) << "\": {\"count\": " << iter->second.count;
+			ss << ", \"seconds\": " << iter->second.seconds << ", \"max\": " << iter->second.maxSeconds << "}";
+		}
+
+		ss << "}, \"counters\": {";
+
+		first = true;
+		foreach_const(CounterValues, values, iter)
+		{
+			if(first == false) { ss << ", "; }
+			first = false;
+
+			ss << "\"" << iter->first << "\": " << iter->second;
+		}
+
+		ss << "}}" << endl;
+	}
+	else
+	{
+		if(snapshotsCount == 1) { ss << "snapshot,elapsed,type,name,count,value" << endl; }
+
+		pair_foreach_const(map<string, TimerStatistics>, timers, iter)
+		{
+			ss << snapshotsCount << "," << elapsed << ",timer," << EscapeString(iter->first, outputFormat) << ",";
+			ss << iter->second.count << "," << iter->second.seconds << endl;
+		}
+
+		foreach_const(CounterValues, values, iter)
+		{
+			ss << snapshotsCount << "," << elapsed << ",counter," << EscapeString(iter->first, outputFormat) << ",," << iter->second << endl;
+		}
+	}
+
+	outputFile << ss.str();
+	outputFile.flush();
+
+	return outputFile.good();
+
+  // Bouml preserved body end 000E3411
+}
+
+//!
+//! \brief Stops the periodic snapshots and writes a last snapshot
+//!
+//! \note This is called automatically when the program exits.
+//!
+//! \return nothing
+//!
+void Instrumentation::Stop()
+{
+  // Bouml preserved body begin 000E3491
+
+	if(threadRunning == true)
+	{
+		stopRequested = true;
+		pthread_join(snapshotThread, NULL);
+		threadRunning = false;
+		stopRequested = false;
+	}
+
+	if(outputFile.is_open() == false) { return; }
+
+	WriteSnapshot();
+
+	ScopedLock lock(mutex);
+	outputFile.close();
+
+  // Bouml preserved body end 000E3491
+}
+
+//!
+//! \brief Returns the value of a monotonic high-resolution clock
+//!
+//! \return the time in seconds (relative to an arbitrary origin)
+//!
+double Instrumentation::GetTime()
+{
+  // Bouml preserved body begin 000E3511
+
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return (double)now.tv_sec + (double)now.tv_nsec * 1e-9;
+
+  // Bouml preserved body end 000E3511
+}
+
+void* Instrumentation::RunSnapshotThread(void* arg)
+{
+  // Bouml preserved body begin 000E3591
+
+	Instrumentation* instrumentation = static_cast<Instrumentation*>(arg);
+
+	double lastSnapshot = GetTime();
+	while(instrumentation->stopRequested == false)
+	{
+		usleep(INSTRUMENTATION_POLL_MICROSECONDS);
+
+		if(GetTime() - lastSnapshot >= (double)instrumentation->snapshotInterval)
+		{
+			instrumentation->WriteSnapshot();
+			lastSnapshot = GetTime();
+		}
+	}
+
+	return NULL;
+
+  // Bouml preserved body end 000E3591
+}
+
+void Instrumentation::StopAtExit()
+{
+  // Bouml preserved body begin 000E3611
+
+	Instrumentation::GetInstance()->Stop();
+
+  // Bouml preserved body end 000E3611
+}
+
+string Instrumentation::GetCounterName(InstrumentationCounter counter)
+{
+  // Bouml preserved body begin 000E3691
+
+	switch(counter)
+	{
+		case EventsReadCounter: return "events read";
+		case EventsProcessedCounter: return "events processed";
+		case TrellisCellsCounter: return "trellis cells";
+		case BytesReadCounter: return "bytes read";
+		case BytesWrittenCounter: return "bytes written";
+		case GibbsIterationsCounter: return "gibbs iterations";
+		default: return "unknown";
+	}
+
+  // Bouml preserved body end 000E3691
+}
+
+string Instrumentation::EscapeString(const string& str, InstrumentationFormat format)
+{
+  // Bouml preserved body begin 000E3711
+
+	string escaped = "";
+
+	if(format == JSONInstrumentationFormat)
+	{
+		for(string::const_iterator iter = str.begin(); iter != str.end(); iter++)
+		{
+			if(*iter == '"' || *iter == '\\') { escaped += '\\'; }
+			escaped += *iter;
+		}
+	}
+	else
+	{
+		escaped += '"';
+		for(string::const_iterator iter = str.begin(); iter != str.end(); iter++)
+		{
+			if(*iter == '"') { escaped += '"'; }
+			escaped += *iter;
+		}
+		escaped += '"';
+	}
+
+	return escaped;
+
+  // Bouml preserved body end 000E3711
+}
+
+ScopedTimer::ScopedTimer(const string& name) : timerName()
+{
+  // Bouml preserved body begin 000E3791
+
+	enabled = Instrumentation::GetInstance()->IsEnabled();
+	startTime = 0.0;
+
+	if(enabled == true)
+	{
+		timerName = name;
+		startTime = Instrumentation::GetTime();
+	}
+
+  // Bouml preserved body end 000E3791
+}
+
+ScopedTimer::~ScopedTimer()
+{
+  // Bouml preserved body begin 000E3811
+
+	if(enabled == true) { Instrumentation::GetInstance()->AddTime(timerName, Instrumentation::GetTime() - startTime); }
+
+  // Bouml preserved body end 000E3811
+}
+
+
+} // namespace lpm
@@ -11,6 +11,8 @@
 #include "../include/CreateContextOperation.h"
 #include "../include/ContextAnalysisSchedule.h"
 #include "../include/TraceGeneratorOperation.h"
+#include "../include/Threads.h"
+#include "../include/Instrumentation.h"
 
 namespace lpm {
 
@@ -60,6 +62,8 @@ bool LPM::RunSchedule(const Schedule* schedule, const File* actualTraceFile, con
 {
   // Bouml preserved body begin 0002B311
 
+	ScopedTimer timer("LPM::RunSchedule");
+
 	Log::GetInstance()->Append("Entering LPM::RunSchedule");
 
 	if(schedule == NULL || schedule->IsValid() == false)
@@ -114,6 +118,33 @@ bool LPM::RunSchedule(const Schedule* schedule, const File* actualTraceFile, con
   // Bouml preserved body end 0002B311
 }
 
+// runs the branches of a forked schedule (one branch per index), each on its own copy of the state and with its own random stream
+class LPM::BranchTask : public ParallelTask
+{
+  public:
+	BranchTask(const LPM* lpm, const Schedule* schedule, vector<LPM::State*>* states, vector<RNGStream>* streams)
+		: lpm(lpm), schedule(schedule), states(states), streams(streams), results(states->size(), 0) { }
+
+	virtual void Run(ull index, ull thread)
+	{
+		// the random numbers drawn by a branch do not depend on the other branches running concurrently
+		RNGStream* previousStream = RNG::GetInstance()->SetThreadStream(&((*streams)[index]));
+
+		results[index] = (lpm->RunSubschedule(schedule->branches[index], (*states)[index]) == true) ? 1 : 0;
+
+		RNG::GetInstance()->SetThreadStream(previousStream);
+	}
+
+	bool Succeeded(ull branch) const { return results[branch] != 0; }
+
+  private:
+	const LPM* lpm;
+	const Schedule* schedule;
+	vector<LPM::State*>* states;
+	vector<RNGStream>* streams;
+	vector<int> results; // one entry per branch (not a vector<bool>: threads write distinct entries concurrently)
+};
+
 bool LPM::RunSubschedule(const Schedule* subschedule, LPM::State* state) const 
 {
   // Bouml preserved body begin 00066B91
@@ -174,41 +205,56 @@ bool LPM::RunSubschedule(const Schedule* subschedule, LPM::State* state) const
 			state->anonymizationMap = anonymizationMap;
 			state->sigma = sigma;
 
-			for(ull branch = 0; branch < schedule->branches.size(); branch++)
+			// the branches run concurrently, each on its own copy of the state (with its own output prefix).
+			// The upstream objects (trace sets, context, attack output) are shared read-only, each branch holding a reference to them.
+			ull numBranches = schedule->branches.size();
+			vector<string> branchOutputPrefixes = vector<string>(numBranches);
+			vector<LPM::State*> branchStates = vector<LPM::State*>(numBranches, NULL);
+			vector<RNGStream> branchStreams = vector<RNGStream>();
+
+			for(ull branch = 0; branch < numBranches; branch++)
 			{
 				Schedule* subsched = schedule->branches[branch];
 				VERIFY(subsched != NULL);
 
 				stringstream newOutputPrefix("");
 				newOutputPrefix << outputPrefix << "-branch" << branch;
-				string tmp = newOutputPrefix.str();
-				state->outputPrefix = strdup(tmp.c_str());
+				branchOutputPrefixes[branch] = newOutputPrefix.str();
 
 				if(actualTraceSet != NULL) { actualTraceSet->AddRef(); }
 				if(currentTraceSet != NULL) { currentTraceSet->AddRef(); }
 				if(state->context != NULL) { state->context->AddRef(); }
 				if(state->attackOutput != NULL) { state->attackOutput->AddRef(); }
 
-				ull stateByteSize = sizeof(LPM::State);
-				LPM::State* stateCopy = (LPM::State*)Allocate(stateByteSize);
-				memcpy(stateCopy, state, stateByteSize);
+				LPM::State* stateCopy = new LPM::State(*state); // copy construct (the state holds a map)
+				VERIFY(stateCopy != NULL);
+				stateCopy->outputPrefix = const_cast<char*>(branchOutputPrefixes[branch].c_str());
 
-				if(RunSubschedule(subsched, stateCopy) == false)
+				branchStates[branch] = stateCopy;
+				branchStreams.push_back(RNG::GetInstance()->CreateStream()); // in branches order (for reproducibility)
+			}
+			state->outputPrefix = NULL;
+
+			BranchTask task(this, schedule, &branchStates, &branchStreams);
+			VERIFY(Threads::ParallelFor(numBranches, &task) == true);
+
+			bool success = true;
+			for(ull branch = 0; branch < numBranches; branch++)
+			{
+				delete branchStates[branch];
+
+				if(task.Succeeded(branch) == false)
 				{
-					stringstream ss("LPM::RunSubschedule: Failed while branching (branch ");
-					ss << branch << ")!";
+					stringstream ss("");
+					ss << "LPM::RunSubschedule: Failed while branching (branch " << branch << ")!";
 					Log::GetInstance()->Append(ss.str(), Log::errorLevel);
 
-					Free(stateCopy);
-					free(state->outputPrefix);  // the memory was allocated with strdup
-					state->outputPrefix = NULL;
-					return false;
+					success = false;
 				}
-
-				Free(stateCopy);
-				free(state->outputPrefix); // the memory was allocated with strdup
-				state->outputPrefix = NULL;
 			}
+			branchStates.clear();
+
+			if(success == false) { return false; }
 
 			VERIFY(state->actualTraceSet != NULL && currentTraceSet != NULL && state->context != NULL);
 
@@ -220,6 +266,18 @@ bool LPM::RunSubschedule(const Schedule* subschedule, LPM::State* state) const
 			return true;
 		}
 
+		// stream the users through the remaining stages, if possible
+		if(CanStream(schedule, currentPosition, lppmPDF) == true)
+		{
+			if(RunStreamingStages(schedule, currentPosition, context, actualTraceSet, currentTraceSet, appPDF, lppmPDF, outputPrefix) == false) { return false; }
+
+			if(currentTraceSet != actualTraceSet) { currentTraceSet->Release(); }
+			currentTraceSet = NULL;
+
+			currentPosition = ScheduleEnd;
+			break;
+		}
+
 		switch(currentPosition)
 		{
 			case ScheduleBeforeInputs:
@@ -235,7 +293,7 @@ bool LPM::RunSubschedule(const Schedule* subschedule, LPM::State* state) const
 
 				VERIFY(inputOperation != NULL);
 				state->actualTraceSet = actualTraceSet = currentTraceSet = new TraceSet(ActualTrace);
-				if(inputOperation->Execute(actualTraceFile, actualTraceSet) == false) { return false; } /* the Execute() method sets the error. */
+				if(inputOperation->TimedExecute(actualTraceFile, actualTraceSet) == false) { return false; } /* the Execute() method sets the error. */
 
 				Log::GetInstance()->Append("LPM::RunSchedule: Executed Actual Trace InputOperation::Execute successfully!");
 
@@ -249,7 +307,7 @@ bool LPM::RunSubschedule(const Schedule* subschedule, LPM::State* state) const
 				LoadContextOperation* loadContextOperation = schedule->loadContextOperation;
 				File* contextFile = schedule->contextFile;
 
-				if(loadContextOperation->Execute(contextFile, context) == false) { return false; }
+				if(loadContextOperation->TimedExecute(contextFile, context) == false) { return false; }
 
 				// check that we have a well-defined time partitioning
 				Parameters* params = Parameters::GetInstance();
@@ -302,7 +360,7 @@ bool LPM::RunSubschedule(const Schedule* subschedule, LPM::State* state) const
 					inputOperation = schedule->inputOperation;
 					VERIFY(inputOperation != NULL);
 					currentTraceSet = new TraceSet(type);
-					if(inputOperation->Execute(traceFile, currentTraceSet) == false) { return false; } /* the Execute() method sets the error. */
+					if(inputOperation->TimedExecute(traceFile, currentTraceSet) == false) { return false; } /* the Execute() method sets the error. */
 
 					Log::GetInstance()->Append("LPM::RunSchedule: Executed InputOperation::Execute successfully!");
 
@@ -327,7 +385,7 @@ bool LPM::RunSubschedule(const Schedule* subschedule, LPM::State* state) const
 
 				TraceSet* exposedTraceSet = new TraceSet(ExposedTrace);
 				VERIFY(exposedTraceSet != NULL);
-				if(applicationOperation->Execute(currentTraceSet, exposedTraceSet) == false) { return false; }
+				if(applicationOperation->TimedExecute(currentTraceSet, exposedTraceSet) == false) { return false; }
 
 				Log::GetInstance()->Append("LPM::RunSchedule: Executed ApplicationOperation::Execute successfully!");
 
@@ -350,7 +408,7 @@ bool LPM::RunSubschedule(const Schedule* subschedule, LPM::State* state) const
 
 				TraceSet* observedTraceSet = new TraceSet(ObservedTrace);
 				VERIFY(observedTraceSet != NULL);
-				if(lppmOperation->Execute(currentTraceSet, observedTraceSet) == false) { return false; }
+				if(lppmOperation->TimedExecute(currentTraceSet, observedTraceSet) == false) { return false; }
 
 				Log::GetInstance()->Append("LPM::RunSchedule: Executed LPPMOperation::Execute successfully!");
 
@@ -377,7 +435,7 @@ bool LPM::RunSubschedule(const Schedule* subschedule, LPM::State* state) const
 
 				attackOutput = new AttackOutput();
 				VERIFY(attackOutput != NULL);
-				if(attackOperation->Execute(currentTraceSet, attackOutput) == false) { return false; }
+				if(attackOperation->TimedExecute(currentTraceSet, attackOutput) == false) { return false; }
 
 				stringstream info("");
 				info << "LPM::RunSchedule: Executed AttackOperation::Execute successfully!";
@@ -433,7 +491,7 @@ bool LPM::RunSubschedule(const Schedule* subschedule, LPM::State* state) const
 					return false;
 				}
 
-				if(metricOperation->Execute(attackOutput, &outputFile) == false) { return false; }
+				if(metricOperation->TimedExecute(attackOutput, &outputFile) == false) { return false; }
 
 				// release the metricOperation object here since we instantiated it (it is not part of the Schedule like the rest)
 				metricOperation->Release();
@@ -500,7 +558,7 @@ bool LPM::DoOutput(const Schedule* schedule, SchedulePosition currentPosition, s
 			return false;
 		}
 
-		if(outputOperation->Execute(currentTraceSet, &outputFile) == false) { return false; }
+		if(outputOperation->TimedExecute(currentTraceSet, &outputFile) == false) { return false; }
 
 		Log::GetInstance()->Append("LPM::DoOutput: Output successfully written in " + outputFilePath + "!");
 	}
@@ -510,6 +568,252 @@ bool LPM::DoOutput(const Schedule* schedule, SchedulePosition currentPosition, s
   // Bouml preserved body end 00032711
 }
 
+//! 
+//! \brief Returns whether the users can be streamed through the stages of the schedule which follow the given position
+//!
+//! \param[in] schedule 	Schedule*, the schedule.
+//! \param[in] currentPosition 	SchedulePosition, the position from which the users would be streamed.
+//! \param[in] lppmPDF 	FilterFunction*, the LPPM PDF (only used if the LPPM stage precedes \a currentPosition).
+//!
+//! \return true or false, depending on whether the users can be streamed
+//!
+bool LPM::CanStream(const Schedule* schedule, SchedulePosition currentPosition, const FilterFunction* lppmPDF) const 
+{
+  // Bouml preserved body begin 000E2E11
+
+	if(schedule->streamingBatchSize == 0) { return false; }
+
+	if(currentPosition < ScheduleBeforeApplicationOperation || currentPosition > ScheduleBeforeAttackOperation) { return false; }
+
+	if(schedule->branchingPosition != ScheduleInvalidPosition || schedule->endPosition != ScheduleEnd) { return false; }
+
+	// intermediary outputs would be split over the batches
+	for(ull pos = currentPosition + 1; pos <= ScheduleBeforeAttackOperation; pos++)
+	{
+		if(schedule->GetOutputOperationAt((SchedulePosition)pos) != NULL) { return false; }
+	}
+
+	// the users must keep their identity through the LPPM (the observed traces of a batch are those of its users)
+	const LPPMOperation* lppmOperation = schedule->lppmOperation;
+	if(currentPosition == ScheduleBeforeAttackOperation) { lppmOperation = dynamic_cast<const LPPMOperation*>(lppmPDF); }
+
+	if(lppmOperation == NULL || lppmOperation->GetFlags() != NoFlags) { return false; }
+
+	AttackOperation* attackOperation = schedule->attackOperation;
+	VERIFY(attackOperation != NULL);
+
+	attackOperation->SetLPPMFlags(lppmOperation->GetFlags());
+	if(attackOperation->IsPerUser() == false) { return false; }
+
+	MetricOperation* metricOperation = NULL;
+	if(attackOperation->CreateMetric(schedule->metricType, &metricOperation) == false) { return false; }
+	VERIFY(metricOperation != NULL);
+
+	bool perUserMetric = metricOperation->IsPerUser();
+	metricOperation->Release();
+
+	return perUserMetric;
+
+  // Bouml preserved body end 000E2E11
+}
+
+//! 
+//! \brief Runs the stages of the schedule which follow the given position on successive batches of users
+//!
+//! Each batch goes through the application, LPPM, attack and metric stages (those following \a currentPosition) before the next one starts.
+//! The intermediary results of a batch are released once the metric has consumed them, and the metric outputs of the batches are written one after the other in the same file.
+//!
+//! \param[in] schedule 	Schedule*, the schedule.
+//! \param[in] currentPosition 	SchedulePosition, the position from which the users are streamed.
+//! \param[in] context 	Context*, the context (with the profiles of all users).
+//! \param[in] actualTraceSet 	TraceSet*, the actual traces of all users.
+//! \param[in] currentTraceSet 	TraceSet*, the traces of all users at \a currentPosition.
+//! \param[in] appPDF 	FilterFunction*, the application PDF (if the application stage precedes \a currentPosition).
+//! \param[in] lppmPDF 	FilterFunction*, the LPPM PDF (if the LPPM stage precedes \a currentPosition).
+//! \param[in] outputPrefix 	string, the prefix to use when naming output files.
+//!
+//! \return true or false, depending on whether the call is successful
+//!
+bool LPM::RunStreamingStages(const Schedule* schedule, SchedulePosition currentPosition, Context* context, TraceSet* actualTraceSet, TraceSet* currentTraceSet, FilterFunction* appPDF, FilterFunction* lppmPDF, string outputPrefix) const 
+{
+  // Bouml preserved body begin 000E2E91
+
+	ScopedTimer timer("LPM::RunStreamingStages");
+
+	VERIFY(context != NULL && actualTraceSet != NULL && currentTraceSet != NULL);
+
+	ull batchSize = schedule->streamingBatchSize;
+	VERIFY(batchSize != 0);
+
+	map<ull, Trace*> actualTraces = map<ull, Trace*>();
+	actualTraceSet->GetMapping(actualTraces);
+
+	map<ull, Trace*> currentTraces = map<ull, Trace*>();
+	currentTraceSet->GetMapping(currentTraces);
+
+	vector<ull> users = vector<ull>();
+	pair_foreach_const(map<ull, Trace*>, currentTraces, iter) { users.push_back(iter->first); } // in increasing order (as the metrics output them)
+
+	ull numBatches = (users.size() + batchSize - 1) / batchSize;
+
+	stringstream info("");
+	info << "LPM::RunSchedule: Streaming " << users.size() << " users in " << numBatches << " batch(es) of (at most) " << batchSize << " users!";
+	Log::GetInstance()->Append(info.str());
+
+	ApplicationOperation* applicationOperation = NULL;
+	if(currentPosition <= ScheduleBeforeApplicationOperation)
+	{
+		applicationOperation = schedule->applicationOperation;
+		VERIFY(applicationOperation != NULL);
+		appPDF = (FilterFunction*)applicationOperation;
+	}
+
+	LPPMOperation* lppmOperation = NULL;
+	if(currentPosition <= ScheduleBeforeLPPMOperation)
+	{
+		lppmOperation = schedule->lppmOperation;
+		VERIFY(lppmOperation != NULL);
+		lppmPDF = (FilterFunction*)lppmOperation;
+	}
+
+	AttackOperation* attackOperation = schedule->attackOperation;
+	VERIFY(attackOperation != NULL);
+
+	MetricType metricType = schedule->metricType;
+
+	// the metric outputs of all batches go to the same file
+	MetricOperation* metricOperation = NULL;
+	if(attackOperation->CreateMetric(metricType, &metricOperation) == false) { return false; }
+	VERIFY(metricOperation != NULL);
+
+	info.str("");
+	info << outputPrefix << "-metric_" << metricOperation->GetTypeString();
+	metricOperation->Release(); metricOperation = NULL;
+
+	File outputFile(info.str(), false);
+
+	if(outputFile.IsGood() == false)
+	{
+		SET_ERROR_CODE(ERROR_CODE_INVALID_ARGUMENTS);
+		return false;
+	}
+
+	MetricDistance* distance = schedule->distanceFunction;
+	MetricDistance* defaultDistance = NULL;
+	if(distance == NULL) { distance = defaultDistance = new DefaultMetricDistance(); } // create the default
+
+	bool success = true;
+	for(ull batch = 0; batch < numBatches && success == true; batch++)
+	{
+		ull firstUser = batch * batchSize;
+		ull lastUser = MIN(firstUser + batchSize, users.size());
+
+		// the batch traces and context share the events and profiles of the whole sets
+		Context* batchContext = contextFactory->NewContext();
+		VERIFY(batchContext != NULL);
+
+		TraceSet* batchActualTraceSet = new TraceSet(ActualTrace);
+		TraceSet* batchTraceSet = batchActualTraceSet;
+		if(currentTraceSet != actualTraceSet) { batchTraceSet = new TraceSet(currentTraceSet->GetTraceType()); }
+
+		for(ull userIndex = firstUser; userIndex < lastUser; userIndex++)
+		{
+			ull user = users[userIndex];
+
+			UserProfile* profile = NULL;
+			if(context->GetUserProfile(user, &profile) == true && profile != NULL) { VERIFY(batchContext->AddProfile(profile) == true); }
+
+			map<ull, Trace*>::const_iterator actualIter = actualTraces.find(user);
+			VERIFY(actualIter != actualTraces.end());
+
+			vector<Event*> events = vector<Event*>();
+			actualIter->second->GetEvents(events);
+			foreach_const(vector<Event*>, events, iter) { VERIFY(batchActualTraceSet->AddEvent(*iter) == true); }
+
+			if(batchTraceSet != batchActualTraceSet)
+			{
+				events.clear();
+				currentTraces[user]->GetEvents(events);
+				foreach_const(vector<Event*>, events, iter) { VERIFY(batchTraceSet->AddEvent(*iter) == true); }
+			}
+		}
+
+		AttackOutput* attackOutput = NULL;
+
+		// the operations only see the profiles of the users of the batch
+		if(applicationOperation != NULL)
+		{
+			applicationOperation->SetContext(batchContext);
+
+			TraceSet* exposedTraceSet = new TraceSet(ExposedTrace);
+			VERIFY(exposedTraceSet != NULL);
+			success = applicationOperation->TimedExecute(batchTraceSet, exposedTraceSet);
+
+			if(batchTraceSet != batchActualTraceSet) { batchTraceSet->Release(); }
+			batchTraceSet = exposedTraceSet;
+		}
+
+		if(success == true && lppmOperation != NULL)
+		{
+			lppmOperation->SetContext(batchContext);
+
+			TraceSet* observedTraceSet = new TraceSet(ObservedTrace);
+			VERIFY(observedTraceSet != NULL);
+			success = lppmOperation->TimedExecute(batchTraceSet, observedTraceSet);
+
+			if(batchTraceSet != batchActualTraceSet) { batchTraceSet->Release(); }
+			batchTraceSet = observedTraceSet;
+		}
+
+		if(success == true)
+		{
+			VERIFY(batchTraceSet->GetTraceType() == ObservedTrace);
+
+			attackOperation->SetContext(batchContext);
+			VERIFY(attackOperation->SetPDFs(appPDF, lppmPDF) == true);
+
+			attackOutput = new AttackOutput();
+			VERIFY(attackOutput != NULL);
+			success = attackOperation->TimedExecute(batchTraceSet, attackOutput);
+		}
+
+		if(success == true)
+		{
+			VERIFY(attackOperation->CreateMetric(metricType, &metricOperation) == true && metricOperation != NULL);
+			VERIFY(metricOperation->SetActualTrace(batchActualTraceSet) == true);
+
+			DistortionMetricOperation* distortionMetric = dynamic_cast<DistortionMetricOperation*>(metricOperation);
+			if(distortionMetric != NULL) { distortionMetric->SetDistanceFunction(distance); }
+
+			success = metricOperation->TimedExecute(attackOutput, &outputFile);
+
+			metricOperation->Release(); metricOperation = NULL;
+		}
+
+		// release the batch (whether it went through all the stages or not)
+		if(batchTraceSet != batchActualTraceSet) { batchTraceSet->Release(); }
+		if(attackOutput != NULL) { attackOutput->Release(); }
+		batchActualTraceSet->Release();
+		batchContext->Release();
+
+		info.str("");
+		if(success == true) { info << "LPM::RunSchedule: Streamed batch " << (batch + 1) << "/" << numBatches << " successfully!"; }
+		else { info << "LPM::RunSchedule: Streaming of batch " << (batch + 1) << "/" << numBatches << " failed!"; }
+		Log::GetInstance()->Append(info.str(), (success == true) ? Log::infoLevel : Log::errorLevel);
+	}
+
+	// do not hold on to the last batch context
+	if(applicationOperation != NULL) { applicationOperation->SetContext(context); }
+	if(lppmOperation != NULL) { lppmOperation->SetContext(context); }
+	attackOperation->SetContext(context);
+
+	if(defaultDistance != NULL) { delete defaultDistance; }
+
+	return success;
+
+  // Bouml preserved body end 000E2E91
+}
+
 void LPM::LogParameters() const 
 {
   // Bouml preserved body begin 00096891
@@ -568,10 +872,12 @@ void LPM::LogParameters() const
 //!
 //! \return true or false, depending on whether the call is successful (i.e. whether the knowledge is constructed successfully)
 //!
-bool LPM::RunKnowledgeConstruction(const KnowledgeInput* knowledgeFiles, File* outputFile, ull maxGSIterationsPerUser, ull maxSecondsPerUser) const 
+bool LPM::RunKnowledgeConstruction(const KnowledgeInput* knowledgeFiles, File* outputFile, ull maxGSIterationsPerUser, ull maxSecondsPerUser, File* outputCountsFile) const 
 {
   // Bouml preserved body begin 00067091
 
+	ScopedTimer timer("LPM::RunKnowledgeConstruction");
+
 	if(knowledgeFiles == NULL || outputFile == NULL || outputFile->IsGood() == false)
 	{
 		SET_ERROR_CODE(ERROR_CODE_INVALID_ARGUMENTS);
@@ -601,10 +907,11 @@ bool LPM::RunKnowledgeConstruction(const KnowledgeInput* knowledgeFiles, File* o
 	Context* context = contextFactory->NewContext();
 
 	bool success = createContextOperation->SetLimits(maxGSIterationsPerUser, maxSecondsPerUser);
+	createContextOperation->SetTransitionsCountOutput(outputCountsFile);
 
-	if(success == true) { if(createContextOperation->Execute(knowledgeFiles, context) == false) { success = false; } }
+	if(success == true) { if(createContextOperation->TimedExecute(knowledgeFiles, context) == false) { success = false; } }
 
-	if(success == true) { if(storeContextOperation->Execute(context, outputFile) == false) { success = false; } }
+	if(success == true) { if(storeContextOperation->TimedExecute(context, outputFile) == false) { success = false; } }
 
 	context->Release();
 	createContextOperation->Release();
@@ -617,10 +924,80 @@ bool LPM::RunKnowledgeConstruction(const KnowledgeInput* knowledgeFiles, File* o
   // Bouml preserved body end 00067091
 }
 
+//! 
+//! \brief Updates a knowledge with new learning traces
+//!
+//! Only the users observed in the new learning traces are re-derived, the profiles of the other users are copied from \a knowledgeFile.
+//!
+//! \param[in] newKnowledgeFiles 	KnowledgeInput*, the new learning traces, and, as transitions count file, the transitions count written by 
+//! the previous construction (or update) of the knowledge.
+//! \param[in] knowledgeFile 	File*, the knowledge to update.
+//! \param[in] outputFile 	File*, the output (updated) knowledge file.
+//! \param[in] outputCountsFile 	File*, the file to which the updated transitions count are written (may be NULL).
+//! \param[in] maxGSIterationsPerUser [optional] ull, the maximum number of Gibbs sampling iterations, for each user.
+//! \param[in] maxSecondsPerUser [optional] ull, the maximum number of seconds to spend in the Gibbs sampling procedure, for each user.
+//!
+//! \return true or false, depending on whether the call is successful (i.e. whether the knowledge is updated successfully)
+//!
+bool LPM::UpdateKnowledge(const KnowledgeInput* newKnowledgeFiles, const File* knowledgeFile, File* outputFile, File* outputCountsFile, ull maxGSIterationsPerUser, ull maxSecondsPerUser) const 
+{
+  // Bouml preserved body begin 000E2891
+
+	ScopedTimer timer("LPM::UpdateKnowledge");
+
+	if(newKnowledgeFiles == NULL || knowledgeFile == NULL || outputFile == NULL || outputFile->IsGood() == false)
+	{
+		SET_ERROR_CODE(ERROR_CODE_INVALID_ARGUMENTS);
+		return false;
+	}
+
+	vector<File*> files = newKnowledgeFiles->learningTraceFilesVector;
+	foreach_const(vector<File*>, files, iter)
+	{
+		File* file = *iter;
+
+		if(file == NULL || file->IsGood() == false)
+		{
+			SET_ERROR_CODE_DETAILS(ERROR_CODE_INVALID_ARGUMENTS, "one of the provided learning file was not found");
+			return false;
+		}
+	}
+
+	Log::GetInstance()->Append("Entered LPM::UpdateKnowledge()!");
+
+	LoadContextOperation* loadContextOperation = new LoadContextOperation("LoadContextOperation");
+	CreateContextOperation* createContextOperation = new CreateContextOperation("CreateContextOperation");
+	StoreContextOperation* storeContextOperation = new StoreContextOperation("StoreContextOperation");
+
+	Context* context = contextFactory->NewContext();
+
+	bool success = createContextOperation->SetLimits(maxGSIterationsPerUser, maxSecondsPerUser);
+	createContextOperation->SetTransitionsCountOutput(outputCountsFile);
+
+	if(success == true) { if(loadContextOperation->TimedExecute(knowledgeFile, context) == false) { success = false; } }
+
+	if(success == true) { if(createContextOperation->UpdateKnowledge(newKnowledgeFiles, context) == false) { success = false; } }
+
+	if(success == true) { if(storeContextOperation->TimedExecute(context, outputFile) == false) { success = false; } }
+
+	context->Release();
+	loadContextOperation->Release();
+	createContextOperation->Release();
+	storeContextOperation->Release();
+
+	Log::GetInstance()->Append((success == true) ? "Exited LPM::UpdateKnowledge() successfully!" : "LPM::UpdateKnowledge() failed!");
+
+	return success;
+
+  // Bouml preserved body end 000E2891
+}
+
 bool LPM::RunContextAnalysisSchedule(ContextAnalysisSchedule* schedule, const File* contextFile, string outputFileName) const 
 {
   // Bouml preserved body begin 000BB611
 
+	ScopedTimer timer("LPM::RunContextAnalysisSchedule");
+
 	File output(outputFileName, false);
 
 	if(contextFile == NULL || schedule == NULL || output.IsGood() == false)
@@ -634,11 +1011,11 @@ bool LPM::RunContextAnalysisSchedule(ContextAnalysisSchedule* schedule, const Fi
 	LoadContextOperation* loadContextOperation = schedule->loadContextOperation;
 	Context* context = contextFactory->NewContext();
 
-	bool success = loadContextOperation->Execute(contextFile, context);
+	bool success = loadContextOperation->TimedExecute(contextFile, context);
 
 	if(success != false)
 	{
-		success = schedule->contextAnalysisOperation->Execute(context, &output);
+		success = schedule->contextAnalysisOperation->TimedExecute(context, &output);
 	}
 
 	Log::GetInstance()->Append((success == true) ? "Exited LPM::RunContextAnalysisSchedule() successfully!" : "LPM::RunContextAnalysisSchedule() failed!");
@@ -673,7 +1050,7 @@ bool LPM::GenerateTracesFromKnowledge(const File* knowledge, File* output) const
 
 	KnowledgeSamplingTraceGeneratorOperation* generatorOperation = new KnowledgeSamplingTraceGeneratorOperation();
 
-	bool success = loadContextOperation->Execute(knowledge, context);
+	bool success = loadContextOperation->TimedExecute(knowledge, context);
 
 	if(success != false)
 	{
@@ -727,7 +1104,7 @@ bool LPM::GenerateTraces(TraceGeneratorOperation* generator, const TraceGenerato
 
 	Log::GetInstance()->Append("Entered LPM::GenerateTraces()!");
 
-	bool success = generator->Execute(input, output);
+	bool success = generator->TimedExecute(input, output);
 
 	Log::GetInstance()->Append((success == true) ? "Exited LPM::GenerateTraces() successfully!" : "LPM::GenerateTraces() failed!");
 
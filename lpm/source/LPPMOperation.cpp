@@ -9,6 +9,7 @@
 #include "../include/Event.h"
 #include "../include/ActualEvent.h"
 #include "../include/TraceSet.h"
+#include "../include/Instrumentation.h"
 
 namespace lpm {
 
@@ -220,6 +221,8 @@ bool LPPMOperation::Execute(const TraceSet* input, TraceSet* output)
 		ull eventsSize = events.size();
 		ull tmIdx = 0;
 
+		Instrumentation::GetInstance()->AddToCounter(EventsProcessedCounter, eventsSize);
+
 		// Warning: if you change the indexing scheme, parts of the code may be break (e.g., attack, metrics), so make sure you update those as well
 		ull currentObservedIndex = userIdx; // set currentObservedIndex
 
@@ -2,32 +2,74 @@
 //! \file
 //!
 #include "../include/Log.h"
+#include "../include/ExecutionContext.h"
+
+#include <unistd.h>
+#include <sched.h>
 
 namespace lpm {
 
-Log::Log() 
+Log::Log()
 {
   // Bouml preserved body begin 00058B91
 
 	enabled = false;
+	minimumSeverity = GetSeverity(infoLevel);
+
+	// ring buffer (bounded multi-producer queue): the slot at position p is free for the producer of position p when its sequence is p,
+	// and it holds the message of position p (for the consumer) when its sequence is p + 1
+	ringBuffer = new LogRecord[LOG_RING_BUFFER_SIZE];
+	for(ull i = 0; i < LOG_RING_BUFFER_SIZE; i++) { ringBuffer[i].sequence = i; ringBuffer[i].time = 0; ringBuffer[i].level = infoLevel; }
+
+	enqueuePosition = 0;
+	dequeuePosition = 0;
+
+	lastTime = 0;
+	lastTimeString = "";
+
+	writerRunning = false;
+	stopRequested = false;
+
 	SetOutputFileName("log");
 
   // Bouml preserved body end 00058B91
 }
 
-Log::~Log() 
+Log::~Log()
 {
   // Bouml preserved body begin 00058C11
 
+	StopWriter();
+	Flush();
+
 	logFile.close();
 
+	delete[] ringBuffer;
+
   // Bouml preserved body end 00058C11
 }
 
-//! 
+//!
+//! \brief Returns the log of the execution context active on the calling thread (see ExecutionContext), or the global log if none (or if the context has no log)
+//!
+//! \return Log*, the log
+//!
+Log* Log::GetInstance()
+{
+  // Bouml preserved body begin 000E4411
+
+	ExecutionContext* context = ExecutionContext::GetCurrent();
+	if(context != NULL && context->GetLog() != NULL) { return context->GetLog(); }
+
+	return Singleton<Log>::GetInstance();
+
+  // Bouml preserved body end 000E4411
+}
+
+//!
 //! \brief Appends a message to the log
 //
-//! Adds a message at the end of the current log file. 
+//! Adds a message at the end of the current log file.
 //! The seriousness level of the message (info, warning, or error) can be specified.
 //
 //! \param[in] message 	string to append to the log file.
@@ -36,19 +78,42 @@ Log::~Log()
 //
 //! \return nothing
 //!
-void Log::Append(string message, ushort level) 
+void Log::Append(string message, ushort level)
 {
   // Bouml preserved body begin 0002B291
 
-	if(enabled == false) { return; }
+	if(IsEnabled(level) == false) { return; }
 
-	string timeString = "";
-	GetTimeString(timeString);
+	time_t t = time(NULL);
+
+	// claim a slot
+	ull position = enqueuePosition;
+	LogRecord* record = NULL;
+	while(true)
+	{
+		record = &ringBuffer[position & (LOG_RING_BUFFER_SIZE - 1)];
 
-	string levelMsg = ((level == warningLevel) ? "[Warning]: " : ((level == errorLevel) ? "[Error]: " : "[Info]: "));
-	logFile << timeString << " - " << levelMsg << message << endl;
+		ull sequence = record->sequence;
+		__sync_synchronize();
 
-	logFile.flush();
+		ll diff = (ll)sequence - (ll)position;
+		if(diff == 0)
+		{
+			if(__sync_bool_compare_and_swap(&enqueuePosition, position, position + 1) == true) { break; }
+		}
+		else if(diff < 0) { Flush(); sched_yield(); } // the buffer is full: write the pending messages ourselves
+
+		position = enqueuePosition;
+	}
+
+	record->time = t;
+	record->level = level;
+	record->message.swap(message);
+
+	__sync_synchronize();
+	record->sequence = position + 1; // publish
+
+	if(level == errorLevel || writerRunning == false) { Flush(); }
 
   // Bouml preserved body end 0002B291
 }
@@ -59,18 +124,24 @@ const ushort Log::errorLevel = 1;
 
 const ushort Log::infoLevel = 2;
 
+const ushort Log::debugLevel = 3;
+
 //!
 //! \brief Sets the output file name
 //!
 //! \param[in] filename 	string to be use as base file name (if not present, the '.log' extension will be used).
 //
 //! \return nothing
-void Log::SetOutputFileName(string filename) 
+void Log::SetOutputFileName(string filename)
 {
   // Bouml preserved body begin 0005D891
 
 	if(enabled == false) { return; }
 
+	Flush(); // the pending messages belong to the previous file
+
+	ScopedLock lock(mutex);
+
 	if(logFile.is_open() == true) { logFile.close(); }
 
 	string filepath = filename + ".log";
@@ -87,33 +158,93 @@ void Log::SetOutputFileName(string filename)
 //! \note Crash logging cannot be disabled
 //
 //! \return nothing
-void Log::SetEnabled(bool state) 
+void Log::SetEnabled(bool state)
 {
   // Bouml preserved body begin 0005F211
 
 	enabled = state;
 
+	if(enabled == true && writerRunning == false)
+	{
+		if(pthread_create(&writerThread, NULL, RunWriterThread, this) == 0)
+		{
+			writerRunning = true;
+
+			// the logs of the execution contexts are flushed when they are destroyed
+			if(this == Singleton<Log>::GetInstance()) { atexit(StopAtExit); }
+		}
+	}
+
   // Bouml preserved body end 0005F211
 }
 
+//!
+//! \brief Sets the minimum level of the messages which are logged
+//!
+//! \param[in] level 	ushort, the minimum level (in increasing order of seriousness: Log::debugLevel, Log::infoLevel (default), Log::warningLevel, Log::errorLevel).
+//!
+//! \return nothing
+void Log::SetLevel(ushort level)
+{
+  // Bouml preserved body begin 000E3911
+
+	minimumSeverity = GetSeverity(level);
+
+  // Bouml preserved body end 000E3911
+}
+
+//!
+//! \brief Returns whether the messages of the given level are logged
+//!
+//! \param[in] level 	ushort, the level of the messages.
+//!
+//! \return true if the log is enabled and \a level is at least the minimum level, false otherwise
+bool Log::IsEnabled(ushort level) const
+{
+  // Bouml preserved body begin 000E3991
+
+	return enabled == true && GetSeverity(level) >= minimumSeverity;
+
+  // Bouml preserved body end 000E3991
+}
+
+//!
+//! \brief Writes the pending messages to the log file
+//!
+//! \return nothing
+void Log::Flush()
+{
+  // Bouml preserved body begin 000E3A11
+
+	ScopedLock lock(mutex);
+
+	WritePendingMessages();
+
+  // Bouml preserved body end 000E3A11
+}
+
 //!
 //! \brief Registers an error
 //
 //! \param[in] message 	string detailing the error.
 //!
 //! \return nothing
-void Log::RegisterError(string message) 
+void Log::RegisterError(string message)
 {
   // Bouml preserved body begin 00081C91
 
+	string timeString = "";
+	GetTimeString(timeString, time(NULL));
+
+	ScopedLock lock(mutex);
+
+	WritePendingMessages(); // so that the log is up to date when the error is looked at
+
 	if(errorLogFile.is_open() == false)
 	{
 		errorLogFile.open("error.log", ofstream::out);
 	}
 
-	string timeString = "";
-	GetTimeString(timeString);
-
 	errorLogFile << timeString << " - " << message << endl;
 
 	errorLogFile.flush();
@@ -129,18 +260,22 @@ void Log::RegisterError(string message)
 //! \note the program will terminate before it returns from the call
 //!
 //! \return nothing
-void Log::RegisterCrash(string message) 
+void Log::RegisterCrash(string message)
 {
   // Bouml preserved body begin 00081D11
 
+	string timeString = "";
+	GetTimeString(timeString, time(NULL));
+
+	ScopedLock lock(mutex);
+
+	WritePendingMessages();
+
 	if(crashLogFile.is_open() == false)
 	{
 		crashLogFile.open("crash.log", ofstream::out);
 	}
 
-	string timeString = "";
-	GetTimeString(timeString);
-
 	crashLogFile << timeString << " - " << message << endl;
 
 	crashLogFile.flush();
@@ -148,12 +283,12 @@ void Log::RegisterCrash(string message)
   // Bouml preserved body end 00081D11
 }
 
-bool Log::GetTimeString(string& timeString) const 
+bool Log::GetTimeString(string& timeString, time_t t) const
 {
   // Bouml preserved body begin 00088911
 
-	time_t t = time(NULL);
-	struct tm* tm = localtime(&t);
+	struct tm tmBuffer;
+	struct tm* tm = localtime_r(&t, &tmBuffer); // reentrant version
 
 #define MAX_TIME_STRING_LENGTH 1024
 	char tmp[MAX_TIME_STRING_LENGTH + 1];
@@ -169,5 +304,104 @@ bool Log::GetTimeString(string& timeString) const
   // Bouml preserved body end 00088911
 }
 
+ushort Log::GetSeverity(ushort level)
+{
+  // Bouml preserved body begin 000E3A91
+
+	if(level == errorLevel) { return 3; }
+	else if(level == warningLevel) { return 2; }
+	else if(level == infoLevel) { return 1; }
+
+	return 0; // debug
+
+  // Bouml preserved body end 000E3A91
+}
+
+// writes the published messages (in order) and flushes the file, the caller must hold the mutex
+void Log::WritePendingMessages()
+{
+  // Bouml preserved body begin 000E3B11
+
+	bool written = false;
+	while(true)
+	{
+		LogRecord* record = &ringBuffer[dequeuePosition & (LOG_RING_BUFFER_SIZE - 1)];
+
+		ull sequence = record->sequence;
+		__sync_synchronize();
+
+		if(sequence != dequeuePosition + 1) { break; } // empty (or the next message is still being appended)
+
+		if(logFile.is_open() == true)
+		{
+			if(record->time != lastTime || lastTimeString.empty() == true)
+			{
+				lastTime = record->time;
+				GetTimeString(lastTimeString, lastTime);
+			}
+
+			ushort level = record->level;
+			const char* levelMsg = ((level == warningLevel) ? "[Warning]: " : ((level == errorLevel) ? "[Error]: " : ((level == debugLevel) ? "[Debug]: " : "[Info]: ")));
+
+			logFile << lastTimeString << " - " << levelMsg << record->message << '\n';
+			written = true;
+		}
+		record->message.clear();
+
+		__sync_synchronize();
+		record->sequence = dequeuePosition + LOG_RING_BUFFER_SIZE; // release the slot
+
+		dequeuePosition++;
+	}
+
+	if(written == true) { logFile.flush(); }
+
+  // Bouml preserved body end 000E3B11
+}
+
+void Log::StopWriter()
+{
+  // Bouml preserved body begin 000E3B91
+
+	if(writerRunning == false) { return; }
+
+	stopRequested = true;
+	pthread_join(writerThread, NULL);
+
+	writerRunning = false;
+	stopRequested = false;
+
+  // Bouml preserved body end 000E3B91
+}
+
+void* Log::RunWriterThread(void* arg)
+{
+  // Bouml preserved body begin 000E3C11
+
+	Log* log = static_cast<Log*>(arg);
+
+	while(log->stopRequested == false)
+	{
+		usleep(LOG_WRITER_INTERVAL_MICROSECONDS);
+		log->Flush();
+	}
+
+	return NULL;
+
+  // Bouml preserved body end 000E3C11
+}
+
+void Log::StopAtExit()
+{
+  // Bouml preserved body begin 000E3C91
+
+	Log* log = Singleton<Log>::GetInstance();
+
+	log->StopWriter();
+	log->Flush();
+
+  // Bouml preserved body end 000E3C91
+}
+
 
 } // namespace lpm
@@ -12,6 +12,9 @@ Memory::Memory()
 	references = map<void*, ull>();
 	chunks = map<void*, string>();
 
+	allocationsCount = 0;
+	allocatedBytes = 0;
+
   // Bouml preserved body end 00090F11
 }
 
@@ -49,8 +52,13 @@ void* Memory::AllocateChunk(ull bytes, const char* file, int line)
 	}
 	else
 	{
+		ScopedLock lock(mutex);
+
 		// register the allocation
 		chunks.insert(pair<void*, string>(ret, details));
+
+		allocationsCount++;
+		allocatedBytes += bytes;
 	}
 
 	return ret;
@@ -65,17 +73,23 @@ void Memory::FreeChunk(void* chunk)
 	stringstream ss("");
 	ull pointer = (ull)chunk;
 
-	map<void*, string>::iterator iter = chunks.find(chunk);
-	if(iter != chunks.end()) // found entry
+	bool found = false;
 	{
-		string details = iter->second;
+		ScopedLock lock(mutex);
 
-		/* ss << "Freeing memory at 0x" << hex << pointer << " (" << details << ")!";
-		Log::GetInstance()->Append(ss.str()); */
+		map<void*, string>::iterator iter = chunks.find(chunk);
+		if(iter != chunks.end()) // found entry
+		{
+			/* string details = iter->second;
+			ss << "Freeing memory at 0x" << hex << pointer << " (" << details << ")!";
+			Log::GetInstance()->Append(ss.str()); */
 
-		chunks.erase(iter);
+			chunks.erase(iter);
+			found = true;
+		}
 	}
-	else // not found
+
+	if(found == false) // not found
 	{
 		ss << "Attempting to Free possibly unallocated memory at 0x" << hex << pointer << "!";
 		Log::GetInstance()->Append(ss.str(), Log::warningLevel);
@@ -92,6 +106,8 @@ void Memory::UpdateReference(void* object, ull newCount)
 
 	//ull pointer = (ull)object;
 
+	ScopedLock lock(mutex);
+
 	map<void*, ull>::iterator iter = references.find(object);
 	if(iter != references.end()) // found entry
 	{
@@ -124,12 +140,52 @@ void Memory::UpdateReference(void* object, ull newCount)
   // Bouml preserved body end 00091091
 }
 
+//!
+//! \brief Increments (or decrements) the given reference count and updates the bookkeeping accordingly
+//!
+//! The count is updated while holding the lock of the bookkeeping, so that the recorded count follows the actual one.
+//!
+//! \note Only used by debug builds: release builds update the count atomically without recording it (see Reference), so that
+//! references can be added and released without contending for the lock.
+//!
+//! \param[in] object 	void*, the referenced object.
+//! \param[in,out] refCount 	unsigned long*, the reference count of the object.
+//! \param[in] increment 	bool, whether to increment (or decrement) the count.
+//!
+//! \return unsigned long, the new reference count (if 0, the caller must delete the object)
+//!
+unsigned long Memory::UpdateReferenceCount(void* object, unsigned long* refCount, bool increment)
+{
+  // Bouml preserved body begin 000E2911
+
+	ScopedLock lock(mutex);
+
+	VERIFY(refCount != NULL && *refCount > 0);
+
+	if(increment == true) { (*refCount)++; }
+	else { (*refCount)--; }
+
+	// when the count drops to 0, the entry is removed by the destructor of the object (see Reference)
+	if(*refCount > 0)
+	{
+		map<void*, ull>::iterator iter = references.find(object);
+		VERIFY(iter != references.end());
+		iter->second = *refCount;
+	}
+
+	return *refCount;
+
+  // Bouml preserved body end 000E2911
+}
+
 void Memory::Report() 
 {
   // Bouml preserved body begin 00092A91
 
 	stringstream ss("");
 
+	ScopedLock lock(mutex);
+
 	ull refs = references.size();
 	ull chunksCount = chunks.size();
 
@@ -167,5 +223,17 @@ void Memory::Report()
   // Bouml preserved body end 00092A91
 }
 
+void Memory::GetAllocationStatistics(ull* allocations, ull* bytes)
+{
+  // Bouml preserved body begin 000E2F11
+
+	ScopedLock lock(mutex);
+
+	if(allocations != NULL) { *allocations = allocationsCount; }
+	if(bytes != NULL) { *bytes = allocatedBytes; }
+
+  // Bouml preserved body end 000E2F11
+}
+
 
 } // namespace lpm
@@ -57,5 +57,43 @@ string MetricOperation::GetDetailString()
   // Bouml preserved body end 00055591
 }
 
+//! 
+//! \brief Returns whether the metric writes its output user by user
+//!
+//! \return true or false, depending on whether the metric is per-user (the default implementation returns false)
+//!
+bool MetricOperation::IsPerUser() const 
+{
+  // Bouml preserved body begin 000E2B91
+
+	return false;
+
+  // Bouml preserved body end 000E2B91
+}
+
+
+//! 
+//! \brief Computes the distances between a location and all the locations
+//!
+//! The default implementation calls ComputeDistance() for each location. Distance functions which can do better
+//! (e.g. those holding a precomputed distance matrix) should override it, as metrics use it for their inner loops.
+//!
+//! \param[in] firstLocation 	ull, the location.
+//! \param[out] row 	double*, the distances: row[loc - minLoc] is the distance between \a firstLocation and \a loc, for each location loc
+//!	of the locationstamps range (see Parameters::GetLocationstampsRange()).
+//!
+//! \return nothing
+//!
+void MetricDistance::ComputeDistanceRow(ull firstLocation, double* row) const
+{
+  // Bouml preserved body begin 000E4591
+
+	ull minLoc = 0; ull maxLoc = 0;
+	VERIFY(Parameters::GetInstance()->GetLocationstampsRange(&minLoc, &maxLoc) == true);
+
+	for(ull loc = minLoc; loc <= maxLoc; loc++) { row[loc - minLoc] = ComputeDistance(firstLocation, loc); }
+
+  // Bouml preserved body end 000E4591
+}
 
 } // namespace lpm
@@ -4,6 +4,8 @@
 #include "../include/Metrics.h"
 #include "../include/AttackOutput.h"
 #include "../include/File.h"
+#include "../include/Algorithms.h"
+#include "../include/Threads.h"
 
 namespace lpm {
 
@@ -24,6 +26,189 @@ DistortionMetricOperation::~DistortionMetricOperation()
   // Bouml preserved body end 0004D191
 }
 
+// rows of distances are precomputed for the distinct actual locations as long as they fit in that many bytes (otherwise they are computed on demand)
+#define METRIC_DISTANCE_ROWS_MAX_BYTES (128 * 1024 * 1024)
+
+// gets the time and location indices (relative to minTime and minLoc) of the actual events of the users, in the order of the events of their traces:
+// timeIndices[GET_INDEX(userIndex, eventIndex, numTimes)] and locIndices[GET_INDEX(userIndex, eventIndex, numTimes)]
+static void GetActualEventIndices(const map<ull, Trace*>& mapping, ull minTime, ull numTimes, ull minLoc, ull* timeIndices, ull* locIndices)
+{
+	ull userIndex = 0;
+	pair_foreach_const(map<ull, Trace*>, mapping, userIter)
+	{
+		vector<Event*> events = vector<Event*>();
+		userIter->second->GetEvents(events);
+
+		VERIFY(numTimes == events.size());
+
+		ull eventIndex = 0;
+		foreach_const(vector<Event*>, events, eventsIter)
+		{
+			ActualEvent* actualEvent = dynamic_cast<ActualEvent*>(*eventsIter);
+
+			ull index = GET_INDEX(userIndex, eventIndex, numTimes);
+			timeIndices[index] = actualEvent->GetTimestamp() - minTime;
+			locIndices[index] = actualEvent->GetLocationstamp() - minLoc;
+
+			eventIndex++;
+		}
+
+		userIndex++;
+	}
+}
+
+// formats the line "user: value, value, ..., value" of a per-user metric
+static string FormatUserLine(ull user, const double* values, ull count)
+{
+	stringstream ss("");
+	ss << user << ": ";
+
+	for(ull i = 0; i < count; i++)
+	{
+		ss << values[i];
+		if(i + 1 != count) { ss << ", "; }
+	}
+
+	return ss.str();
+}
+
+// rows of distances between the actual locations of the users and all the locations: row[loc] = distance(minLoc + locIndex, minLoc + loc)
+// the row of each distinct actual location is computed once (in parallel), or on demand in a per-thread buffer if all the rows do not fit in memory
+class MetricDistanceRows : public ParallelTask
+{
+  public:
+	MetricDistanceRows(const MetricDistance* distanceFunction, ull minLoc, ull numLoc, const ull* locIndices, ull count, ull numThreads)
+	{
+		this->distanceFunction = distanceFunction;
+		this->minLoc = minLoc;
+		this->numLoc = numLoc;
+
+		rowOfLocation = vector<ll>(numLoc, -1);
+		for(ull i = 0; i < count; i++)
+		{
+			ull locIndex = locIndices[i];
+			if(rowOfLocation[locIndex] == -1) { rowOfLocation[locIndex] = rowLocations.size(); rowLocations.push_back(locIndex); }
+		}
+
+		rows = NULL; buffers = NULL;
+		if(rowLocations.size() * numLoc * sizeof(double) <= METRIC_DISTANCE_ROWS_MAX_BYTES)
+		{
+			rows = (double*)Allocate(rowLocations.size() * numLoc * sizeof(double));
+			VERIFY(rows != NULL);
+
+			VERIFY(Threads::ParallelFor(rowLocations.size(), this) == true);
+		}
+		else
+		{
+			buffers = (double*)Allocate(MAX(numThreads, 1) * numLoc * sizeof(double));
+			VERIFY(buffers != NULL);
+		}
+	}
+
+	virtual ~MetricDistanceRows()
+	{
+		if(rows != NULL) { Free(rows); }
+		if(buffers != NULL) { Free(buffers); }
+	}
+
+	// returns the row of the given actual location (the caller must be the given thread of a ParallelFor() of at most numThreads threads)
+	const double* GetRow(ull locIndex, ull thread) const
+	{
+		if(rows != NULL) { return &rows[GET_INDEX(rowOfLocation[locIndex], 0, numLoc)]; }
+
+		double* row = &buffers[GET_INDEX(thread, 0, numLoc)];
+		ComputeRow(locIndex, row);
+
+		return row;
+	}
+
+	virtual void Run(ull rowIndex, ull thread)
+	{
+		ComputeRow(rowLocations[rowIndex], &rows[GET_INDEX(rowIndex, 0, numLoc)]);
+	}
+
+  private:
+	void ComputeRow(ull locIndex, double* row) const
+	{
+		distanceFunction->ComputeDistanceRow(minLoc + locIndex, row);
+	}
+
+	const MetricDistance* distanceFunction;
+	ull minLoc;
+	ull numLoc;
+
+	vector<ll> rowOfLocation; // index of the row of each location (-1 if it is not an actual location)
+	vector<ull> rowLocations;
+
+	double* rows; // rows[GET_INDEX(rowIndex, loc, numLoc)]
+	double* buffers; // buffers[GET_INDEX(thread, loc, numLoc)]
+};
+
+// computes the expected distortion of each event of one user (i.e. dot products of distance rows and localization rows), see DistortionMetricOperation::Execute()
+class DistortionMetricTask : public ParallelTask
+{
+  public:
+	ull numTimes;
+	ull numLoc;
+
+	const ull* users;
+	const ull* timeIndices;
+	const ull* locIndices;
+	const MetricDistanceRows* distanceRows;
+
+	const double* localizationDistribution; // may be NULL
+	const double* genericRecDistribution; // may be NULL (not normalized)
+
+	// outputs, per user
+	string* lines;
+	string* linesRec;
+	double* avgErrors;
+	double* avgErrorsRec;
+
+	// buffers of numTimes errors per thread
+	double* errors;
+	double* errorsRec;
+
+	virtual void Run(ull userIndex, ull thread)
+	{
+		double* userErrors = &errors[GET_INDEX(thread, 0, numTimes)];
+		double* userErrorsRec = &errorsRec[GET_INDEX(thread, 0, numTimes)];
+
+		double avgError = 0.0; double avgErrorRec = 0.0;
+		for(ull eventIndex = 0; eventIndex < numTimes; eventIndex++)
+		{
+			ull index = GET_INDEX(userIndex, eventIndex, numTimes);
+
+			const double* distanceRow = distanceRows->GetRow(locIndices[index], thread);
+			ull rowIndex = GET_INDEX_3D(userIndex, timeIndices[index], 0, numTimes, numLoc);
+
+			double probError = 0.0; double probErrorRec = 0.0;
+			if(localizationDistribution != NULL) { probError = Algorithms::DotProduct(distanceRow, &localizationDistribution[rowIndex], numLoc); }
+			if(genericRecDistribution != NULL)
+			{
+				const double* row = &genericRecDistribution[rowIndex];
+
+				double sum = 0.0;
+				for(ull loc = 0; loc < numLoc; loc++) { sum += row[loc]; }
+
+				probErrorRec = Algorithms::DotProduct(distanceRow, row, numLoc) / sum; // normalized
+			}
+
+			userErrors[eventIndex] = probError;
+			userErrorsRec[eventIndex] = probErrorRec;
+
+			avgError += probError;
+			avgErrorRec += probErrorRec;
+		}
+
+		avgErrors[userIndex] = avgError / numTimes;
+		avgErrorsRec[userIndex] = avgErrorRec / numTimes;
+
+		if(localizationDistribution != NULL) { lines[userIndex] = FormatUserLine(users[userIndex], userErrors, numTimes); }
+		if(genericRecDistribution != NULL) { linesRec[userIndex] = FormatUserLine(users[userIndex], userErrorsRec, numTimes); }
+	}
+};
+
 bool DistortionMetricOperation::Execute(const AttackOutput* input, File* output) 
 {
   // Bouml preserved body begin 0004D211
@@ -53,125 +238,79 @@ bool DistortionMetricOperation::Execute(const AttackOutput* input, File* output)
 	double* genericRecDistribution = NULL;
 	set<ull> genericRecPseudonymsSet = set<ull>();
 
-	double* genericRecLocalization = NULL;
 	VERIFY(input->GetGenericReconstructionObjects(&genericRecDistribution, NULL, NULL, genericRecPseudonymsSet) == true);
 	if(genericRecDistribution != NULL && genericRecPseudonymsSet.empty() == false)
 	{
 		string genOutputFilepath = primaryOutput->GetFilePath();
 		secondaryOutput = new File(genOutputFilepath + ".genrec", false);
-
-		ull Nusers = mapping.size();
-		ull genericRecLocalizationByteSize = Nusers * numTimes * numLoc * sizeof(double);
-		genericRecLocalization = (double*)Allocate(genericRecLocalizationByteSize);
-		VERIFY(genericRecLocalization != NULL); memset(genericRecLocalization, 0, genericRecLocalizationByteSize);
-
-		// only need to renormalize genericRecDistribution
-		for(ull userIdx = 0; userIdx < Nusers; userIdx++)
-		{
-			for (ull tmIdx = 0; tmIdx < numTimes; tmIdx++)
-			{
-				double sum = 0.0;
-				for (ull locIdx = 0; locIdx < numLoc; locIdx++)
-				{
-					ull idx = GET_INDEX_3D(userIdx, tmIdx, locIdx, numTimes, numLoc);
-					double val = genericRecDistribution[idx];
-					genericRecLocalization[idx] = val;
-					sum += val;
-				}
-
-				for (ull locIdx = 0; locIdx < numLoc; locIdx++) // normalize
-				{
-					ull idx = GET_INDEX_3D(userIdx, tmIdx, locIdx, numTimes, numLoc);
-					genericRecLocalization[idx] /= sum;
-				}
-			}
-		}
 	}
+	else { genericRecDistribution = NULL; } // (genericRecDistribution is normalized on the fly)
 
-	VERIFY(localizationDistribution != NULL || genericRecLocalization != NULL);
-
-
-	ull userIndex = 0;
-	pair_foreach_const(map<ull, Trace*>, mapping, userIter)
-	{
-		ull user = userIter->first;
-		Trace* actualTrace = userIter->second;
-
-		vector<Event*> events = vector<Event*>();
-		actualTrace->GetEvents(events);
-
-		VERIFY(numTimes == events.size());
-
-		stringstream info("");
-		info << "Computing average error for user " << user <<" userIndex " << userIndex;
-
-		Log::GetInstance()->Append(info.str());
-
-		stringstream ss("");
-		double avgError = 0.0;
-		ss << user << ": ";
-
-		stringstream ssRec("");
-		double avgErrorRec = 0.0;
-		ssRec << user << ": ";
-
-		foreach_const(vector<Event*>, events, eventsIter)
-		{
-			ActualEvent* actualEvent = dynamic_cast<ActualEvent*>(*eventsIter);
+	VERIFY(localizationDistribution != NULL || genericRecDistribution != NULL);
 
-			ull timestamp = actualEvent->GetTimestamp();
-			ull locationstamp = actualEvent->GetLocationstamp();
+	ull Nusers = mapping.size();
+	ull numThreads = Threads::GetEffectiveThreadsCount(Nusers);
 
-			double probError = 0; double probErrorRec = 0.0;
-			for(ull loc = minLoc; loc <= maxLoc; loc++)
-			{
-				double distance = distanceFunction->ComputeDistance(locationstamp, loc);
+	vector<ull> users = vector<ull>();
+	pair_foreach_const(map<ull, Trace*>, mapping, userIter) { users.push_back(userIter->first); }
 
-				if(distance != 0.0)
-				{
-					ull index = GET_INDEX_3D(userIndex, (timestamp - minTime), (loc - minLoc), numTimes, numLoc);
+	vector<ull> timeIndices = vector<ull>(Nusers * numTimes);
+	vector<ull> locIndices = vector<ull>(Nusers * numTimes);
+	if(Nusers != 0) { GetActualEventIndices(mapping, minTime, numTimes, minLoc, &timeIndices[0], &locIndices[0]); }
 
-					if(localizationDistribution != NULL) { probError += distance * localizationDistribution[index]; }
-					if(genericRecLocalization != NULL) { probErrorRec += distance * genericRecLocalization[index]; }
-				}
-			}
-			// output file
+	MetricDistanceRows distanceRows(distanceFunction, minLoc, numLoc, (Nusers != 0) ? &locIndices[0] : NULL, Nusers * numTimes, numThreads);
 
-			ss << probError;
-			ssRec << probErrorRec;
-			if((eventsIter + 1) != events.end())
-			{
-				ss << ", ";
-				ssRec << ", ";
-			}
+	vector<string> lines = vector<string>(Nusers);
+	vector<string> linesRec = vector<string>(Nusers);
+	vector<double> avgErrors = vector<double>(Nusers);
+	vector<double> avgErrorsRec = vector<double>(Nusers);
+	vector<double> errors = vector<double>(numThreads * numTimes);
+	vector<double> errorsRec = vector<double>(numThreads * numTimes);
 
-			avgError += probError;
-			avgErrorRec += probErrorRec;
-		}
+	// compute the errors of the users in parallel
+	if(Nusers != 0)
+	{
+		DistortionMetricTask task;
+		task.numTimes = numTimes;
+		task.numLoc = numLoc;
+		task.users = &users[0];
+		task.timeIndices = &timeIndices[0];
+		task.locIndices = &locIndices[0];
+		task.distanceRows = &distanceRows;
+		task.localizationDistribution = localizationDistribution;
+		task.genericRecDistribution = genericRecDistribution;
+		task.lines = &lines[0];
+		task.linesRec = &linesRec[0];
+		task.avgErrors = &avgErrors[0];
+		task.avgErrorsRec = &avgErrorsRec[0];
+		task.errors = &errors[0];
+		task.errorsRec = &errorsRec[0];
+
+		VERIFY(Threads::ParallelFor(Nusers, &task, numThreads) == true);
+	}
 
-		avgError /= numTimes;
-		avgErrorRec /= numTimes;
+	bool logEnabled = Log::GetInstance()->IsEnabled();
 
-		double locPrivacy = avgError;
-		double locPrivacyRec = avgErrorRec;
+	for(ull userIndex = 0; userIndex < Nusers; userIndex++)
+	{
+		ull user = users[userIndex];
 
 		// output to file
-		if(localizationDistribution != NULL) { primaryOutput->WriteLine(ss.str()); }
-		if(genericRecLocalization != NULL) { secondaryOutput->WriteLine(ssRec.str()); }
+		if(localizationDistribution != NULL) { primaryOutput->WriteLine(lines[userIndex]); }
+		if(genericRecDistribution != NULL) { secondaryOutput->WriteLine(linesRec[userIndex]); }
 
-		// log
-		ss.str("");
-		ss << user << ", " << locPrivacy;
-		ssRec.str("");
-		ssRec << user << ", " << locPrivacyRec;
-		if(localizationDistribution != NULL) { Log::GetInstance()->Append("Location privacy: " + ss.str()); }
-		if(genericRecLocalization != NULL) { Log::GetInstance()->Append("Location privacy (Generic Reconstruction): " + ssRec.str()); }
-
-		userIndex++;
+		if(logEnabled == true) // log
+		{
+			stringstream ss("");
+			ss << user << ", " << avgErrors[userIndex];
+			stringstream ssRec("");
+			ssRec << user << ", " << avgErrorsRec[userIndex];
+			if(localizationDistribution != NULL) { Log::GetInstance()->Append("Location privacy: " + ss.str()); }
+			if(genericRecDistribution != NULL) { Log::GetInstance()->Append("Location privacy (Generic Reconstruction): " + ssRec.str()); }
+		}
 	}
 
 	if(secondaryOutput != NULL) { delete secondaryOutput; }
-	if(genericRecLocalization != NULL) { Free(genericRecLocalization); }
 
 	return true;
 
@@ -196,6 +335,15 @@ string DistortionMetricOperation::GetTypeString() const
   // Bouml preserved body end 00076091
 }
 
+bool DistortionMetricOperation::IsPerUser() const 
+{
+  // Bouml preserved body begin 000E2C11
+
+	return true; // one line of errors per user
+
+  // Bouml preserved body end 000E2C11
+}
+
 EntropyMetricOperation::EntropyMetricOperation() :  MetricOperation(Entropy)
 {
   // Bouml preserved body begin 00070E11
@@ -208,6 +356,52 @@ EntropyMetricOperation::~EntropyMetricOperation()
   // Bouml preserved body end 00070E91
 }
 
+// computes the normalized entropy of the localization of each event of one user, see EntropyMetricOperation::Execute()
+class EntropyMetricTask : public ParallelTask
+{
+  public:
+	ull numTimes;
+	ull numLoc;
+	double maxEntropy;
+
+	const ull* users;
+	const ull* timeIndices;
+
+	const double* localizationDistribution;
+
+	string* lines; // output, per user
+
+	double* entropies; // buffers of numTimes entropies per thread
+
+	virtual void Run(ull userIndex, ull thread)
+	{
+		double* userEntropies = &entropies[GET_INDEX(thread, 0, numTimes)];
+
+		for(ull eventIndex = 0; eventIndex < numTimes; eventIndex++)
+		{
+			ull timeIndex = timeIndices[GET_INDEX(userIndex, eventIndex, numTimes)];
+			const double* row = &localizationDistribution[GET_INDEX_3D(userIndex, timeIndex, 0, numTimes, numLoc)];
+
+			double sum = 0.0;
+			for(ull loc = 0; loc < numLoc; loc++)
+			{
+				double p = row[loc];
+
+				if(p != 0.0)
+				{
+					VERIFY(p > 0.0 && p <= 1.0);
+
+					sum += p * log(p);
+				}
+			}
+
+			userEntropies[eventIndex] = (sum == 0.0) ? 0.0 : (-sum / maxEntropy);
+		}
+
+		lines[userIndex] = FormatUserLine(users[userIndex], userEntropies, numTimes);
+	}
+};
+
 bool EntropyMetricOperation::Execute(const AttackOutput* input, File* output) 
 {
   // Bouml preserved body begin 00070F11
@@ -233,64 +427,44 @@ bool EntropyMetricOperation::Execute(const AttackOutput* input, File* output)
 	VERIFY(input->GetProbabilityDistribution(&localizationDistribution) == true);
 	VERIFY(localizationDistribution != NULL);
 
-	ull userIndex = 0;
-	pair_foreach_const(map<ull, Trace*>, mapping, userIter)
-	{
-		ull user = userIter->first;
-		Trace* actualTrace = userIter->second;
-
-		vector<Event*> events = vector<Event*>();
-		actualTrace->GetEvents(events);
-
-		VERIFY(numTimes == events.size());
-
-		stringstream info("");
-		info << "Computing entropy for user " << user << " userIndex " << userIndex;
-
-		Log::GetInstance()->Append(info.str());
-
-		stringstream ss("");
-
-		ss << user << ": ";
-
-		foreach_const(vector<Event*>, events, eventsIter)
-		{
-			ActualEvent* actualEvent = dynamic_cast<ActualEvent*>(*eventsIter);
-
-			ull timestamp = actualEvent->GetTimestamp();
+	ull Nusers = mapping.size();
+	ull numThreads = Threads::GetEffectiveThreadsCount(Nusers);
 
-			double sum = 0.0;
-			double entropy = 0.0;
-			for(ull loc = minLoc; loc <= maxLoc; loc++)
-			{
-				ull index = GET_INDEX_3D(userIndex, (timestamp - minTime), (loc - minLoc), numTimes, numLoc);
+	vector<ull> users = vector<ull>();
+	pair_foreach_const(map<ull, Trace*>, mapping, userIter) { users.push_back(userIter->first); }
 
-				double p = localizationDistribution[index];
+	vector<ull> timeIndices = vector<ull>(Nusers * numTimes);
+	vector<ull> locIndices = vector<ull>(Nusers * numTimes);
+	if(Nusers != 0) { GetActualEventIndices(mapping, minTime, numTimes, minLoc, &timeIndices[0], &locIndices[0]); }
 
-				if(p != 0.0)
-				{
-					VERIFY(p > 0.0 && p <= 1.0);
+	vector<string> lines = vector<string>(Nusers);
+	vector<double> entropies = vector<double>(numThreads * numTimes);
 
-					sum += p * log(p);
-				}
-			}
-			entropy = (sum == 0.0) ? 0.0 : (-sum / maxEntropy);
+	// compute the entropies of the users in parallel
+	if(Nusers != 0)
+	{
+		EntropyMetricTask task;
+		task.numTimes = numTimes;
+		task.numLoc = numLoc;
+		task.maxEntropy = maxEntropy;
+		task.users = &users[0];
+		task.timeIndices = &timeIndices[0];
+		task.localizationDistribution = localizationDistribution;
+		task.lines = &lines[0];
+		task.entropies = &entropies[0];
+
+		VERIFY(Threads::ParallelFor(Nusers, &task, numThreads) == true);
+	}
 
-			// output file
-			ss << entropy;
-			if((eventsIter + 1) != events.end())
-			{
-				ss << ", ";
-			}
-		}
+	bool logEnabled = Log::GetInstance()->IsEnabled();
 
+	for(ull userIndex = 0; userIndex < Nusers; userIndex++)
+	{
 		// output to file
-		output->WriteLine(ss.str());
+		output->WriteLine(lines[userIndex]);
 
 		// log
-		Log::GetInstance()->Append("Entropy: " + ss.str());
-
-		userIndex++;
+		if(logEnabled == true) { Log::GetInstance()->Append("Entropy: " + lines[userIndex]); }
 	}
 
 	return true;
@@ -307,6 +481,15 @@ string EntropyMetricOperation::GetTypeString() const
   // Bouml preserved body end 00076191
 }
 
+bool EntropyMetricOperation::IsPerUser() const 
+{
+  // Bouml preserved body begin 000E2C91
+
+	return true; // one line of entropies per user
+
+  // Bouml preserved body end 000E2C91
+}
+
 MostLikelyLocationDistortionMetricOperation::MostLikelyLocationDistortionMetricOperation() : DistortionMetricOperation(MostLikelyLocationDistortion)
 {
   // Bouml preserved body begin 00075C11
@@ -319,6 +502,57 @@ MostLikelyLocationDistortionMetricOperation::~MostLikelyLocationDistortionMetric
   // Bouml preserved body end 00075C91
 }
 
+// computes the most likely location of one user at each time (argmax of the localization rows) and the distortion of the events of the user,
+// see MostLikelyLocationDistortionMetricOperation::Execute()
+class MostLikelyLocationMetricTask : public ParallelTask
+{
+  public:
+	ull numTimes;
+	ull numLoc;
+	ull minLoc;
+
+	const ull* users;
+	const ull* timeIndices;
+	const ull* locIndices;
+	const MetricDistance* distanceFunction;
+
+	const double* localizationDistribution;
+
+	// outputs, per user
+	ull* mostLikelyLocation; // mostLikelyLocation[GET_INDEX(userIndex, timeIndex, numTimes)]
+	string* lines;
+	double* avgErrors;
+
+	double* errors; // buffers of numTimes errors per thread
+
+	virtual void Run(ull userIndex, ull thread)
+	{
+		for(ull timeIndex = 0; timeIndex < numTimes; timeIndex++)
+		{
+			const double* row = &localizationDistribution[GET_INDEX_3D(userIndex, timeIndex, 0, numTimes, numLoc)];
+
+			mostLikelyLocation[GET_INDEX(userIndex, timeIndex, numTimes)] = minLoc + Algorithms::ArgMax(row, numLoc);
+		}
+
+		double* userErrors = &errors[GET_INDEX(thread, 0, numTimes)];
+
+		double avgError = 0.0;
+		for(ull eventIndex = 0; eventIndex < numTimes; eventIndex++)
+		{
+			ull index = GET_INDEX(userIndex, eventIndex, numTimes);
+
+			ull loc = mostLikelyLocation[GET_INDEX(userIndex, timeIndices[index], numTimes)];
+			double error = distanceFunction->ComputeDistance(minLoc + locIndices[index], loc);
+
+			userErrors[eventIndex] = error;
+			avgError += error;
+		}
+
+		avgErrors[userIndex] = avgError / numTimes;
+		lines[userIndex] = FormatUserLine(users[userIndex], userErrors, numTimes);
+	}
+};
+
 bool MostLikelyLocationDistortionMetricOperation::Execute(const AttackOutput* input, File* output) 
 {
   // Bouml preserved body begin 00075D11
@@ -326,6 +560,7 @@ bool MostLikelyLocationDistortionMetricOperation::Execute(const AttackOutput* in
 	Log::GetInstance()->Append("Entering MostLikelyLocationDistortionMetricOperation::Execute");
 
 	VERIFY(input != NULL && output != NULL);
+	VERIFY(distanceFunction != NULL);
 
 	ull minTime = 0; ull maxTime = 0;
 	VERIFY(Parameters::GetInstance()->GetTimestampsRange(&minTime, &maxTime) == true);
@@ -343,6 +578,14 @@ bool MostLikelyLocationDistortionMetricOperation::Execute(const AttackOutput* in
 	VERIFY(localizationDistribution != NULL);
 
 	ull Nusers = mapping.size();
+	ull numThreads = Threads::GetEffectiveThreadsCount(Nusers);
+
+	vector<ull> users = vector<ull>();
+	pair_foreach_const(map<ull, Trace*>, mapping, userIter) { users.push_back(userIter->first); }
+
+	vector<ull> timeIndices = vector<ull>(Nusers * numTimes);
+	vector<ull> locIndices = vector<ull>(Nusers * numTimes);
+	if(Nusers != 0) { GetActualEventIndices(mapping, minTime, numTimes, minLoc, &timeIndices[0], &locIndices[0]); }
 
 	// most likely location
 	ull mostLikelyLocationByteSize = Nusers * numTimes * sizeof(ull);
@@ -350,50 +593,35 @@ bool MostLikelyLocationDistortionMetricOperation::Execute(const AttackOutput* in
 	VERIFY(mostLikelyLocation != NULL);
 	memset(mostLikelyLocation, 0, mostLikelyLocationByteSize);
 
-	// for each user
-	for(ull userIndex = 0; userIndex < Nusers; userIndex++)
-	{
-		for (ull tm = minTime; tm <= maxTime; tm++)
-		{
-			double sum = 0.0;
-
-			// most likely location
-			ull mostLikelyLoc = minLoc;
-			double mostLikelyLocProb = 0.0;
-
-			for (ull loc = minLoc; loc <= maxLoc; loc++)
-			{
-				ull index = GET_INDEX_3D(userIndex, (tm - minTime), (loc - minLoc), numTimes, numLoc);
+	vector<string> lines = vector<string>(Nusers);
+	vector<double> avgErrors = vector<double>(Nusers);
+	vector<double> errors = vector<double>(numThreads * numTimes);
 
-				double prob = localizationDistribution[index];
-
-
-				if(prob > mostLikelyLocProb) // update most likely location for that time
-				{
-					mostLikelyLoc = loc;
-					mostLikelyLocProb = prob;
-				}
-
-				stringstream info2("");
-				info2 << "       sum " << userIndex << " " << tm << " " << loc << " | " << sum;
-				Log::GetInstance()->Append(info2.str());
-
-			}
-
-			// set most likely location for time tm
-			mostLikelyLocation[GET_INDEX(userIndex, (tm - minTime), numTimes)] = mostLikelyLoc;
-		}
+	// compute the most likely locations and the errors of the users in parallel
+	if(Nusers != 0)
+	{
+		MostLikelyLocationMetricTask task;
+		task.numTimes = numTimes;
+		task.numLoc = numLoc;
+		task.minLoc = minLoc;
+		task.users = &users[0];
+		task.timeIndices = &timeIndices[0];
+		task.locIndices = &locIndices[0];
+		task.distanceFunction = distanceFunction;
+		task.localizationDistribution = localizationDistribution;
+		task.mostLikelyLocation = mostLikelyLocation;
+		task.lines = &lines[0];
+		task.avgErrors = &avgErrors[0];
+		task.errors = &errors[0];
+
+		VERIFY(Threads::ParallelFor(Nusers, &task, numThreads) == true);
 	}
 
-	ull userIndex = 0;
-	pair_foreach_const(map<ull, Trace*>, mapping, userIter)
-	{
-		ull user = userIter->first;
+	bool logEnabled = Log::GetInstance()->IsEnabled();
 
-		stringstream info("");
-		info << "Computing most likely locations for user " << user << ", userIndex " << userIndex;
-
-		Log::GetInstance()->Append(info.str());
+	for(ull userIndex = 0; userIndex < Nusers; userIndex++)
+	{
+		ull user = users[userIndex];
 
 		// output file
 		stringstream ss("");
@@ -408,68 +636,22 @@ bool MostLikelyLocationDistortionMetricOperation::Execute(const AttackOutput* in
 		output->WriteLine(ss.str());
 
 		// log
-		Log::GetInstance()->Append(ss.str());
-
-		userIndex++;
+		if(logEnabled == true) { Log::GetInstance()->Append(ss.str()); }
 	}
 
 	output->WriteLine(""); // empty line
 
-	VERIFY(distanceFunction != NULL);
-
-	userIndex = 0;
-	pair_foreach_const(map<ull, Trace*>, mapping, userIter)
+	for(ull userIndex = 0; userIndex < Nusers; userIndex++)
 	{
-		ull user = userIter->first;
-		Trace* actualTrace = userIter->second;
-
-		vector<Event*> events = vector<Event*>();
-		actualTrace->GetEvents(events);
-
-		VERIFY(numTimes == events.size());
-
-		stringstream info("");
-		info << "Computing average error for user " << user <<" userIndex " << userIndex;
-
-		Log::GetInstance()->Append(info.str());
-
-		stringstream ss("");
-		double avgError = 0.0;
-		ss << user << ": ";
+		// output to file
+		output->WriteLine(lines[userIndex]);
 
-		foreach_const(vector<Event*>, events, eventsIter)
+		if(logEnabled == true) // log
 		{
-			ActualEvent* actualEvent = dynamic_cast<ActualEvent*>(*eventsIter);
-
-			ull timestamp = actualEvent->GetTimestamp();
-			ull locationstamp = actualEvent->GetLocationstamp();
-
-			ull loc = mostLikelyLocation[GET_INDEX(userIndex, (timestamp - minTime), numTimes)];
-			double error = distanceFunction->ComputeDistance(locationstamp, loc);
-
-			// output file
-			ss << error;
-			if((eventsIter + 1) != events.end())
-			{
-				ss << ", ";
-			}
-
-			avgError += error;
+			stringstream ss("");
+			ss << users[userIndex] << ", " << avgErrors[userIndex];
+			Log::GetInstance()->Append("Location privacy: " + ss.str());
 		}
-
-		avgError /= numTimes;
-
-		double locPrivacy = avgError;
-
-		// output to file
-		output->WriteLine(ss.str());
-
-		// log
-		ss.str("");
-		ss << user << ", " << locPrivacy;
-		Log::GetInstance()->Append("Location privacy: " + ss.str());
-
-		userIndex++;
 	}
 
 	Free(mostLikelyLocation);
@@ -685,6 +867,21 @@ double DefaultMetricDistance::ComputeDistance(ull firstLocation, ull secondLocat
   // Bouml preserved body end 00077D11
 }
 
+void DefaultMetricDistance::ComputeDistanceRow(ull firstLocation, double* row) const
+{
+  // Bouml preserved body begin 000E4611
+
+	ull minLoc = 0; ull maxLoc = 0;
+	VERIFY(Parameters::GetInstance()->GetLocationstampsRange(&minLoc, &maxLoc) == true);
+	ull numLoc = maxLoc - minLoc + 1;
+
+	for(ull loc = 0; loc < numLoc; loc++) { row[loc] = 1.0; }
+
+	if(firstLocation >= minLoc && firstLocation <= maxLoc) { row[firstLocation - minLoc] = 0.0; }
+
+  // Bouml preserved body end 000E4611
+}
+
 MostLikelyTraceDistortionMetricOperation::MostLikelyTraceDistortionMetricOperation() : DistortionMetricOperation(MostLikelyTraceDistortion)
 {
   // Bouml preserved body begin 0008BC11
@@ -816,6 +1013,15 @@ string MostLikelyTraceDistortionMetricOperation::GetTypeString() const
   // Bouml preserved body end 0008BD91
 }
 
+bool MostLikelyTraceDistortionMetricOperation::IsPerUser() const 
+{
+  // Bouml preserved body begin 000E2D11
+
+	return false; // the most likely traces of all users are written before their errors
+
+  // Bouml preserved body end 000E2D11
+}
+
 DensityMetricOperation::DensityMetricOperation() : MetricOperation(Density)
 {
   // Bouml preserved body begin 0008BE11
@@ -828,6 +1034,28 @@ DensityMetricOperation::~DensityMetricOperation()
   // Bouml preserved body end 0008BE91
 }
 
+// adds the localization distribution of one user to the reconstructed presence of the thread, see DensityMetricOperation::Execute()
+class DensityMetricTask : public ParallelTask
+{
+  public:
+	ull numTimes;
+	ull numLoc;
+
+	const double* localizationDistribution;
+
+	double* presence; // presence[GET_INDEX_3D(thread, timeIndex, loc, numTimes, numLoc)]
+
+	virtual void Run(ull userIndex, ull thread)
+	{
+		ull numCells = numTimes * numLoc;
+
+		const double* userDistribution = &localizationDistribution[GET_INDEX(userIndex, 0, numCells)];
+		double* threadPresence = &presence[GET_INDEX(thread, 0, numCells)];
+
+		for(ull cell = 0; cell < numCells; cell++) { threadPresence[cell] += userDistribution[cell]; }
+	}
+};
+
 bool DensityMetricOperation::Execute(const AttackOutput* input, File* output) 
 {
   // Bouml preserved body begin 0008BF11
@@ -852,67 +1080,53 @@ bool DensityMetricOperation::Execute(const AttackOutput* input, File* output)
 	VERIFY(localizationDistribution != NULL);
 
 	ull Nusers = mapping.size();
+	ull numThreads = Threads::GetEffectiveThreadsCount(Nusers);
+	ull numCells = numTimes * numLoc;
 
-	ull actualPresenceByteSize = numLoc * numTimes * sizeof(double);
+	// presences are indexed by GET_INDEX((tm - minTime), (loc - minLoc), numLoc), as the localization distribution
+	ull actualPresenceByteSize = numCells * sizeof(double);
 	double* actualPresence = (double*)Allocate(actualPresenceByteSize);
 	VERIFY(actualPresence != NULL);
 	memset(actualPresence, 0, actualPresenceByteSize);
 
-	stringstream info("");
-	info << "Computing actual user presence!";
+	Log::GetInstance()->Append("Computing actual user presence!");
 
-	Log::GetInstance()->Append(info.str());
+	vector<ull> timeIndices = vector<ull>(Nusers * numTimes);
+	vector<ull> locIndices = vector<ull>(Nusers * numTimes);
+	if(Nusers != 0) { GetActualEventIndices(mapping, minTime, numTimes, minLoc, &timeIndices[0], &locIndices[0]); }
 
-	pair_foreach_const(map<ull, Trace*>, mapping, userIter)
+	for(ull index = 0; index < Nusers * numTimes; index++)
 	{
-		Trace* actualTrace = userIter->second;
-
-		vector<Event*> events = vector<Event*>();
-		actualTrace->GetEvents(events);
-
-		VERIFY(numTimes == events.size());
-
-		foreach_const(vector<Event*>, events, eventsIter)
-		{
-			ActualEvent* actualEvent = dynamic_cast<ActualEvent*>(*eventsIter);
-
-			ull timestamp = actualEvent->GetTimestamp();
-			ull locationstamp = actualEvent->GetLocationstamp();
-
-			ull index = GET_INDEX((locationstamp - minLoc), (timestamp - minTime), numTimes);
-
-			actualPresence[index]++;
-		}
+		actualPresence[GET_INDEX(timeIndices[index], locIndices[index], numLoc)]++;
 	}
 
-	ull reconstructedPresenceByteSize = numLoc * numTimes * sizeof(double);
-	double* reconstructedPresence = (double*)Allocate(reconstructedPresenceByteSize);
-	VERIFY(reconstructedPresence != NULL);
-	memset(reconstructedPresence, 0, reconstructedPresenceByteSize);
+	Log::GetInstance()->Append("Computing reconstructed user presence!");
 
-	info.str("");
-	info << "Computing reconstructed user presence!";
+	// each thread sums the distributions of its users, then the partial sums are added
+	ull threadsPresenceByteSize = MAX(numThreads, 1) * numCells * sizeof(double);
+	double* threadsPresence = (double*)Allocate(threadsPresenceByteSize);
+	VERIFY(threadsPresence != NULL);
+	memset(threadsPresence, 0, threadsPresenceByteSize);
 
-	Log::GetInstance()->Append(info.str());
-
-	for(ull userIndex = 0; userIndex < Nusers; userIndex++)
+	if(Nusers != 0)
 	{
-		for(ull loc = minLoc; loc <= maxLoc; loc++)
-		{
-			for(ull tm = minTime; tm <= maxTime; tm++)
-			{
-				ull probIndex = GET_INDEX_3D(userIndex, (loc - minLoc), (tm - minTime), numLoc, numTimes);
-				ull presenceIndex = GET_INDEX((loc - minLoc), (tm - minTime), numTimes);
+		DensityMetricTask task;
+		task.numTimes = numTimes;
+		task.numLoc = numLoc;
+		task.localizationDistribution = localizationDistribution;
+		task.presence = threadsPresence;
 
-				reconstructedPresence[presenceIndex] += localizationDistribution[probIndex];
-			}
-		}
+		VERIFY(Threads::ParallelFor(Nusers, &task, numThreads) == true);
 	}
 
-	info.str("");
-	info << "Outputting density!";
+	double* reconstructedPresence = threadsPresence; // the partial sum of thread 0
+	for(ull thread = 1; thread < numThreads; thread++)
+	{
+		const double* threadPresence = &threadsPresence[GET_INDEX(thread, 0, numCells)];
+		for(ull cell = 0; cell < numCells; cell++) { reconstructedPresence[cell] += threadPresence[cell]; }
+	}
 
-	Log::GetInstance()->Append(info.str());
+	Log::GetInstance()->Append("Outputting density!");
 
 	stringstream ss("");
 
@@ -920,7 +1134,7 @@ bool DensityMetricOperation::Execute(const AttackOutput* input, File* output)
 	{
 		for(ull tm = minTime; tm <= maxTime; tm++)
 		{
-			ull index = GET_INDEX((loc - minLoc), (tm - minTime), numTimes);
+			ull index = GET_INDEX((tm - minTime), (loc - minLoc), numLoc);
 			double abs = ABS(reconstructedPresence[index] - actualPresence[index]);
 
 			ss << abs;
@@ -933,7 +1147,7 @@ bool DensityMetricOperation::Execute(const AttackOutput* input, File* output)
 	}
 
 	Free(actualPresence);
-	Free(reconstructedPresence);
+	Free(threadsPresence);
 
 	return true;
 
@@ -961,154 +1175,168 @@ MeetingDisclosureMetricOperation::~MeetingDisclosureMetricOperation()
   // Bouml preserved body end 0008C091
 }
 
-bool MeetingDisclosureMetricOperation::Execute(const AttackOutput* input, File* output) 
+// number of users per side of the tiles of pairs, and number of (time, location) cells per block, of MeetingDisclosureMetricTask
+// (two blocks of rows, i.e. 2 * 32 * 256 doubles, fit in the L2 cache)
+#define MEETING_DISCLOSURE_TILE_USERS 32
+#define MEETING_DISCLOSURE_TILE_CELLS 256
+
+// computes the actual and reconstructed (i.e. expected) number of meetings of the pairs of users of one tile, see MeetingDisclosureMetricOperation::Execute()
+// the expected number of meetings of users i and j is the dot product of their localization distributions (over all the (time, location) cells),
+// so the tiles compute the upper triangle of the Gram matrix of the Nusers x (numTimes * numLoc) distribution, block by block of cells
+class MeetingDisclosureMetricTask : public ParallelTask
 {
-  // Bouml preserved body begin 0008C111
+  public:
+	ull Nusers;
+	ull numTimes;
+	ull numLoc;
 
-	Log::GetInstance()->Append("Entering MeetingDisclosureMetricOperation::Execute");
+	const ull* timeIndices;
+	const ull* locIndices;
 
-	VERIFY(input != NULL && output != NULL);
+	const double* localizationDistribution;
 
-	ull minTime = 0; ull maxTime = 0;
-	VERIFY(Parameters::GetInstance()->GetTimestampsRange(&minTime, &maxTime) == true);
-	ull numTimes = maxTime - minTime + 1;
+	vector<pair<ull, ull> > tiles; // first users block, second users block (first <= second)
 
-	ull minLoc = 0; ull maxLoc = 0;
-	VERIFY(Parameters::GetInstance()->GetLocationstampsRange(&minLoc, &maxLoc) == true);
-	ull numLoc = maxLoc - minLoc + 1;
-
-	map<ull, Trace*> mapping = map<ull, Trace*>();
-	actualTraceSet->GetMapping(mapping);
-
-	double* localizationDistribution = NULL;
-	VERIFY(input->GetProbabilityDistribution(&localizationDistribution) == true);
-	VERIFY(localizationDistribution != NULL);
+	// outputs, per pair (see GetPairIndex())
+	double* actualMeetings;
+	double* reconstructedMeetings;
 
-	ull Nusers = mapping.size();
+	// index of the pair of users (firstUserIndex < secondUserIndex), in lexicographic order
+	static ull GetPairIndex(ull firstUserIndex, ull secondUserIndex, ull Nusers)
+	{
+		return firstUserIndex * Nusers - (firstUserIndex * (firstUserIndex + 1)) / 2 + (secondUserIndex - firstUserIndex - 1);
+	}
 
-	VERIFY(Nusers > 1); // makes no sense to use this metric if there is a single user.
+	virtual void Run(ull tileIndex, ull thread)
+	{
+		ull firstStart = tiles[tileIndex].first * MEETING_DISCLOSURE_TILE_USERS;
+		ull firstEnd = MIN(firstStart + MEETING_DISCLOSURE_TILE_USERS, Nusers);
+		ull secondStart = tiles[tileIndex].second * MEETING_DISCLOSURE_TILE_USERS;
+		ull secondEnd = MIN(secondStart + MEETING_DISCLOSURE_TILE_USERS, Nusers);
 
-	map<ull, ull> usersPairs = map<ull, ull>();
-	map<ull, ull> usersIndexPairs = map<ull, ull>();
+		ull numCells = numTimes * numLoc;
 
-	ull firstUserIndex = 0;
-	pair_foreach_const(map<ull, Trace*>, mapping, userIter)
-	{
-		ull firstUser = userIter->first;
+		double sums[MEETING_DISCLOSURE_TILE_USERS * MEETING_DISCLOSURE_TILE_USERS];
+		memset(sums, 0, sizeof(sums));
 
-		ull secondUserIndex = 0;
-		pair_foreach_const(map<ull, Trace*>, mapping, userIter2)
+		for(ull cellStart = 0; cellStart < numCells; cellStart += MEETING_DISCLOSURE_TILE_CELLS)
 		{
-			ull secondUser = userIter2->first;
+			ull count = MIN(MEETING_DISCLOSURE_TILE_CELLS, numCells - cellStart);
 
-			if(firstUser < secondUser) // consider unordered pairs of distinct users
+			for(ull i = firstStart; i < firstEnd; i++)
 			{
-				usersPairs.insert(pair<ull, ull>(firstUser, secondUser));
-				usersIndexPairs.insert(pair<ull, ull>(firstUserIndex, secondUserIndex));
-			}
-
-			secondUserIndex++;
-		}
+				const double* firstRow = &localizationDistribution[GET_INDEX(i, cellStart, numCells)];
 
-		firstUserIndex++;
-	}
-
-	ull pairs = usersIndexPairs.size();
-	VERIFY(pairs >= 1);
+				for(ull j = MAX(secondStart, i + 1); j < secondEnd; j++)
+				{
+					const double* secondRow = &localizationDistribution[GET_INDEX(j, cellStart, numCells)];
 
-	ull actualMeetingsByteSize = pairs * sizeof(double);
-	double* actualMeetings = (double*)Allocate(actualMeetingsByteSize);
-	VERIFY(actualMeetings != NULL);
-	memset(actualMeetings, 0, actualMeetingsByteSize);
+					sums[GET_INDEX(i - firstStart, j - secondStart, MEETING_DISCLOSURE_TILE_USERS)] += Algorithms::DotProduct(firstRow, secondRow, count);
+				}
+			}
+		}
 
-	ull pairIndex = 0;
-	pair_foreach_const(map<ull, ull>, usersPairs, pairsIter)
-	{
-		ull firstUser = pairsIter->first;
-		ull secondUser = pairsIter->second;
+		for(ull i = firstStart; i < firstEnd; i++)
+		{
+			for(ull j = MAX(secondStart, i + 1); j < secondEnd; j++)
+			{
+				ull pairIndex = GetPairIndex(i, j, Nusers);
 
-		VERIFY(mapping.find(firstUser) != mapping.end());
-		Trace* firstTrace = (mapping.find(firstUser))->second;
+				reconstructedMeetings[pairIndex] = sums[GET_INDEX(i - firstStart, j - secondStart, MEETING_DISCLOSURE_TILE_USERS)];
 
-		vector<Event*> firstEvents = vector<Event*>();
-		firstTrace->GetEvents(firstEvents);
+				// the users meet when they are at the same location at the same time
+				double meetings = 0.0;
+				for(ull eventIndex = 0; eventIndex < numTimes; eventIndex++)
+				{
+					ull firstIndex = GET_INDEX(i, eventIndex, numTimes);
+					ull secondIndex = GET_INDEX(j, eventIndex, numTimes);
 
-		VERIFY(mapping.find(secondUser) != mapping.end());
-		Trace* secondTrace = (mapping.find(secondUser))->second;
+					VERIFY(timeIndices[firstIndex] == timeIndices[secondIndex]);
 
-		vector<Event*> secondEvents = vector<Event*>();
-		secondTrace->GetEvents(secondEvents);
+					if(locIndices[firstIndex] == locIndices[secondIndex]) { meetings++; }
+				}
+				actualMeetings[pairIndex] = meetings;
+			}
+		}
+	}
+};
 
-		VERIFY(firstEvents.size() == secondEvents.size());
+bool MeetingDisclosureMetricOperation::Execute(const AttackOutput* input, File* output) 
+{
+  // Bouml preserved body begin 0008C111
 
-		vector<Event*>::const_iterator secondIter = secondEvents.begin();
-		foreach_const(vector<Event*>, firstEvents, firstIter)
-		{
-			ActualEvent* firstEvent = dynamic_cast<ActualEvent*>(*firstIter);
-			ActualEvent* secondEvent = dynamic_cast<ActualEvent*>(*secondIter);
+	Log::GetInstance()->Append("Entering MeetingDisclosureMetricOperation::Execute");
 
-			ull tm = firstEvent->GetTimestamp();
-			VERIFY(tm == secondEvent->GetTimestamp());
+	VERIFY(input != NULL && output != NULL);
 
-			ull firstLoc = firstEvent->GetLocationstamp();
-			ull secondLoc = secondEvent->GetLocationstamp();
+	ull minTime = 0; ull maxTime = 0;
+	VERIFY(Parameters::GetInstance()->GetTimestampsRange(&minTime, &maxTime) == true);
+	ull numTimes = maxTime - minTime + 1;
 
-			if(firstLoc == secondLoc) // meeting
-			{
-				actualMeetings[pairIndex]++;
-			}
+	ull minLoc = 0; ull maxLoc = 0;
+	VERIFY(Parameters::GetInstance()->GetLocationstampsRange(&minLoc, &maxLoc) == true);
+	ull numLoc = maxLoc - minLoc + 1;
 
-			secondIter++;
-		}
+	map<ull, Trace*> mapping = map<ull, Trace*>();
+	actualTraceSet->GetMapping(mapping);
 
-		pairIndex++;
-	}
+	double* localizationDistribution = NULL;
+	VERIFY(input->GetProbabilityDistribution(&localizationDistribution) == true);
+	VERIFY(localizationDistribution != NULL);
 
+	ull Nusers = mapping.size();
 
-	ull reconstructedMeetingsByteSize = pairs * sizeof(double);
-	double* reconstructedMeetings = (double*)Allocate(reconstructedMeetingsByteSize);
-	VERIFY(reconstructedMeetings != NULL);
-	memset(reconstructedMeetings, 0, reconstructedMeetingsByteSize);
+	VERIFY(Nusers > 1); // makes no sense to use this metric if there is a single user.
 
-	pairIndex = 0;
-	pair_foreach_const(map<ull, ull>, usersIndexPairs, indexPairsIter)
+	vector<ull> users = vector<ull>();
+	pair_foreach_const(map<ull, Trace*>, mapping, userIter) { users.push_back(userIter->first); }
+
+	vector<ull> timeIndices = vector<ull>(Nusers * numTimes);
+	vector<ull> locIndices = vector<ull>(Nusers * numTimes);
+	GetActualEventIndices(mapping, minTime, numTimes, minLoc, &timeIndices[0], &locIndices[0]);
+
+	// all the unordered pairs of distinct users
+	ull pairs = (Nusers * (Nusers - 1)) / 2;
+
+	ull meetingsByteSize = pairs * sizeof(double);
+	double* actualMeetings = (double*)Allocate(meetingsByteSize);
+	double* reconstructedMeetings = (double*)Allocate(meetingsByteSize);
+	VERIFY(actualMeetings != NULL && reconstructedMeetings != NULL);
+
+	// compute the meetings of the pairs of users, tile by tile in parallel
+	MeetingDisclosureMetricTask task;
+	task.Nusers = Nusers;
+	task.numTimes = numTimes;
+	task.numLoc = numLoc;
+	task.timeIndices = &timeIndices[0];
+	task.locIndices = &locIndices[0];
+	task.localizationDistribution = localizationDistribution;
+	task.actualMeetings = actualMeetings;
+	task.reconstructedMeetings = reconstructedMeetings;
+
+	ull numBlocks = (Nusers + MEETING_DISCLOSURE_TILE_USERS - 1) / MEETING_DISCLOSURE_TILE_USERS;
+	for(ull firstBlock = 0; firstBlock < numBlocks; firstBlock++)
 	{
-		ull firstUserIndex = indexPairsIter->first;
-		ull secondUserIndex = indexPairsIter->second;
-
-		for(ull tm = minTime; tm <= maxTime; tm++)
-		{
-			for(ull loc = minLoc; loc <= maxLoc; loc++)
-			{
-				ull firstProbIndex = GET_INDEX_3D(firstUserIndex, (loc - minLoc), (tm - minTime), numLoc, numTimes);
-				ull secondProbIndex = GET_INDEX_3D(secondUserIndex, (loc - minLoc), (tm - minTime), numLoc, numTimes);
-
-				reconstructedMeetings[pairIndex] += (localizationDistribution[firstProbIndex] * localizationDistribution[secondProbIndex]);
-			}
-		}
-
-		pairIndex++;
+		for(ull secondBlock = firstBlock; secondBlock < numBlocks; secondBlock++) { task.tiles.push_back(pair<ull, ull>(firstBlock, secondBlock)); }
 	}
 
-	stringstream info("");
-	info << "Outputting meeting disclosure!";
-
-	Log::GetInstance()->Append(info.str());
+	VERIFY(Threads::ParallelFor(task.tiles.size(), &task) == true);
 
+	Log::GetInstance()->Append("Outputting meeting disclosure!");
 
-	pairIndex = 0;
-	pair_foreach_const(map<ull, ull>, usersPairs, pairsIter)
+	ull pairIndex = 0;
+	for(ull firstUserIndex = 0; firstUserIndex < Nusers; firstUserIndex++)
 	{
-		ull firstUser = pairsIter->first;
-		ull secondUser = pairsIter->second;
-
-		stringstream ss("");
-		double abs = ABS(actualMeetings[pairIndex] - reconstructedMeetings[pairIndex]);
-		ss << firstUser << ", " << secondUser << ": " << abs;
+		for(ull secondUserIndex = firstUserIndex + 1; secondUserIndex < Nusers; secondUserIndex++)
+		{
+			stringstream ss("");
+			double abs = ABS(actualMeetings[pairIndex] - reconstructedMeetings[pairIndex]);
+			ss << users[firstUserIndex] << ", " << users[secondUserIndex] << ": " << abs;
 
-		output->WriteLine(ss.str());
+			output->WriteLine(ss.str());
 
-		pairIndex++;
+			pairIndex++;
+		}
 	}
 
 	Free(actualMeetings);
@@ -2,6 +2,8 @@
 //! \file
 //!
 #include "../include/Parameters.h"
+#include "../include/Threads.h"
+#include "../include/ExecutionContext.h"
 
 namespace lpm {
 
@@ -22,6 +24,10 @@ Parameters::Parameters()
     tpInfo.propTPVector = NULL;
     tpInfo.propTransMatrix = NULL;
 
+	numThreads = Threads::GetProcessorsCount();
+
+	ownsTimePartitioning = true;
+
   // Bouml preserved body end 0002F211
 }
 
@@ -31,11 +37,79 @@ Parameters::~Parameters()
 
 	if(tpInfo.propTPVector != NULL) { Free(tpInfo.propTPVector); }
 	if(tpInfo.propTransMatrix != NULL) { Free(tpInfo.propTransMatrix); }
-	if(tpInfo.partitioning != NULL) { delete tpInfo.partitioning; }
+	if(tpInfo.partitioning != NULL && ownsTimePartitioning == true) { delete tpInfo.partitioning; }
 
   // Bouml preserved body end 000B1291
 }
 
+//!
+//! \brief Returns the parameters of the execution context active on the calling thread (see ExecutionContext), or the global parameters if none
+//!
+//! \return Parameters*, the parameters
+//!
+Parameters* Parameters::GetInstance()
+{
+  // Bouml preserved body begin 000E4291
+
+	ExecutionContext* context = ExecutionContext::GetCurrent();
+	if(context != NULL) { return context->GetParameters(); }
+
+	return Singleton<Parameters>::GetInstance();
+
+  // Bouml preserved body end 000E4291
+}
+
+//!
+//! \brief Copies the given parameters
+//!
+//! \note The time partitioning is shared with \a source (which keeps ownership of it).
+//!
+//! \param[in] source 	Parameters*, the parameters to copy.
+//!
+//! \return true or false, depending on whether the call is successful
+//!
+bool Parameters::CopyFrom(const Parameters* source)
+{
+  // Bouml preserved body begin 000E4311
+
+	if(source == NULL || source == this)
+	{
+		SET_ERROR_CODE(ERROR_CODE_INVALID_ARGUMENTS);
+		return false;
+	}
+
+	minTimestamp = source->minTimestamp; maxTimestamp = source->maxTimestamp;
+	minLocationstamp = source->minLocationstamp; maxLocationstamp = source->maxLocationstamp;
+	usersRanges = source->usersRanges;
+	numThreads = source->numThreads;
+
+	if(tpInfo.propTPVector != NULL) { Free(tpInfo.propTPVector); }
+	if(tpInfo.propTransMatrix != NULL) { Free(tpInfo.propTransMatrix); }
+	if(tpInfo.partitioning != NULL && ownsTimePartitioning == true) { delete tpInfo.partitioning; }
+
+	tpInfo = source->tpInfo;
+	ownsTimePartitioning = false;
+
+	// the arrays are owned by each copy
+	if(source->tpInfo.propTPVector != NULL)
+	{
+		ull byteSize = tpInfo.numPeriods * sizeof(double);
+		tpInfo.propTPVector = (double*)Allocate(byteSize);
+		VERIFY(tpInfo.propTPVector != NULL); memcpy(tpInfo.propTPVector, source->tpInfo.propTPVector, byteSize);
+	}
+
+	if(source->tpInfo.propTransMatrix != NULL)
+	{
+		ull byteSize = tpInfo.numPeriodsInclDummies * tpInfo.numPeriodsInclDummies * sizeof(double);
+		tpInfo.propTransMatrix = (double*)Allocate(byteSize);
+		VERIFY(tpInfo.propTransMatrix != NULL); memcpy(tpInfo.propTransMatrix, source->tpInfo.propTransMatrix, byteSize);
+	}
+
+	return true;
+
+  // Bouml preserved body end 000E4311
+}
+
 bool Parameters::GetUsersSet(set<ull>& users) 
 {
   // Bouml preserved body begin 000A0691
@@ -411,6 +485,44 @@ bool Parameters::GetTimePeriodInfo(ull* numPeriods, TPInfo* tpInfo)
   // Bouml preserved body end 000AAA11
 }
 
+//!
+//! \brief Returns the number of threads used by the parallel computations of the library
+//!
+//! \return ull, the number of threads (defaults to the number of online processors)
+//!
+ull Parameters::GetThreadsCount() const
+{
+  // Bouml preserved body begin 000E1511
+
+	return numThreads;
+
+  // Bouml preserved body end 000E1511
+}
+
+//!
+//! \brief Sets the number of threads used by the parallel computations of the library
+//!
+//! \param[in] count 	ull, the number of threads (1 disables multi-threading).
+//!
+//! \return true or false, depending on whether the call is successful
+//!
+bool Parameters::SetThreadsCount(ull count)
+{
+  // Bouml preserved body begin 000E1591
+
+	if(count == 0)
+	{
+		SET_ERROR_CODE(ERROR_CODE_INVALID_ARGUMENTS);
+		return false;
+	}
+
+	numThreads = count;
+
+	return true;
+
+  // Bouml preserved body end 000E1591
+}
+
 bool Parameters::InitializeTPInfo(TPNode* partitioning) 
 {
   // Bouml preserved body begin 000B7E11
@@ -489,8 +601,9 @@ bool Parameters::InitializeTPInfo(TPNode* partitioning)
 	}
 
 
-	if(tpInfo.partitioning != NULL) { delete tpInfo.partitioning; }
+	if(tpInfo.partitioning != NULL && ownsTimePartitioning == true) { delete tpInfo.partitioning; }
 	tpInfo.partitioning = partitioning;
+	ownsTimePartitioning = true;
 
 
 	// compute the number of time periods
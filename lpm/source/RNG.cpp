@@ -7,56 +7,164 @@
 
 namespace lpm {
 
-RNG::RNG() 
+// splitmix64 (used to expand a 64 bits seed into the state of the engine)
+static inline uint64 SplitMix64(uint64* x)
 {
-  // Bouml preserved body begin 00039691
+	uint64 z = (*x += 0x9e3779b97f4a7c15ULL);
+	z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+	return z ^ (z >> 31);
+}
+
+static inline uint64 RotateLeft(const uint64 x, int k)
+{
+	return (x << k) | (x >> (64 - k));
+}
 
-	srand(time(NULL) ^ clock());
+// stream used by the calling thread instead of the shared one (see RNG::SetThreadStream())
+static __thread RNGStream* threadStream = NULL;
 
-  // Bouml preserved body end 00039691
+RNGStream::RNGStream()
+{
+  // Bouml preserved body begin 000E1811
+
+	Seed(0);
+
+  // Bouml preserved body end 000E1811
 }
 
-uint64 RNG::RandomUINT64() const 
+RNGStream::RNGStream(uint64 seed)
 {
-  // Bouml preserved body begin 00039791
+  // Bouml preserved body begin 000E1891
 
-	return (uint64)(((uint64)-1) * GetUniformRandomDouble());
+	Seed(seed);
 
-  // Bouml preserved body end 00039791
+  // Bouml preserved body end 000E1891
 }
 
-//! 
-//! \brief Returns a uniform random double in ]0; 1[
 //!
-//! \return double, the number generated
+//! \brief Seeds the stream (the 256 bits of state are expanded from \a seed with splitmix64)
 //!
-double RNG::GetUniformRandomDouble() const 
+//! \param[in] seed 	uint64, the seed.
+//!
+//! \return nothing
+//!
+void RNGStream::Seed(uint64 seed)
 {
-  // Bouml preserved body begin 00039611
+  // Bouml preserved body begin 000E1911
 
-	double r = 0.0;
+	uint64 x = seed;
+	for(ull i = 0; i < 4; i++) { state[i] = SplitMix64(&x); }
 
-	do
+  // Bouml preserved body end 000E1911
+}
+
+//!
+//! \brief Advances the stream by 2^128 steps
+//!
+//! This is equivalent to 2^128 calls to GetRandomUINT64() and is used to generate non-overlapping sub-streams.
+//!
+//! \return nothing
+//!
+void RNGStream::Jump()
+{
+  // Bouml preserved body begin 000E1991
+
+	static const uint64 jump[] = { 0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL, 0xa9582618e03fc9aaULL, 0x39abdc4529b1661cULL };
+
+	JumpBy(jump);
+
+  // Bouml preserved body end 000E1991
+}
+
+//!
+//! \brief Advances the stream by 2^192 steps
+//!
+//! This is used to generate non-overlapping streams, each of which can itself be split into 2^64 sub-streams with Jump().
+//!
+//! \return nothing
+//!
+void RNGStream::LongJump()
+{
+  // Bouml preserved body begin 000E2991
+
+	static const uint64 longJump[] = { 0x76e15d3efefdcbbfULL, 0xc5004e441c522fb3ULL, 0x77710069854ee241ULL, 0x39109bb02acbe635ULL };
+
+	JumpBy(longJump);
+
+  // Bouml preserved body end 000E2991
+}
+
+void RNGStream::JumpBy(const uint64* polynomial)
+{
+	uint64 s0 = 0; uint64 s1 = 0; uint64 s2 = 0; uint64 s3 = 0;
+	for(ull i = 0; i < 4; i++)
 	{
-		r = (double)rand() * (double)(1.0 / (double)(RAND_MAX));
+		for(ull b = 0; b < 64; b++)
+		{
+			if(polynomial[i] & (1ULL << b))
+			{
+				s0 ^= state[0]; s1 ^= state[1]; s2 ^= state[2]; s3 ^= state[3];
+			}
+			Next();
+		}
 	}
-	while(r <= 0.0 || r >= 1.0); // rejection sampling to make the bounds exclusive: i.e. r \in ]0, 1[
 
-	return r;
+	state[0] = s0; state[1] = s1; state[2] = s2; state[3] = s3;
+}
 
-  // Bouml preserved body end 00039611
+//!
+//! \brief Returns a uniform random 64 bits unsigned integer
+//!
+//! \return uint64, the number generated
+//!
+uint64 RNGStream::GetRandomUINT64()
+{
+  // Bouml preserved body begin 000E1A11
+
+	return Next();
+
+  // Bouml preserved body end 000E1A11
 }
 
-ull RNG::GetUniformRandomULL() const 
+//!
+//! \brief Returns a uniform random double in ]0; 1[ (with 52 bits of precision)
+//!
+//! \return double, the number generated
+//!
+double RNGStream::GetUniformRandomDouble()
 {
-  // Bouml preserved body begin 0003D091
+  // Bouml preserved body begin 000E1A91
 
-	return (ull)RandomUINT64();
+	// the 52 most significant bits, shifted by half a step to make the bounds exclusive: i.e. r \in ]0, 1[
+	return ((double)(Next() >> 12) + 0.5) * (1.0 / 4503599627370496.0);
 
-  // Bouml preserved body end 0003D091
+  // Bouml preserved body end 000E1A91
 }
 
-//! 
+//!
+//! \brief Fills the given array with uniform random doubles in ]0; 1[
+//!
+//! \param[in,out] output 	double*, the output array (an array of \a count doubles).
+//! \param[in] count 	ull, the number of doubles to generate.
+//!
+//! \return nothing
+//!
+void RNGStream::FillUniform(double* output, ull count)
+{
+  // Bouml preserved body begin 000E1B11
+
+	DEBUG_VERIFY(output != NULL || count == 0);
+
+	for(ull i = 0; i < count; i++)
+	{
+		output[i] = ((double)(Next() >> 12) + 0.5) * (1.0 / 4503599627370496.0);
+	}
+
+  // Bouml preserved body end 000E1B11
+}
+
+//!
 //! \brief Returns a uniform random unsigned long long (\a ull) between \a min and \a max (inclusive)
 //!
 //! \param[in] min 	ull, the lower bound.
@@ -64,16 +172,34 @@ ull RNG::GetUniformRandomULL() const
 //!
 //! \return ull, the number generated
 //!
-ull RNG::GetUniformRandomULLBetween(ull min, ull max) const 
+ull RNGStream::GetUniformRandomULLBetween(ull min, ull max)
 {
-  // Bouml preserved body begin 0007B011
+  // Bouml preserved body begin 000E1B91
 
-	return (ull)(min + floor((double)((max - min + 1) * GetUniformRandomDouble())));
+	DEBUG_VERIFY(min <= max);
 
-  // Bouml preserved body end 0007B011
+	uint64 range = max - min + 1;
+	if(range == 0) { return Next(); } // the whole 64 bits range
+
+	// multiply-shift with rejection of the (few) values which would bias the result
+	unsigned __int128 m = (unsigned __int128)Next() * range;
+	uint64 low = (uint64)m;
+	if(low < range)
+	{
+		uint64 threshold = (0 - range) % range;
+		while(low < threshold)
+		{
+			m = (unsigned __int128)Next() * range;
+			low = (uint64)m;
+		}
+	}
+
+	return min + (ull)(m >> 64);
+
+  // Bouml preserved body end 000E1B91
 }
 
-//! 
+//!
 //! \brief Returns a random permutation of the given \a input array
 //!
 //! \param[in] input 	ull*, the input array (an array of \a count \a ulls).
@@ -82,9 +208,9 @@ ull RNG::GetUniformRandomULLBetween(ull min, ull max) const
 //!
 //! \return true or false, depending on whether the call is successful
 //!
-bool RNG::RandomPermutation(const ull* input, const ull count, ull* output) const 
+bool RNGStream::RandomPermutation(const ull* input, const ull count, ull* output)
 {
-  // Bouml preserved body begin 00072891
+  // Bouml preserved body begin 000E1C11
 
 	if(input == NULL || count == 0 || output == NULL) { return false; }
 
@@ -106,24 +232,20 @@ bool RNG::RandomPermutation(const ull* input, const ull count, ull* output) cons
 
 	return true;
 
-  // Bouml preserved body end 00072891
+  // Bouml preserved body end 000E1C11
 }
 
-//! 
-//! \brief Samples (returns an index) from the given probability vector
-//!
-//! Samples an index in the range \[\a 0; \a length - 1\] according to the probabilities given by \a probVector.
 //!
-//! \note Naturally, this only make sense if the elements of \a probVector sum up to 1.
+//! \brief Samples (returns an index) from the given probability vector
 //!
-//! \param[in] probVector 	ull*, the probability vector (an array of \a length \a doubles).
+//! \param[in] probVector 	double*, the probability vector (an array of \a length \a doubles).
 //! \param[in] length 	ull, the number of elements in the probability vector
 //!
 //! \return ull, the sampled index
 //!
-ull RNG::SampleIndexFromVector(double* probVector, ull length) const 
+ull RNGStream::SampleIndexFromVector(const double* probVector, ull length)
 {
-  // Bouml preserved body begin 0007FE91
+  // Bouml preserved body begin 000E1C91
 
 	DEBUG_VERIFY(probVector != NULL && length != 0);
 
@@ -142,12 +264,12 @@ ull RNG::SampleIndexFromVector(double* probVector, ull length) const
 
 	return -1;
 
-  // Bouml preserved body end 0007FE91
+  // Bouml preserved body end 000E1C91
 }
 
-double RNG::GetGaussianRandomDouble(double sigma) const 
+double RNGStream::GetGaussianRandomDouble(double sigma)
 {
-  // Bouml preserved body begin 0007FF91
+  // Bouml preserved body begin 000E1D11
 
 	double x = 0.0;
 	double y = 0.0;
@@ -168,12 +290,46 @@ double RNG::GetGaussianRandomDouble(double sigma) const
 	/* Box-Muller transform */
 	return sigma * y * sqrt(-2.0 * log(norm) / norm);
 
-  // Bouml preserved body end 0007FF91
+  // Bouml preserved body end 000E1D11
+}
+
+//!
+//! \brief Fills the given array with standard normal random doubles (Box-Muller transform on bulk uniforms)
+//!
+//! \param[in,out] output 	double*, the output array (an array of \a count doubles).
+//! \param[in] count 	ull, the number of doubles to generate.
+//!
+//! \return nothing
+//!
+void RNGStream::FillGaussian(double* output, ull count)
+{
+  // Bouml preserved body begin 000E2491
+
+	DEBUG_VERIFY(output != NULL || count == 0);
+
+	if(count == 0) { return; }
+
+	// the uniforms are first written in the output array, each pair is then transformed in place into two normals
+	FillUniform(output, count);
+
+	ull pairs = count / 2;
+	for(ull i = 0; i < pairs; i++)
+	{
+		double r = sqrt(-2.0 * log(output[2 * i]));
+		double angle = 2.0 * M_PI * output[2 * i + 1];
+
+		output[2 * i] = r * cos(angle);
+		output[2 * i + 1] = r * sin(angle);
+	}
+
+	if(count % 2 == 1) { output[count - 1] = GetGaussianRandomDouble(1.0); }
+
+  // Bouml preserved body end 000E2491
 }
 
-double RNG::GetGammaRandomDouble(double a, double b) const 
+double RNGStream::GetGammaRandomDouble(double a, double b)
 {
-  // Bouml preserved body begin 00080011
+  // Bouml preserved body begin 000E1D91
 
 	//VERIFY(a > 0);
 	if(a == 0.0) { return 0.0; }
@@ -216,105 +372,127 @@ double RNG::GetGammaRandomDouble(double a, double b) const
 
 	return b * d * v;
 
-  // Bouml preserved body end 00080011
+  // Bouml preserved body end 000E1D91
 }
 
-void RNG::GetDirichletRandomSampleSmall(const double* alpha, ull K, double* theta) const 
+//!
+//! \brief Draws one Gamma(\a alpha[i], 1) variate per entry and returns its logarithm
+//!
+//! The variates are drawn in batches (Marsaglia-Tsang, with the rejected entries redrawn in the next batch). For \a alpha[i] < 1,
+//! a Gamma(\a alpha[i] + 1, 1) variate is boosted by U^(1 / \a alpha[i]) in the log domain, which cannot underflow.
+//! Entries with \a alpha[i] <= 0 are set to -HUGE_VAL (i.e. log(0)).
+//!
+//! \param[in] alpha 	double*, the shape parameters (an array of \a K doubles).
+//! \param[in] K 	ull, the number of variates.
+//! \param[in,out] logGamma 	double*, the output array (an array of \a K doubles).
+//!
+//! \return nothing
+//!
+void RNGStream::GetGammaRandomLogSample(const double* alpha, ull K, double* logGamma)
 {
-  // Bouml preserved body begin 00080091
+  // Bouml preserved body begin 000E2511
 
-	/* When the values of alpha[] are small, scale the variates to avoid
-		underflow so that the result is not 0/0.  Note that the Dirichlet
-		distribution is defined by a ratio of gamma functions so we can
-		take out an arbitrary factor to keep the values in the range of
-		double precision. */
+	DEBUG_VERIFY(alpha != NULL && logGamma != NULL);
 
-	DEBUG_VERIFY(alpha != NULL && K != 0 && theta != NULL);
+	vector<ull> pending = vector<ull>(); pending.reserve(K); // entries still to be drawn
+	vector<ull> boosted = vector<ull>(); // entries with alpha < 1
 
-	size_t i = 0;
-	double norm = 0.0;
-	double umax = 0;
-
-	for (i = 0; i < K; i++)
+	for(ull i = 0; i < K; i++)
 	{
-		double u = log(GetUniformRandomDouble()) / alpha[i];
+		if(alpha[i] <= 0.0) { logGamma[i] = -HUGE_VAL; continue; }
 
-		theta[i] = u;
-
-		if (u > umax || i == 0) { umax = u; }
+		pending.push_back(i);
+		if(alpha[i] < 1.0) { boosted.push_back(i); }
 	}
 
-	for (i = 0; i < K; i++)
+	vector<double> normals = vector<double>(pending.size());
+	vector<double> uniforms = vector<double>(pending.size());
+
+	while(pending.empty() == false)
 	{
-		double e = theta[i] - umax;
-		double r = exp(e);
-		bool err = (errno == ERANGE) || (errno == -ERANGE);
-		if(err == true) { r = SQRT_DBL_MIN; }
+		ull count = pending.size();
+		FillGaussian(&normals[0], count);
+		FillUniform(&uniforms[0], count);
 
-		theta[i] = (double)r;
+		ull rejected = 0;
+		for(ull j = 0; j < count; j++)
+		{
+			ull i = pending[j];
+			double a = (alpha[i] < 1.0) ? alpha[i] + 1.0 : alpha[i];
+			double d = a - 1.0 / 3.0;
+			double c = (1.0 / 3.0) / sqrt(d);
+
+			double x = normals[j];
+			double v = 1.0 + c * x;
+			if(v > 0.0)
+			{
+				v = v * v * v;
+				double u = uniforms[j];
+				double x2 = x * x;
+
+				if(u < (1.0 - 0.0331 * x2 * x2) || log(u) < (0.5 * x2 + d * (1.0 - v + log(v))))
+				{
+					logGamma[i] = log(d * v);
+					continue;
+				}
+			}
+
+			pending[rejected++] = i; // redraw in the next batch
+		}
 
+		pending.resize(rejected);
 	}
 
-	for (i = 0; i < K; i++)
+	if(boosted.empty() == false)
 	{
-		// FIX 02.04.2012: if alpha[i] is 0.0, then theta[i] should be 0.0
-		if(alpha[i] == 0.0) { theta[i] = 0.0; }
-		else { theta[i] = theta[i] * GetGammaRandomDouble(alpha[i] + 1.0, 1.0); }
-	}
+		FillUniform(&uniforms[0], boosted.size());
 
-	for (i = 0; i < K; i++)
-	{
-		norm += theta[i];
-	}
-
-	for (i = 0; i < K; i++)
-	{
-		theta[i] /= norm;
+		for(ull j = 0; j < boosted.size(); j++)
+		{
+			ull i = boosted[j];
+			logGamma[i] += log(uniforms[j]) / alpha[i];
+		}
 	}
 
-  // Bouml preserved body end 00080091
+  // Bouml preserved body end 000E2511
 }
 
-void RNG::GetDirichletRandomSample(const double* alpha, ull K, double* theta) const 
+void RNGStream::GetDirichletRandomSample(const double* alpha, ull K, double* theta)
 {
-  // Bouml preserved body begin 00080111
+  // Bouml preserved body begin 000E1E11
 
-	// TODO: check all of this -- the theory also
 	DEBUG_VERIFY(alpha != NULL && K != 0 && theta != NULL);
 
-	memset(theta, 0, K * sizeof(double));
+	// draw the gamma variates in the log domain and normalize them with the log-sum-exp trick
+	// (this handles small values of alpha without the need for a separate underflow path)
+	GetGammaRandomLogSample(alpha, K, theta);
 
 	ull i = 0;
-	double norm = 0.0;
-
-	bool underflow = false;
-
+	double maxLog = -HUGE_VAL;
 	for (i = 0; i < K; i++)
 	{
-		double g = GetGammaRandomDouble(alpha[i], 1.0);
-		if((g == 0) && (alpha[i] > 0)) { underflow = true; } // underflow
-
-		theta[i] = g;
+		if(alpha[i] > 0.0 && theta[i] > maxLog) { maxLog = theta[i]; }
 	}
 
-	for (i = 0; i < K; i++)
+	if(maxLog == -HUGE_VAL) // all alpha[i] are 0.0
 	{
-		norm += theta[i];
+		memset(theta, 0, K * sizeof(double));
+		return;
 	}
 
-	if(norm < SQRT_DBL_MIN || underflow == true)  /* Handle underflow */
+	double norm = 0.0;
+	for (i = 0; i < K; i++)
 	{
-		GetDirichletRandomSampleSmall(alpha, K, theta);
-
-		return;
+		// FIX 02.04.2012: if alpha[i] is 0.0, then theta[i] should be 0.0
+		theta[i] = (alpha[i] > 0.0) ? exp(theta[i] - maxLog) : 0.0;
+		norm += theta[i];
 	}
 
 	bool renormalize = false;
 	for (i = 0; i < K; i++)
 	{
-		double t = theta[i];
 		theta[i] /= norm;
-		if(t > 0 && theta[i] == 0) { theta[i] = SQRT_DBL_MIN; renormalize = true;}  // prevent underflow
+		if(alpha[i] > 0.0 && theta[i] == 0.0) { theta[i] = SQRT_DBL_MIN; renormalize = true; }  // prevent underflow
 	}
 
 	if(renormalize == true)
@@ -331,10 +509,378 @@ void RNG::GetDirichletRandomSample(const double* alpha, ull K, double* theta) co
 		}
 	}
 
+  // Bouml preserved body end 000E1E11
+}
+
+uint64 RNGStream::Next()
+{
+  // Bouml preserved body begin 000E1E91
+
+	// xoshiro256++ (see: http://prng.di.unimi.it/)
+	const uint64 result = RotateLeft(state[0] + state[3], 23) + state[0];
+	const uint64 t = state[1] << 17;
+
+	state[2] ^= state[0];
+	state[3] ^= state[1];
+	state[1] ^= state[2];
+	state[0] ^= state[3];
+
+	state[2] ^= t;
+	state[3] = RotateLeft(state[3], 45);
+
+	return result;
+
+  // Bouml preserved body end 000E1E91
+}
+
+AliasTable::AliasTable() : threshold(), alias()
+{
+  // Bouml preserved body begin 000E2191
+  // Bouml preserved body end 000E2191
+}
+
+//!
+//! \brief Builds the table of the given probability vector (Vose's method)
+//!
+//! \note The vector does not need to be normalized, but its elements must be non-negative and sum up to a positive value.
+//!
+//! \param[in] probVector 	double*, the probability vector (an array of \a length \a doubles).
+//! \param[in] length 	ull, the number of elements in the probability vector.
+//!
+//! \return true or false, depending on whether the call is successful
+//!
+bool AliasTable::Build(const double* probVector, ull length)
+{
+  // Bouml preserved body begin 000E2211
+
+	threshold.clear(); alias.clear();
+
+	if(probVector == NULL || length == 0) { return false; }
+
+	double sum = 0.0;
+	for(ull i = 0; i < length; i++)
+	{
+		if(probVector[i] < 0.0) { return false; }
+		sum += probVector[i];
+	}
+	if(sum <= 0.0) { return false; }
+
+	threshold = vector<double>(length, 1.0);
+	alias = vector<ull>(length, 0);
+
+	// scaled probabilities: the mean is 1, entries below 1 are "small" and those above are "large"
+	vector<double> scaled = vector<double>(length, 0.0);
+	vector<ull> small = vector<ull>(); small.reserve(length);
+	vector<ull> large = vector<ull>(); large.reserve(length);
+	for(ull i = 0; i < length; i++)
+	{
+		scaled[i] = probVector[i] * (double)length / sum;
+		alias[i] = i;
+
+		if(scaled[i] < 1.0) { small.push_back(i); }
+		else { large.push_back(i); }
+	}
+
+	while(small.empty() == false && large.empty() == false)
+	{
+		ull s = small.back(); small.pop_back();
+		ull l = large.back(); large.pop_back();
+
+		threshold[s] = scaled[s];
+		alias[s] = l;
+
+		scaled[l] = (scaled[l] + scaled[s]) - 1.0;
+		if(scaled[l] < 1.0) { small.push_back(l); }
+		else { large.push_back(l); }
+	}
+
+	// the remaining entries (in either list) are full, up to rounding errors
+	foreach_const(vector<ull>, small, iter) { threshold[*iter] = 1.0; }
+	foreach_const(vector<ull>, large, iter) { threshold[*iter] = 1.0; }
+
+	return true;
+
+  // Bouml preserved body end 000E2211
+}
+
+//!
+//! \brief Returns the number of elements of the distribution (0 if the table has not been built)
+//!
+//! \return ull, the number of elements
+//!
+ull AliasTable::GetLength() const
+{
+  // Bouml preserved body begin 000E2291
+
+	return threshold.size();
+
+  // Bouml preserved body end 000E2291
+}
+
+//!
+//! \brief Samples an index in the range \[\a 0; \a length - 1\] using the given stream
+//!
+//! \param[in] stream 	RNGStream*, the random stream to draw from.
+//!
+//! \return ull, the sampled index
+//!
+ull AliasTable::Sample(RNGStream* stream) const
+{
+  // Bouml preserved body begin 000E2311
+
+	DEBUG_VERIFY(stream != NULL && threshold.empty() == false);
+
+	return Lookup(stream->GetUniformRandomDouble());
+
+  // Bouml preserved body end 000E2311
+}
+
+//!
+//! \brief Samples an index in the range \[\a 0; \a length - 1\] using the shared stream of the RNG
+//!
+//! \return ull, the sampled index
+//!
+ull AliasTable::Sample() const
+{
+  // Bouml preserved body begin 000E2391
+
+	DEBUG_VERIFY(threshold.empty() == false);
+
+	return Lookup(RNG::GetInstance()->GetUniformRandomDouble());
+
+  // Bouml preserved body end 000E2391
+}
+
+ull AliasTable::Lookup(double u) const
+{
+  // Bouml preserved body begin 000E2411
+
+	// a single uniform variate selects both the column (integer part) and the coin flip (fractional part)
+	ull length = threshold.size();
+	double x = u * (double)length;
+	ull column = MIN((ull)x, length - 1);
+
+	return ((x - (double)column) < threshold[column]) ? column : alias[column];
+
+  // Bouml preserved body end 000E2411
+}
+
+RNG::RNG()
+{
+  // Bouml preserved body begin 00039691
+
+	seed = (uint64)time(NULL) ^ ((uint64)clock() << 32);
+	stream.Seed(seed);
+
+  // Bouml preserved body end 00039691
+}
+
+//!
+//! \brief Seeds the generator (e.g. to make a run reproducible)
+//!
+//! \param[in] seed 	uint64, the seed.
+//!
+//! \return nothing
+//!
+void RNG::SetSeed(uint64 seed)
+{
+  // Bouml preserved body begin 000E1F91
+
+	ScopedLock lock(mutex);
+
+	this->seed = seed;
+	stream.Seed(seed);
+
+  // Bouml preserved body end 000E1F91
+}
+
+//!
+//! \brief Returns the seed of the generator
+//!
+//! \return uint64, the seed (by default, derived from the current time)
+//!
+uint64 RNG::GetSeed() const
+{
+  // Bouml preserved body begin 000E2011
+
+	return seed;
+
+  // Bouml preserved body end 000E2011
+}
+
+//!
+//! \brief Returns a new independent stream
+//!
+//! The returned stream starts at the current position of the shared stream, which is then jumped ahead by 2^128 steps.
+//! Hence, the sequence of streams returned only depends on the seed and the order of the calls.
+//!
+//! \return RNGStream, the new stream
+//!
+RNGStream RNG::CreateStream()
+{
+  // Bouml preserved body begin 000E2091
+
+	if(threadStream != NULL) // sub-stream of the stream of the calling thread
+	{
+		RNGStream newStream = *threadStream;
+		threadStream->Jump();
+
+		return newStream;
+	}
+
+	ScopedLock lock(mutex);
+
+	RNGStream newStream = stream;
+	stream.LongJump();
+
+	return newStream;
+
+  // Bouml preserved body end 000E2091
+}
+
+//!
+//! \brief Sets the stream used by the calling thread
+//!
+//! While set, the methods of the singleton called from this thread draw from the given stream (without locking) instead of the shared stream,
+//! and CreateStream() returns sub-streams of it. This makes the numbers drawn by a unit of work independent of the other threads.
+//!
+//! \param[in] stream 	RNGStream*, the stream (NULL to use the shared stream again).
+//!
+//! \return RNGStream*, the stream previously used by the calling thread (NULL if it used the shared stream)
+//!
+RNGStream* RNG::SetThreadStream(RNGStream* stream)
+{
+  // Bouml preserved body begin 000E2A11
+
+	RNGStream* previousStream = threadStream;
+	threadStream = stream;
+
+	return previousStream;
+
+  // Bouml preserved body end 000E2A11
+}
+
+//! 
+//! \brief Returns a uniform random double in ]0; 1[
+//!
+//! \return double, the number generated
+//!
+double RNG::GetUniformRandomDouble() const
+{
+  // Bouml preserved body begin 00039611
+
+	if(threadStream != NULL) { return threadStream->GetUniformRandomDouble(); }
+
+	ScopedLock lock(mutex);
+
+	return stream.GetUniformRandomDouble();
+
+  // Bouml preserved body end 00039611
+}
+
+//!
+//! \brief Fills the given array with uniform random doubles in ]0; 1[
+//!
+//! \param[in,out] output 	double*, the output array (an array of \a count doubles).
+//! \param[in] count 	ull, the number of doubles to generate.
+//!
+//! \return nothing
+//!
+void RNG::FillUniform(double* output, ull count) const
+{
+  // Bouml preserved body begin 000E2111
+
+	if(threadStream != NULL) { threadStream->FillUniform(output, count); return; }
+
+	ScopedLock lock(mutex);
+
+	stream.FillUniform(output, count);
+
+  // Bouml preserved body end 000E2111
+}
+
+//! 
+//! \brief Returns a uniform random unsigned long long (\a ull) between \a min and \a max (inclusive)
+//!
+//! \param[in] min 	ull, the lower bound.
+//! \param[in] max 	ull, the upper bound.
+//!
+//! \return ull, the number generated
+//!
+ull RNG::GetUniformRandomULLBetween(ull min, ull max) const
+{
+  // Bouml preserved body begin 0007B011
+
+	if(threadStream != NULL) { return threadStream->GetUniformRandomULLBetween(min, max); }
+
+	ScopedLock lock(mutex);
+
+	return stream.GetUniformRandomULLBetween(min, max);
+
+  // Bouml preserved body end 0007B011
+}
+
+//! 
+//! \brief Returns a random permutation of the given \a input array
+//!
+//! \param[in] input 	ull*, the input array (an array of \a count \a ulls).
+//! \param[in] count 	ull, the number of elements in the \a input array
+//! \param[in,out] output ull*, the output array (an array of \a count \a ull numbers) which will be filled with the output permutation (if the call is successful).
+//!
+//! \return true or false, depending on whether the call is successful
+//!
+bool RNG::RandomPermutation(const ull* input, const ull count, ull* output) const
+{
+  // Bouml preserved body begin 00072891
+
+	if(threadStream != NULL) { return threadStream->RandomPermutation(input, count, output); }
+
+	ScopedLock lock(mutex);
+
+	return stream.RandomPermutation(input, count, output);
+
+  // Bouml preserved body end 00072891
+}
+
+//! 
+//! \brief Samples (returns an index) from the given probability vector
+//!
+//! Samples an index in the range \[\a 0; \a length - 1\] according to the probabilities given by \a probVector.
+//!
+//! \note Naturally, this only make sense if the elements of \a probVector sum up to 1.
+//!
+//! \param[in] probVector 	ull*, the probability vector (an array of \a length \a doubles).
+//! \param[in] length 	ull, the number of elements in the probability vector
+//!
+//! \return ull, the sampled index
+//!
+ull RNG::SampleIndexFromVector(double* probVector, ull length) const
+{
+  // Bouml preserved body begin 0007FE91
+
+	if(threadStream != NULL) { return threadStream->SampleIndexFromVector(probVector, length); }
+
+	ScopedLock lock(mutex);
+
+	return stream.SampleIndexFromVector(probVector, length);
+
+  // Bouml preserved body end 0007FE91
+}
+
+void RNG::GetDirichletRandomSample(const double* alpha, ull K, double* theta) const
+{
+  // Bouml preserved body begin 00080111
+
+	if(threadStream != NULL) { threadStream->GetDirichletRandomSample(alpha, K, theta); return; }
+
+	ScopedLock lock(mutex);
+
+	stream.GetDirichletRandomSample(alpha, K, theta);
+
   // Bouml preserved body end 00080111
 }
 
-void RNG::GetDirichletExpectedValue(double* alpha, ull K, double* theta) const 
+void RNG::GetDirichletExpectedValue(double* alpha, ull K, double* theta) const
 {
   // Bouml preserved body begin 000BE991
 
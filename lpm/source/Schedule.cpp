@@ -49,6 +49,8 @@ Schedule::Schedule(string name)
 
 	outputOperations = map<SchedulePosition, OutputOperation*>();
 
+	streamingBatchSize = 0; // no streaming
+
   // Bouml preserved body end 00021911
 }
 
@@ -279,6 +281,13 @@ string Schedule::GetDetailString(ull level) const
 		ret += indent + "Metric: " + metricString + "\n";
 	}
 
+	if(streamingBatchSize != 0)
+	{
+		stringstream ss("");
+		ss << indent << "Streaming: batches of " << streamingBatchSize << " users\n";
+		ret += ss.str();
+	}
+
 	if(branchingPosition != ScheduleInvalidPosition)
 	{
 		for(ull branch = 0; branch < branches.size(); branch++)
@@ -151,6 +151,7 @@ bool ScheduleBuilder::ForkSchedule(ushort branches)
 
 		builder->schedule->builder = static_cast<void*>(builder);
 		builder->schedule->startPosition = currentPosition;
+		builder->schedule->streamingBatchSize = schedule->streamingBatchSize;
 		schedule->branches.push_back(builder->schedule);
 		builder->schedule->root = false; // set the schedule as non-root
 	}
@@ -530,5 +531,27 @@ bool ScheduleBuilder::SetMetricType(MetricType type, MetricDistance* distance)
   // Bouml preserved body end 00065211
 }
 
+//! 
+//! \brief Sets the number of users per batch when streaming the users through the stages of the schedule
+//!
+//! \param[in] batchSize 	ull, the number of users per batch (0 disables streaming, which is the default).
+//!
+//! \return true or false, depending on whether the call is successful
+//!
+bool ScheduleBuilder::SetStreamingBatchSize(ull batchSize) 
+{
+  // Bouml preserved body begin 000E2D91
+
+	VERIFY(schedule != NULL);
+
+	if(wasForked == true) { return false; } // the batch size of the branches is set through their own builders
+
+	schedule->streamingBatchSize = batchSize;
+
+	return true;
+
+  // Bouml preserved body end 000E2D91
+}
+
 
 } // namespace lpm
@@ -0,0 +1,255 @@
+//!
+//! \file
+//!
+#include "../include/SimilarityCandidateIndex.h"
+#include "../include/RNG.h"
+
+namespace lpm {
+
+// splitmix64 finalizer (combines the hashes into signature values and band keys)
+static inline uint64 MixHash(uint64 x)
+{
+	x ^= x >> 30; x *= 0xBF58476D1CE4E5B9ULL;
+	x ^= x >> 27; x *= 0x94D049BB133111EBULL;
+	x ^= x >> 31;
+
+	return x;
+}
+
+// signature value of the vectors whose entries are all zero
+const uint64 SIMILARITY_INDEX_EMPTY_HASH = 0xFFFFFFFFFFFFFFFFULL;
+
+//!
+//! \brief Creates an empty index
+//!
+//! \param[in] dimension 	ull, the dimension of the vectors.
+//! \param[in] seed 	uint64, the seed of the hash functions (the vectors are comparable only within an index).
+//! \param[in] bands 	ull, the number of bands.
+//! \param[in] rowsPerBand 	ull, the number of hashes per band.
+//!
+SimilarityCandidateIndex::SimilarityCandidateIndex(ull dimension, uint64 seed, ull bands, ull rowsPerBand)
+{
+  // Bouml preserved body begin 000E4B11
+
+	VERIFY(dimension != 0 && bands != 0 && rowsPerBand != 0);
+
+	this->dimension = dimension;
+	this->bands = bands;
+	this->rowsPerBand = rowsPerBand;
+	numHashes = bands * rowsPerBand;
+
+	numVectors = 0;
+
+	// r ~ Gamma(2, 1), c ~ Gamma(2, 1), beta ~ Uniform(0, 1) for each hash and each dimension
+	RNGStream stream(seed);
+
+	ull numVariates = numHashes * dimension;
+	gammaRates = vector<double>(numVariates);
+	logGammaScales = vector<double>(numVariates);
+	offsets = vector<double>(numVariates);
+	for(ull i = 0; i < numVariates; i++)
+	{
+		gammaRates[i] = -log(stream.GetUniformRandomDouble() * stream.GetUniformRandomDouble());
+		logGammaScales[i] = log(-log(stream.GetUniformRandomDouble() * stream.GetUniformRandomDouble()));
+		offsets[i] = stream.GetUniformRandomDouble();
+	}
+
+  // Bouml preserved body end 000E4B11
+}
+
+SimilarityCandidateIndex::~SimilarityCandidateIndex()
+{
+  // Bouml preserved body begin 000E4B91
+  // Bouml preserved body end 000E4B91
+}
+
+//!
+//! \brief Adds a vector to the index
+//!
+//! \param[in] weights 	const double*, the vector (of the dimension of the index, with non-negative entries).
+//!
+//! \return the index of the vector (i.e. the number of vectors added before it)
+//!
+ull SimilarityCandidateIndex::AddVector(const double* weights)
+{
+  // Bouml preserved body begin 000E4C11
+
+	VERIFY(weights != NULL);
+
+	vector<ull> support = vector<ull>(); vector<double> logWeights = vector<double>();
+	for(ull i = 0; i < dimension; i++)
+	{
+		VERIFY(weights[i] >= 0.0);
+		if(weights[i] > 0.0) { support.push_back(i); logWeights.push_back(log(weights[i])); }
+	}
+
+	// improved consistent weighted sampling: for each hash, the sample (i, t) minimizing ln(a) = ln(c) - r * (t - beta) - r,
+	// where t = floor(ln(w_i) / r + beta)
+	for(ull h = 0; h < numHashes; h++)
+	{
+		uint64 hash = SIMILARITY_INDEX_EMPTY_HASH; double minLogA = DBL_MAX;
+		for(ull k = 0; k < support.size(); k++)
+		{
+			ull idx = GET_INDEX(h, support[k], dimension);
+			double r = gammaRates[idx]; double beta = offsets[idx];
+
+			double t = floor(logWeights[k] / r + beta);
+			double logA = logGammaScales[idx] - r * (t - beta) - r;
+
+			if(logA < minLogA)
+			{
+				minLogA = logA;
+				hash = MixHash((uint64)support[k] ^ MixHash((uint64)(ll)t));
+			}
+		}
+
+		signatures.push_back(hash);
+	}
+
+	return numVectors++;
+
+  // Bouml preserved body end 000E4C11
+}
+
+//!
+//! \brief Returns the number of vectors of the index
+//!
+//! \return the number of vectors
+//!
+ull SimilarityCandidateIndex::GetVectorsCount() const
+{
+  // Bouml preserved body begin 000E4C91
+
+	return numVectors;
+
+  // Bouml preserved body end 000E4C91
+}
+
+//!
+//! \brief Estimates the weighted Jaccard similarity of two vectors of the index
+//!
+//! \param[in] first 	ull, the index of the first vector.
+//! \param[in] second 	ull, the index of the second vector.
+//!
+//! \return the proportion of the hashes of the vectors which are equal
+//!
+double SimilarityCandidateIndex::EstimateSimilarity(ull first, ull second) const
+{
+  // Bouml preserved body begin 000E4D11
+
+	VERIFY(first < numVectors && second < numVectors);
+
+	const uint64* signature1 = &signatures[GET_INDEX(first, 0, numHashes)];
+	const uint64* signature2 = &signatures[GET_INDEX(second, 0, numHashes)];
+
+	ull equal = 0;
+	for(ull h = 0; h < numHashes; h++) { if(signature1[h] == signature2[h]) { equal++; } }
+
+	return (double)equal / (double)numHashes;
+
+  // Bouml preserved body end 000E4D11
+}
+
+//!
+//! \brief Returns the candidate pairs whose estimated similarity is at least the given threshold
+//!
+//! \param[in] minSimilarity 	double, the threshold on the estimated similarity (see EstimateSimilarity()).
+//! \param[out] pairs 	vector<pair<ull, ull> >&, the pairs (first < second, sorted).
+//!
+//! \return nothing
+//!
+void SimilarityCandidateIndex::GetCandidatePairs(double minSimilarity, vector<pair<ull, ull> >& pairs) const
+{
+  // Bouml preserved body begin 000E4D91
+
+	vector<pair<ull, ull> > collidingPairs = vector<pair<ull, ull> >();
+	GetCollidingPairs(collidingPairs);
+
+	pairs.clear();
+	for(ull p = 0; p < collidingPairs.size(); p++)
+	{
+		if(EstimateSimilarity(collidingPairs[p].first, collidingPairs[p].second) >= minSimilarity) { pairs.push_back(collidingPairs[p]); }
+	}
+
+  // Bouml preserved body end 000E4D91
+}
+
+//!
+//! \brief Returns the nearest neighbors of each vector among its candidates
+//!
+//! \param[in] neighbors 	ull, the maximum number of neighbors per vector.
+//! \param[out] neighborsLists 	vector<vector<ull> >&, for each vector, its neighbors (by decreasing estimated similarity).
+//!
+//! \return nothing
+//!
+void SimilarityCandidateIndex::GetNearestNeighbors(ull neighbors, vector<vector<ull> >& neighborsLists) const
+{
+  // Bouml preserved body begin 000E4E11
+
+	vector<pair<ull, ull> > collidingPairs = vector<pair<ull, ull> >();
+	GetCollidingPairs(collidingPairs);
+
+	// candidates of each vector, ordered by decreasing estimated similarity (then by index)
+	vector<vector<pair<double, ull> > > candidates = vector<vector<pair<double, ull> > >(numVectors);
+	for(ull p = 0; p < collidingPairs.size(); p++)
+	{
+		ull first = collidingPairs[p].first; ull second = collidingPairs[p].second;
+		double similarity = EstimateSimilarity(first, second);
+
+		candidates[first].push_back(pair<double, ull>(-similarity, second));
+		candidates[second].push_back(pair<double, ull>(-similarity, first));
+	}
+
+	neighborsLists = vector<vector<ull> >(numVectors);
+	for(ull v = 0; v < numVectors; v++)
+	{
+		vector<pair<double, ull> >& list = candidates[v];
+
+		ull count = MIN(neighbors, (ull)list.size());
+		partial_sort(list.begin(), list.begin() + count, list.end());
+
+		for(ull k = 0; k < count; k++) { neighborsLists[v].push_back(list[k].second); }
+	}
+
+  // Bouml preserved body end 000E4E11
+}
+
+// pairs of vectors which share all the hashes of at least one band (first < second, sorted, without duplicates)
+void SimilarityCandidateIndex::GetCollidingPairs(vector<pair<ull, ull> >& pairs) const
+{
+  // Bouml preserved body begin 000E4E91
+
+	pairs.clear();
+
+	vector<pair<uint64, ull> > keys = vector<pair<uint64, ull> >(numVectors);
+	for(ull b = 0; b < bands; b++)
+	{
+		for(ull v = 0; v < numVectors; v++)
+		{
+			const uint64* band = &signatures[GET_INDEX(v, b * rowsPerBand, numHashes)];
+
+			uint64 key = 0;
+			for(ull r = 0; r < rowsPerBand; r++) { key = MixHash(key ^ band[r]); }
+
+			keys[v] = pair<uint64, ull>(key, v);
+		}
+		sort(keys.begin(), keys.end());
+
+		// each vector of a bucket is paired with the (at most SIMILARITY_INDEX_MAX_BUCKET_WINDOW) next ones
+		for(ull p = 0; p < numVectors; p++)
+		{
+			for(ull q = p + 1; q < numVectors && q <= p + SIMILARITY_INDEX_MAX_BUCKET_WINDOW && keys[q].first == keys[p].first; q++)
+			{
+				pairs.push_back(pair<ull, ull>(keys[p].second, keys[q].second));
+			}
+		}
+	}
+
+	sort(pairs.begin(), pairs.end());
+	pairs.erase(unique(pairs.begin(), pairs.end()), pairs.end());
+
+  // Bouml preserved body end 000E4E91
+}
+
+
+} // namespace lpm
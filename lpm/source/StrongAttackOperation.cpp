@@ -7,10 +7,12 @@
 #include "../include/UserProfile.h"
 #include "../include/MetricOperation.h"
 #include "../include/AttackOutput.h"
+#include "../include/Threads.h"
+#include "../include/Instrumentation.h"
 
 namespace lpm {
 
-StrongAttackOperation::StrongAttackOperation(bool genericRec, ull genericRecSamples, bool viterbiNotAlphaBeta)
+StrongAttackOperation::StrongAttackOperation(bool genericRec, ull genericRecSamples, bool viterbiNotAlphaBeta, ull genericRecChains, ull genericRecMaxSeconds)
 			: AttackOperation("StrongAttackOperation")
 {
   // Bouml preserved body begin 0004CD91
@@ -21,6 +23,8 @@ StrongAttackOperation::StrongAttackOperation(bool genericRec, ull genericRecSamp
 
 	genericReconstruction = genericRec;
 	genericReconstructionSamples = genericRecSamples;
+	genericReconstructionChains = MAX(genericRecChains, 1);
+	genericReconstructionMaxSeconds = genericRecMaxSeconds;
 
 	viterbiInsteadOfAlphaBeta = viterbiNotAlphaBeta;
 
@@ -524,6 +528,26 @@ bool StrongAttackOperation::Execute(const TraceSet* input, AttackOutput* output)
   // Bouml preserved body end 0004CF91
 }
 
+//!
+//! \brief Returns whether the attack processes each user independently of the other users
+//!
+//! This is the case when the Viterbi algorithm is used (without the generic reconstruction) and the LPPM neither anonymizes nor changes pseudonyms:
+//! each user is then tracked on his own observed trace.
+//!
+//! \return true or false, depending on whether the attack is per-user
+//!
+bool StrongAttackOperation::IsPerUser() const 
+{
+  // Bouml preserved body begin 000E2B11
+
+	bool anonymization = CONTAINS_FLAG(lppmFlags, Anonymization);
+	bool pseudonymChange = CONTAINS_FLAG(lppmFlags, PseudonymChange);
+
+	return viterbiInsteadOfAlphaBeta == true && genericReconstruction == false && anonymization == false && pseudonymChange == false;
+
+  // Bouml preserved body end 000E2B11
+}
+
 void StrongAttackOperation::SetGenericReconstructionHint(const TraceSet* actual, const TraceSet* exposed, ull* sigma) 
 {
   // Bouml preserved body begin 000CBD11
@@ -879,6 +903,8 @@ bool StrongAttackOperation::ComputeAlphaBeta(const TraceSet* traces, double** al
 	Free(arnrm);
 /**/
 
+	Instrumentation::GetInstance()->AddToCounter(TrellisCellsCounter, 2 * Nusers * Nusers * numTimes * numLoc); // alpha and beta
+
 	return true;
 
   // Bouml preserved body end 0001F582
@@ -1180,11 +1206,37 @@ bool StrongAttackOperation::ComputeMostLikelyTrace(const TraceSet* traces, const
 	Free(delta);
 	Free(predecessor);
 
+	Instrumentation::GetInstance()->AddToCounter(TrellisCellsCounter, Nusers * numTimes * numLoc);
+
 	return true;
 
   // Bouml preserved body end 0007C991
 }
 
+// runs the chains of the generic reconstruction (one chain per index)
+class StrongAttackOperation::GenericReconstructionChainTask : public ParallelTask
+{
+  public:
+	GenericReconstructionChainTask(const StrongAttackOperation* attack, vector<GenericReconstructionChain>* chains)
+		: attack(attack), chains(chains), results(chains->size(), 0) { }
+
+	virtual void Run(ull index, ull thread)
+	{
+		results[index] = (attack->RunGenericReconstructionChain(&((*chains)[index])) == true) ? 1 : 0;
+	}
+
+	bool Succeeded() const
+	{
+		foreach_const(vector<int>, results, iter) { if(*iter == 0) { return false; } }
+		return true;
+	}
+
+  private:
+	const StrongAttackOperation* attack;
+	vector<GenericReconstructionChain>* chains;
+	vector<int> results; // one entry per chain (not a vector<bool>: threads write distinct entries concurrently)
+};
+
 bool StrongAttackOperation::ProposeSampleA(StrongAttackOperation::GenericReconstructionProposalPackage* package, bool training) const 
 {
   // Bouml preserved body begin 000D2711
@@ -1203,10 +1255,11 @@ bool StrongAttackOperation::ProposeSampleA(StrongAttackOperation::GenericReconst
 	VERIFY(params->GetLocationstampsRange(&minLoc, &maxLoc) == true);
 	//ull numLoc = maxLoc - minLoc + 1;
 
-	RNG* rng = RNG::GetInstance();
+	RNGStream* stream = package->stream;
+	VERIFY(stream != NULL);
 
 	double u = 0.0;
-	if(training == false) { u = rng->GetUniformRandomDouble(); }
+	if(training == false) { u = stream->GetUniformRandomDouble(); }
 
 	// extract stuff in our proposal package
     ull step = package->step;
@@ -1269,7 +1322,7 @@ bool StrongAttackOperation::ProposeSampleA(StrongAttackOperation::GenericReconst
 
 	// 2. propose new sample and get/create events for the proposal
 	ull proposedThisLoc = thisLoc;
-	while(proposedThisLoc == thisLoc) { proposedThisLoc = rng->GetUniformRandomULLBetween(minLoc, maxLoc); }
+	while(proposedThisLoc == thisLoc) { proposedThisLoc = stream->GetUniformRandomULLBetween(minLoc, maxLoc); }
 
 	/** compute ratio **/
 	// create the new actual event
@@ -1397,8 +1450,8 @@ bool StrongAttackOperation::ProposeSampleX(StrongAttackOperation::GenericReconst
 	double u = 0.0;
 	if(training == false)
 	{
-		RNG* rng = RNG::GetInstance();
-		u = rng->GetUniformRandomDouble();
+		VERIFY(package->stream != NULL);
+		u = package->stream->GetUniformRandomDouble();
 	}
 
 	// extract stuff in our proposal package
@@ -1540,10 +1593,11 @@ bool StrongAttackOperation::ProposeSampleSigma(StrongAttackOperation::GenericRec
 	VERIFY(params->GetLocationstampsRange(&minLoc, &maxLoc) == true);
 	//ull numLoc = maxLoc - minLoc + 1;
 
-	RNG* rng = RNG::GetInstance();
+	RNGStream* stream = package->stream;
+	VERIFY(stream != NULL);
 
 	double u = 0.0;
-	if(training == false) { u = rng->GetUniformRandomDouble(); }
+	if(training == false) { u = stream->GetUniformRandomDouble(); }
 
 	// extract stuff in our proposal package
     ull step = package->step;
@@ -1551,7 +1605,7 @@ bool StrongAttackOperation::ProposeSampleSigma(StrongAttackOperation::GenericRec
     bool* currentSampleX = package->currentSampleX;
     ull* currentSampleSigma = package->currentSampleSigma;
     ObservedEvent** observedMatrix = package->observedMatrix;
-    vector<ull> users = package->users;
+    const vector<ull>& users = *(package->users);
     ull user = package->user;
     ull userIdx = package->userIdx;
     //UserProfile* profile = package->profile;
@@ -1565,7 +1619,7 @@ bool StrongAttackOperation::ProposeSampleSigma(StrongAttackOperation::GenericRec
     // logic starts here
 	// determine two users whose observed events we want to swap
 	ull otherUserIdx = userIdx;
-	while(otherUserIdx == userIdx) { otherUserIdx = rng->GetUniformRandomULLBetween(0, Nusers-1); }
+	while(otherUserIdx == userIdx) { otherUserIdx = stream->GetUniformRandomULLBetween(0, Nusers-1); }
 	ull otherUser = users[otherUserIdx];
 
 	const ull timeWindow = (persistentPseudonyms == true) ? numTimes : 1; // for now
@@ -1896,23 +1950,7 @@ bool StrongAttackOperation::GenericReconstruction(const TraceSet* traces, const
 	ull* currentSampleSigma = (ull*)Allocate(currentSampleSigmaByteSize); // current sample matrix Sigma (idx mapping, i.e., matrix of users, times -> observed event idx)
 	VERIFY(currentSampleSigma != NULL); memset(currentSampleSigma, 0, currentSampleSigmaByteSize);
 
-	// initialize the proposal package
-	GenericReconstructionProposalPackage package;
-	memset(&package, 0, sizeof(GenericReconstructionProposalPackage));
-	package.step = 0;
-	package.currentSampleA = currentSampleA;
-	package.currentSampleX = currentSampleX;
-	package.currentSampleSigma = currentSampleSigma;
-	package.observedMatrix = observedMatrix;
-	package.users = users;
-	package.user = 0;
-	package.userIdx = 0;
-	package.profile = NULL;
-	package.tm = 0;
-	package.tmIdx = 0;
-
-
-	// get the initial sample
+	// get the initial sample (shared by all chains)
 	bool persistentPseudonyms = CONTAINS_FLAG(lppmFlags, PseudonymChange) == false;
 	if(persistentPseudonyms == false) // use hints
 	{
@@ -1965,8 +2003,246 @@ bool StrongAttackOperation::GenericReconstruction(const TraceSet* traces, const
 
 		memcpy(currentSampleSigma, sigmaHint, currentSampleSigmaByteSize); // sigma
 
-		// now we have the hint as initial sample
-		// do a random walk to obtain another feasible initial sample
+		// now we have the hint as initial sample, each chain will do a random walk to obtain another feasible initial sample
+	}
+	else // use the result of the most likely trace attack
+	{
+		VERIFY(mostLikelyTrace != NULL);
+		VERIFY(userToPseudonymMap.empty() == false);
+
+		map<ull, Trace*> mapping = map<ull, Trace*>();
+		traces->GetMapping(mapping);
+
+		for(ull userIdx = 0; userIdx < Nusers; userIdx++)
+		{
+			ull user = users[userIdx];
+
+			map<ull, ull>::const_iterator iter = userToPseudonymMap.find(user);
+			VERIFY(iter != userToPseudonymMap.end());
+			ull nym = iter->second;
+
+			map<ull, Trace*>::const_iterator mapIter = mapping.find(nym);
+			VERIFY(mapIter != mapping.end());
+			Trace* trace = mapIter->second;
+
+			vector<Event*> observedEvents = vector<Event*>();
+			trace->GetEvents(observedEvents);
+
+			ull index = 0;
+
+			for(ull tmIdx = 0; tmIdx < numTimes; tmIdx++)
+			{
+				ull tm = minTime + tmIdx;
+
+				ull idx = GET_INDEX(userIdx, tmIdx, numTimes);
+				ull loc = mostLikelyTrace[idx];
+				currentSampleA[idx] = loc;
+
+				ActualEvent* actualEvent = new ActualEvent(user, tm, loc);
+				ExposedEvent* exposedEvent = new ExposedEvent(*actualEvent);
+
+				ObservedEvent* properObservedEvent = dynamic_cast<ObservedEvent*>(observedEvents[tmIdx]);
+				VERIFY(tmIdx == 0 || properObservedEvent->GetEventIndex() == index);
+
+				set<ull> tmSet = set<ull>();
+				properObservedEvent->GetTimestamps(tmSet);
+				VERIFY(tmSet.size() == 1 && (*(tmSet.begin())) == tm);
+
+				index = properObservedEvent->GetEventIndex();
+				properObservedEvent = NULL; // from now on use the event in the observedMatrix
+
+				ObservedEvent* observedEvent = observedMatrix[GET_INDEX(index, tmIdx, numTimes)];
+				VERIFY(observedEvent->GetEventIndex() == index);
+
+				ull sigmaIdx = GET_INDEX(userIdx, tmIdx, numTimes);
+				currentSampleSigma[sigmaIdx] = index;
+
+				VERIFY(actualEvent != NULL && exposedEvent != NULL);
+
+				double lppmProb0 = lppmPDF->PDF(context, actualEvent, observedEvent);
+				double applicationProb0 = applicationPDF->PDF(context, actualEvent, actualEvent);
+
+				double lppmProb1 = lppmPDF->PDF(context, exposedEvent, observedEvent);
+				double applicationProb1 = applicationPDF->PDF(context, actualEvent, exposedEvent);
+
+				double probExposure = applicationProb1 * lppmProb1;
+				double probNonExposure = applicationProb0 * lppmProb0;
+
+				VERIFY(probExposure > 0 || probNonExposure > 0);
+
+				bool exposure = (probExposure >= probNonExposure) ? true : false;
+				currentSampleX[idx] = exposure;
+			}
+		}
+
+	}
+
+	// run the chains: each chain has its own copy of the initial sample, its own random stream and its own counts
+	const ull numChains = genericReconstructionChains;
+	const ull targetSubSamples = (genericReconstructionSamples + numChains - 1) / numChains;
+
+	ss.str("");
+	ss << "Generic Reconstruction: running " << numChains << " chain(s) of " << targetSubSamples << " sub-samples each";
+	if(genericReconstructionMaxSeconds > 0) { ss << " (time budget: " << genericReconstructionMaxSeconds << " seconds)"; }
+	Log::GetInstance()->Append(ss.str());
+
+	vector<GenericReconstructionChain> chains = vector<GenericReconstructionChain>(numChains);
+	ull startTime = time(NULL);
+	for(ull chainIdx = 0; chainIdx < numChains; chainIdx++)
+	{
+		GenericReconstructionChain& chain = chains[chainIdx];
+
+		chain.chainIdx = chainIdx;
+		chain.stream = rng->CreateStream();
+
+		chain.currentSampleA = (ull*)Allocate(currentSampleAByteSize); VERIFY(chain.currentSampleA != NULL);
+		chain.currentSampleX = (bool*)Allocate(currentSampleXByteSize); VERIFY(chain.currentSampleX != NULL);
+		chain.currentSampleSigma = (ull*)Allocate(currentSampleSigmaByteSize); VERIFY(chain.currentSampleSigma != NULL);
+		memcpy(chain.currentSampleA, currentSampleA, currentSampleAByteSize);
+		memcpy(chain.currentSampleX, currentSampleX, currentSampleXByteSize);
+		memcpy(chain.currentSampleSigma, currentSampleSigma, currentSampleSigmaByteSize);
+
+		chain.dist = (double*)Allocate(distributionByteSize); VERIFY(chain.dist != NULL); memset(chain.dist, 0, distributionByteSize);
+		chain.nyms = (double*)Allocate(pseudonymsByteSize); VERIFY(chain.nyms != NULL); memset(chain.nyms, 0, pseudonymsByteSize);
+		chain.sigma = (double*)Allocate(sigmaByteSize); VERIFY(chain.sigma != NULL); memset(chain.sigma, 0, sigmaByteSize);
+
+		chain.targetSubSamples = targetSubSamples;
+		chain.subSamples = 0;
+		chain.steps = 0;
+
+		chain.randomWalkFromHint = (persistentPseudonyms == false);
+		chain.observedMatrix = observedMatrix;
+		chain.users = &users;
+		chain.profiles = &profiles;
+		chain.pseudonymsToIdxMap = &pseudonymsToIdxMap;
+		chain.startTime = startTime;
+	}
+
+	GenericReconstructionChainTask task(this, &chains);
+	VERIFY(Threads::ParallelFor(numChains, &task, numChains) == true);
+	VERIFY(task.Succeeded() == true);
+
+	// pool the counts of all chains
+	vector<vector<double> > meanLocationTraces = vector<vector<double> >();
+	vector<vector<double> > exposureTraces = vector<vector<double> >();
+	ull totalSubSamples = 0;
+
+	foreach_const(vector<GenericReconstructionChain>, chains, iter)
+	{
+		const GenericReconstructionChain& chain = *iter;
+
+		for(ull i = 0; i < Nusers * numTimes * numLoc; i++) { dist[i] += chain.dist[i]; }
+		for(ull i = 0; i < Nusers * numTimes * Nnyms; i++) { nyms[i] += chain.nyms[i]; }
+		for(ull i = 0; i < Nusers * numTimes * numIndex; i++) { sigma[i] += chain.sigma[i]; }
+
+		meanLocationTraces.push_back(chain.meanLocationTrace);
+		exposureTraces.push_back(chain.exposureTrace);
+		totalSubSamples += chain.subSamples;
+
+		ss.str("");
+		ss << "Chain " << chain.chainIdx << ": " << chain.subSamples << " sub-samples after " << chain.steps << " steps";
+		Log::GetInstance()->Append(ss.str());
+
+		Free(chain.currentSampleA);
+		Free(chain.currentSampleX);
+		Free(chain.currentSampleSigma);
+		Free(chain.dist);
+		Free(chain.nyms);
+		Free(chain.sigma);
+	}
+
+	// convergence diagnostics (R-hat close to 1 and ESS close to the number of sub-samples indicate well mixed chains), returned with the output
+	double meanLocationRHat = Algorithms::ComputePotentialScaleReduction(meanLocationTraces);
+	double meanLocationESS = Algorithms::ComputeEffectiveSampleSize(meanLocationTraces);
+	double exposureRHat = Algorithms::ComputePotentialScaleReduction(exposureTraces);
+	double exposureESS = Algorithms::ComputeEffectiveSampleSize(exposureTraces);
+	output->SetGenericReconstructionDiagnostics(meanLocationRHat, meanLocationESS, exposureRHat, exposureESS);
+
+	ss.str("");
+	ss << "Generic Reconstruction done in " << (ull)(time(NULL) - startTime) << " seconds: " << totalSubSamples << " sub-samples";
+	ss << " | mean location: R-hat = " << meanLocationRHat << ", ESS = " << meanLocationESS;
+	ss << " | exposure: R-hat = " << exposureRHat << ", ESS = " << exposureESS;
+	if(numChains == 1) { ss << " (R-hat requires at least 2 chains)"; }
+	Log::GetInstance()->Append(ss.str());
+
+	// cleanup
+	// Free(observedMatrix); don't free it, we give it the output
+	output->SetObservedMatrix(observedMatrix);
+
+	Free(currentSampleA);
+	Free(currentSampleX);
+	Free(currentSampleSigma);
+
+	output->SetGenericReconstructionObjects(dist, sigma, nyms, pseudonymsSet); // set the output
+
+	return true;
+
+  // Bouml preserved body end 000C6D11
+}
+
+bool StrongAttackOperation::RunGenericReconstructionChain(GenericReconstructionChain* chain) const 
+{
+  // Bouml preserved body begin 000E1791
+
+	VERIFY(chain != NULL);
+
+	Parameters* params = Parameters::GetInstance();
+
+	// get time parameters
+	ull minTime = 0; ull maxTime = 0;
+	VERIFY(params->GetTimestampsRange(&minTime, &maxTime) == true);
+	ull numTimes = maxTime - minTime + 1;
+
+	// get location parameters
+	ull minLoc = 0; ull maxLoc = 0;
+	VERIFY(params->GetLocationstampsRange(&minLoc, &maxLoc) == true);
+	ull numLoc = maxLoc - minLoc + 1;
+
+	const vector<ull>& users = *(chain->users);
+	const map<ull, UserProfile*>& profiles = *(chain->profiles);
+	const map<ull, ull>& pseudonymsToIdxMap = *(chain->pseudonymsToIdxMap);
+	ObservedEvent** observedMatrix = chain->observedMatrix;
+
+	ull Nusers = users.size();
+	ull numIndex = Nusers;
+	ull Nnyms = pseudonymsToIdxMap.size();
+
+	ull distributionByteSize =  Nusers * numTimes * numLoc * sizeof(double);
+	ull pseudonymsByteSize =  Nusers * numTimes * Nnyms * sizeof(double);
+	ull sigmaByteSize = Nusers * numTimes * numIndex * sizeof(ull);
+
+	double* dist = chain->dist;
+	double* nyms = chain->nyms;
+	double* sigma = chain->sigma;
+
+	ull* currentSampleA = chain->currentSampleA;
+	bool* currentSampleX = chain->currentSampleX;
+	ull* currentSampleSigma = chain->currentSampleSigma;
+
+	ull currentSampleAByteSize = Nusers * numTimes * sizeof(ull);
+	ull currentSampleXByteSize = Nusers * numTimes * sizeof(bool);
+	ull currentSampleSigmaByteSize = Nusers * numTimes * sizeof(ull);
+
+	stringstream ss("");
+
+	// initialize the proposal package
+	GenericReconstructionProposalPackage package;
+	package.step = 0;
+	package.currentSampleA = currentSampleA;
+	package.currentSampleX = currentSampleX;
+	package.currentSampleSigma = currentSampleSigma;
+	package.observedMatrix = observedMatrix;
+	package.users = &users;
+	package.user = 0;
+	package.userIdx = 0;
+	package.profile = NULL;
+	package.tm = 0;
+	package.tmIdx = 0;
+	package.stream = &(chain->stream);
+
+	if(chain->randomWalkFromHint == true)
+	{
+		// the initial sample is the hint: do a random walk (using the stream of this chain) to obtain another feasible initial sample
 		const ull maxWalkSteps = 100;
 		ull walkSteps = 0; ull step = 0;
 		while(walkSteps < maxWalkSteps)
@@ -2003,15 +2279,15 @@ bool StrongAttackOperation::GenericReconstruction(const TraceSet* traces, const
 
 					vector<string> outputLines = vector<string>();
 					VERIFY(LineFormatter<ull>::GetInstance()->FormatMatrix(currentSampleA, Nusers, numTimes, outputLines) == true);
-					ss.str(""); ss << "Training step: " << step << " - currentSampleA: "; Log::GetInstance()->Append(ss.str());
+					ss.str(""); ss << "Chain " << chain->chainIdx << ": Training step: " << step << " - currentSampleA: "; Log::GetInstance()->Append(ss.str());
 					foreach_const(vector<string>, outputLines, iter) { Log::GetInstance()->Append(*iter); }
 
 					VERIFY(LineFormatter<bool>::GetInstance()->FormatMatrix(currentSampleX, Nusers, numTimes, outputLines) == true);
-					ss.str(""); ss << "Training step: " << step << " - currentSampleX: "; Log::GetInstance()->Append(ss.str());
+					ss.str(""); ss << "Chain " << chain->chainIdx << ": Training step: " << step << " - currentSampleX: "; Log::GetInstance()->Append(ss.str());
 					foreach_const(vector<string>, outputLines, iter) { Log::GetInstance()->Append(*iter); }
 
 					VERIFY(LineFormatter<ull>::GetInstance()->FormatMatrix(currentSampleA, Nusers, numTimes, outputLines) == true);
-					ss.str(""); ss << "Training step: " << step << " - currentSampleSigma: "; Log::GetInstance()->Append(ss.str());
+					ss.str(""); ss << "Chain " << chain->chainIdx << ": Training step: " << step << " - currentSampleSigma: "; Log::GetInstance()->Append(ss.str());
 					foreach_const(vector<string>, outputLines, iter) { Log::GetInstance()->Append(*iter); }
 
 					Log::GetInstance()->Append("");
@@ -2037,7 +2313,7 @@ bool StrongAttackOperation::GenericReconstruction(const TraceSet* traces, const
 #ifdef LOGGING_CURRENT_SAMPLE
 					// log stuff
 					ss.str("");
-					ss << "Training step: " << step << " user = " << user << ", tm = " << tm << " -> accepted: " << accepted;
+					ss << "Chain " << chain->chainIdx << ": Training step: " << step << " user = " << user << ", tm = " << tm << " -> accepted: " << accepted;
 					Log::GetInstance()->Append(ss.str());
 #endif
 				}
@@ -2048,80 +2324,9 @@ bool StrongAttackOperation::GenericReconstruction(const TraceSet* traces, const
 		}
 
 		ss.str("");
-		ss << "Training phase done after " << step << " steps: accepted " << walkSteps << " samples.";
+		ss << "Chain " << chain->chainIdx << ": Training phase done after " << step << " steps: accepted " << walkSteps << " samples.";
 		Log::GetInstance()->Append(ss.str());
 	}
-	else // use the result of the most likely trace attack
-	{
-		VERIFY(mostLikelyTrace != NULL);
-		VERIFY(userToPseudonymMap.empty() == false);
-
-		map<ull, Trace*> mapping = map<ull, Trace*>();
-		traces->GetMapping(mapping);
-
-		for(ull userIdx = 0; userIdx < Nusers; userIdx++)
-		{
-			ull user = users[userIdx];
-
-			map<ull, ull>::const_iterator iter = userToPseudonymMap.find(user);
-			VERIFY(iter != userToPseudonymMap.end());
-			ull nym = iter->second;
-
-			map<ull, Trace*>::const_iterator mapIter = mapping.find(nym);
-			VERIFY(mapIter != mapping.end());
-			Trace* trace = mapIter->second;
-
-			vector<Event*> observedEvents = vector<Event*>();
-			trace->GetEvents(observedEvents);
-
-			ull index = 0;
-
-			for(ull tmIdx = 0; tmIdx < numTimes; tmIdx++)
-			{
-				ull tm = minTime + tmIdx;
-
-				ull idx = GET_INDEX(userIdx, tmIdx, numTimes);
-				ull loc = mostLikelyTrace[idx];
-				currentSampleA[idx] = loc;
-
-				ActualEvent* actualEvent = new ActualEvent(user, tm, loc);
-				ExposedEvent* exposedEvent = new ExposedEvent(*actualEvent);
-
-				ObservedEvent* properObservedEvent = dynamic_cast<ObservedEvent*>(observedEvents[tmIdx]);
-				VERIFY(tmIdx == 0 || properObservedEvent->GetEventIndex() == index);
-
-				set<ull> tmSet = set<ull>();
-				properObservedEvent->GetTimestamps(tmSet);
-				VERIFY(tmSet.size() == 1 && (*(tmSet.begin())) == tm);
-
-				index = properObservedEvent->GetEventIndex();
-				properObservedEvent = NULL; // from now on use the event in the observedMatrix
-
-				ObservedEvent* observedEvent = observedMatrix[GET_INDEX(index, tmIdx, numTimes)];
-				VERIFY(observedEvent->GetEventIndex() == index);
-
-				ull sigmaIdx = GET_INDEX(userIdx, tmIdx, numTimes);
-				currentSampleSigma[sigmaIdx] = index;
-
-				VERIFY(actualEvent != NULL && exposedEvent != NULL);
-
-				double lppmProb0 = lppmPDF->PDF(context, actualEvent, observedEvent);
-				double applicationProb0 = applicationPDF->PDF(context, actualEvent, actualEvent);
-
-				double lppmProb1 = lppmPDF->PDF(context, exposedEvent, observedEvent);
-				double applicationProb1 = applicationPDF->PDF(context, actualEvent, exposedEvent);
-
-				double probExposure = applicationProb1 * lppmProb1;
-				double probNonExposure = applicationProb0 * lppmProb0;
-
-				VERIFY(probExposure > 0 || probNonExposure > 0);
-
-				bool exposure = (probExposure >= probNonExposure) ? true : false;
-				currentSampleX[idx] = exposure;
-			}
-		}
-
-	}
 
 	const ull initialSubSamplesBeforeCheck = 30;
 	const ull subSamplesBeforeCheck = 1; // for now // 100;
@@ -2141,10 +2346,10 @@ bool StrongAttackOperation::GenericReconstruction(const TraceSet* traces, const
 	bool* prevSubSampleX = (bool*)Allocate(currentSampleXByteSize); VERIFY(prevSubSampleX != NULL); memset(prevSubSampleX, 0, currentSampleXByteSize);
 	ull* prevSubSampleSigma = (ull*)Allocate(currentSampleSigmaByteSize); VERIFY(prevSubSampleSigma != NULL); memset(prevSubSampleSigma, 0, currentSampleSigmaByteSize);
 
-	const ull iidSamples = genericReconstructionSamples;
-	const ull maxSeconds = 0; // for now
+	const ull iidSamples = chain->targetSubSamples;
+	const ull maxSeconds = genericReconstructionMaxSeconds;
 
-	ull step = 0; ull startTime = time(NULL);
+	ull step = 0; ull startTime = chain->startTime;
 	while(true)
 	{
 		ull currentTime = time(NULL);
@@ -2177,15 +2382,15 @@ bool StrongAttackOperation::GenericReconstruction(const TraceSet* traces, const
 
 					vector<string> outputLines = vector<string>();
 					VERIFY(LineFormatter<ull>::GetInstance()->FormatMatrix(currentSampleA, Nusers, numTimes, outputLines) == true);
-					ss.str(""); ss << "Step: " << step << " - currentSampleA: "; Log::GetInstance()->Append(ss.str());
+					ss.str(""); ss << "Chain " << chain->chainIdx << ": Step: " << step << " - currentSampleA: "; Log::GetInstance()->Append(ss.str());
 					foreach_const(vector<string>, outputLines, iter) { Log::GetInstance()->Append(*iter); }
 
 					VERIFY(LineFormatter<bool>::GetInstance()->FormatMatrix(currentSampleX, Nusers, numTimes, outputLines) == true);
-					ss.str(""); ss << "Step: " << step << " - currentSampleX: "; Log::GetInstance()->Append(ss.str());
+					ss.str(""); ss << "Chain " << chain->chainIdx << ": Step: " << step << " - currentSampleX: "; Log::GetInstance()->Append(ss.str());
 					foreach_const(vector<string>, outputLines, iter) { Log::GetInstance()->Append(*iter); }
 
 					VERIFY(LineFormatter<ull>::GetInstance()->FormatMatrix(currentSampleSigma, Nusers, numTimes, outputLines) == true);
-					ss.str(""); ss << "Step: " << step << " - currentSampleSigma: "; Log::GetInstance()->Append(ss.str());
+					ss.str(""); ss << "Chain " << chain->chainIdx << ": Step: " << step << " - currentSampleSigma: "; Log::GetInstance()->Append(ss.str());
 					foreach_const(vector<string>, outputLines, iter) { Log::GetInstance()->Append(*iter); }
 
 					Log::GetInstance()->Append("");
@@ -2222,7 +2427,7 @@ bool StrongAttackOperation::GenericReconstruction(const TraceSet* traces, const
 						default: CODING_ERROR; break;
 					}
 
-					bool subSampled = (rng->GetUniformRandomDouble() <= subSampleProb) ? true: false;
+					bool subSampled = (chain->stream.GetUniformRandomDouble() <= subSampleProb) ? true: false;
 
 #ifdef LOGGING_CURRENT_SAMPLE
 					// log stuff
@@ -2308,7 +2513,7 @@ bool StrongAttackOperation::GenericReconstruction(const TraceSet* traces, const
 						if(subSamples == checkPointSamples)
 						{
 							ss.str("");
-							ss << "Step: " << step << ", subSampled: " << subSampled << " (subSampleProb = " << subSampleProb << ")";
+							ss << "Chain " << chain->chainIdx << ": Step: " << step << ", subSampled: " << subSampled << " (subSampleProb = " << subSampleProb << ")";
 							Log::GetInstance()->Append(ss.str());
 
 							// do turning point test
@@ -2323,7 +2528,7 @@ bool StrongAttackOperation::GenericReconstruction(const TraceSet* traces, const
 							bool iid = (abs(ratio - mean/subSamples) <= (halfInterval/subSamples));
 
 							ss.str("");
-							ss << "Turning point test: subSamples = " << subSamples << ", turningPoints = " << turningPoints << " (ratio: " << ratio;
+							ss << "Chain " << chain->chainIdx << ": Turning point test: subSamples = " << subSamples << ", turningPoints = " << turningPoints << " (ratio: " << ratio;
 							ss << ") | interval: " << mean << " +- " << halfInterval << " (+= " << halfInterval/subSamples << ") -> iid = " << (iid == 1 ? "yes" : "no");
 							Log::GetInstance()->Append(ss.str());
 
@@ -2333,7 +2538,7 @@ bool StrongAttackOperation::GenericReconstruction(const TraceSet* traces, const
 								tptFailuresInARow++;
 
 								ss.str("");
-								ss << "Turning point test: failures in a row: " << tptFailuresInARow;
+								ss << "Chain " << chain->chainIdx << ": Turning point test: failures in a row: " << tptFailuresInARow;
 
 								if(tptFailuresInARow > maxTPTFailuresInARow) // discard everything, reset the test
 								{
@@ -2348,6 +2553,8 @@ bool StrongAttackOperation::GenericReconstruction(const TraceSet* traces, const
 									turningPoints = 0;
 									prevCompValue = false;
 
+									chain->meanLocationTrace.clear();
+									chain->exposureTrace.clear();
 
 									VERIFY(dist != NULL); memset(dist, 0, distributionByteSize);
 									VERIFY(nyms != NULL); memset(nyms, 0, pseudonymsByteSize);
@@ -2369,6 +2576,8 @@ bool StrongAttackOperation::GenericReconstruction(const TraceSet* traces, const
 
 						if(reset == false) // include this sample
 						{
+							double meanLocation = 0.0; double exposure = 0.0; // scalar summaries of the sample (for the convergence diagnostics)
+
 							// count (i.e., update dist or nyms)
 							for(ull userIdx = 0; userIdx < Nusers; userIdx++)
 							{
@@ -2394,8 +2603,14 @@ bool StrongAttackOperation::GenericReconstruction(const TraceSet* traces, const
 									dist[distIdx]++;
 									nyms[nymIdx]++;
 									sigma[sigmaIdx]++;
+
+									meanLocation += (double)locIdx;
+									if(currentSampleX[sampleIdx] == true) { exposure++; }
 								}
 							}
+
+							chain->meanLocationTrace.push_back(meanLocation / (double)(Nusers * numTimes));
+							chain->exposureTrace.push_back(exposure / (double)(Nusers * numTimes));
 						}
 
 					}
@@ -2408,24 +2623,16 @@ bool StrongAttackOperation::GenericReconstruction(const TraceSet* traces, const
 
 	} // end of while
 
-	// cleanup
-	// Free(observedMatrix); don't free it, we give it the output
-	output->SetObservedMatrix(observedMatrix);
-
-	Free(currentSampleA);
-	Free(currentSampleX);
-	Free(currentSampleSigma);
+	chain->subSamples = subSamples;
+	chain->steps = step;
 
 	Free(prevSubSampleA);
 	Free(prevSubSampleX);
 	Free(prevSubSampleSigma);
 
-
-	output->SetGenericReconstructionObjects(dist, sigma, nyms, pseudonymsSet); // set the output
-
 	return true;
 
-  // Bouml preserved body end 000C6D11
+  // Bouml preserved body end 000E1791
 }
 
 
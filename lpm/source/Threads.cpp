@@ -0,0 +1,212 @@
+//!
+//! \file
+//!
+#include "../include/Threads.h"
+#include "../include/NoDepend.h"
+#include "../include/Memory.h"
+#include "../include/Instrumentation.h"
+#include "../include/ExecutionContext.h"
+
+#include <unistd.h>
+
+namespace lpm {
+
+Mutex::Mutex()
+{
+  // Bouml preserved body begin 000E1011
+
+	VERIFY(pthread_mutex_init(&mutex, NULL) == 0);
+
+  // Bouml preserved body end 000E1011
+}
+
+Mutex::~Mutex()
+{
+  // Bouml preserved body begin 000E1091
+
+	pthread_mutex_destroy(&mutex);
+
+  // Bouml preserved body end 000E1091
+}
+
+void Mutex::Lock()
+{
+  // Bouml preserved body begin 000E1111
+
+	pthread_mutex_lock(&mutex);
+
+  // Bouml preserved body end 000E1111
+}
+
+void Mutex::Unlock()
+{
+  // Bouml preserved body begin 000E1191
+
+	pthread_mutex_unlock(&mutex);
+
+  // Bouml preserved body end 000E1191
+}
+
+ScopedLock::ScopedLock(Mutex& mutex) : lockedMutex(mutex)
+{
+  // Bouml preserved body begin 000E1211
+
+	lockedMutex.Lock();
+
+  // Bouml preserved body end 000E1211
+}
+
+ScopedLock::~ScopedLock()
+{
+  // Bouml preserved body begin 000E1291
+
+	lockedMutex.Unlock();
+
+  // Bouml preserved body end 000E1291
+}
+
+ParallelTask::~ParallelTask()
+{
+  // Bouml preserved body begin 000E1311
+  // Bouml preserved body end 000E1311
+}
+
+// shared state of a ParallelFor() call
+struct ParallelForState
+{
+	ParallelTask* task;
+	ull count;
+	ull next; // next index to hand out (updated atomically)
+	ExecutionContext* context; // execution context of the caller (under which the workers run)
+};
+
+// per-thread argument of a ParallelFor() worker
+struct ParallelForWorker
+{
+	ParallelForState* state;
+	ull thread;
+	pthread_t handle;
+};
+
+static void* RunParallelForWorker(void* arg)
+{
+	ParallelForWorker* worker = (ParallelForWorker*)arg;
+	ParallelForState* state = worker->state;
+
+	ExecutionContext* previousContext = ExecutionContext::SetCurrent(state->context);
+
+	while(true)
+	{
+		ull index = __sync_fetch_and_add(&state->next, 1);
+		if(index >= state->count) { break; }
+
+		state->task->Run(index, worker->thread);
+	}
+
+	ExecutionContext::SetCurrent(previousContext);
+
+	return NULL;
+}
+
+//!
+//! \brief Returns the number of online processors (at least 1)
+//!
+//! \return ull, the number of online processors
+//!
+ull Threads::GetProcessorsCount()
+{
+  // Bouml preserved body begin 000E1391
+
+	long count = sysconf(_SC_NPROCESSORS_ONLN);
+
+	return (count < 1) ? 1 : (ull)count;
+
+  // Bouml preserved body end 000E1391
+}
+
+//!
+//! \brief Runs task->Run(index, thread) for each index in [0; count[ using several threads
+//!
+//! Indices are handed out dynamically to the threads. The calling thread takes part in the computation (as thread 0).
+//!
+//! \param[in] count 	ull, the number of indices.
+//! \param[in] task 	ParallelTask*, the task to run.
+//! \param[in] numThreads 	[optional] ull, the number of threads to use (if 0, Parameters::GetThreadsCount() is used).
+//!
+//! \return true or false, depending on whether the call is successful
+//!
+bool Threads::ParallelFor(ull count, ParallelTask* task, ull numThreads)
+{
+  // Bouml preserved body begin 000E1411
+
+	if(task == NULL)
+	{
+		SET_ERROR_CODE(ERROR_CODE_INVALID_ARGUMENTS);
+		return false;
+	}
+
+	numThreads = GetEffectiveThreadsCount(count, numThreads);
+
+	if(numThreads <= 1) // no need to spawn threads
+	{
+		for(ull index = 0; index < count; index++) { task->Run(index, 0); }
+		return true;
+	}
+
+	// create the singletons used by the workers before the threads start (rather than concurrently from the workers)
+	Memory::GetInstance(); Errors::GetInstance(); Log::GetInstance(); Instrumentation::GetInstance();
+
+	ParallelForState state;
+	state.task = task;
+	state.count = count;
+	state.next = 0;
+	state.context = ExecutionContext::GetCurrent();
+
+	vector<ParallelForWorker> workers = vector<ParallelForWorker>(numThreads);
+	for(ull t = 0; t < numThreads; t++)
+	{
+		workers[t].state = &state;
+		workers[t].thread = t;
+	}
+
+	// thread 0 is the calling thread
+	ull started = 1;
+	for(ull t = 1; t < numThreads; t++)
+	{
+		if(pthread_create(&workers[t].handle, NULL, RunParallelForWorker, &workers[t]) != 0) { break; }
+		started++;
+	}
+
+	RunParallelForWorker(&workers[0]);
+
+	for(ull t = 1; t < started; t++)
+	{
+		pthread_join(workers[t].handle, NULL);
+	}
+
+	return true;
+
+  // Bouml preserved body end 000E1411
+}
+
+//!
+//! \brief Returns the number of threads ParallelFor() would use for \a count indices
+//!
+//! \param[in] count 	ull, the number of indices.
+//! \param[in] numThreads 	[optional] ull, the number of threads requested (if 0, Parameters::GetThreadsCount() is used).
+//!
+//! \return ull, the number of threads
+//!
+ull Threads::GetEffectiveThreadsCount(ull count, ull numThreads)
+{
+  // Bouml preserved body begin 000E1491
+
+	if(numThreads == 0) { numThreads = Parameters::GetInstance()->GetThreadsCount(); }
+
+	return MAX(MIN(numThreads, count), 1);
+
+  // Bouml preserved body end 000E1491
+}
+
+
+} // namespace lpm
@@ -5,6 +5,7 @@
 #include "../include/MetricOperation.h"
 #include "../include/TraceSet.h"
 #include "../include/AttackOutput.h"
+#include "../include/Threads.h"
 
 namespace lpm {
 
@@ -103,64 +104,28 @@ bool WeakAttackOperation::Execute(const TraceSet* input, AttackOutput* output)
 
 	VERIFY((ull)((ll)Nusers) == Nusers); // check overflow
 
-	// allocate weight and mapping
-	ull byteSizeMatrix = (Nusers * Nusers) * sizeof(ll);
+	// allocate cost and mapping
+	ull byteSizeMatrix = (Nusers * Nusers) * sizeof(double);
 	ull byteSizeVector = Nusers * sizeof(ll);
 
-	ll* weight = (ll*)Allocate(byteSizeMatrix);
+	double* costMatrix = (double*)Allocate(byteSizeMatrix);
 	ll* mapping = (ll*)Allocate(byteSizeVector);
-	memset(weight, 0, byteSizeMatrix);
 	memset(mapping, 0, byteSizeVector);
 
-	VERIFY(weight != NULL && mapping != NULL);
+	VERIFY(costMatrix != NULL && mapping != NULL);
 
-	// convert likelihood matrix to weight matrix
-	double maxnll = 0.0;
-	for(ull i = 0; i < Nusers; i++)
-	{
-		for(ull j = 0; j < Nusers; j++)
-		{
-			ull index = GET_INDEX(i, j, Nusers);
-
-			double nll = -likelihoodMatrix[index];
-			if(nll > maxnll) { maxnll = nll; }
-		}
-	}
-
-	ll llhoodBigNumber = (maxnll == 0.0) ? -1 : (ll)(-(double)LONG_LONG_MAX/maxnll + 10000);
-	for(ull i = 0; i < Nusers; i++)
+	// the mapping which maximizes the likelihood is the minimum cost assignment on the negative log-likelihoods
+	for(ull index = 0; index < Nusers * Nusers; index++)
 	{
-		for(ull j = 0; j < Nusers; j++)
-		{
-			ull index = GET_INDEX(i, j, Nusers);
-			double llhood = likelihoodMatrix[index];
-			if(llhood > 0) { weight[index] = 0; }
-			else { weight[index] = (ll)(llhoodBigNumber * llhood); }
-		}
+		double llhood = likelihoodMatrix[index];
+		costMatrix[index] = (llhood > 0) ? 0.0 : -llhood;
 	}
 
 	Free(likelihoodMatrix);
 
-	// log the weight matrix
-	Log::GetInstance()->Append("Weight Matrix (weak adv):");
-	for(ull i = 0; i < Nusers; i++)
-	{
-		stringstream info(""); info.precision(16);
-
-		for(ull j = 0; j < Nusers; j++)
-		{
-			info << " " << weight[GET_INDEX(i, j, Nusers)];
-		}
-
-		Log::GetInstance()->Append(info.str());
-	}
-
-	// prev code: VERIFY(Algorithms::MaximumWeightAssignment(Nusers, weight, mapping) == 0); // this method was called maximum weight assignment but it was computing minimum cost assignement!
+	Algorithms::MinimumCostAssignment(costMatrix, Nusers, mapping); // floating-point version: no need to scale the log-likelihoods to integers
 
-	ll* costMatrix = weight;
-	Algorithms::MinimumCostAssignment(costMatrix, Nusers, mapping); // Note: the weight matrix is indeed a cost matrix, the mapping which maximizes the likelihood is the minimum cost assignment!
-
-	Free(weight); weight = costMatrix = NULL;
+	Free(costMatrix); costMatrix = NULL;
 
 	// get mapping (pseudonym -> observed trace)
 	map<ull, Trace*> traceMapping = map<ull, Trace*>();
@@ -228,13 +193,67 @@ bool WeakAttackOperation::Execute(const TraceSet* input, AttackOutput* output)
   // Bouml preserved body end 0004D011
 }
 
+// computes one column (i.e. one pseudonym) of the likelihood matrix for the current user, see ComputeLikelihood()
+class WeakLikelihoodTask : public ParallelTask
+{
+  public:
+	const Context* context;
+	const FilterFunction* lppmPDF;
+
+	ull numTimes;
+	ull numLoc;
+
+	const vector<ObservedEvent*>* observedEvents; // observedEvents[pseudonymIndex * numTimes + timeIndex]
+
+	// per (time, location) caches of the current user
+	ActualEvent** actualEvents;
+	ExposedEvent** exposedEvents;
+	double* applicationProbs0;
+	double* applicationProbs1;
+	double* presenceProbs;
+
+	double* likelihoodRow; // likelihood[userIndex, .]
+
+	virtual void Run(ull pseudonymIndex, ull thread)
+	{
+		const double bigNumber = 1e20;
+		const double bigNumberInverse = 1.0 / bigNumber;
+
+		double logsum = 0.0;
+		for(ull timeIndex = 0; timeIndex < numTimes; timeIndex++)
+		{
+			const ObservedEvent* observedEvent = (*observedEvents)[GET_INDEX(pseudonymIndex, timeIndex, numTimes)];
+
+			double sum = 0.0;
+			for(ull locIndex = 0; locIndex < numLoc; locIndex++)
+			{
+				ull index = GET_INDEX(timeIndex, locIndex, numLoc);
+
+				double presenceProb = presenceProbs[index];
+				if(presenceProb == 0.0) { continue; } // the user is never there at that time
+
+				double lppmProb0 = lppmPDF->PDF(context, actualEvents[index], observedEvent);
+				double lppmProb1 = lppmPDF->PDF(context, exposedEvents[index], observedEvent);
+
+				sum += ((lppmProb0 * applicationProbs0[index]) + (lppmProb1 * applicationProbs1[index])) * presenceProb;
+			}
+
+			// take care of small sum
+			VERIFY(sum == 0.0 || sum > bigNumberInverse);
+
+			if(sum == 0.0) { sum = DBL_MIN; }
+
+			logsum += log(sum);
+		}
+
+		likelihoodRow[pseudonymIndex] = logsum;
+	}
+};
+
 bool WeakAttackOperation::ComputeLikelihood(const TraceSet* trace, double** matrix) const 
 {
   // Bouml preserved body begin 00052111
 
-	const double bigNumber = 1e20;
-	const double bigNumberInverse = 1.0 / bigNumber;
-
 	// get user profiles
 	map<ull, UserProfile*> profiles = map<ull, UserProfile*>();
 	VERIFY(context->GetProfiles(profiles) == true);
@@ -253,115 +272,150 @@ bool WeakAttackOperation::ComputeLikelihood(const TraceSet* trace, double** matr
 
 	ull minLoc = 0; ull maxLoc = 0;
 	VERIFY(Parameters::GetInstance()->GetLocationstampsRange(&minLoc, &maxLoc) == true);
+	ull numLoc = maxLoc - minLoc + 1;
 
-	ull byteSize = (Nusers * Nusers) * sizeof(double);
-	double* likelihood = *matrix = (double*)Allocate(byteSize);
-	VERIFY(likelihood != NULL);
-	memset(likelihood, 0, byteSize);
+	ull numPeriods = 0; TPInfo tpInfo;
+	VERIFY(Parameters::GetInstance()->GetTimePeriodInfo(&numPeriods, &tpInfo) == true);
+	ull minPeriod = tpInfo.minPeriod;
 
-	ull userIndex = 0;
-	pair_foreach_const(map<ull, UserProfile*>, profiles, usersIter)
+	// time period of each timestamp
+	vector<ull> timePeriods = vector<ull>(numTimes);
+	for(ull tm = minTime; tm <= maxTime; tm++)
 	{
-		ull user = usersIter->first;
-		UserProfile* profile = usersIter->second;
-
-		double* steadyStateVector = NULL;
-		VERIFY(profile->GetSteadyStateVector(&steadyStateVector) == true);
-		VERIFY(steadyStateVector != NULL);
-
-		ull pseudonymIndex = 0;
-		pair_foreach_const(map<ull, Trace*>, mapping, pseudonymsIter)
+		ull tp = Parameters::GetInstance()->LookupTimePeriod(tm);
+		if(tp == INVALID_TIME_PERIOD)
 		{
-			// ull pseudonym = pseudonymsIter->first;
-			Trace* observedTrace = pseudonymsIter->second;
-
-			vector<Event*> events = vector<Event*>();
-			observedTrace->GetEvents(events);
+			SET_ERROR_CODE(ERROR_CODE_INCONSISTENT_TIME_PARTITIONING_USAGE);
+			return false;
+		}
+		timePeriods[tm - minTime] = tp;
+	}
 
-			VERIFY(numTimes == events.size());
+	// observed events of each pseudonym (in the order of the pseudonyms in mapping)
+	vector<ObservedEvent*> observedEvents = vector<ObservedEvent*>(Nusers * numTimes);
+	ull pseudonymIndex = 0;
+	pair_foreach_const(map<ull, Trace*>, mapping, pseudonymsIter)
+	{
+		Trace* observedTrace = pseudonymsIter->second;
 
-			double logsum = 0.0;
+		vector<Event*> events = vector<Event*>();
+		observedTrace->GetEvents(events);
 
-			ull tm = minTime;
-			foreach_const(vector<Event*>, events, eventsIter)
-			{
-				ObservedEvent* observedEvent = dynamic_cast<ObservedEvent*>(*eventsIter);
-				set<ull> timestamps = set<ull>();
-				observedEvent->GetTimestamps(timestamps);
+		VERIFY(numTimes == events.size());
 
-				VERIFY(timestamps.size() == 1);
+		ull tm = minTime;
+		foreach_const(vector<Event*>, events, eventsIter)
+		{
+			ObservedEvent* observedEvent = dynamic_cast<ObservedEvent*>(*eventsIter);
+			set<ull> timestamps = set<ull>();
+			observedEvent->GetTimestamps(timestamps);
 
-				ull timestamp = *(timestamps.begin());
+			VERIFY(timestamps.size() == 1);
 
-				VERIFY(tm == timestamp && (timestamp >= minTime && timestamp <= maxTime));
+			ull timestamp = *(timestamps.begin());
 
-				ull tp = Parameters::GetInstance()->LookupTimePeriod(timestamp);
-				if(tp == INVALID_TIME_PERIOD)
-				{
-					SET_ERROR_CODE(ERROR_CODE_INCONSISTENT_TIME_PARTITIONING_USAGE);
-					return false;
-				}
+			VERIFY(tm == timestamp && (timestamp >= minTime && timestamp <= maxTime));
 
-				// get the proper sub-chain steady-state vector according to the time period of the event
-				double* subChainSteadyStateVector = NULL;
-				VERIFY(Algorithms::GetSteadyStateVectorOfSubChain(steadyStateVector, tp, &subChainSteadyStateVector) == true);
+			observedEvents[GET_INDEX(pseudonymIndex, timestamp - minTime, numTimes)] = observedEvent;
 
+			tm++;
+		}
 
-				double sum = 0.0;
-				for(ull loc = minLoc; loc <= maxLoc; loc++)
-				{
-					ActualEvent* actualEvent = new ActualEvent(user, timestamp, loc);
-					ExposedEvent* exposedEvent = new ExposedEvent(*actualEvent);
+		pseudonymIndex++;
+	}
 
-					VERIFY(actualEvent != NULL && exposedEvent != NULL);
+	ull byteSize = (Nusers * Nusers) * sizeof(double);
+	double* likelihood = *matrix = (double*)Allocate(byteSize);
+	VERIFY(likelihood != NULL);
+	memset(likelihood, 0, byteSize);
 
-					double lppmProb0 = lppmPDF->PDF(context, actualEvent, observedEvent);
-					double applicationProb0 = applicationPDF->PDF(context, actualEvent, actualEvent);
+	// per (time, location) caches, rebuilt for each user and shared (read-only) by the threads
+	ull numCells = numTimes * numLoc;
+	ull cacheByteSize = numCells * sizeof(double);
+	ActualEvent** actualEvents = (ActualEvent**)Allocate(numCells * sizeof(ActualEvent*));
+	ExposedEvent** exposedEvents = (ExposedEvent**)Allocate(numCells * sizeof(ExposedEvent*));
+	double* applicationProbs0 = (double*)Allocate(cacheByteSize);
+	double* applicationProbs1 = (double*)Allocate(cacheByteSize);
+	double* presenceProbs = (double*)Allocate(cacheByteSize);
+	double* subChainSteadyStateVectors = (double*)Allocate(numPeriods * numLoc * sizeof(double));
+
+	VERIFY(actualEvents != NULL && exposedEvents != NULL && applicationProbs0 != NULL && applicationProbs1 != NULL);
+	VERIFY(presenceProbs != NULL && subChainSteadyStateVectors != NULL);
+
+	WeakLikelihoodTask task;
+	task.context = context;
+	task.lppmPDF = lppmPDF;
+	task.numTimes = numTimes;
+	task.numLoc = numLoc;
+	task.observedEvents = &observedEvents;
+	task.actualEvents = actualEvents;
+	task.exposedEvents = exposedEvents;
+	task.applicationProbs0 = applicationProbs0;
+	task.applicationProbs1 = applicationProbs1;
+	task.presenceProbs = presenceProbs;
 
-					double lppmProb1 = lppmPDF->PDF(context, exposedEvent, observedEvent);
-					double applicationProb1 = applicationPDF->PDF(context, actualEvent, exposedEvent);
+	ull userIndex = 0;
+	pair_foreach_const(map<ull, UserProfile*>, profiles, usersIter)
+	{
+		ull user = usersIter->first;
+		UserProfile* profile = usersIter->second;
 
-					double presenceProb = subChainSteadyStateVector[loc - minLoc];
+		double* steadyStateVector = NULL;
+		VERIFY(profile->GetSteadyStateVector(&steadyStateVector) == true);
+		VERIFY(steadyStateVector != NULL);
 
-					sum += ((lppmProb0 * applicationProb0) + (lppmProb1 * applicationProb1)) * presenceProb;
+		// get the sub-chain steady-state vector of each time period (once per user, not once per event)
+		for(ull tpIndex = 0; tpIndex < numPeriods; tpIndex++)
+		{
+			double* subChainSteadyStateVector = NULL;
+			VERIFY(Algorithms::GetSteadyStateVectorOfSubChain(steadyStateVector, minPeriod + tpIndex, &subChainSteadyStateVector) == true);
 
-					/*
-					stringstream info("");
-					info << "prob: " << user << ", " << pseudonym << ", "<< timestamp << ", " << loc << ", ";
-					info << lppmProb0 << ", " << applicationProb0 << ", " << lppmProb1 << ", " << applicationProb1 << ", ";
-					info << presenceProb << " = " << sum;
-					Log::GetInstance()->Append(info.str());
-					*/
+			memcpy(&subChainSteadyStateVectors[GET_INDEX(tpIndex, 0, numLoc)], subChainSteadyStateVector, numLoc * sizeof(double));
 
-					actualEvent->Release();
-					exposedEvent->Release();
-				}
+			Free(subChainSteadyStateVector); // free the sub-chain steady-state vector
+		}
 
-				Free(subChainSteadyStateVector); // free the sub-chain steady-state vector
+		// the events, application probabilities and presence probabilities do not depend on the pseudonym
+		for(ull tm = minTime; tm <= maxTime; tm++)
+		{
+			ull tpIndex = timePeriods[tm - minTime] - minPeriod;
 
-				// take care of small sum
-				VERIFY(sum == 0.0 || sum > bigNumberInverse);
+			for(ull loc = minLoc; loc <= maxLoc; loc++)
+			{
+				ull index = GET_INDEX(tm - minTime, loc - minLoc, numLoc);
 
-				if(sum == 0.0) { sum = DBL_MIN; }
+				ActualEvent* actualEvent = actualEvents[index] = new ActualEvent(user, tm, loc);
+				ExposedEvent* exposedEvent = exposedEvents[index] = new ExposedEvent(*actualEvent);
 
-				logsum += log(sum);
+				VERIFY(actualEvent != NULL && exposedEvent != NULL);
 
-				/*
-				stringstream info(""); info.precision(16);
-				info << "logsum: " << userIndex << ", " << pseudonymIndex << " = "<< sum << ", " << tmp << ", " << logsum;
-				Log::GetInstance()->Append(info.str());
-				*/
+				applicationProbs0[index] = applicationPDF->PDF(context, actualEvent, actualEvent);
+				applicationProbs1[index] = applicationPDF->PDF(context, actualEvent, exposedEvent);
 
-				tm++;
+				presenceProbs[index] = subChainSteadyStateVectors[GET_INDEX(tpIndex, loc - minLoc, numLoc)];
 			}
+		}
 
-			likelihood[GET_INDEX(userIndex, pseudonymIndex, Nusers)] = logsum;
+		// compute the likelihood of each pseudonym in parallel
+		task.likelihoodRow = &likelihood[GET_INDEX(userIndex, 0, Nusers)];
+		VERIFY(Threads::ParallelFor(Nusers, &task) == true);
 
-			pseudonymIndex++;
+		for(ull index = 0; index < numCells; index++)
+		{
+			actualEvents[index]->Release();
+			exposedEvents[index]->Release();
 		}
+
 		userIndex++;
 	}
 
+	Free(actualEvents);
+	Free(exposedEvents);
+	Free(applicationProbs0);
+	Free(applicationProbs1);
+	Free(presenceProbs);
+	Free(subChainSteadyStateVectors);
+
 	return true;
 
   // Bouml preserved body end 00052111
@@ -1,7 +1,7 @@
 #include "SGAttackOperation.h"
 #include "SGMetric.h"
 
-SGAttackOperation::SGAttackOperation(double maxMult): AttackOperation("SGAttackOperation"), maxMultFactor(maxMult)
+SGAttackOperation::SGAttackOperation(double maxMult): AttackOperation("SGAttackOperation"), maxMultFactor(maxMult), numSamples(0), temperature(1.0)
 {
 	VERIFY(maxMultFactor >= 1.0);
 }
@@ -37,7 +37,7 @@ bool SGAttackOperation::CreateMetric(MetricType type, MetricOperation** metric)
 			*metric = new AnonymityMetricOperation();
 			return true;
 		case SGMetric:
-			*metric = new SGMetricOperation();
+			*metric = new SGMetricOperation((numSamples == 0) ? 1 : numSamples);
 			return true;
 		default:
 			CODING_ERROR;
@@ -84,18 +84,22 @@ bool SGAttackOperation::Execute(const TraceSet* input, AttackOutput* output)
 		userToPseudonymMapping.insert(make_pair(user, user)); // we assume that there is no anonymization!!!
 	}
 
-	ull mostLikelyTraceByteSize = Nusers * numTimes * sizeof(ull);
+	// with backward sampling, the traces of each user are one after the other
+	ull samplesPerUser = (numSamples == 0) ? 1 : numSamples;
+
+	ull mostLikelyTraceByteSize = Nusers * samplesPerUser * numTimes * sizeof(ull);
 	mostLikelyTrace = (ull*)Allocate(mostLikelyTraceByteSize);
 	VERIFY(mostLikelyTrace != NULL);
 	memset(mostLikelyTrace, 0, mostLikelyTraceByteSize);
 
-	ull logLikelihoodsByteSize = Nusers * sizeof(double);
+	ull logLikelihoodsByteSize = Nusers * samplesPerUser * sizeof(double);
 	double* logLikelihoods =(double*)Allocate(logLikelihoodsByteSize);
 	VERIFY(logLikelihoods != NULL);
 	memset(logLikelihoods, 0, logLikelihoodsByteSize);
 
 	// tracking
-	VERIFY(ModifiedViterbi(input, userToPseudonymMapping, mostLikelyTrace, logLikelihoods) == true);
+	if(numSamples == 0) { VERIFY(ModifiedViterbi(input, userToPseudonymMapping, mostLikelyTrace, logLikelihoods) == true); }
+	else { VERIFY(BackwardSampling(input, userToPseudonymMapping, mostLikelyTrace, logLikelihoods) == true); }
 	output->SetMostLikelyTrace(mostLikelyTrace);
 
 	output->SetMostLikelyTraceLL(logLikelihoods);
@@ -104,6 +108,80 @@ bool SGAttackOperation::Execute(const TraceSet* input, AttackOutput* output)
 
 }
 
+bool SGAttackOperation::IsPerUser() const
+{
+	return true; // each user is tracked on his own observed trace (there is no anonymization)
+}
+
+void SGAttackOperation::SetBackwardSampling(ull numSamples, double temperature)
+{
+	VERIFY(temperature > 0.0);
+
+	this->numSamples = numSamples;
+	this->temperature = temperature;
+}
+
+// log(sum_i exp(logWeights[i]))
+static double LogSumExp(const double* logWeights, ull count)
+{
+	double maxLogWeight = logWeights[0];
+	for(ull i = 1; i < count; i++) { maxLogWeight = MAX(maxLogWeight, logWeights[i]); }
+
+	double sum = 0.0;
+	for(ull i = 0; i < count; i++) { sum += exp(logWeights[i] - maxLogWeight); }
+
+	return maxLogWeight + log(sum);
+}
+
+// draws an index with probability proportional to exp(logWeights[i]), given a uniform variate in [0, 1) (logWeights is overwritten)
+static ull SampleLogWeights(double* logWeights, ull count, double uniform)
+{
+	double maxLogWeight = logWeights[0];
+	for(ull i = 1; i < count; i++) { maxLogWeight = MAX(maxLogWeight, logWeights[i]); }
+
+	double sum = 0.0;
+	for(ull i = 0; i < count; i++) { logWeights[i] = exp(logWeights[i] - maxLogWeight); sum += logWeights[i]; }
+
+	double target = uniform * sum; ull lastIndex = 0;
+	for(ull i = 0; i < count; i++)
+	{
+		if(logWeights[i] <= 0.0) { continue; }
+
+		lastIndex = i;
+		target -= logWeights[i];
+		if(target < 0.0) { return i; }
+	}
+
+	return lastIndex; // rounding errors
+}
+
+double SGAttackOperation::LogEmissionProbability(ull user, ull timestamp, ull loc, ObservedEvent* observedEvent) const
+{
+	ActualEvent* actualEvent = new ActualEvent(user, timestamp, loc);
+	ExposedEvent* exposedEvent = new ExposedEvent(*actualEvent);
+
+	VERIFY(actualEvent != NULL && exposedEvent != NULL);
+
+	double lppmProb0 = lppmPDF->PDF(context, actualEvent, observedEvent);
+	double applicationProb0 = applicationPDF->PDF(context, actualEvent, actualEvent);
+
+	double lppmProb1 = lppmPDF->PDF(context, exposedEvent, observedEvent);
+	double applicationProb1 = applicationPDF->PDF(context, actualEvent, exposedEvent);
+
+	actualEvent->Release();
+	exposedEvent->Release();
+
+	double f = ((lppmProb0 * applicationProb0) + (lppmProb1 * applicationProb1));
+	double logf = log(f);
+
+	if(f <= 0.0 || logf == nan("n-char-sequence"))
+	{
+		logf = log(SQRT_DBL_MIN); // avoid log overflow/underflow/nan
+	}
+
+	return logf;
+}
+
 
 bool SGAttackOperation::ModifiedViterbi(const TraceSet* traces, const map<ull, ull>& userToPseudonymMap, ull* mostLikelyTrace, double* logLikelihoods)
 {
@@ -143,6 +221,16 @@ bool SGAttackOperation::ModifiedViterbi(const TraceSet* traces, const map<ull, u
 	memset(predecessor, 0, predecessorByteSize);
 
 
+	// multiplicative noise: one uniform variate per trellis edge, drawn in bulk for each time instant
+	RNG* rng = RNG::GetInstance();
+	bool addNoise = (maxMultFactor != 1.0); // for maxMultFactor == 1.0, the multiplicative factor is always 1.0 (and no noise is drawn)
+	ull noiseByteSize = numLoc * numLoc * sizeof(double);
+	double* noise = (double*)Allocate(noiseByteSize);
+
+	VERIFY(noise != NULL);
+	memset(noise, 0, noiseByteSize);
+
+
 	// get the mapping (pseudonym -> observed trace)
 	map<ull, Trace*> mappingNymObserved = map<ull, Trace*>();
 	traces->GetMapping(mappingNymObserved);
@@ -209,31 +297,13 @@ bool SGAttackOperation::ModifiedViterbi(const TraceSet* traces, const map<ull, u
 			if(timestamp == minTime) // only needed for timestamp == minTime
 			{ VERIFY(Algorithms::GetSteadyStateVectorOfSubChain(steadyStateVector, tp, &subChainSteadyStateVector) == true); }
 
+			if(addNoise == true) { rng->FillUniform(noise, (timestamp == minTime) ? numLoc : numLoc * numLoc); }
+
 			for(ull loc = minLoc; loc <= maxLoc; loc++)
 			{
 				ull deltaIndex = GET_INDEX_3D(userIndex, (timestamp - minTime), (loc - minLoc), numTimes, numLoc);
 
-				ActualEvent* actualEvent = new ActualEvent(user, timestamp, loc);
-				ExposedEvent* exposedEvent = new ExposedEvent(*actualEvent);
-
-				VERIFY(actualEvent != NULL && exposedEvent != NULL);
-
-				double lppmProb0 = lppmPDF->PDF(context, actualEvent, observedEvent);
-				double applicationProb0 = applicationPDF->PDF(context, actualEvent, actualEvent);
-
-				double lppmProb1 = lppmPDF->PDF(context, exposedEvent, observedEvent);
-				double applicationProb1 = applicationPDF->PDF(context, actualEvent, exposedEvent);
-
-				actualEvent->Release();
-				exposedEvent->Release();
-
-				double f = ((lppmProb0 * applicationProb0) + (lppmProb1 * applicationProb1));
-				double logf = log(f);
-
-				if(f <= 0.0 || logf == nan("n-char-sequence"))
-				{
-					logf = log(SQRT_DBL_MIN); // avoid log overflow/underflow/nan
-				}
+				double logf = LogEmissionProbability(user, timestamp, loc, observedEvent);
 
 				if(timestamp == minTime) // initialization
 				{
@@ -248,8 +318,9 @@ bool SGAttackOperation::ModifiedViterbi(const TraceSet* traces, const map<ull, u
 					// delta[deltaIndex] = f * presenceProb;
 					delta[deltaIndex] = logf + logpp; // use logarithms to avoid underflow
 
-					{ // multiplicative factor to slightly change the probabilities
-						double mult = ((maxMultFactor - 1.0) * RNG::GetInstance()->GetUniformRandomDouble()) + 1.0;
+					if(addNoise == true) // multiplicative factor to slightly change the probabilities
+					{
+						double mult = ((maxMultFactor - 1.0) * noise[loc - minLoc]) + 1.0;
 						delta[deltaIndex] += log(mult);
 					}
 				}
@@ -275,8 +346,9 @@ bool SGAttackOperation::ModifiedViterbi(const TraceSet* traces, const map<ull, u
 						// double m = (prevDelta * transProb);
 						double m = prevDelta + log(transProb);  // use logarithms to avoid underflow
 
-						{ // multiplicative factor to slightly change the probabilities
-							double mult = ((maxMultFactor - 1.0) * RNG::GetInstance()->GetUniformRandomDouble()) + 1.0;
+						if(addNoise == true) // multiplicative factor to slightly change the probabilities
+						{
+							double mult = ((maxMultFactor - 1.0) * noise[GET_INDEX((loc - minLoc), (loc2 - minLoc), numLoc)]) + 1.0;
 							m += log(mult);
 						}
 
@@ -347,71 +419,308 @@ bool SGAttackOperation::ModifiedViterbi(const TraceSet* traces, const map<ull, u
 		}
 
 		// compute the likelihood, we will need it later
+		const ull* userTrace = &mostLikelyTrace[GET_INDEX(userIndex, 0, numTimes)];
 		double logLikelihood = 0.0;
-		for(ull tm = minTime; tm <= maxTime-1; tm++)
+		if(ComputeLogLikelihood(transitionMatrix, steadyStateVector, userTrace, &logLikelihood) == false) { return false; }
+
+		logLikelihoods[userIndex] = logLikelihood;
+
+		userIndex++;
+	}
+
+	Free(delta);
+	Free(predecessor);
+	Free(noise);
+
+	Instrumentation::GetInstance()->AddToCounter(TrellisCellsCounter, Nusers * numTimes * numLoc);
+
+	return true;
+
+  // Bouml preserved body end 0007C991
+}
+
+// log-likelihood of the given trace (of numTimes locations) under the mobility profile of the user
+bool SGAttackOperation::ComputeLogLikelihood(double* transitionMatrix, double* steadyStateVector, const ull* trace, double* logLikelihood) const
+{
+	VERIFY(transitionMatrix != NULL && steadyStateVector != NULL && trace != NULL && logLikelihood != NULL);
+
+	ull minTime = 0; ull maxTime = 0;
+	VERIFY(Parameters::GetInstance()->GetTimestampsRange(&minTime, &maxTime) == true);
+
+	ull minLoc = 0; ull maxLoc = 0;
+	VERIFY(Parameters::GetInstance()->GetLocationstampsRange(&minLoc, &maxLoc) == true);
+
+	*logLikelihood = 0.0;
+	for(ull tm = minTime; tm <= maxTime-1; tm++)
+	{
+		ull tp = Parameters::GetInstance()->LookupTimePeriod(tm);
+		ull nexttp = tp; // ensure nexttp is always consistent with its usage
+		if(tm < maxTime) { nexttp = Parameters::GetInstance()->LookupTimePeriod(tm + 1); }
+		if(nexttp == INVALID_TIME_PERIOD || tp == INVALID_TIME_PERIOD)
+		{
+			SET_ERROR_CODE(ERROR_CODE_INCONSISTENT_TIME_PARTITIONING_USAGE);
+			return false;
+		}
+
+		ull loc = trace[tm - minTime];
+
+		if(tm == minTime) // initialization
+		{
+			double* subChainSteadyStateVector = NULL;
+			VERIFY(Algorithms::GetSteadyStateVectorOfSubChain(steadyStateVector, tp, &subChainSteadyStateVector) == true);
+
+			double presenceProb = subChainSteadyStateVector[loc - minLoc];
+			double logpp = log(presenceProb);
+
+			Free(subChainSteadyStateVector);
+
+			if(presenceProb <= 0.0 || logpp == nan("n-char-sequence"))
+			{
+				logpp = log(SQRT_DBL_MIN); // avoid log overflow/underflow/nan
+			}
+
+			*logLikelihood += logpp; // use logarithms to avoid underflow
+		}
+		else
+		{
+			ull loc2 = trace[tm+1 - minTime];
+
+			// get the proper sub-chain transition vector to the time period of the previous event
+			double* subChainTransitionVector = NULL;
+			VERIFY(Algorithms::GetTransitionVectorOfSubChain(transitionMatrix, tp, loc, nexttp, &subChainTransitionVector) == true);
+
+			ull nextLocIdx = (loc2 - minLoc);
+			double transProb = subChainTransitionVector[nextLocIdx];
+
+			Free(subChainTransitionVector);  // free the sub-chain transition vector
+
+			double logtp = log(transProb);
+
+			if(transProb <= 0.0 || logtp == nan("n-char-sequence"))
+			{
+				logtp = log(SQRT_DBL_MIN); // avoid log overflow/underflow/nan
+			}
+			*logLikelihood += logtp;  // use logarithms to avoid underflow
+
+		}
+	}
+
+	return true;
+}
+
+bool SGAttackOperation::BackwardSampling(const TraceSet* traces, const map<ull, ull>& userToPseudonymMap, ull* sampledTraces, double* logLikelihoods)
+{
+	if(traces == NULL || userToPseudonymMap.empty() == true || sampledTraces == NULL || logLikelihoods == NULL || numSamples == 0)
+	{
+		SET_ERROR_CODE(ERROR_CODE_INVALID_ARGUMENTS);
+		return false;
+	}
+
+	ull minTime = 0; ull maxTime = 0;
+	VERIFY(Parameters::GetInstance()->GetTimestampsRange(&minTime, &maxTime) == true);
+	ull numTimes = maxTime - minTime + 1;
+
+	ull minLoc = 0; ull maxLoc = 0;
+	VERIFY(Parameters::GetInstance()->GetLocationstampsRange(&minLoc, &maxLoc) == true);
+	ull numLoc = maxLoc - minLoc + 1;
+
+	// get the user profiles
+	map<ull, UserProfile*> profiles = map<ull, UserProfile*>();
+	VERIFY(context->GetProfiles(profiles) == true);
+
+	ull Nusers = profiles.size();
+
+	const double invTemperature = 1.0 / temperature;
+
+	// tempered (log) forward messages of the current user: alpha[GET_INDEX(tm - minTime, loc - minLoc, numLoc)] is the log of the (tempered)
+	// joint probability of the observed events up to tm and of the location loc at tm
+	ull alphaByteSize = numTimes * numLoc * sizeof(double);
+	double* alpha = (double*)Allocate(alphaByteSize);
+
+	VERIFY(alpha != NULL);
+	memset(alpha, 0, alphaByteSize);
+
+	ull logWeightsByteSize = numLoc * sizeof(double);
+	double* logWeights = (double*)Allocate(logWeightsByteSize);
+
+	VERIFY(logWeights != NULL);
+	memset(logWeights, 0, logWeightsByteSize);
+
+	// one uniform variate per sampled location, drawn in bulk for each user
+	RNG* rng = RNG::GetInstance();
+	ull uniformsByteSize = numSamples * numTimes * sizeof(double);
+	double* uniforms = (double*)Allocate(uniformsByteSize);
+
+	VERIFY(uniforms != NULL);
+	memset(uniforms, 0, uniformsByteSize);
+
+	// get the mapping (pseudonym -> observed trace)
+	map<ull, Trace*> mappingNymObserved = map<ull, Trace*>();
+	traces->GetMapping(mappingNymObserved);
+
+	VERIFY(Nusers == mappingNymObserved.size());
+
+	typedef map<pair<ull, ull>, vector<double> > LogTransitionsMap;
+
+	// for all users
+	ull userIndex = 0;
+	pair_foreach_const(map<ull, UserProfile*>, profiles, usersIter)
+	{
+		ull user = usersIter->first;
+		UserProfile* profile = usersIter->second;
+
+		double* transitionMatrix = NULL;
+		profile->GetTransitionMatrix(&transitionMatrix);
+
+		double* steadyStateVector = NULL;
+		profile->GetSteadyStateVector(&steadyStateVector);
+
+		VERIFY(transitionMatrix != NULL && steadyStateVector != NULL);
+
+		map<ull, ull>::const_iterator iter = userToPseudonymMap.find(user);
+		VERIFY(iter != userToPseudonymMap.end());
+
+		map<ull, Trace*>::const_iterator mappingIter = mappingNymObserved.find(iter->second);
+		VERIFY(mappingIter != mappingNymObserved.end());
+
+		Trace* observedTrace = mappingIter->second;
+
+		vector<Event*> events = vector<Event*>();
+		observedTrace->GetEvents(events);
+
+		VERIFY(numTimes == events.size());
+
+		// tempered log transition matrices of the sub-chains, one per pair of consecutive time periods (prevtp, tp), transposed: the
+		// transition from loc2 to loc at GET_INDEX(loc - minLoc, loc2 - minLoc, numLoc); and the one used at each time instant
+		LogTransitionsMap logTransitions = LogTransitionsMap();
+		vector<const double*> stepLogTransitions = vector<const double*>(numTimes, (const double*)NULL);
+
+		// forward pass
+		ull tm = minTime;
+		foreach_const(vector<Event*>, events, eventsIter)
 		{
-			ull tp = Parameters::GetInstance()->LookupTimePeriod(tm);
-			ull nexttp = tp; // ensure nexttp is always consistent with its usage
-			if(tm < maxTime) { nexttp = Parameters::GetInstance()->LookupTimePeriod(tm + 1); }
-			if(nexttp == INVALID_TIME_PERIOD || tp == INVALID_TIME_PERIOD)
+			ObservedEvent* observedEvent = dynamic_cast<ObservedEvent*>(*eventsIter);
+			set<ull> timestamps = set<ull>();
+			observedEvent->GetTimestamps(timestamps);
+
+			VERIFY(timestamps.size() == 1);
+			ull timestamp = *(timestamps.begin());
+
+			VERIFY(timestamp == tm && (timestamp >= minTime && timestamp <= maxTime));
+
+			ull tp = Parameters::GetInstance()->LookupTimePeriod(timestamp);
+			ull prevtp = tp; // ensure prevtp is always consistent with its usage
+			if(timestamp > minTime) { prevtp = Parameters::GetInstance()->LookupTimePeriod(timestamp - 1); }
+			if(prevtp == INVALID_TIME_PERIOD || tp == INVALID_TIME_PERIOD)
 			{
 				SET_ERROR_CODE(ERROR_CODE_INCONSISTENT_TIME_PARTITIONING_USAGE);
 				return false;
 			}
 
-			index = GET_INDEX(userIndex, (tm - minTime), numTimes);
-			ull loc = mostLikelyTrace[index];
+			double* alphaRow = &alpha[GET_INDEX((timestamp - minTime), 0, numLoc)];
 
-			if(tm == minTime) // initialization
+			if(timestamp == minTime) // initialization
 			{
 				double* subChainSteadyStateVector = NULL;
 				VERIFY(Algorithms::GetSteadyStateVectorOfSubChain(steadyStateVector, tp, &subChainSteadyStateVector) == true);
 
-				double presenceProb = subChainSteadyStateVector[loc - minLoc];
-				double logpp = log(presenceProb);
+				for(ull loc = minLoc; loc <= maxLoc; loc++)
+				{
+					double presenceProb = subChainSteadyStateVector[loc - minLoc];
+					double logpp = log(presenceProb);
 
-				Free(subChainSteadyStateVector);
+					if(presenceProb <= 0.0 || logpp == nan("n-char-sequence"))
+					{
+						logpp = log(SQRT_DBL_MIN); // avoid log overflow/underflow/nan
+					}
 
-				if(presenceProb <= 0.0 || logpp == nan("n-char-sequence"))
-				{
-					logpp = log(SQRT_DBL_MIN); // avoid log overflow/underflow/nan
+					alphaRow[loc - minLoc] = (LogEmissionProbability(user, timestamp, loc, observedEvent) + logpp) * invTemperature;
 				}
 
-				logLikelihood += logpp; // use logarithms to avoid underflow
+				Free(subChainSteadyStateVector);
 			}
 			else
 			{
-				ull index2 = GET_INDEX(userIndex, (tm+1 - minTime), numTimes);
-				ull loc2 = mostLikelyTrace[index2];
+				pair<ull, ull> periods = pair<ull, ull>(prevtp, tp);
+				LogTransitionsMap::iterator transIter = logTransitions.find(periods);
+				if(transIter == logTransitions.end())
+				{
+					vector<double> logTransition = vector<double>(numLoc * numLoc);
+					for(ull loc2 = minLoc; loc2 <= maxLoc; loc2++)
+					{
+						double* subChainTransitionVector = NULL;
+						VERIFY(Algorithms::GetTransitionVectorOfSubChain(transitionMatrix, prevtp, loc2, tp, &subChainTransitionVector) == true);
+
+						for(ull loc = minLoc; loc <= maxLoc; loc++)
+						{
+							double transProb = subChainTransitionVector[loc - minLoc];
+							double logtp = log(transProb);
 
-				// get the proper sub-chain transition vector to the time period of the previous event
-				double* subChainTransitionVector = NULL;
-				VERIFY(Algorithms::GetTransitionVectorOfSubChain(transitionMatrix, tp, loc, nexttp, &subChainTransitionVector) == true);
+							if(transProb <= 0.0 || logtp == nan("n-char-sequence"))
+							{
+								logtp = log(SQRT_DBL_MIN); // avoid log overflow/underflow/nan
+							}
 
-				ull nextLocIdx = (loc2 - minLoc);
-				double transProb = subChainTransitionVector[nextLocIdx];
+							logTransition[GET_INDEX((loc - minLoc), (loc2 - minLoc), numLoc)] = logtp * invTemperature;
+						}
+
+						Free(subChainTransitionVector);  // free the sub-chain transition vector
+					}
 
-				Free(subChainTransitionVector);  // free the sub-chain transition vector
+					transIter = logTransitions.insert(make_pair(periods, logTransition)).first;
+				}
 
-				double logtp = log(transProb);
+				const double* logTransition = &(transIter->second[0]);
+				stepLogTransitions[timestamp - minTime] = logTransition;
 
-				if(transProb <= 0.0 || logtp == nan("n-char-sequence"))
+				const double* prevAlphaRow = &alpha[GET_INDEX(((timestamp - 1) - minTime), 0, numLoc)];
+				for(ull loc = minLoc; loc <= maxLoc; loc++)
 				{
-					logtp = log(SQRT_DBL_MIN); // avoid log overflow/underflow/nan
+					const double* logTransitionsTo = &logTransition[GET_INDEX((loc - minLoc), 0, numLoc)];
+					for(ull idx = 0; idx < numLoc; idx++) { logWeights[idx] = prevAlphaRow[idx] + logTransitionsTo[idx]; }
+
+					alphaRow[loc - minLoc] = LogSumExp(logWeights, numLoc) + (LogEmissionProbability(user, timestamp, loc, observedEvent) * invTemperature);
 				}
-				logLikelihood += logtp;  // use logarithms to avoid underflow
+			}
+
+			tm++;
+		}
 
+		// backward sampling: the last location given the observed trace, then each location given the next one and the observed trace
+		rng->FillUniform(uniforms, numSamples * numTimes);
+
+		for(ull sample = 0; sample < numSamples; sample++)
+		{
+			ull traceIndex = GET_INDEX(userIndex, sample, numSamples);
+			ull* trace = &sampledTraces[GET_INDEX(traceIndex, 0, numTimes)];
+			const double* sampleUniforms = &uniforms[GET_INDEX(sample, 0, numTimes)];
+
+			memcpy(logWeights, &alpha[GET_INDEX((numTimes - 1), 0, numLoc)], logWeightsByteSize);
+			ull locIdx = SampleLogWeights(logWeights, numLoc, sampleUniforms[numTimes - 1]);
+			trace[numTimes - 1] = minLoc + locIdx;
+
+			for(ull tmIdx = numTimes - 1; tmIdx > 0; tmIdx--)
+			{
+				const double* prevAlphaRow = &alpha[GET_INDEX((tmIdx - 1), 0, numLoc)];
+				const double* logTransitionsTo = &stepLogTransitions[tmIdx][GET_INDEX(locIdx, 0, numLoc)];
+				for(ull idx = 0; idx < numLoc; idx++) { logWeights[idx] = prevAlphaRow[idx] + logTransitionsTo[idx]; }
+
+				locIdx = SampleLogWeights(logWeights, numLoc, sampleUniforms[tmIdx - 1]);
+				trace[tmIdx - 1] = minLoc + locIdx;
 			}
+
+			// the likelihood of the sample (untempered), as for the most likely trace
+			if(ComputeLogLikelihood(transitionMatrix, steadyStateVector, trace, &logLikelihoods[traceIndex]) == false) { return false; }
 		}
-		logLikelihoods[userIndex] = logLikelihood;
 
 		userIndex++;
 	}
 
-	Free(delta);
-	Free(predecessor);
+	Free(alpha);
+	Free(logWeights);
+	Free(uniforms);
 
-	return true;
+	Instrumentation::GetInstance()->AddToCounter(TrellisCellsCounter, Nusers * numTimes * numLoc);
 
-  // Bouml preserved body end 0007C991
+	return true;
 }
@@ -9,6 +9,11 @@ using namespace std;
 /**
  * This is not an attack but part of the synthetic trace generation process.
  * The modified Viterbi algorithm is implemented in this class.
+ *
+ * Alternatively (see SetBackwardSampling()), the traces are sampled by forward filtering, backward sampling: one forward pass computes
+ * the (log) forward messages of each user on its observed trace, then any number of traces are drawn from the posterior distribution of
+ * the traces given the observed trace, each by a backward pass in O(T * L) (instead of a full Viterbi pass in O(T * L^2) per trace).
+ * The output then holds the sampled traces of each user, one after the other (see SGMetricOperation).
  */
 class SGAttackOperation : public AttackOperation
 {
@@ -21,11 +26,29 @@ class SGAttackOperation : public AttackOperation
 
       virtual bool Execute(const TraceSet* input, AttackOutput* output);
 
+      virtual bool IsPerUser() const;
+
+      // samples numSamples traces per user from the posterior tempered by the given temperature (the probability of a trace is
+      // proportional to its posterior probability to the power 1 / temperature: > 1.0 flattens it, < 1.0 sharpens it towards the most
+      // likely trace), instead of the modified Viterbi algorithm (numSamples == 0, the default); the multiplicative noise is not used
+      void SetBackwardSampling(ull numSamples, double temperature = 1.0);
+
 
     private:
       bool ModifiedViterbi(const TraceSet* traces, const map<ull, ull>& userToPseudonymMap, ull* mostLikelyTrace, double* logLikelihoods);
 
+      bool BackwardSampling(const TraceSet* traces, const map<ull, ull>& userToPseudonymMap, ull* sampledTraces, double* logLikelihoods);
+
+      // log of the probability of the observed event given the actual location of the user (application and LPPM combined)
+      double LogEmissionProbability(ull user, ull timestamp, ull loc, ObservedEvent* observedEvent) const;
+
+      bool ComputeLogLikelihood(double* transitionMatrix, double* steadyStateVector, const ull* trace, double* logLikelihood) const;
+
       double maxMultFactor;
+
+      ull numSamples;
+
+      double temperature;
 };
 
 #endif /* SGATTACKOPERATION_H_ */
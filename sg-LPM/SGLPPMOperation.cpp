@@ -20,7 +20,7 @@ SGLPPMOperation::SGLPPMOperation(File& traceFile, map<ull, ull> ltcMap, vector<s
 
 	TraceSet* actualTraceSet = new TraceSet(ActualTrace);
 
-	bool readOk = inputOperation->Execute(&traceFile, actualTraceSet); inputOperation->Release();
+	bool readOk = inputOperation->TimedExecute(&traceFile, actualTraceSet); inputOperation->Release();
 	VERIFY(readOk == true);
 
 	map<ull, Trace*> tracesMap;
@@ -38,8 +38,11 @@ SGLPPMOperation::SGLPPMOperation(File& traceFile, map<ull, ull> ltcMap, vector<s
 		vector<set<ull> > userClustersVec; vector<ull> userClusterIdxVec;
 		map<ull, set<ull> > tiSSClustersMap; // time independent subsampled clusters
 
-		stringstream ssl(""); ssl << "Subsampling clusters for user " << user;
-		Log::GetInstance()->Append(ssl.str());
+		bool logEnabled = Log::GetInstance()->IsEnabled();
+		bool debugEnabled = Log::GetInstance()->IsEnabled(Log::debugLevel);
+
+		stringstream ssl("");
+		if(logEnabled == true) { ssl << "Subsampling clusters for user " << user; Log::GetInstance()->Append(ssl.str()); }
 
 		// step 1: subsamples the clusters
 		foreach_const(vector<Event*>, events, iterEvents)
@@ -82,11 +85,12 @@ SGLPPMOperation::SGLPPMOperation(File& traceFile, map<ull, ull> ltcMap, vector<s
 				iterSSC = tiSSClustersMap.find(clusterIdx);
 			}
 
-			/*{ // logging
+			if(debugEnabled == true) // logging
+			{
 				ssl.str(""); ssl << "Time-indep. cluster " << clusterIdx << " (at loc: " << loc << ") - ";
 				foreach_const(set<ull>, iterSSC->second, iterTmp) { if(iterTmp != iterSSC->second.begin()) { ssl << ", "; } ssl << *iterTmp;  }
-				Log::GetInstance()->Append(ssl.str());
-			}*/
+				Log::GetInstance()->Append(ssl.str(), Log::debugLevel);
+			}
 
 			userClustersVec.push_back(iterSSC->second);
 			userClusterIdxVec.push_back(clusterIdx);
@@ -192,11 +196,12 @@ SGLPPMOperation::SGLPPMOperation(File& traceFile, map<ull, ull> ltcMap, vector<s
 
 			tdUserClustersVec[tmIdx].insert(currentClusterLocs.begin(), currentClusterLocs.end());
 
-			/*{ // logging
+			if(debugEnabled == true) // logging
+			{
 				stringstream ssl(""); ssl << "Time-dep. cluster at tm: " << tm << " (loc: " << loc << ") - ";
 				foreach_const(set<ull>, tdUserClustersVec[tmIdx], iterTmp) { if(iterTmp != tdUserClustersVec[tmIdx].begin()) { ssl << ", "; } ssl << *iterTmp;  }
-				Log::GetInstance()->Append(ssl.str());
-			}*/
+				Log::GetInstance()->Append(ssl.str(), Log::debugLevel);
+			}
 
 			prevtm = tm;
 			tmIdx++;
@@ -1,8 +1,8 @@
 #include "SGMetric.h"
 
-SGMetricOperation::SGMetricOperation() : MetricOperation(SGMetric)
+SGMetricOperation::SGMetricOperation(ull samplesPerUser) : MetricOperation(SGMetric), samplesPerUser(samplesPerUser)
 {
-
+	VERIFY(samplesPerUser >= 1);
 }
 
 SGMetricOperation::~SGMetricOperation()
@@ -39,21 +39,26 @@ bool SGMetricOperation::Execute(const AttackOutput* input, File* output)
 	{
 		ull user = userIter->first;
 
-		stringstream ss("");
-		//ss << "Most likely trace for user " << user << ": ";
-		ss << user << ", " << mostLikelyTraceLL[userIndex] <<  ": ";
-
-		for(ull tm = minTime; tm <= maxTime; tm++)
+		for(ull sample = 0; sample < samplesPerUser; sample++)
 		{
-			ull index = GET_INDEX(userIndex, (tm - minTime), numTimes);
-			ull loc = mostLikelyTrace[index];
+			ull traceIndex = GET_INDEX(userIndex, sample, samplesPerUser);
 
-			ss << loc;
+			stringstream ss("");
+			//ss << "Most likely trace for user " << user << ": ";
+			ss << user << ", " << mostLikelyTraceLL[traceIndex] <<  ": ";
 
-			if(tm != maxTime) { ss << ", "; }
-		}
+			for(ull tm = minTime; tm <= maxTime; tm++)
+			{
+				ull index = GET_INDEX(traceIndex, (tm - minTime), numTimes);
+				ull loc = mostLikelyTrace[index];
 
-		output->WriteLine(ss.str());
+				ss << loc;
+
+				if(tm != maxTime) { ss << ", "; }
+			}
+
+			output->WriteLine(ss.str());
+		}
 
 		userIndex++;
 	}
@@ -65,3 +70,8 @@ string SGMetricOperation::GetTypeString() const
 {
 	return "sg";
 }
+
+bool SGMetricOperation::IsPerUser() const
+{
+	return true; // one line per user
+}
@@ -7,16 +7,23 @@ using namespace lpm;
 using namespace std;
 
 
+// writes the traces of the attack (one line per trace: the user, the log-likelihood of the trace and its locations), for each user,
+// its samplesPerUser traces (see SGAttackOperation::SetBackwardSampling())
 class SGMetricOperation : public MetricOperation
 {
   public:
-	SGMetricOperation();
+	SGMetricOperation(ull samplesPerUser = 1);
 
     ~SGMetricOperation();
 
     virtual bool Execute(const AttackOutput* input, File* output);
 
     virtual string GetTypeString() const;
+
+    virtual bool IsPerUser() const;
+
+  private:
+    ull samplesPerUser;
 };
 
 
@@ -0,0 +1,510 @@
+#include "SyntheticTraceStore.h"
+
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <errno.h>
+#include <iomanip>
+
+// headers of the segments and of their indexes (format version 1)
+const char SEGMENT_HEADER[8] = { 'S', 'G', 'T', 'S', 'E', 'G', '0', '1' };
+const char INDEX_HEADER[8] = { 'S', 'G', 'T', 'I', 'D', 'X', '0', '1' };
+
+const uint32 RECORD_MAGIC = 0x52544753; // "SGTR"
+
+// magic and payload length before the payload, checksum after it
+const ull RECORD_HEADER_SIZE = 2 * sizeof(uint32);
+const ull RECORD_TRAILER_SIZE = sizeof(uint64);
+
+// maximum number of segments of a store (bounds the search of a free segment)
+const ull MAX_SEGMENTS = 1000000;
+
+static uint64 ComputeChecksum(const char* data, size_t length)
+{
+	uint64 hash = 14695981039346656037ULL; // FNV-1a
+	for(size_t i = 0; i < length; i++)
+	{
+		hash ^= (unsigned char)data[i];
+		hash *= 1099511628211ULL;
+	}
+	return hash;
+}
+
+template<typename T> static void AppendValue(string& buffer, const T& value)
+{
+	buffer.append((const char*)&value, sizeof(T));
+}
+
+template<typename T> static bool ReadValue(const string& buffer, size_t* pos, T* value)
+{
+	if(*pos + sizeof(T) > buffer.size()) { return false; }
+
+	memcpy(value, buffer.data() + *pos, sizeof(T));
+	*pos += sizeof(T);
+
+	return true;
+}
+
+// unsigned LEB128 (7 bits per byte, the high bit is set on all bytes but the last)
+static void AppendVarint(string& buffer, ull value)
+{
+	while(value >= 0x80)
+	{
+		buffer.push_back((char)((value & 0x7F) | 0x80));
+		value >>= 7;
+	}
+	buffer.push_back((char)value);
+}
+
+static bool ReadVarint(const string& buffer, size_t* pos, ull* value)
+{
+	*value = 0;
+	for(ull shift = 0; shift < 64; shift += 7)
+	{
+		if(*pos >= buffer.size()) { return false; }
+
+		unsigned char byte = (unsigned char)buffer[(*pos)++];
+		*value |= (ull)(byte & 0x7F) << shift;
+
+		if((byte & 0x80) == 0) { return true; }
+	}
+	return false;
+}
+
+static bool WriteAll(int fd, const char* data, size_t length)
+{
+	while(length > 0)
+	{
+		ssize_t written = write(fd, data, length);
+		if(written < 0)
+		{
+			if(errno == EINTR) { continue; }
+			return false;
+		}
+		data += written; length -= (size_t)written;
+	}
+	return true;
+}
+
+static bool ReadAllAt(int fd, char* data, size_t length, ull offset)
+{
+	while(length > 0)
+	{
+		ssize_t numRead = pread(fd, data, length, (off_t)offset);
+		if(numRead < 0)
+		{
+			if(errno == EINTR) { continue; }
+			return false;
+		}
+		if(numRead == 0) { return false; } // end of file
+
+		data += numRead; length -= (size_t)numRead; offset += (ull)numRead;
+	}
+	return true;
+}
+
+static string GetSegmentFilePath(const string& storeDir, ull segment, const char* extension)
+{
+	stringstream ss("");
+	ss << storeDir << "/" "segment-" << setw(6) << setfill('0') << segment << extension;
+	return ss.str();
+}
+
+// index path of the given segment path
+static string GetIndexFilePath(const string& segmentPath)
+{
+	return segmentPath.substr(0, segmentPath.size() - 4) + ".idx";
+}
+
+// path of the export manifest of the store (one line '<segment file name> <number of entries exported>' per exported segment)
+static string GetManifestFilePath(const string& storeDir)
+{
+	return storeDir + "/" "export.manifest";
+}
+
+static bool ReadExportManifest(const string& storeDir, map<string, ull>& exportedEntries)
+{
+	exportedEntries.clear();
+
+	string path = GetManifestFilePath(storeDir);
+
+	struct stat st;
+	if(stat(path.c_str(), &st) != 0) { return errno == ENOENT; } // nothing exported yet
+
+	ifstream manifestFile(path.c_str(), ios::in);
+	if(manifestFile.is_open() == false) { return false; }
+
+	string name = ""; ull count = 0;
+	while(manifestFile >> name >> count) { exportedEntries[name] = count; }
+
+	return manifestFile.eof();
+}
+
+// replaces the manifest of the store (atomically, so that an interrupted export leaves the previous manifest)
+static bool WriteExportManifest(const string& storeDir, const map<string, ull>& exportedEntries)
+{
+	string path = GetManifestFilePath(storeDir);
+	string tmpPath = path + ".tmp";
+
+	{
+		ofstream manifestFile(tmpPath.c_str(), ios::out | ios::trunc);
+		if(manifestFile.is_open() == false) { return false; }
+
+		pair_foreach_const(map<string, ull>, exportedEntries, iter) { manifestFile << iter->first << " " << iter->second << "\n"; }
+
+		manifestFile.flush();
+		if(manifestFile.good() == false) { return false; }
+	}
+
+	return rename(tmpPath.c_str(), path.c_str()) == 0;
+}
+
+SyntheticTraceStoreWriter::SyntheticTraceStoreWriter()
+{
+	dataFd = -1;
+	indexFd = -1;
+	dataSize = 0;
+	segmentPath = "";
+}
+
+SyntheticTraceStoreWriter::~SyntheticTraceStoreWriter()
+{
+	Close();
+}
+
+bool SyntheticTraceStoreWriter::Open(const string& storeDir)
+{
+	Close();
+
+	if(mkdir(storeDir.c_str(), 0755) != 0 && errno != EEXIST) { return false; }
+
+	// claim the first free segment (the exclusive creation fails if another writer claimed it first)
+	for(ull segment = 0; segment < MAX_SEGMENTS && dataFd < 0; segment++)
+	{
+		string path = GetSegmentFilePath(storeDir, segment, ".dat");
+
+		int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_APPEND, 0644);
+		if(fd < 0)
+		{
+			if(errno == EEXIST) { continue; }
+			return false;
+		}
+
+		dataFd = fd;
+		segmentPath = path;
+	}
+	if(dataFd < 0) { return false; }
+
+	indexFd = open(GetIndexFilePath(segmentPath).c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_APPEND, 0644);
+	if(indexFd < 0) { Close(); return false; }
+
+	if(WriteAll(dataFd, SEGMENT_HEADER, sizeof(SEGMENT_HEADER)) == false || WriteAll(indexFd, INDEX_HEADER, sizeof(INDEX_HEADER)) == false)
+	{
+		Close();
+		return false;
+	}
+	dataSize = sizeof(SEGMENT_HEADER);
+
+	return true;
+}
+
+bool SyntheticTraceStoreWriter::Append(const SyntheticTraceRecord& record)
+{
+	if(dataFd < 0 || indexFd < 0) { return false; }
+
+	string payload = "";
+	AppendValue(payload, (uint64)record.userID);
+	AppendValue(payload, (uint64)record.seedUserID);
+	AppendValue(payload, record.logLikelihood);
+	AppendValue(payload, record.geographicSim);
+	AppendValue(payload, record.semanticSim);
+	AppendValue(payload, record.intersection);
+	AppendValue(payload, record.removeProp);
+	AppendValue(payload, record.mergeProp);
+	AppendValue(payload, record.removeActualLocProb);
+	AppendValue(payload, record.multFactor);
+	AppendValue(payload, (uint64)record.minTimestamp);
+	AppendVarint(payload, record.trace.size());
+	foreach_const(vector<ull>, record.trace, iter) { AppendVarint(payload, *iter); }
+
+	VERIFY(payload.size() <= 0xFFFFFFFFULL);
+
+	string buffer = "";
+	buffer.reserve(RECORD_HEADER_SIZE + payload.size() + RECORD_TRAILER_SIZE);
+	AppendValue(buffer, RECORD_MAGIC);
+	AppendValue(buffer, (uint32)payload.size());
+	buffer.append(payload);
+	AppendValue(buffer, ComputeChecksum(payload.data(), payload.size()));
+
+	// the record is written first, so that the index never refers to an incomplete record
+	if(WriteAll(dataFd, buffer.data(), buffer.size()) == false) { return false; }
+
+	string entry = "";
+	AppendValue(entry, (uint64)record.userID);
+	AppendValue(entry, (uint64)dataSize);
+	AppendValue(entry, (uint64)buffer.size());
+
+	dataSize += buffer.size();
+
+	return WriteAll(indexFd, entry.data(), entry.size());
+}
+
+string SyntheticTraceStoreWriter::GetSegmentPath() const
+{
+	return segmentPath;
+}
+
+void SyntheticTraceStoreWriter::Close()
+{
+	if(dataFd >= 0) { close(dataFd); dataFd = -1; }
+	if(indexFd >= 0) { close(indexFd); indexFd = -1; }
+	dataSize = 0;
+}
+
+SyntheticTraceStoreReader::SyntheticTraceStoreReader(const string& segmentPath)
+{
+	this->segmentPath = segmentPath;
+	dataSize = 0;
+
+	dataFd = open(segmentPath.c_str(), O_RDONLY);
+	if(dataFd < 0) { return; }
+
+	char header[sizeof(SEGMENT_HEADER)];
+	struct stat st;
+	if(fstat(dataFd, &st) != 0 || ReadAllAt(dataFd, header, sizeof(header), 0) == false || memcmp(header, SEGMENT_HEADER, sizeof(header)) != 0)
+	{
+		close(dataFd); dataFd = -1;
+		return;
+	}
+	dataSize = (ull)st.st_size;
+}
+
+SyntheticTraceStoreReader::~SyntheticTraceStoreReader()
+{
+	if(dataFd >= 0) { close(dataFd); }
+}
+
+bool SyntheticTraceStoreReader::IsGood() const
+{
+	return dataFd >= 0;
+}
+
+bool SyntheticTraceStoreReader::ReadIndex(vector<SyntheticTraceIndexEntry>& entries)
+{
+	entries.clear();
+	if(dataFd < 0) { return false; }
+
+	// entries of the index (an entry torn by a killed writer is ignored)
+	ifstream indexFile(GetIndexFilePath(segmentPath).c_str(), ios::in | ios::binary);
+	char header[sizeof(INDEX_HEADER)];
+	if(indexFile.read(header, sizeof(header)).gcount() == (streamsize)sizeof(header) && memcmp(header, INDEX_HEADER, sizeof(header)) == 0)
+	{
+		uint64 values[3];
+		while(indexFile.read((char*)values, sizeof(values)).gcount() == (streamsize)sizeof(values))
+		{
+			SyntheticTraceIndexEntry entry;
+			entry.userID = values[0]; entry.offset = values[1]; entry.length = values[2];
+
+			if(entry.offset + entry.length > dataSize) { break; }
+
+			entries.push_back(entry);
+		}
+	}
+
+	// records written after the last entry (i.e. the writer was killed before it could index them)
+	ull offset = (entries.empty() == true) ? sizeof(SEGMENT_HEADER) : (entries.back().offset + entries.back().length);
+	while(offset < dataSize)
+	{
+		SyntheticTraceRecord record; ull length = 0;
+		if(ReadRecordAt(offset, &record, &length) == false) { break; } // torn record
+
+		SyntheticTraceIndexEntry entry;
+		entry.userID = record.userID; entry.offset = offset; entry.length = length;
+		entries.push_back(entry);
+
+		offset += length;
+	}
+
+	return true;
+}
+
+bool SyntheticTraceStoreReader::ReadRecord(const SyntheticTraceIndexEntry& entry, SyntheticTraceRecord& record)
+{
+	ull length = 0;
+	if(ReadRecordAt(entry.offset, &record, &length) == false) { return false; }
+
+	return length == entry.length && record.userID == entry.userID;
+}
+
+bool SyntheticTraceStoreReader::ReadRecordAt(ull offset, SyntheticTraceRecord* record, ull* length)
+{
+	VERIFY(record != NULL && length != NULL);
+
+	if(dataFd < 0 || offset + RECORD_HEADER_SIZE + RECORD_TRAILER_SIZE > dataSize) { return false; }
+
+	uint32 header[2];
+	if(ReadAllAt(dataFd, (char*)header, sizeof(header), offset) == false || header[0] != RECORD_MAGIC) { return false; }
+
+	ull payloadSize = header[1];
+	*length = RECORD_HEADER_SIZE + payloadSize + RECORD_TRAILER_SIZE;
+	if(offset + *length > dataSize) { return false; }
+
+	string payload(payloadSize, '\0'); uint64 checksum = 0;
+	if(ReadAllAt(dataFd, &payload[0], payloadSize, offset + RECORD_HEADER_SIZE) == false) { return false; }
+	if(ReadAllAt(dataFd, (char*)&checksum, sizeof(checksum), offset + RECORD_HEADER_SIZE + payloadSize) == false) { return false; }
+	if(checksum != ComputeChecksum(payload.data(), payload.size())) { return false; }
+
+	size_t pos = 0; uint64 userID = 0; uint64 seedUserID = 0; uint64 minTimestamp = 0; ull numTimestamps = 0;
+	bool ok = ReadValue(payload, &pos, &userID) && ReadValue(payload, &pos, &seedUserID);
+	ok = ok && ReadValue(payload, &pos, &record->logLikelihood) && ReadValue(payload, &pos, &record->geographicSim);
+	ok = ok && ReadValue(payload, &pos, &record->semanticSim) && ReadValue(payload, &pos, &record->intersection);
+	ok = ok && ReadValue(payload, &pos, &record->removeProp) && ReadValue(payload, &pos, &record->mergeProp);
+	ok = ok && ReadValue(payload, &pos, &record->removeActualLocProb) && ReadValue(payload, &pos, &record->multFactor);
+	ok = ok && ReadValue(payload, &pos, &minTimestamp) && ReadVarint(payload, &pos, &numTimestamps);
+	if(ok == false || numTimestamps > payloadSize) { return false; }
+
+	record->userID = userID;
+	record->seedUserID = seedUserID;
+	record->minTimestamp = minTimestamp;
+
+	record->trace.resize(numTimestamps);
+	for(ull i = 0; i < numTimestamps; i++) { if(ReadVarint(payload, &pos, &record->trace[i]) == false) { return false; } }
+
+	return pos == payload.size();
+}
+
+bool SyntheticTraceStoreReader::ListSegments(const string& storeDir, vector<string>& segmentPaths)
+{
+	segmentPaths.clear();
+
+	DIR* dir = opendir(storeDir.c_str());
+	if(dir == NULL) { return false; }
+
+	vector<string> names = vector<string>();
+	struct dirent* dirEntry = NULL;
+	while((dirEntry = readdir(dir)) != NULL)
+	{
+		string name = dirEntry->d_name;
+		if(name.size() > 12 && name.compare(0, 8, "segment-") == 0 && name.compare(name.size() - 4, 4, ".dat") == 0) { names.push_back(name); }
+	}
+	closedir(dir);
+
+	sort(names.begin(), names.end()); // the segment numbers are zero-padded
+	foreach_const(vector<string>, names, iter) { segmentPaths.push_back(storeDir + "/" + *iter); }
+
+	return true;
+}
+
+bool ExportSyntheticTraces(const string& storeDir, const string& outputDir, ull* numExported)
+{
+	VERIFY(numExported != NULL);
+	*numExported = 0;
+
+	vector<string> segmentPaths = vector<string>();
+	if(SyntheticTraceStoreReader::ListSegments(storeDir, segmentPaths) == false) { return false; }
+
+	// the number of entries of each segment exported by the previous exports
+	map<string, ull> exportedEntries = map<string, ull>();
+	if(ReadExportManifest(storeDir, exportedEntries) == false) { return false; }
+
+	map<ull, ull> traceIdxMap = map<ull, ull>(); // user -> index of its next trace (after the traces previously exported)
+
+	// the entries of each segment (the records appended by the running writers after this point are left for a later export)
+	vector<vector<SyntheticTraceIndexEntry> > segmentEntries = vector<vector<SyntheticTraceIndexEntry> >(segmentPaths.size());
+	vector<ull> firstEntries = vector<ull>(segmentPaths.size(), 0); // first entry of each segment to export
+	set<ull> users = set<ull>();
+	for(ull s = 0; s < segmentPaths.size(); s++)
+	{
+		string segmentName = segmentPaths[s].substr(storeDir.size() + 1);
+		map<string, ull>::const_iterator exportedIter = exportedEntries.find(segmentName);
+		ull exported = (exportedIter != exportedEntries.end()) ? exportedIter->second : 0;
+
+		SyntheticTraceStoreReader reader(segmentPaths[s]);
+		if(reader.IsGood() == false) // e.g. a segment just claimed by a writer
+		{
+			if(exported != 0) { return false; }
+			continue;
+		}
+
+		if(reader.ReadIndex(segmentEntries[s]) == false || exported > segmentEntries[s].size()) { return false; }
+		firstEntries[s] = exported;
+
+		for(ull e = 0; e < segmentEntries[s].size(); e++)
+		{
+			ull userID = segmentEntries[s][e].userID;
+
+			if(e < exported) { traceIdxMap[userID]++; }
+			else { users.insert(userID); }
+		}
+	}
+
+	// the directories of the users (which may exist, e.g. from a previous export)
+	foreach_const(set<ull>, users, iterUser)
+	{
+		stringstream ssu(""); ssu << outputDir << "/" << "user" << *iterUser;
+		if(mkdir(ssu.str().c_str(), 0755) != 0 && errno != EEXIST) { return false; }
+	}
+
+	for(ull s = 0; s < segmentPaths.size(); s++)
+	{
+		if(firstEntries[s] == segmentEntries[s].size()) { continue; }
+
+		SyntheticTraceStoreReader reader(segmentPaths[s]);
+		if(reader.IsGood() == false) { return false; }
+
+		for(ull e = firstEntries[s]; e < segmentEntries[s].size(); e++)
+		{
+			SyntheticTraceRecord record;
+			if(reader.ReadRecord(segmentEntries[s][e], record) == false) { return false; }
+
+			ull userID = record.userID;
+
+			stringstream ssot(""); ssot << outputDir << "/" << "user" << userID << "/" "synthetic-trace" << traceIdxMap[userID]++;
+			string outputTraceFilePath = ssot.str();
+
+			{
+				File outputInfoFile(outputTraceFilePath + ".info", false);
+				if(outputInfoFile.IsGood() == false) { return false; }
+
+				stringstream ss2("");
+				ss2 << record.seedUserID << DEFAULT_FIELDS_DELIMITER;
+				ss2 << record.logLikelihood << DEFAULT_FIELDS_DELIMITER;
+				ss2 << record.geographicSim << DEFAULT_FIELDS_DELIMITER;
+				ss2 << record.semanticSim << DEFAULT_FIELDS_DELIMITER;
+				ss2 << record.intersection;
+
+				outputInfoFile.WriteLine(ss2.str());
+
+				ss2.str("");
+				ss2 << record.removeProp << DEFAULT_FIELDS_DELIMITER;
+				ss2 << record.mergeProp << DEFAULT_FIELDS_DELIMITER;
+				ss2 << record.removeActualLocProb << DEFAULT_FIELDS_DELIMITER;
+				ss2 << record.multFactor;
+
+				outputInfoFile.WriteLine(ss2.str());
+			}
+
+			File outputTraceFile(outputTraceFilePath, false);
+			if(outputTraceFile.IsGood() == false) { return false; }
+
+			for(ull idx = 0; idx < record.trace.size(); idx++)
+			{
+				stringstream ss2("");
+				ss2 << userID << DEFAULT_FIELDS_DELIMITER;
+				ss2 << (record.minTimestamp + idx) << DEFAULT_FIELDS_DELIMITER;
+				ss2 << record.trace[idx];
+
+				outputTraceFile.WriteLine(ss2.str());
+			}
+
+			(*numExported)++;
+		}
+
+		exportedEntries[segmentPaths[s].substr(storeDir.size() + 1)] = segmentEntries[s].size();
+	}
+
+	// the traces written by an interrupted export are written again (to the same files) by the next one
+	return WriteExportManifest(storeDir, exportedEntries);
+}
@@ -0,0 +1,112 @@
+#ifndef SYNTHETICTRACESTORE_H_
+#define SYNTHETICTRACESTORE_H_
+
+#include "include/Public.h"
+
+using namespace lpm;
+using namespace std;
+
+/*
+ * Packed store of the synthetic traces.
+ * The store is a directory of segments. Each writer (i.e. each sg-LPM instance) claims its own segment when it opens the store (the first
+ * free 'segment-<k>.dat', created exclusively), hence any number of instances can write to the same store concurrently without locking.
+ *
+ * A segment is append-only: each record (a synthetic trace along with its metadata, see SyntheticTraceRecord) is written with a single
+ * write, and is followed by an entry (user, offset, length) in the index of the segment ('segment-<k>.idx'). A record is delimited by a
+ * magic number and its length, and ends with a checksum of its payload, so that a record torn by a killed writer is detected (and ignored).
+ * The locations of the traces are stored as variable-length integers.
+ *
+ * The traces are exported to the text format (one 'synthetic-trace<i>' file and its '.info' file per trace) by 'sg-LPM export'. The export is
+ * incremental: the number of entries of each segment already exported is recorded in the manifest of the store ('export.manifest'), so
+ * that an export only writes the records appended since the previous one (and exporting twice writes nothing the second time).
+ */
+
+// a synthetic trace and its metadata (the seed user, the scores of the trace and the parameters of the generation)
+struct SyntheticTraceRecord
+{
+	ull userID;
+	ull seedUserID;
+	double logLikelihood;
+	double geographicSim;
+	double semanticSim;
+	double intersection;
+	double removeProp;
+	double mergeProp;
+	double removeActualLocProb;
+	double multFactor;
+	ull minTimestamp;
+	vector<ull> trace; // location of each timestamp, starting from minTimestamp
+};
+
+// position of a record in its segment
+struct SyntheticTraceIndexEntry
+{
+	ull userID;
+	ull offset;
+	ull length;
+};
+
+class SyntheticTraceStoreWriter
+{
+  public:
+	SyntheticTraceStoreWriter();
+
+	~SyntheticTraceStoreWriter();
+
+	// creates the store directory (if needed) and claims a new segment
+	bool Open(const string& storeDir);
+
+	// appends the record to the segment, and its entry to the index
+	bool Append(const SyntheticTraceRecord& record);
+
+	string GetSegmentPath() const;
+
+	void Close();
+
+  private:
+	SyntheticTraceStoreWriter(const SyntheticTraceStoreWriter& source);
+
+	SyntheticTraceStoreWriter& operator=(const SyntheticTraceStoreWriter& source);
+
+	int dataFd;
+	int indexFd;
+	ull dataSize;
+	string segmentPath;
+};
+
+class SyntheticTraceStoreReader
+{
+  public:
+	explicit SyntheticTraceStoreReader(const string& segmentPath);
+
+	~SyntheticTraceStoreReader();
+
+	bool IsGood() const;
+
+	// reads the index of the segment (the complete records written after the last entry of the index, if any, are recovered by scanning the segment)
+	bool ReadIndex(vector<SyntheticTraceIndexEntry>& entries);
+
+	bool ReadRecord(const SyntheticTraceIndexEntry& entry, SyntheticTraceRecord& record);
+
+	// returns the paths of the segments of the store (in order of creation)
+	static bool ListSegments(const string& storeDir, vector<string>& segmentPaths);
+
+  private:
+	SyntheticTraceStoreReader(const SyntheticTraceStoreReader& source);
+
+	SyntheticTraceStoreReader& operator=(const SyntheticTraceStoreReader& source);
+
+	// reads the record at the given offset (if it is complete and valid), and returns its length
+	bool ReadRecordAt(ull offset, SyntheticTraceRecord* record, ull* length);
+
+	string segmentPath;
+	int dataFd;
+	ull dataSize;
+};
+
+// writes the traces of the store not exported yet (see the export manifest above) to <outputDir>/user<userID>/synthetic-trace<i> (and its
+// '.info' file), where the traces of a user are numbered after those previously exported for that user (the directories are created if needed);
+// the store should always be exported to the same directory
+bool ExportSyntheticTraces(const string& storeDir, const string& outputDir, ull* numExported);
+
+#endif
@@ -7,6 +7,7 @@ CPP_SRCS += \
 ../SGAttackOperation.cpp \
 ../SGLPPMOperation.cpp \
 ../SGMetric.cpp \
+../SyntheticTraceStore.cpp \
 ../community.cpp \
 ../graph.cpp \
 ../graph_binary.cpp \
@@ -16,12 +17,14 @@ OBJS += \
 ./SGAttackOperation.o \
 ./SGLPPMOperation.o \
 ./SGMetric.o \
+./SyntheticTraceStore.o \
 ./main.o 
 
 CPP_DEPS += \
 ./SGAttackOperation.d \
 ./SGLPPMOperation.d \
 ./SGMetric.d \
+./SyntheticTraceStore.d \
 ./main.d 
 
 
@@ -29,7 +32,7 @@ CPP_DEPS += \
 %.o: ../%.cpp
 	@echo 'Building file: $<'
 	@echo 'Invoking: GCC C++ Compiler'
-	g++ -DDEBUG -I"%LPM_ROOTPATH%" -m64 -O0 -g3 -Wall -c -fmessage-length=0 -MMD -MP -MF"$(@:%.o=%.d)" -MT"$(@:%.o=%.d)" -o "$@" "$<"
+	g++ -DDEBUG -I"%LPM_ROOTPATH%" -m64 -pthread -O0 -g3 -Wall -c -fmessage-length=0 -MMD -MP -MF"$(@:%.o=%.d)" -MT"$(@:%.o=%.d)" -o "$@" "$<"
 	@echo 'Finished building: $<'
 	@echo ' '
 
@@ -4,5 +4,5 @@
 
 USER_OBJS :=
 
-LIBS := -lLPM
+LIBS := -lLPM -lpthread
 
@@ -7,18 +7,21 @@ CPP_SRCS += \
 ../SGAttackOperation.cpp \
 ../SGLPPMOperation.cpp \
 ../SGMetric.cpp \
+../SyntheticTraceStore.cpp \
 ../main.cpp 
 
 OBJS += \
 ./SGAttackOperation.o \
 ./SGLPPMOperation.o \
 ./SGMetric.o \
+./SyntheticTraceStore.o \
 ./main.o 
 
 CPP_DEPS += \
 ./SGAttackOperation.d \
 ./SGLPPMOperation.d \
 ./SGMetric.d \
+./SyntheticTraceStore.d \
 ./main.d 
 
 
@@ -26,7 +29,7 @@ CPP_DEPS += \
 %.o: ../%.cpp
 	@echo 'Building file: $<'
 	@echo 'Invoking: GCC C++ Compiler'
-	g++ -I"%LPM_ROOTPATH%" -m64 -O3 -Wall -c -fmessage-length=0 -MMD -MP -MF"$(@:%.o=%.d)" -MT"$(@:%.o=%.d)" -o "$@" "$<"
+	g++ -I"%LPM_ROOTPATH%" -m64 -pthread -O3 -Wall -c -fmessage-length=0 -MMD -MP -MF"$(@:%.o=%.d)" -MT"$(@:%.o=%.d)" -o "$@" "$<"
 	@echo 'Finished building: $<'
 	@echo ' '
 
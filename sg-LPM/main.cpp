@@ -9,17 +9,189 @@
 
 #include "SGMetric.h"
 
+#include "SyntheticTraceStore.h"
+
+#include <sys/stat.h>
+#include <iomanip>
+
 using namespace lpm;
 
+// limits of the knowledge construction (part of the cache key of the knowledge)
+#define SG_KC_MAX_GS_ITERATIONS 100000
+#define SG_KC_MAX_SECONDS 60
 
-bool ConstructKnowledge(string& traceFilePath, string& mobilityFilePath, string& knowledgeFilePath)
+// cutoff radius of the distance kernel of the aggregate statistics (KC_NO_KERNEL_CUTOFF: all the pairs of locations, see
+// CreateContextOperation::SetDistanceKernelCutoff()), part of the cache key of the aggregate statistics
+#define SG_AGGREGATE_KERNEL_CUTOFF KC_NO_KERNEL_CUTOFF
+
+// the best assignments of the locations of the users (clustering of the locations) are approximated by this number of Sinkhorn iterations
+// (0: exact assignments, see Algorithms::ApproximateMaximumWeightAssignment()), the approximation is part of the cache key of the clusters
+#define SG_CLUSTERING_SINKHORN_ITERATIONS 0
+#define SG_CLUSTERING_SINKHORN_REGULARIZATION 0.01
+
+// number of users with which each user is compared to cluster the locations: its nearest neighbors in a SimilarityCandidateIndex of the
+// stationary distributions (0: all the users), also part of the cache key of the clusters
+#define SG_CLUSTERING_CANDIDATE_NEIGHBORS 0
+
+// number of users tracked at once by the Viterbi schedule (the users are streamed through the attack and the metric in batches)
+#define SG_VITERBI_STREAMING_BATCH_SIZE 256
+
+// number of traces sampled per user and per iteration by forward filtering, backward sampling from the posterior tempered by the given
+// temperature (0: the most likely trace of the modified Viterbi algorithm, see SGAttackOperation::SetBackwardSampling())
+#define SG_FFBS_SAMPLES 0
+#define SG_FFBS_TEMPERATURE 1.0
+
+// number of seconds between two snapshots of the instrumentation (timers and counters, see lpm::Instrumentation)
+#define SG_INSTRUMENTATION_INTERVAL 60
+
+/*
+ * Stage timings.
+ * The wall-clock time spent in each stage of the run (setup and generation) is recorded by the instrumentation (timers 'sg-LPM/<stage>'),
+ * and reported at the end of the run along with the number of synthetic traces generated per second (see the optional number of iterations
+ * in main()). The snapshots of the instrumentation, which include the timings of the LPM operations, are written to output-instrumentation.json.
+ */
+enum SGStage { SGStageAggregateStats = 0, SGStageKnowledge, SGStageClustering, SGStageLPPM, SGStageViterbi, SGStagePlausibility, SGStagesCount };
+
+const char* SG_STAGE_NAMES[SGStagesCount] = { "aggregate stats", "knowledge", "clustering", "SGLPPM", "Viterbi", "plausibility" };
+
+double GetWallClockSeconds()
+{
+	return Instrumentation::GetTime();
+}
+
+string GetStageTimerName(SGStage stage)
+{
+	return string("sg-LPM/") + SG_STAGE_NAMES[stage];
+}
+
+// adds the time elapsed since start to the given stage
+void AddStageTime(SGStage stage, double start)
+{
+	Instrumentation::GetInstance()->AddTime(GetStageTimerName(stage), GetWallClockSeconds() - start);
+}
+
+void ReportStageTimes(ull iterations, ull numTraces, double generationSeconds)
+{
+	stringstream ss("");
+	ss << "[SG Timing] " << iterations << " iterations, " << numTraces << " synthetic traces in " << fixed << setprecision(3) << generationSeconds << " seconds";
+	ss << " (" << (generationSeconds > 0.0 ? numTraces / generationSeconds : 0.0) << " traces/s)" << endl;
+
+	for(ull stage = 0; stage < SGStagesCount; stage++)
+	{
+		double stageSeconds = 0.0;
+		Instrumentation::GetInstance()->GetTimer(GetStageTimerName((SGStage)stage), NULL, &stageSeconds);
+
+		ss << "[SG Timing] " << left << setw(16) << SG_STAGE_NAMES[stage] << right << setw(12) << stageSeconds << " s";
+		if(stage >= SGStageLPPM && iterations > 0) { ss << " (" << stageSeconds / iterations << " s/iteration)"; }
+		if(stage + 1 < SGStagesCount) { ss << endl; }
+	}
+
+	std::cout << ss.str() << endl;
+	Log::GetInstance()->Append(ss.str());
+}
+
+/*
+ * Setup artifacts cache.
+ * The aggregate statistics, the knowledge and the locations clusters are stored in the cache directory under a key which is
+ * a hash (64 bits FNV-1a) of everything they are computed from: the content of the input files and the parameters (users, times,
+ * locations, time partitioning). Hence, an artifact is recomputed if and only if one of its inputs changes (stale artifacts are never
+ * reused) and the unchanged stages are reused across runs with different parameters of the same dataset.
+ */
+const ull FNV_OFFSET_BASIS = 14695981039346656037ULL;
+const ull FNV_PRIME = 1099511628211ULL;
+
+ull HashBytes(const char* data, size_t length, ull hash)
 {
-	// test if the output file exists, if so there is no need to re-create it...
+	for(size_t i = 0; i < length; i++)
 	{
-		File outputKCFileExists(knowledgeFilePath, true);
-		if(outputKCFileExists.IsGood() == true) { return true; }
+		hash ^= (unsigned char)data[i];
+		hash *= FNV_PRIME;
 	}
+	return hash;
+}
+
+ull HashString(const string& str, ull hash)
+{
+	hash = HashBytes(str.c_str(), str.length(), hash);
+	return HashBytes("", 1, hash); // include the terminating null char, so that consecutive strings are delimited
+}
 
+ull HashFile(const string& filePath, ull hash)
+{
+	ifstream file(filePath.c_str(), ios::in | ios::binary);
+	if(file.good() == false) { return HashString("<missing file>", hash); }
+
+	char buffer[1 << 16];
+	while(file.good() == true)
+	{
+		file.read(buffer, sizeof(buffer));
+		hash = HashBytes(buffer, (size_t)file.gcount(), hash);
+	}
+
+	return HashString("<end of file>", hash);
+}
+
+ull HashSetupParameters(const string& timePartitioning, ull hash)
+{
+	Parameters* params = Parameters::GetInstance();
+
+	set<ull> users = set<ull>();
+	VERIFY(params->GetUsersSet(users) == true);
+
+	ull minTime = 0; ull maxTime = 0;
+	VERIFY(params->GetTimestampsRange(&minTime, &maxTime) == true);
+
+	ull minLoc = 0; ull maxLoc = 0;
+	VERIFY(params->GetLocationstampsRange(&minLoc, &maxLoc) == true);
+
+	stringstream ss("");
+	ss << "users:"; foreach_const(set<ull>, users, iter) { ss << " " << *iter; }
+	ss << " | times: " << minTime << " " << maxTime << " | locs: " << minLoc << " " << maxLoc;
+	ss << " | partitioning: " << timePartitioning;
+
+	return HashString(ss.str(), hash);
+}
+
+string GetCachedArtifactPath(const string& cacheDir, const string& name, ull key)
+{
+	stringstream ss("");
+	ss << cacheDir << "/" << name << "-" << hex << setw(16) << setfill('0') << key;
+	return ss.str();
+}
+
+// returns whether the given artifact is in the cache (if not, it needs to be computed)
+bool IsArtifactCached(const string& artifactPath)
+{
+	File artifactFile(artifactPath, true);
+	bool cached = artifactFile.IsGood();
+
+	Log::GetInstance()->Append((cached == true ? "Cache hit: " : "Cache miss: ") + artifactPath);
+
+	return cached;
+}
+
+// moves a (complete) artifact into the cache
+// artifacts are first written to a temporary file, so that an interrupted stage never leaves a truncated artifact in the cache
+bool CommitArtifact(const string& tmpArtifactPath, const string& artifactPath)
+{
+	if(rename(tmpArtifactPath.c_str(), artifactPath.c_str()) != 0)
+	{
+		SET_ERROR_CODE_DETAILS(ERROR_CODE_INVALID_ARGUMENTS, "unable to move the artifact into the cache: " + artifactPath);
+		std::cout << Errors::GetInstance()->GetLastErrorMessage() << endl;
+		return false;
+	}
+
+	// contexts are stored along with an accuracy file (see StoreContextOperation), which follows the artifact
+	string tmpAccuracyPath = tmpArtifactPath + ".accuracy";
+	File tmpAccuracyFile(tmpAccuracyPath, true);
+	if(tmpAccuracyFile.IsGood() == true) { rename(tmpAccuracyPath.c_str(), (artifactPath + ".accuracy").c_str()); }
+
+	return true;
+}
+
+
+bool ConstructKnowledge(string& traceFilePath, string& mobilityFilePath, string& knowledgeFilePath)
+{
 	LPM* lpm = LPM::GetInstance();
 
 	File learningTraceFile(traceFilePath, true);
@@ -32,8 +204,8 @@ bool ConstructKnowledge(string& traceFilePath, string& mobilityFilePath, string&
 	knowledge.learningTraceFilesVector = vector<File*>();
 	knowledge.learningTraceFilesVector.push_back(&learningTraceFile);
 
-	const ull maxGSIterations = 100000;
-	const ull maxSeconds = 60;
+	const ull maxGSIterations = SG_KC_MAX_GS_ITERATIONS;
+	const ull maxSeconds = SG_KC_MAX_SECONDS;
 
 	if(lpm->RunKnowledgeConstruction(&knowledge, &outputKC, maxGSIterations, maxSeconds) == false)
 	{
@@ -46,16 +218,6 @@ bool ConstructKnowledge(string& traceFilePath, string& mobilityFilePath, string&
 
 bool ComputeAggregateStats(string& traceFilePath, string& locationsFilePath, string& aggregateStatsFilePath)
 {
-	// test if the output file exists, if so there is no need to re-create it...
-	{
-		File aggregateStatsFileExists(aggregateStatsFilePath, true);
-		if(aggregateStatsFileExists.IsGood() == true)
-		{
-			Log::GetInstance()->Append("Aggregate statistics file found.");
-			return true;
-		}
-	}
-
 	Log::GetInstance()->Append("Computing aggregate statistics...");
 
 	File learningTraceFile(traceFilePath, true);
@@ -66,6 +228,7 @@ bool ComputeAggregateStats(string& traceFilePath, string& locationsFilePath, str
 	File locationsFile(locationsFilePath, true);
 
 	CreateContextOperation* createContextOp = new CreateContextOperation();
+	createContextOp->SetDistanceKernelCutoff(SG_AGGREGATE_KERNEL_CUTOFF);
 	if(createContextOp->ComputeAggregateStatistics(&learningTraceFile, &locationsFile, &transitionMatrix, &steadyStateVector) == false) { return false; }
 	createContextOp->Release();
 
@@ -87,7 +250,7 @@ bool ComputeAggregateStats(string& traceFilePath, string& locationsFilePath, str
 	}
 
 	StoreContextOperation* storeContextOp = new StoreContextOperation();
-	if(storeContextOp->Execute(context, &aggregateStatsFile) == false) { return false; }
+	if(storeContextOp->TimedExecute(context, &aggregateStatsFile) == false) { return false; }
 	storeContextOp->Release();
 
 	for(ull userID = minUserID; userID <= maxUserID; userID++)
@@ -113,17 +276,6 @@ bool ComputeAggregateStats(string& traceFilePath, string& locationsFilePath, str
  */
 bool ClusterLocations(string& outputDir, string& knowledgeFilePath, string& locClustersFilePath, MetricDistance* distanceFunction = new DefaultMetricDistance())
 {
-	// test if the output file exists, if so there is no need to re-create it...
-	{
-		File locClustersFileExists(locClustersFilePath, true);
-		if(locClustersFileExists.IsGood() == true)
-		{
-			Log::GetInstance()->Append("Locations clusters file found.");
-			return true;
-		}
-	}
-
-
 	Log::GetInstance()->Append("Starting clustering locations...");
 
 	File knowledgeFile(knowledgeFilePath, true);
@@ -136,7 +288,7 @@ bool ClusterLocations(string& outputDir, string& knowledgeFilePath, string& locC
 	LoadContextOperation* loadContextOp = new LoadContextOperation();
 
 	Context* context = new Context();
-	bool ok = loadContextOp->Execute(&knowledgeFile, context); loadContextOp->Release();
+	bool ok = loadContextOp->TimedExecute(&knowledgeFile, context); loadContextOp->Release();
 	if(ok == false) { context->Release(); return false; }
 
 	Log::GetInstance()->Append("Context loaded, calculating weights for clustering locations.");
@@ -176,10 +328,45 @@ bool ClusterLocations(string& outputDir, string& knowledgeFilePath, string& locC
 
 	bool isDefaultDistance = (dynamic_cast<DefaultMetricDistance*>(distanceFunction) != NULL);
 
-	pair_foreach_const(map<ull, UserProfile*>, profiles, iterProfiles)
+	vector<UserProfile*> profilesList = vector<UserProfile*>();
+	pair_foreach_const(map<ull, UserProfile*>, profiles, iterProfiles) { profilesList.push_back(iterProfiles->second); }
+	ull Nusers = profilesList.size();
+
+	// the users compared with each user: all of them, or the user itself and its nearest neighbors (see SG_CLUSTERING_CANDIDATE_NEIGHBORS)
+	vector<vector<ull> > comparedUsers = vector<vector<ull> >(Nusers);
+	if(SG_CLUSTERING_CANDIDATE_NEIGHBORS == 0)
+	{
+		for(ull userIndex = 0; userIndex < Nusers; userIndex++)
+		{
+			for(ull userIndex2 = 0; userIndex2 < Nusers; userIndex2++) { comparedUsers[userIndex].push_back(userIndex2); }
+		}
+	}
+	else
 	{
-		ull user1 = iterProfiles->first;
-		UserProfile* profile1 = iterProfiles->second;
+		// the stationary distributions are sorted within each time period, as the mappings of the locations do not depend on their order
+		ull numStates = numPeriods * numLoc;
+		SimilarityCandidateIndex index(numStates, RNG::GetInstance()->CreateStream().GetRandomUINT64());
+		for(ull userIndex = 0; userIndex < Nusers; userIndex++)
+		{
+			double* steadyStateVector = NULL;
+			VERIFY(profilesList[userIndex]->GetSteadyStateVector(&steadyStateVector) == true);
+
+			vector<double> sortedVector = vector<double>(steadyStateVector, steadyStateVector + numStates);
+			for(ull start = 0; start < numStates; start += numLoc) { sort(sortedVector.begin() + start, sortedVector.begin() + start + numLoc); }
+			index.AddVector(&sortedVector[0]);
+		}
+
+		index.GetNearestNeighbors(SG_CLUSTERING_CANDIDATE_NEIGHBORS, comparedUsers);
+		for(ull userIndex = 0; userIndex < Nusers; userIndex++)
+		{
+			comparedUsers[userIndex].push_back(userIndex);
+			sort(comparedUsers[userIndex].begin(), comparedUsers[userIndex].end());
+		}
+	}
+
+	for(ull userIndex1 = 0; userIndex1 < Nusers; userIndex1++)
+	{
+		UserProfile* profile1 = profilesList[userIndex1];
 
 		double* steadyStateVector1 = NULL;
 		double* transitionMatrix1 = NULL;
@@ -188,10 +375,9 @@ bool ClusterLocations(string& outputDir, string& knowledgeFilePath, string& locC
 		VERIFY(profile1->GetTransitionMatrix(&transitionMatrix1) == true);
 
 
-		pair_foreach_const(map<ull, UserProfile*>, profiles, iterProfiles2)
+		foreach_const(vector<ull>, comparedUsers[userIndex1], iterUsers2)
 		{
-			ull user2 = iterProfiles2->first;
-			UserProfile* profile2 = iterProfiles2->second;
+			UserProfile* profile2 = profilesList[*iterUsers2];
 
 			double* steadyStateVector2 = NULL;
 			double* transitionMatrix2 = NULL;
@@ -295,10 +481,14 @@ bool ClusterLocations(string& outputDir, string& knowledgeFilePath, string& locC
 
 						//Log::GetInstance()->Append(info.str());
 					}
-					Free(wd); wd = NULL; // free wd
 					//Log::GetInstance()->Append("------------");
 
-					Algorithms::MinimumCostAssignment(costMatrix, numLoc, sigma); // Hungarian (munkres) algorithm to find sigma
+					if(SG_CLUSTERING_SINKHORN_ITERATIONS != 0)
+					{
+						Algorithms::ApproximateMaximumWeightAssignment(wd, numLoc, sigma, SG_CLUSTERING_SINKHORN_REGULARIZATION, SG_CLUSTERING_SINKHORN_ITERATIONS);
+					}
+					else { Algorithms::MinimumCostAssignment(costMatrix, numLoc, sigma); } // Hungarian (munkres) algorithm to find sigma
+					Free(wd); wd = NULL; // free wd
 					for(ull loc = minLoc; loc <= maxLoc; loc++)
 					{
 						//stringstream info("");
@@ -589,8 +779,12 @@ bool RunViterbi(string& outputDir, string& traceFilePath, string& observedTraceF
 
 	VERIFY(startPos == ScheduleBeforeAttackOperation);
 
+	// the tracking is per-user: bound the memory used by the attack (and its output) regardless of the number of users
+	VERIFY(builder->SetStreamingBatchSize(SG_VITERBI_STREAMING_BATCH_SIZE) == true);
+
 	// create and set the attack -> derive from Viterbi
-	AttackOperation* attack = new SGAttackOperation(multFactor);
+	SGAttackOperation* attack = new SGAttackOperation(multFactor);
+	if(SG_FFBS_SAMPLES != 0) { attack->SetBackwardSampling(SG_FFBS_SAMPLES, SG_FFBS_TEMPERATURE); }
 	VERIFY(builder->SetAttackOperation(attack) == true);
 	attack->Release(); // release now
 
@@ -630,8 +824,34 @@ typedef struct _SampleTrace
 }
 SampleTrace;
 
+// exports the traces of the store of the given output directory to the text format (see ExportSyntheticTraces())
+int ExportStore(int argc, char **argv)
+{
+	if(argc < 3)
+	{
+		cout << "Usage: sg-LPM export <output directory>" << endl;
+		return -1;
+	}
+
+	string outputDir = string(argv[2]);
+	string storeDir = outputDir + "/" "out" "/" "store";
+
+	ull numExported = 0;
+	if(ExportSyntheticTraces(storeDir, outputDir + "/" "out", &numExported) == false)
+	{
+		cout << "Unable to export the synthetic traces store: " << storeDir << " (" << numExported << " traces exported)" << endl;
+		return -1;
+	}
+
+	cout << "Exported " << numExported << " synthetic traces to " << outputDir << "/" "out" << endl;
+
+	return 0;
+}
+
 int main(int argc, char **argv)
 {
+	if(argc >= 2 && string(argv[1]) == "export") { return ExportStore(argc, argv); }
+
 	if(argc < 6)
 	{
 		cout << "Not enough arguments provided, exiting..." << endl;
@@ -671,6 +891,12 @@ int main(int argc, char **argv)
 	double multFactor = 1.0;
 	if(argc >= 11) { char* mf = argv[10];  stringstream ss(""); ss << mf; ss >> multFactor; }
 
+	ull seed = 0; bool seeded = false; // optional seed of the random number generator (for reproducible runs)
+	if(argc >= 12) { char* sd = argv[11];  stringstream ss(""); ss << sd; ss >> seed; seeded = true; }
+
+	ull maxIterations = 0; // optional number of generation iterations (0: generate until killed), the stage timings are reported at the end
+	if(argc >= 13) { char* it = argv[12];  stringstream ss(""); ss << it; ss >> maxIterations; }
+
 	ull minUserID = 1; ull maxUserID = 0;
 	{ stringstream ss(""); ss << minU; ss >> minUserID; }
 	{ stringstream ss(""); ss << maxU; ss >> maxUserID; }
@@ -687,6 +913,8 @@ int main(int argc, char **argv)
 	RNG* rng = RNG::GetInstance();
 	Log* logPtr = Log::GetInstance();
 
+	if(seeded == true) { rng->SetSeed(seed); }
+
 	Parameters* params = Parameters::GetInstance();
 	params->AddUsersRange(minUserID, maxUserID);
 	params->SetTimestampsRange(minTimestamp, maxTimestamp);
@@ -740,6 +968,13 @@ int main(int argc, char **argv)
 	logPtr->SetEnabled(true);
 	logPtr->SetOutputFileName(outputDir + "/" "output");
 
+	Instrumentation* instrumentation = Instrumentation::GetInstance();
+	instrumentation->SetEnabled(true); // the stage timings are reported even if the snapshots cannot be written
+	if(instrumentation->SetOutput(outputDir + "/" "output-instrumentation.json", JSONInstrumentationFormat, SG_INSTRUMENTATION_INTERVAL) == false)
+	{
+		logPtr->Append("Unable to open the instrumentation output file!", Log::warningLevel);
+	}
+
 	string traceFilePath = filePath + ".trace";
 	string mobilityFilePath = filePath + ".mobility";
 
@@ -768,6 +1003,7 @@ int main(int argc, char **argv)
 
 		ssl.str(""); ssl << "Remove actual loc prob: " << removeActualLocProb; logPtr->Append(ssl.str());
 		ssl.str(""); ssl << "Viterbi m-factor: " << multFactor; logPtr->Append(ssl.str());
+		ssl.str(""); ssl << "RNG seed: " << rng->GetSeed(); logPtr->Append(ssl.str());
 
 		ssl.str(""); ssl << "Time Partitioning:" << str; logPtr->Append(ssl.str());
 	}
@@ -775,18 +1011,61 @@ int main(int argc, char **argv)
 	size_t pos = filePath.rfind('/');
 	string inputDir = filePath.substr(0, pos);
 
-	string aggregateStatsFilePath = inputDir + "/" "aggregate.stats";
 	string locationsFilePath = inputDir + "/" "locations";
-	if(ComputeAggregateStats(traceFilePath, locationsFilePath,  aggregateStatsFilePath) == false) { return -1; }
 
-	string knowledgeFilePath = inputDir + "/" "knowledge";
-	if(ConstructKnowledge(traceFilePath, mobilityFilePath, knowledgeFilePath) == false) { return -1; }
+	// the setup artifacts are cached, each stage is only run if its inputs changed (see GetCachedArtifactPath())
+	string cacheDir = inputDir + "/" "cache";
+	if(mkdir(cacheDir.c_str(), 0755) != 0 && errno != EEXIST)
+	{
+		std::cout << "Unable to create the cache directory: " << cacheDir << endl;
+		return -1;
+	}
+
+	const ull paramsKey = HashSetupParameters(str, FNV_OFFSET_BASIS);
+	const ull traceKey = HashFile(traceFilePath, paramsKey);
+
+	stringstream aggregateStatsKeyString(""); aggregateStatsKeyString << "aggregate.stats";
+	if(SG_AGGREGATE_KERNEL_CUTOFF != KC_NO_KERNEL_CUTOFF) { aggregateStatsKeyString << " cutoff " << SG_AGGREGATE_KERNEL_CUTOFF; }
+	const ull aggregateStatsKey = HashFile(locationsFilePath, HashString(aggregateStatsKeyString.str(), traceKey));
+	string aggregateStatsFilePath = GetCachedArtifactPath(cacheDir, "aggregate.stats", aggregateStatsKey);
+	if(IsArtifactCached(aggregateStatsFilePath) == false)
+	{
+		string tmpFilePath = aggregateStatsFilePath + ".tmp";
+		double start = GetWallClockSeconds();
+		if(ComputeAggregateStats(traceFilePath, locationsFilePath, tmpFilePath) == false) { return -1; }
+		AddStageTime(SGStageAggregateStats, start);
+		if(CommitArtifact(tmpFilePath, aggregateStatsFilePath) == false) { return -1; }
+	}
+
+	stringstream kcLimits(""); kcLimits << "knowledge " << SG_KC_MAX_GS_ITERATIONS << " " << SG_KC_MAX_SECONDS;
+	const ull knowledgeKey = HashFile(mobilityFilePath, HashString(kcLimits.str(), traceKey));
+	string knowledgeFilePath = GetCachedArtifactPath(cacheDir, "knowledge", knowledgeKey);
+	if(IsArtifactCached(knowledgeFilePath) == false)
+	{
+		string tmpFilePath = knowledgeFilePath + ".tmp";
+		double start = GetWallClockSeconds();
+		if(ConstructKnowledge(traceFilePath, mobilityFilePath, tmpFilePath) == false) { return -1; }
+		AddStageTime(SGStageKnowledge, start);
+		if(CommitArtifact(tmpFilePath, knowledgeFilePath) == false) { return -1; }
+	}
 
-	string locClustersFilePath = inputDir + "/" "locations.clusters";
-	if(ClusterLocations(outputDir, knowledgeFilePath, locClustersFilePath) == false) { return -1; }
+	// the clusters only depend on the knowledge (i.e. on its key)
+	stringstream clusteringKey(""); clusteringKey << "locations.clusters";
+	if(SG_CLUSTERING_SINKHORN_ITERATIONS != 0) { clusteringKey << " sinkhorn " << SG_CLUSTERING_SINKHORN_ITERATIONS << " " << SG_CLUSTERING_SINKHORN_REGULARIZATION; }
+	if(SG_CLUSTERING_CANDIDATE_NEIGHBORS != 0) { clusteringKey << " neighbors " << SG_CLUSTERING_CANDIDATE_NEIGHBORS; }
+	const ull locClustersKey = HashString(clusteringKey.str(), knowledgeKey);
+	string locClustersFilePath = GetCachedArtifactPath(cacheDir, "locations.clusters", locClustersKey);
+	if(IsArtifactCached(locClustersFilePath) == false)
+	{
+		string tmpFilePath = locClustersFilePath + ".tmp";
+		double start = GetWallClockSeconds();
+		if(ClusterLocations(outputDir, knowledgeFilePath, tmpFilePath) == false) { return -1; }
+		AddStageTime(SGStageClustering, start);
+		if(CommitArtifact(tmpFilePath, locClustersFilePath) == false) { return -1; }
+	}
 
 
-	if(initOnly == true) { return 0; }
+	if(initOnly == true) { ReportStageTimes(0, 0, 0.0); return 0; }
 
 	string observedTraceFilePath = outputDir + "/" "output-lppm";
 
@@ -802,7 +1081,7 @@ int main(int argc, char **argv)
 
 		actualTraceSet = new TraceSet(ActualTrace);
 
-		bool readOk = inputOperation->Execute(&seedTraceFile, actualTraceSet); inputOperation->Release();
+		bool readOk = inputOperation->TimedExecute(&seedTraceFile, actualTraceSet); inputOperation->Release();
 		VERIFY(readOk == true);
 	}
 
@@ -812,7 +1091,16 @@ int main(int argc, char **argv)
 
     const double llBigFactor = MIN((double)numTimes, log(sqrt(DBL_MAX)));
 
-	map<ull, ull> traceIdxMap;
+	// the synthetic traces are appended to a segment of the store of their own (see SyntheticTraceStore.h)
+	string storeDir = outputDir + "/" "out" "/" "store";
+	SyntheticTraceStoreWriter storeWriter;
+	mkdir((outputDir + "/" "out").c_str(), 0755); // (if needed, the store directory is created by the writer)
+	if(storeWriter.Open(storeDir) == false)
+	{
+		std::cout << "Unable to open the synthetic traces store: " << storeDir << endl;
+		return -1;
+	}
+	logPtr->Append("Writing the synthetic traces to: " + storeWriter.GetSegmentPath());
 
 	map<ull, Trace*> tracesMap;
 	actualTraceSet->GetMapping(tracesMap);
@@ -820,19 +1108,27 @@ int main(int argc, char **argv)
 	//const string tmpDir = "/tmp/";
 	const string tmpDir = outputDir + "/";
 
+	ull numSyntheticTraces = 0;
+	const double generationStart = GetWallClockSeconds();
+
 	//for(ull i = 0; i < sampleTraces; i++)
-	// generate traces until killed...
-    for(ull i = 0; ; i++)
+	// generate traces until killed (or until the given number of iterations is reached)...
+    ull i = 0;
+    for(i = 0; maxIterations == 0 || i < maxIterations; i++)
 	{
-		map<ull, SampleTrace> sampledTracesMap;
+		map<ull, vector<SampleTrace> > sampledTracesMap; // the sampled traces of each seed user (see SG_FFBS_SAMPLES)
 
 		stringstream ssl(""); ssl << "Starting sampling for trace " << i;
 		Log::GetInstance()->Append(ssl.str());
 
+		double stageStart = GetWallClockSeconds();
+
 		LPPMOperation* lppm = NULL;
 		if(RunSGLPPM(outputDir, traceFilePath, knowledgeFilePath, aggregateStatsFilePath, locClustersFilePath,
 									removeProp, mergeProp, removeActualLocProb, &lppm) == false) { return -1; }
 
+		AddStageTime(SGStageLPPM, stageStart); stageStart = GetWallClockSeconds();
+
 		if(RunViterbi(outputDir, traceFilePath, observedTraceFilePath,
 									aggregateStatsFilePath, locClustersFilePath, multFactor, lppm) == false) { return -1; }
 
@@ -893,290 +1189,243 @@ int main(int argc, char **argv)
 				sampleTrace.trace[idx] = trace[idx];
 			}
 
-			sampledTracesMap.insert(make_pair(user, sampleTrace));
+			sampledTracesMap[user].push_back(sampleTrace);
 
-			{ // logging
+			if(Log::GetInstance()->IsEnabled() == true) // logging
+			{
 				stringstream ssl(""); ssl << "Seed user " << user << ", trace: " << i;
 				ssl << ", logLikelihood: " << llk << ", likelihood (not normalized): " << unnorml;
 				Log::GetInstance()->Append(ssl.str());
 			}
 		}
 
+		AddStageTime(SGStageViterbi, stageStart); stageStart = GetWallClockSeconds();
+
 		const ull seedUserID = 1;
 		const ull sampleTraceUserID = 2;
 		pair_foreach_const(map<ull, Trace*>, tracesMap, iterSeedTrace)
 		{
-			TraceSet* seedTraceSet = new TraceSet(ActualTrace);
-
 			ull userID = iterSeedTrace->first;
 			Trace* trace = iterSeedTrace->second;
 			vector<Event*> events; trace->GetEvents(events);
 
-			ull traceByteSize = sizeof(ull) * numTimes;
-			ull* strace = (ull*)Allocate(traceByteSize);
-			VERIFY(strace != NULL); memset(strace, 0, traceByteSize);
-
-			foreach_const(vector<Event*>, events, iterEvents)
-			{
-				ActualEvent* e = dynamic_cast<ActualEvent*>(*iterEvents);
-				VERIFY(e != NULL);
-
-				ull tm = e->GetTimestamp();
-				ull loc =  e->GetLocationstamp();
-
-				ActualEvent* modifiedEvent = new ActualEvent(seedUserID, tm, loc);
-				seedTraceSet->AddEvent(modifiedEvent);
-				modifiedEvent->Release();
-
-				ull tmIdx = (tm - minTimestamp);
-				VERIFY(tmIdx >= 0 && tmIdx < numTimes);
-				strace[tmIdx] = loc;
-			}
-
-			map<ull, SampleTrace>::iterator iterST = sampledTracesMap.find(userID);
+			map<ull, vector<SampleTrace> >::iterator iterST = sampledTracesMap.find(userID);
 			VERIFY(iterST != sampledTracesMap.end());
 
-			SampleTrace& sampleTrace = iterST->second;
-
-			VERIFY(userID == sampleTrace.seedUserID);
+			vector<SampleTrace>& sampleTraces = iterST->second;
 
-			double intersect = 0.0;
-			for(ull tm = minTimestamp; tm <= maxTimestamp; tm++)
+			for(ull sample = 0; sample < sampleTraces.size(); sample++)
 			{
-				ull tmIdx = tm - minTimestamp;
-				ull loc = sampleTrace.trace[tmIdx];
+				TraceSet* seedTraceSet = new TraceSet(ActualTrace);
 
-				ActualEvent* modifiedEvent = new ActualEvent(sampleTraceUserID, tm, loc);
-				seedTraceSet->AddEvent(modifiedEvent);
-				modifiedEvent->Release();
+				ull traceByteSize = sizeof(ull) * numTimes;
+				ull* strace = (ull*)Allocate(traceByteSize);
+				VERIFY(strace != NULL); memset(strace, 0, traceByteSize);
 
-				// compute intersection
-				if(loc == strace[tmIdx]) { intersect += 1.0; }
-			}
-			intersect /= numTimes;
+				foreach_const(vector<Event*>, events, iterEvents)
+				{
+					ActualEvent* e = dynamic_cast<ActualEvent*>(*iterEvents);
+					VERIFY(e != NULL);
 
-			Free(strace); // free the seed trace
-			sampleTrace.intersection = intersect;
+					ull tm = e->GetTimestamp();
+					ull loc =  e->GetLocationstamp();
 
+					ActualEvent* modifiedEvent = new ActualEvent(seedUserID, tm, loc);
+					seedTraceSet->AddEvent(modifiedEvent);
+					modifiedEvent->Release();
 
-			stringstream sst("");
-			ull r = rng->GetUniformRandomULLBetween(0, LLONG_MAX);
-			sst << tmpDir << "sg-LPM__T_" << r;
-			string tempTraceFilePath = sst.str();
+					ull tmIdx = (tm - minTimestamp);
+					VERIFY(tmIdx >= 0 && tmIdx < numTimes);
+					strace[tmIdx] = loc;
+				}
 
-			{
-				File tempTraceFile(tempTraceFilePath, false);
-				VERIFY(tempTraceFile.IsGood() == true);
+				SampleTrace& sampleTrace = sampleTraces[sample];
 
-				// write down the traces
-				OutputOperation* outputOperation = new OutputOperation();
-				VERIFY(outputOperation->Execute(seedTraceSet, &tempTraceFile) == true); outputOperation->Release();
-			}
+				VERIFY(userID == sampleTrace.seedUserID);
 
-			seedTraceSet->Release();
+				double intersect = 0.0;
+				for(ull tm = minTimestamp; tm <= maxTimestamp; tm++)
+				{
+					ull tmIdx = tm - minTimestamp;
+					ull loc = sampleTrace.trace[tmIdx];
 
-			sst.str(""); sst << tmpDir << "sg-LPM__K_" << r;
-			string tempKnowledgeFilePath = sst.str();
+					ActualEvent* modifiedEvent = new ActualEvent(sampleTraceUserID, tm, loc);
+					seedTraceSet->AddEvent(modifiedEvent);
+					modifiedEvent->Release();
 
+					// compute intersection
+					if(loc == strace[tmIdx]) { intersect += 1.0; }
+				}
+				intersect /= numTimes;
 
-			set<ull> rusersSet; VERIFY(params->GetUsersSet(rusersSet) == true);
+				Free(strace); // free the seed trace
+				sampleTrace.intersection = intersect;
 
-			// temporary knowledge construction
-			{
-				File newTempTraceFile(tempTraceFilePath, true);
-				File mobilityFile(mobilityFilePath, true);
-				File tempKnowledgeFile(tempKnowledgeFilePath, false);
 
-				VERIFY(newTempTraceFile.IsGood() == true);
-				VERIFY(tempKnowledgeFile.IsGood() == true);
+				stringstream sst("");
+				ull r = rng->GetUniformRandomULLBetween(0, LLONG_MAX);
+				sst << tmpDir << "sg-LPM__T_" << r;
+				string tempTraceFilePath = sst.str();
 
-				KnowledgeInput knowledge;
-				knowledge.transitionsFeasibilityFile = &mobilityFile;
-				knowledge.transitionsCountFile = NULL;
-				knowledge.learningTraceFilesVector = vector<File*>();
-				knowledge.learningTraceFilesVector.push_back(&newTempTraceFile);
+				{
+					File tempTraceFile(tempTraceFilePath, false);
+					VERIFY(tempTraceFile.IsGood() == true);
 
-				const ull maxGSIterations = 100000;
-				const ull maxSeconds = 60;
+					// write down the traces
+					OutputOperation* outputOperation = new OutputOperation();
+					VERIFY(outputOperation->TimedExecute(seedTraceSet, &tempTraceFile) == true); outputOperation->Release();
+				}
 
-				// set the user set, so the knowledge construction happens correctly
-				params->ClearUsersSet();
-				params->AddUsersRange(seedUserID, seedUserID);
-				params->AddUsersRange(sampleTraceUserID, sampleTraceUserID);
+				seedTraceSet->Release();
 
-				VERIFY(lpm->RunKnowledgeConstruction(&knowledge, &tempKnowledgeFile, maxGSIterations, maxSeconds) == true);
+				sst.str(""); sst << tmpDir << "sg-LPM__K_" << r;
+				string tempKnowledgeFilePath = sst.str();
 
-				remove(tempTraceFilePath.c_str()); // remove the temp file (trace)
-			}
+				// temporary knowledge construction and context analysis of the seed user and of the sampled trace: they run under an
+				// execution context whose user set only contains these two users (the global parameters are left untouched)
+				ExecutionContext* tempContext = new ExecutionContext();
+				VERIFY(tempContext != NULL);
 
-			// do context analysis to get similarity
-			{
-				const bool zerothOrderOnly = true;
+				Parameters* tempParams = tempContext->GetParameters();
+				tempParams->ClearUsersSet();
+				tempParams->AddUsersRange(seedUserID, seedUserID);
+				tempParams->AddUsersRange(sampleTraceUserID, sampleTraceUserID);
 
-				for(ull i = 0; i<2; i++)
 				{
-					File ntempKnowledgeFile(tempKnowledgeFilePath, true);
+					ScopedExecutionContext scope(tempContext);
 
-					VERIFY(ntempKnowledgeFile.IsGood() == true);
+					// temporary knowledge construction
+					{
+						File newTempTraceFile(tempTraceFilePath, true);
+						File mobilityFile(mobilityFilePath, true);
+						File tempKnowledgeFile(tempKnowledgeFilePath, false);
 
-					string name = "Temporary Similarity Analysis Schedule.";
-					ContextAnalysisOperation* contextAnalysisOp = NULL;
+						VERIFY(newTempTraceFile.IsGood() == true);
+						VERIFY(tempKnowledgeFile.IsGood() == true);
 
-					if(i == 0) { contextAnalysisOp = new AbsoluteSimilarityAnalysisOperation("GeographicSimilarityAnalysis", zerothOrderOnly); }
-					else { contextAnalysisOp = new HiddenSemanticsSimilarityAnalysisOperation("SemanticSimilarityAnalysis", zerothOrderOnly); }
-					VERIFY(contextAnalysisOp != NULL);
+						KnowledgeInput knowledge;
+						knowledge.transitionsFeasibilityFile = &mobilityFile;
+						knowledge.transitionsCountFile = NULL;
+						knowledge.learningTraceFilesVector = vector<File*>();
+						knowledge.learningTraceFilesVector.push_back(&newTempTraceFile);
 
-					ContextAnalysisSchedule* schedule = new ContextAnalysisSchedule(name, contextAnalysisOp);
-					VERIFY(schedule != NULL);
+						const ull maxGSIterations = 100000;
+						const ull maxSeconds = 60;
 
-					stringstream ssts(""); ssts << tmpDir << "sg-LPM__S_" << r;
-					string outputSFP = ssts.str();
-					VERIFY(lpm->RunContextAnalysisSchedule(schedule, &ntempKnowledgeFile, outputSFP.c_str()) == true); // run the schedule
+						VERIFY(lpm->RunKnowledgeConstruction(&knowledge, &tempKnowledgeFile, maxGSIterations, maxSeconds) == true);
 
-					File simOutputFile(outputSFP, true);
+						remove(tempTraceFilePath.c_str()); // remove the temp file (trace)
+					}
 
-					string line = ""; VERIFY(simOutputFile.IsGood() == true);
-					bool readOk = simOutputFile.ReadNextLine(line); VERIFY(readOk == true);
-					; // ignore first line
+					// do context analysis to get similarity
+					{
+						const bool zerothOrderOnly = true;
 
-					line = ""; VERIFY(simOutputFile.IsGood() == true);
-					readOk = simOutputFile.ReadNextLine(line); VERIFY(readOk == true);
+						for(ull i = 0; i<2; i++)
+						{
+							File ntempKnowledgeFile(tempKnowledgeFilePath, true);
 
-					size_t posColon = line.find(':');
-					string firstPart = line.substr(0, posColon);
-					string secondPart = line.substr(posColon + 1);
+							VERIFY(ntempKnowledgeFile.IsGood() == true);
 
+							string name = "Temporary Similarity Analysis Schedule.";
+							ContextAnalysisOperation* contextAnalysisOp = NULL;
 
-					VERIFY(firstPart == "1, 2");
-					double sim = 0.0; size_t pos = 0;
-					bool parseOk = parserd->ParseValue(secondPart, &sim, &pos);
-					VERIFY(parseOk == true && pos == string::npos);
+							if(i == 0) { contextAnalysisOp = new AbsoluteSimilarityAnalysisOperation("GeographicSimilarityAnalysis", zerothOrderOnly); }
+							else { contextAnalysisOp = new HiddenSemanticsSimilarityAnalysisOperation("SemanticSimilarityAnalysis", zerothOrderOnly); }
+							VERIFY(contextAnalysisOp != NULL);
 
-					VERIFY(sim >= 0 && sim <= 1.0);
+							ContextAnalysisSchedule* schedule = new ContextAnalysisSchedule(name, contextAnalysisOp);
+							VERIFY(schedule != NULL);
 
-					if(i==0) { sampleTrace.geographicSim = sim; }
-					else { sampleTrace.semanticSim = sim; }
+							stringstream ssts(""); ssts << tmpDir << "sg-LPM__S_" << r;
+							string outputSFP = ssts.str();
+							VERIFY(lpm->RunContextAnalysisSchedule(schedule, &ntempKnowledgeFile, outputSFP.c_str()) == true); // run the schedule
 
-					contextAnalysisOp->Release();
-					delete schedule;
+							File simOutputFile(outputSFP, true);
 
-					remove(outputSFP.c_str()); // remove the temp file (sim)
-				}
-			}
+							string line = ""; VERIFY(simOutputFile.IsGood() == true);
+							bool readOk = simOutputFile.ReadNextLine(line); VERIFY(readOk == true);
+							; // ignore first line
 
-			remove(tempKnowledgeFilePath.c_str()); // remove the temp file (knowledge)
-			string tempKnowledgeFilePathAcc = tempKnowledgeFilePath + ".accuracy";
-			remove(tempKnowledgeFilePathAcc.c_str()); // remove the temp file (knowledge.accuracy)
-
-			// restore the user set;
-			params->ClearUsersSet();
-			foreach_const(set<ull>, rusersSet, iterUsers) { params->AddUsersRange(*iterUsers, *iterUsers); }
-
-			{ // logging
-				stringstream ssl("");
-				ssl << "Seed user: " << sampleTrace.seedUserID << ", trace: " << i;
-				ssl << ", llk: " << sampleTrace.logLikelihood;
-				ssl << ", geo-sim: " << sampleTrace.geographicSim;
-				ssl << ", sem-sim: " << sampleTrace.semanticSim;
-				ssl << ", intersection: " << sampleTrace.intersection;
-				Log::GetInstance()->Append(ssl.str());
-			}
+							line = ""; VERIFY(simOutputFile.IsGood() == true);
+							readOk = simOutputFile.ReadNextLine(line); VERIFY(readOk == true);
 
-			// finally write the trace and suppl file to disk
-			{
-				ull traceIdx = 0;
+							size_t posColon = line.find(':');
+							string firstPart = line.substr(0, posColon);
+							string secondPart = line.substr(posColon + 1);
 
-				// load traceIdx
-				map<ull, ull>::iterator iterTraceIdx = traceIdxMap.find(userID);
-				if(iterTraceIdx == traceIdxMap.end())
-				{
-					traceIdxMap.insert(make_pair(userID, traceIdx));
-					iterTraceIdx = traceIdxMap.find(userID);
-				}
-				traceIdx = iterTraceIdx->second;
 
-				// find appropriate traceIdx
-				{
-					const ull maxAttempts = 10000;
-					ull attempts = 0;
+							VERIFY(firstPart == "1, 2");
+							double sim = 0.0; size_t pos = 0;
+							bool parseOk = parserd->ParseValue(secondPart, &sim, &pos);
+							VERIFY(parseOk == true && pos == string::npos);
 
-					bool done = false;
-					while(done == false)
-					{
-						attempts++;
+							VERIFY(sim >= 0 && sim <= 1.0);
 
-						{ // see if file exists
-							stringstream ssotmp("");
-							ssotmp << "out" << "/" << "user" << userID << "/" "synthetic-trace" << traceIdx;
-							string tryOutputTraceFilePath = outputDir + "/" + ssotmp.str();
-							File tryOutputTraceFile(tryOutputTraceFilePath, true);
+							if(i==0) { sampleTrace.geographicSim = sim; }
+							else { sampleTrace.semanticSim = sim; }
 
-							if(tryOutputTraceFile.IsGood() == false) { done = true; } // file does not exist -> go ahead
-							else { traceIdx++; }
-						}
+							contextAnalysisOp->Release();
+							delete schedule;
 
-						if(attempts >= maxAttempts) { traceIdx = rng->GetUniformRandomULLBetween(0, 2*attempts); }
+							remove(outputSFP.c_str()); // remove the temp file (sim)
+						}
 					}
 				}
-				// save traceIdx
-				iterTraceIdx->second = traceIdx + 1;
 
-				stringstream ssot("");
-				ssot << "out" << "/" << "user" << userID << "/" "synthetic-trace" << traceIdx;
-				string outputTraceFilePath = outputDir + "/" + ssot.str();
-				File outputTraceFile(outputTraceFilePath, false);
-				VERIFY(outputTraceFile.IsGood() == true);
+				tempContext->Release();
+
+				remove(tempKnowledgeFilePath.c_str()); // remove the temp file (knowledge)
+				string tempKnowledgeFilePathAcc = tempKnowledgeFilePath + ".accuracy";
+				remove(tempKnowledgeFilePathAcc.c_str()); // remove the temp file (knowledge.accuracy)
 
-				// write down info
-				ssot << ".info";
+				if(Log::GetInstance()->IsEnabled() == true) // logging
 				{
-					string outputInfoFilePath = outputDir + "/" + ssot.str();
-					File outputInfoFile(outputInfoFilePath, false);
-					VERIFY(outputInfoFile.IsGood() == true);
+					stringstream ssl("");
+					ssl << "Seed user: " << sampleTrace.seedUserID << ", trace: " << i;
+					ssl << ", llk: " << sampleTrace.logLikelihood;
+					ssl << ", geo-sim: " << sampleTrace.geographicSim;
+					ssl << ", sem-sim: " << sampleTrace.semanticSim;
+					ssl << ", intersection: " << sampleTrace.intersection;
+					Log::GetInstance()->Append(ssl.str());
+				}
 
-					stringstream ss2("");
-					ss2 << sampleTrace.seedUserID << DEFAULT_FIELDS_DELIMITER;
-					ss2 << sampleTrace.logLikelihood << DEFAULT_FIELDS_DELIMITER;
-					ss2 << sampleTrace.geographicSim << DEFAULT_FIELDS_DELIMITER;
-					ss2 << sampleTrace.semanticSim << DEFAULT_FIELDS_DELIMITER;
-					ss2 << sampleTrace.intersection;
+				// finally append the trace and its metadata to the store
+				{
+					ull* trace = sampleTrace.trace;
+					VERIFY(trace != NULL);
 
-					outputInfoFile.WriteLine(ss2.str());
+					SyntheticTraceRecord record;
+					record.userID = userID;
+					record.seedUserID = sampleTrace.seedUserID;
+					record.logLikelihood = sampleTrace.logLikelihood;
+					record.geographicSim = sampleTrace.geographicSim;
+					record.semanticSim = sampleTrace.semanticSim;
+					record.intersection = sampleTrace.intersection;
 
 					// save the parameters, just in case we need them later
-					ss2.str("");
-
-					ss2 << removeProp << DEFAULT_FIELDS_DELIMITER;
-					ss2 << mergeProp << DEFAULT_FIELDS_DELIMITER;
-					ss2 << removeActualLocProb << DEFAULT_FIELDS_DELIMITER;
-					ss2 << multFactor;
-
-					outputInfoFile.WriteLine(ss2.str());
-				}
-
-				ull* trace = sampleTrace.trace;
-				VERIFY(trace != NULL);
+					record.removeProp = removeProp;
+					record.mergeProp = mergeProp;
+					record.removeActualLocProb = removeActualLocProb;
+					record.multFactor = multFactor;
 
-				for(ull tm = minTimestamp; tm <= maxTimestamp; tm++)
-				{
-					ull idx = tm - minTimestamp;
-					ull loc = trace[idx];
+					record.minTimestamp = minTimestamp;
+					record.trace = vector<ull>(trace, trace + numTimes);
 
-					stringstream ss2("");
-					ss2 << userID << DEFAULT_FIELDS_DELIMITER;
-					ss2 << tm << DEFAULT_FIELDS_DELIMITER;
-					ss2 << loc;
+					VERIFY(storeWriter.Append(record) == true);
 
-					outputTraceFile.WriteLine(ss2.str());
+					Free(sampleTrace.trace); sampleTrace.trace = NULL;
 				}
 
-				Free(sampleTrace.trace); sampleTrace.trace = NULL;
+				numSyntheticTraces++;
 			}
-
 		}
 
+		AddStageTime(SGStagePlausibility, stageStart);
 	}
 
+	ReportStageTimes(i, numSyntheticTraces, GetWallClockSeconds() - generationStart);
+
 	actualTraceSet->Release();
 
 	stringstream ssl(""); ssl << "Done with sampling.";